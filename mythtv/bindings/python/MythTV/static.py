@@ -8,8 +8,8 @@ OWN_VERSION = (32,0,-1,0)
 SCHEMA_VERSION = 1366
 NVSCHEMA_VERSION = 1007
 MUSICSCHEMA_VERSION = 1024
-PROTO_VERSION = '91'
-PROTO_TOKEN = 'BuzzOff'
+PROTO_VERSION = '92'
+PROTO_TOKEN = 'BuzzKill'
 BACKEND_SEP = '[]:[]'
 INSTALL_PREFIX = '/usr/local'
 
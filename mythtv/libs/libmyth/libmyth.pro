@@ -50,6 +50,7 @@ HEADERS += mythterminal.h
 HEADERS += remoteutil.h
 HEADERS += rawsettingseditor.h
 HEADERS += programinfo.h          programinfoupdater.h
+HEADERS += packedlist.h
 HEADERS += programtypes.h         recordingtypes.h
 HEADERS += rssparse.h
 HEADERS += guistartup.h
@@ -76,6 +77,7 @@ SOURCES += mythterminal.cpp
 SOURCES += remoteutil.cpp
 SOURCES += rawsettingseditor.cpp
 SOURCES += programinfo.cpp        programinfoupdater.cpp
+SOURCES += packedlist.cpp
 SOURCES += programtypes.cpp       recordingtypes.cpp
 SOURCES += rssparse.cpp
 SOURCES += guistartup.cpp
@@ -138,7 +140,7 @@ inc.files += mythaverror.h mythmediamonitor.h
 inc.files += visual.h output.h langsettings.h
 inc.files += mythexp.h storagegroupeditor.h
 inc.files += mythterminal.h       remoteutil.h
-inc.files += programinfo.h
+inc.files += programinfo.h          packedlist.h
 inc.files += programtypes.h       recordingtypes.h
 inc.files += rssparse.h
 inc.files += standardsettings.h
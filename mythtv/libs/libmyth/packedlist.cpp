@@ -0,0 +1,195 @@
+// C++ headers
+#include <cstring>
+
+// Qt headers
+#include <QtEndian>
+
+// MythTV headers
+#include "mythdate.h"
+#include "packedlist.h"
+
+const int  PackedListWriter::kMaxInternLength = 64;
+const char PackedListWriter::kMagic[4] = { 'M', 'P', 'L', 1 };
+
+// String tags, any larger tag is an index into the string table plus two
+static constexpr uint64_t kStringLiteral  = 0;
+static constexpr uint64_t kStringInterned = 1;
+
+static inline uint64_t zigzag_encode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^
+        static_cast<uint64_t>(value >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void PackedListWriter::PutUInt(QByteArray &data, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        data.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(static_cast<char>(value));
+}
+
+void PackedListWriter::PutUInt(uint64_t value)
+{
+    PutUInt(m_data, value);
+}
+
+void PackedListWriter::PutInt(int64_t value)
+{
+    PutUInt(zigzag_encode(value));
+}
+
+void PackedListWriter::PutFloat(float value)
+{
+    quint32 bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = qToLittleEndian(bits);
+    m_data.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+}
+
+void PackedListWriter::PutString(const QString &value)
+{
+    if (value.size() > kMaxInternLength)
+    {
+        QByteArray utf8 = value.toUtf8();
+        PutUInt(kStringLiteral);
+        PutUInt(utf8.size());
+        m_data.append(utf8);
+        return;
+    }
+
+    auto it = m_strings.constFind(value);
+    if (it != m_strings.constEnd())
+    {
+        PutUInt(*it + 2);
+        return;
+    }
+
+    QByteArray utf8 = value.toUtf8();
+    PutUInt(kStringInterned);
+    PutUInt(utf8.size());
+    m_data.append(utf8);
+    m_strings.insert(value, m_strings.size());
+}
+
+void PackedListWriter::PutDateTime(const QDateTime &value)
+{
+    PutUInt(value.isValid() ? zigzag_encode(value.toSecsSinceEpoch()) + 1 : 0);
+}
+
+void PackedListWriter::PutDate(const QDate &value)
+{
+    PutUInt(value.isValid() ? zigzag_encode(value.toJulianDay()) + 1 : 0);
+}
+
+QByteArray PackedListWriter::GetData(void) const
+{
+    QByteArray data;
+    data.reserve(m_data.size() + sizeof(kMagic) + 10);
+    data.append(kMagic, sizeof(kMagic));
+    PutUInt(data, m_count);
+    data.append(m_data);
+    return data;
+}
+
+PackedListReader::PackedListReader(const QByteArray &data) :
+    m_data(data)
+{
+    if (m_data.size() < static_cast<int>(sizeof(PackedListWriter::kMagic)) ||
+        memcmp(m_data.constData(), PackedListWriter::kMagic,
+               sizeof(PackedListWriter::kMagic)) != 0)
+    {
+        m_error = true;
+        return;
+    }
+    m_pos = sizeof(PackedListWriter::kMagic);
+    m_count = GetUInt();
+}
+
+uint64_t PackedListReader::GetUInt(void)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (m_pos >= m_data.size())
+            break;
+        auto byte = static_cast<uint8_t>(m_data[m_pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    m_error = true;
+    return 0;
+}
+
+int64_t PackedListReader::GetInt(void)
+{
+    return zigzag_decode(GetUInt());
+}
+
+float PackedListReader::GetFloat(void)
+{
+    quint32 bits = 0;
+    if (m_pos + static_cast<int>(sizeof(bits)) > m_data.size())
+    {
+        m_error = true;
+        return 0.0F;
+    }
+    memcpy(&bits, m_data.constData() + m_pos, sizeof(bits));
+    m_pos += sizeof(bits);
+    bits = qFromLittleEndian(bits);
+
+    float value = 0.0F;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+QString PackedListReader::GetString(void)
+{
+    uint64_t tag = GetUInt();
+    if (tag >= 2)
+    {
+        if (tag - 2 >= static_cast<uint64_t>(m_strings.size()))
+        {
+            m_error = true;
+            return {};
+        }
+        return m_strings[tag - 2];
+    }
+
+    uint64_t len = GetUInt();
+    if (m_error || len > static_cast<uint64_t>(m_data.size() - m_pos))
+    {
+        m_error = true;
+        return {};
+    }
+    QString value = QString::fromUtf8(m_data.constData() + m_pos, len);
+    m_pos += len;
+
+    if (tag == kStringInterned)
+        m_strings.push_back(value);
+    return value;
+}
+
+QDateTime PackedListReader::GetDateTime(void)
+{
+    uint64_t value = GetUInt();
+    if (!value)
+        return {};
+    return MythDate::fromSecsSinceEpoch(zigzag_decode(value - 1));
+}
+
+QDate PackedListReader::GetDate(void)
+{
+    uint64_t value = GetUInt();
+    if (!value)
+        return {};
+    return QDate::fromJulianDay(zigzag_decode(value - 1));
+}
@@ -0,0 +1,93 @@
+// -*- Mode: c++ -*-
+
+#ifndef PACKEDLIST_H_
+#define PACKEDLIST_H_
+
+// C++ headers
+#include <cstdint>
+
+// Qt headers
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// MythTV headers
+#include "mythexp.h"
+
+/** \class PackedListWriter
+ *  \brief Builds the binary form of a list of records which protocol
+ *         commands send in place of a string list when the client asks
+ *         for it.
+ *
+ *   Each record is a fixed sequence of typed fields.  Integers are
+ *   written as variable length quantities, zig-zag encoded so small
+ *   negative values stay short.  Strings up to kMaxInternLength
+ *   characters are interned: the first occurrence is written as UTF-8
+ *   and every later one as an index into the table of strings already
+ *   seen, which covers the channel, group and host names repeated in
+ *   every record.  The data starts with a magic number, a format version
+ *   and the record count.
+ */
+class MPUBLIC PackedListWriter
+{
+  public:
+    PackedListWriter() = default;
+
+    void PutInt(int64_t value);
+    void PutFloat(float value);
+    void PutString(const QString &value);
+    void PutDateTime(const QDateTime &value);
+    void PutDate(const QDate &value);
+    void EndRecord(void) { m_count++; }
+
+    uint GetCount(void) const { return m_count; }
+    QByteArray GetData(void) const;
+
+    static const int kMaxInternLength;
+    static const char kMagic[4];
+
+  private:
+    void PutUInt(uint64_t value);
+    static void PutUInt(QByteArray &data, uint64_t value);
+
+    QByteArray           m_data;
+    QHash<QString, uint> m_strings;
+    uint                 m_count {0};
+};
+
+/** \class PackedListReader
+ *  \brief Reads the records built by PackedListWriter.
+ *
+ *   Reading past the end of the data or a malformed field sets the
+ *   error flag and returns empty values, so a record can be read in one
+ *   go and checked with HasError() afterwards.
+ */
+class MPUBLIC PackedListReader
+{
+  public:
+    explicit PackedListReader(const QByteArray &data);
+
+    int64_t   GetInt(void);
+    float     GetFloat(void);
+    QString   GetString(void);
+    QDateTime GetDateTime(void);
+    QDate     GetDate(void);
+
+    uint GetCount(void) const { return m_count; }
+    bool HasError(void) const { return m_error; }
+    bool AtEnd(void) const { return m_pos >= m_data.size(); }
+
+  private:
+    uint64_t GetUInt(void);
+
+    QByteArray       m_data;
+    int              m_pos   {0};
+    uint             m_count {0};
+    bool             m_error {false};
+    QVector<QString> m_strings;
+};
+
+#endif // PACKEDLIST_H_
@@ -32,6 +32,7 @@ using std::min;
 #include "compat.h"
 #include "mythcdrom.h"
 #include "mythsorthelper.h"
+#include "packedlist.h"
 
 #include <unistd.h> // for getpid()
 
@@ -1458,6 +1459,186 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     return true;
 }
 
+#define INT_TO_PACKED(x)      do { list.PutInt(x); } while (false)
+#define DATETIME_TO_PACKED(x) do { list.PutDateTime(x); } while (false)
+#define STR_TO_PACKED(x)      do { list.PutString(x); } while (false)
+#define DATE_TO_PACKED(x)     do { list.PutDate(x); } while (false)
+#define FLOAT_TO_PACKED(x)    do { list.PutFloat(x); } while (false)
+
+/** \fn ProgramInfo::ToPackedList(PackedListWriter&) const
+ *  \brief Serializes ProgramInfo into the binary list sent to clients
+ *         which ask for it.
+ *
+ *   The fields and their order are those of ToStringList(), each written
+ *   with its own type rather than as a string.
+ *  \sa FromPackedList(PackedListReader&)
+ */
+void ProgramInfo::ToPackedList(PackedListWriter &list) const
+{
+    STR_TO_PACKED(m_title);        // 0
+    STR_TO_PACKED(m_subtitle);     // 1
+    STR_TO_PACKED(m_description);  // 2
+    INT_TO_PACKED(m_season);       // 3
+    INT_TO_PACKED(m_episode);      // 4
+    INT_TO_PACKED(m_totalEpisodes); // 5
+    STR_TO_PACKED(m_syndicatedEpisode); // 6
+    STR_TO_PACKED(m_category);     // 7
+    INT_TO_PACKED(m_chanId);       // 8
+    STR_TO_PACKED(m_chanStr);      // 9
+    STR_TO_PACKED(m_chanSign);     // 10
+    STR_TO_PACKED(m_chanName);     // 11
+    STR_TO_PACKED(m_pathname);     // 12
+    INT_TO_PACKED(m_fileSize);     // 13
+
+    DATETIME_TO_PACKED(m_startTs); // 14
+    DATETIME_TO_PACKED(m_endTs);   // 15
+    INT_TO_PACKED(m_findId);       // 16
+    STR_TO_PACKED(m_hostname);     // 17
+    INT_TO_PACKED(m_sourceId);     // 18
+    // 19 (formerly cardid) is not sent
+    INT_TO_PACKED(m_inputId);      // 20
+    INT_TO_PACKED(m_recPriority);  // 21
+    INT_TO_PACKED(m_recStatus);    // 22
+    INT_TO_PACKED(m_recordId);     // 23
+
+    INT_TO_PACKED(m_recType);      // 24
+    INT_TO_PACKED(m_dupIn);        // 25
+    INT_TO_PACKED(m_dupMethod);    // 26
+    DATETIME_TO_PACKED(m_recStartTs);//27
+    DATETIME_TO_PACKED(m_recEndTs);// 28
+    INT_TO_PACKED(m_programFlags); // 29
+    STR_TO_PACKED(!m_recGroup.isEmpty() ? m_recGroup : "Default"); // 30
+    STR_TO_PACKED(m_chanPlaybackFilters); // 31
+    STR_TO_PACKED(m_seriesId);     // 32
+    STR_TO_PACKED(m_programId);    // 33
+    STR_TO_PACKED(m_inetRef);      // 34
+
+    DATETIME_TO_PACKED(m_lastModified); // 35
+    FLOAT_TO_PACKED(m_stars);           // 36
+    DATE_TO_PACKED(m_originalAirDate);  // 37
+    STR_TO_PACKED((!m_playGroup.isEmpty()) ? m_playGroup : "Default"); // 38
+    INT_TO_PACKED(m_recPriority2);      // 39
+    INT_TO_PACKED(m_parentId);          // 40
+    STR_TO_PACKED((!m_storageGroup.isEmpty()) ? m_storageGroup : "Default"); // 41
+    INT_TO_PACKED(GetAudioProperties()); // 42
+    INT_TO_PACKED(GetVideoProperties()); // 43
+    INT_TO_PACKED(GetSubtitleType());    // 44
+
+    INT_TO_PACKED(m_year);              // 45
+    INT_TO_PACKED(m_partNumber);   // 46
+    INT_TO_PACKED(m_partTotal);    // 47
+    INT_TO_PACKED(m_catType);      // 48
+
+    INT_TO_PACKED(m_recordedId);          // 49
+    STR_TO_PACKED(m_inputName);           // 50
+    DATETIME_TO_PACKED(m_bookmarkUpdate); // 51
+
+    list.EndRecord();
+/* keep the fields in step with ToStringList() and FromPackedList()! */
+}
+
+#define INT_FROM_PACKED(x)      do { (x) = list.GetInt(); } while (false)
+#define ENUM_FROM_PACKED(x, y)  do { (x) = ((y)list.GetInt()); } while (false)
+#define DATETIME_FROM_PACKED(x) do { (x) = list.GetDateTime(); } while (false)
+#define STR_FROM_PACKED(x)      do { (x) = list.GetString(); } while (false)
+#define DATE_FROM_PACKED(x)     do { (x) = list.GetDate(); } while (false)
+#define FLOAT_FROM_PACKED(x)    do { (x) = list.GetFloat(); } while (false)
+
+/** \fn ProgramInfo::FromPackedList(PackedListReader&)
+ *  \brief Initializes this ProgramInfo from the next record of a binary
+ *         list built by ToPackedList().
+ *  \return true if it succeeds, false if the list is malformed.
+ */
+bool ProgramInfo::FromPackedList(PackedListReader &list)
+{
+    uint      origChanid     = m_chanId;
+    QDateTime origRecstartts = m_recStartTs;
+
+    STR_FROM_PACKED(m_title);            // 0
+    STR_FROM_PACKED(m_subtitle);         // 1
+    STR_FROM_PACKED(m_description);      // 2
+    INT_FROM_PACKED(m_season);           // 3
+    INT_FROM_PACKED(m_episode);          // 4
+    INT_FROM_PACKED(m_totalEpisodes);    // 5
+    STR_FROM_PACKED(m_syndicatedEpisode); // 6
+    STR_FROM_PACKED(m_category);         // 7
+    INT_FROM_PACKED(m_chanId);           // 8
+    STR_FROM_PACKED(m_chanStr);          // 9
+    STR_FROM_PACKED(m_chanSign);         // 10
+    STR_FROM_PACKED(m_chanName);         // 11
+    STR_FROM_PACKED(m_pathname);         // 12
+    INT_FROM_PACKED(m_fileSize);         // 13
+
+    DATETIME_FROM_PACKED(m_startTs);     // 14
+    DATETIME_FROM_PACKED(m_endTs);       // 15
+    INT_FROM_PACKED(m_findId);           // 16
+    STR_FROM_PACKED(m_hostname);         // 17
+    INT_FROM_PACKED(m_sourceId);         // 18
+    INT_FROM_PACKED(m_inputId);          // 20
+    INT_FROM_PACKED(m_recPriority);      // 21
+    ENUM_FROM_PACKED(m_recStatus, RecStatus::Type); // 22
+    INT_FROM_PACKED(m_recordId);         // 23
+
+    ENUM_FROM_PACKED(m_recType, RecordingType);            // 24
+    ENUM_FROM_PACKED(m_dupIn, RecordingDupInType);         // 25
+    ENUM_FROM_PACKED(m_dupMethod, RecordingDupMethodType); // 26
+    DATETIME_FROM_PACKED(m_recStartTs);   // 27
+    DATETIME_FROM_PACKED(m_recEndTs);     // 28
+    INT_FROM_PACKED(m_programFlags);      // 29
+    STR_FROM_PACKED(m_recGroup);          // 30
+    STR_FROM_PACKED(m_chanPlaybackFilters);//31
+    STR_FROM_PACKED(m_seriesId);          // 32
+    STR_FROM_PACKED(m_programId);         // 33
+    STR_FROM_PACKED(m_inetRef);           // 34
+
+    DATETIME_FROM_PACKED(m_lastModified); // 35
+    FLOAT_FROM_PACKED(m_stars);           // 36
+    DATE_FROM_PACKED(m_originalAirDate);  // 37
+    STR_FROM_PACKED(m_playGroup);         // 38
+    INT_FROM_PACKED(m_recPriority2);      // 39
+    INT_FROM_PACKED(m_parentId);          // 40
+    STR_FROM_PACKED(m_storageGroup);      // 41
+    uint audioproperties = 0;
+    uint videoproperties = 0;
+    uint subtitleType = 0;
+    INT_FROM_PACKED(audioproperties);   // 42
+    INT_FROM_PACKED(videoproperties);   // 43
+    INT_FROM_PACKED(subtitleType);      // 44
+    m_properties = ((subtitleType    << kSubtitlePropertyOffset) |
+                    (videoproperties << kVideoPropertyOffset)    |
+                    (audioproperties << kAudioPropertyOffset));
+
+    INT_FROM_PACKED(m_year);              // 45
+    INT_FROM_PACKED(m_partNumber);        // 46
+    INT_FROM_PACKED(m_partTotal);         // 47
+    ENUM_FROM_PACKED(m_catType, CategoryType); // 48
+
+    INT_FROM_PACKED(m_recordedId);          // 49
+    STR_FROM_PACKED(m_inputName);           // 50
+    DATETIME_FROM_PACKED(m_bookmarkUpdate); // 51
+
+    if (list.HasError())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FromPackedList, malformed list.");
+        clear();
+        return false;
+    }
+
+    if (!origChanid || !origRecstartts.isValid() ||
+        (origChanid != m_chanId) || (origRecstartts != m_recStartTs))
+    {
+        m_availableStatus = asAvailable;
+        m_spread = -1;
+        m_startCol = -1;
+        m_inUseForWhat = QString();
+        m_positionMapDBReplacement = nullptr;
+    }
+
+    ensureSortFields();
+
+    return true;
+}
+
 /** \brief Converts ProgramInfo into QString QHash containing each field
  *         in ProgramInfo converted into localized strings.
  */
@@ -5814,7 +5995,8 @@ bool LoadFromRecorded(
     const QMap<QString,bool> &isJobRunning,
     const QMap<QString, ProgramInfo*> &recMap,
     int sort,
-    const QString &sortBy)
+    const QString &sortBy,
+    const QList<uint> &recordedids)
 {
     destination.clear();
 
@@ -5827,6 +6009,16 @@ bool LoadFromRecorded(
     if (possiblyInProgressRecordingsOnly)
         thequery += "WHERE r.endtime >= NOW() AND r.starttime <= NOW() ";
 
+    if (!recordedids.isEmpty())
+    {
+        QStringList ids;
+        ids.reserve(recordedids.size());
+        for (uint recordedid : recordedids)
+            ids << QString::number(recordedid);
+        thequery += possiblyInProgressRecordingsOnly ? "AND " : "WHERE ";
+        thequery += QString("r.recordedid IN (%1) ").arg(ids.join(','));
+    }
+
     if (sortBy.isEmpty())
     {
         if (sort)
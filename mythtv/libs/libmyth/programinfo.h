@@ -28,6 +28,8 @@
 #define NUMPROGRAMLINES 52
 
 class ProgramInfo;
+class PackedListWriter;
+class PackedListReader;
 using ProgramList = AutoDeleteDeque<ProgramInfo*>;
 
 /** \class ProgramInfo
@@ -308,6 +310,8 @@ class MPUBLIC ProgramInfo
 
     // Serializers
     void ToStringList(QStringList &list) const;
+    void ToPackedList(PackedListWriter &list) const;
+    bool FromPackedList(PackedListReader &list);
     virtual void ToMap(InfoMap &progMap,
                        bool showrerecord = false,
                        uint star_range = 10) const;
@@ -529,6 +533,7 @@ class MPUBLIC ProgramInfo
     void SetRecordingRuleID(uint id)                { m_recordId     = id;    }
     void SetSourceID(uint id)                       { m_sourceId     = id;    }
     void SetInputID(uint id)                        { m_inputId      = id;    }
+    void SetProgramFlags(uint32_t flags)         { m_programFlags = flags; }
     void SetReactivated(bool reactivate)
     {
         m_programFlags &= ~FL_REACTIVATE;
@@ -876,7 +881,8 @@ MPUBLIC bool LoadFromRecorded(
     const QMap<QString,bool> &isJobRunning,
     const QMap<QString, ProgramInfo*> &recMap,
     int                 sort = 0,
-    const QString      &sortBy = "");
+    const QString      &sortBy = "",
+    const QList<uint>  &recordedids = QList<uint>());
 
 
 template<typename TYPE>
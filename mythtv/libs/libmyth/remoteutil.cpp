@@ -12,6 +12,68 @@
 #include "storagegroup.h"
 #include "mythevent.h"
 #include "mythsocket.h"
+#include "packedlist.h"
+
+// Cleared once a backend has rejected the packed form of a query, so the
+// query is not tried again until the next start.
+static QAtomicInt s_packedSupported {1};
+
+/** \brief Issues a QUERY_RECORDINGS style request asking for the packed
+ *         form of the list, falling back to the string list form if the
+ *         backend does not know it.
+ *
+ *  \return the number of programs added to reclist
+ */
+static uint RemoteGetPackedRecordingList(
+    vector<ProgramInfo *> &reclist, const QString &query)
+{
+    if (s_packedSupported.loadAcquire())
+    {
+        QStringList strlist(query + " Packed");
+        QByteArray packed;
+        bool ok = gCoreContext->SendReceiveStringList(
+            strlist, false, true, &packed);
+
+        if (ok && strlist.size() >= 3 && strlist[0] == "PACKED")
+        {
+            PackedListReader list(packed);
+            uint count = list.GetCount();
+            if (list.HasError() || count != strlist[1].toUInt())
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    "RemoteGetRecordingList() packed list is malformed.");
+                return 0;
+            }
+
+            uint reclist_initial_size = (uint) reclist.size();
+            reclist.reserve(reclist_initial_size + count);
+            for (uint i = 0; i < count; i++)
+            {
+                auto *pginfo = new ProgramInfo();
+                if (!pginfo->FromPackedList(list))
+                {
+                    delete pginfo;
+                    break;
+                }
+                reclist.push_back(pginfo);
+            }
+            return ((uint) reclist.size()) - reclist_initial_size;
+        }
+
+        // Lost the connection rather than being turned down
+        if (!ok && (strlist.isEmpty() ||
+                    (strlist[0] != "ERROR" && strlist[0] != "UNKNOWN_COMMAND")))
+            return 0;
+
+        LOG(VB_GENERAL, LOG_INFO,
+            "Backend does not support packed recording lists, "
+            "using string lists.");
+        s_packedSupported.storeRelease(0);
+    }
+
+    QStringList strlist(query);
+    return RemoteGetRecordingList(reclist, strlist);
+}
 
 vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
 {
@@ -23,11 +85,9 @@ vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
     else
         str += "Unsorted";
 
-    QStringList strlist(str);
-
     auto *info = new vector<ProgramInfo *>;
 
-    if (!RemoteGetRecordingList(*info, strlist))
+    if (!RemoteGetPackedRecordingList(*info, str))
     {
         delete info;
         return nullptr;
@@ -36,6 +96,63 @@ vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
     return info;
 }
 
+/** \brief Asks the backend which recordings changed since the list
+ *         loaded at a cursor.
+ *
+ *  \param cursor  Cursor of the list held, set to the cursor of the list
+ *                 after the changes.  An empty cursor asks for the cursor
+ *                 to use with a newly loaded list.
+ *  \param reload  Set if the backend can not answer for the cursor, in
+ *                 which case the whole list must be loaded again.
+ *  \param changed Filled with the recordings added or changed.
+ *  \param deleted Filled with the recordedid of the recordings deleted.
+ *  \return false if the request failed or the backend does not support it
+ */
+bool RemoteGetRecordedListChanges(QString &cursor, bool &reload,
+                                  vector<ProgramInfo *> &changed,
+                                  vector<uint> &deleted)
+{
+    QStringList strlist("QUERY_RECORDINGS_CHANGES");
+    if (!cursor.isEmpty())
+        strlist[0] += " " + cursor;
+
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() < 2)
+        return false;
+
+    if (strlist[0] == "FULL")
+    {
+        cursor = strlist[1];
+        reload = true;
+        return true;
+    }
+
+    if (strlist[0] != "CHANGES" || strlist.size() < 4)
+        return false;
+
+    QStringList::const_iterator it = strlist.cbegin() + 2;
+    int ndeleted = (*it++).toInt();
+    if (ndeleted < 0 || ndeleted + 4 > strlist.size())
+        return false;
+    for (int i = 0; i < ndeleted; i++)
+        deleted.push_back((*it++).toUInt());
+
+    int nchanged = (*it++).toInt();
+    if (nchanged < 0 ||
+        nchanged * NUMPROGRAMLINES + ndeleted + 4 > strlist.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "RemoteGetRecordedListChanges() list size appears to be incorrect.");
+        deleted.clear();
+        return false;
+    }
+    for (int i = 0; i < nchanged; i++)
+        changed.push_back(new ProgramInfo(it, strlist.cend()));
+
+    cursor = strlist[1];
+    reload = false;
+    return true;
+}
+
 bool RemoteGetLoad(system_load_array& load)
 {
     QStringList strlist(QString("QUERY_LOAD"));
@@ -524,11 +641,10 @@ vector<ProgramInfo *> *RemoteGetCurrentlyRecordingList(void)
 {
     QString str = "QUERY_RECORDINGS ";
     str += "Recording";
-    QStringList strlist( str );
 
     auto *reclist = new vector<ProgramInfo *>;
     auto *info = new vector<ProgramInfo *>;
-    if (!RemoteGetRecordingList(*info, strlist))
+    if (!RemoteGetPackedRecordingList(*info, str))
     {
         delete info;
         return reclist;
@@ -17,6 +17,9 @@ class MythEvent;
 using system_load_array = std::array<double,3>;
 
 MPUBLIC vector<ProgramInfo *> *RemoteGetRecordedList(int sort);
+MPUBLIC bool RemoteGetRecordedListChanges(
+    QString &cursor, bool &reload,
+    vector<ProgramInfo *> &changed, vector<uint> &deleted);
 MPUBLIC bool RemoteGetLoad(system_load_array &load);
 MPUBLIC bool RemoteGetUptime(time_t &uptime);
 MPUBLIC
@@ -22,6 +22,7 @@
 #include <QtTest/QtTest>
 
 #include "mythcorecontext.h"
+#include "packedlist.h"
 #include "programinfo.h"
 #include "programtypes.h"
 
@@ -289,6 +290,159 @@ class TestProgramInfo : public QObject
         QVERIFY(m_supergirl23 == lrigrepus23c);
     }
 
+    void programToPackedList_test(void)
+    {
+        PackedListWriter writer;
+        m_dracula.ToPackedList(writer);
+        m_flash34.ToPackedList(writer);
+        m_supergirl23.ToPackedList(writer);
+        QCOMPARE(writer.GetCount(), 3U);
+
+        PackedListReader reader(writer.GetData());
+        QVERIFY(!reader.HasError());
+        QCOMPARE(reader.GetCount(), 3U);
+
+        ProgramInfo alucard;
+        QVERIFY(alucard.FromPackedList(reader));
+        QVERIFY(m_dracula == alucard);
+        ProgramInfo hsalf34;
+        QVERIFY(hsalf34.FromPackedList(reader));
+        QVERIFY(m_flash34 == hsalf34);
+        ProgramInfo lrigrepus23;
+        QVERIFY(lrigrepus23.FromPackedList(reader));
+        QVERIFY(m_supergirl23 == lrigrepus23);
+        QVERIFY(reader.AtEnd());
+
+        // The packed and string list forms must carry the same fields
+        QStringList packed_list;
+        QStringList program_list;
+        hsalf34.ToStringList(packed_list);
+        m_flash34.ToStringList(program_list);
+        QCOMPARE(packed_list, program_list);
+
+        // Test a truncated list
+        QByteArray data = writer.GetData();
+        data.chop(10);
+        PackedListReader truncated(data);
+        ProgramInfo program;
+        QVERIFY(program.FromPackedList(truncated));
+        QVERIFY(program.FromPackedList(truncated));
+        QVERIFY(!program.FromPackedList(truncated));
+
+        // Test a bad magic number
+        data[0] = 'X';
+        PackedListReader bad(data);
+        QVERIFY(bad.HasError());
+    }
+
+    static void packedListValues_test(void)
+    {
+        PackedListWriter writer;
+        writer.PutInt(0);
+        writer.PutInt(-1);
+        writer.PutInt(INT64_MAX);
+        writer.PutInt(INT64_MIN);
+        writer.PutInt(UINT_MAX);
+        writer.PutString("");
+        writer.PutString("Default");
+        writer.PutString("Default");
+        writer.PutString(QString(100, QChar(0x00e9)));
+        writer.PutDateTime(QDateTime());
+        writer.PutDateTime(MythDate::fromString("2016-10-26 01:12:34"));
+        writer.PutDate(QDate());
+        writer.PutDate(QDate(1958, 5, 8));
+        writer.PutFloat(0.5F);
+        writer.EndRecord();
+
+        PackedListReader reader(writer.GetData());
+        QCOMPARE(reader.GetCount(), 1U);
+        QCOMPARE(reader.GetInt(), (int64_t)0);
+        QCOMPARE(reader.GetInt(), (int64_t)-1);
+        QCOMPARE(reader.GetInt(), (int64_t)INT64_MAX);
+        QCOMPARE(reader.GetInt(), (int64_t)INT64_MIN);
+        QCOMPARE(reader.GetInt(), (int64_t)UINT_MAX);
+        QCOMPARE(reader.GetString(), QString(""));
+        QCOMPARE(reader.GetString(), QString("Default"));
+        QCOMPARE(reader.GetString(), QString("Default"));
+        QCOMPARE(reader.GetString(), QString(100, QChar(0x00e9)));
+        QVERIFY(!reader.GetDateTime().isValid());
+        QCOMPARE(reader.GetDateTime(),
+                 MythDate::fromString("2016-10-26 01:12:34"));
+        QVERIFY(!reader.GetDate().isValid());
+        QCOMPARE(reader.GetDate(), QDate(1958, 5, 8));
+        QCOMPARE(reader.GetFloat(), 0.5F);
+        QVERIFY(!reader.HasError());
+        QVERIFY(reader.AtEnd());
+
+        reader.GetInt();
+        QVERIFY(reader.HasError());
+    }
+
+    static void benchmarkSerialize_data(void)
+    {
+        QTest::addColumn<bool>("packed");
+        QTest::newRow("stringlist") << false;
+        QTest::newRow("packed")     << true;
+    }
+
+    // Serializes and parses a recording list the size of a large library,
+    // and reports the bytes each form puts on the wire.
+    void benchmarkSerialize(void)
+    {
+        QFETCH(bool, packed);
+
+        static constexpr int kRecordings = 20000;
+        std::vector<ProgramInfo> recordings;
+        recordings.reserve(kRecordings);
+        for (int i = 0; i < kRecordings; i++)
+        {
+            ProgramInfo program(i % 2 ? m_flash34 : m_supergirl23);
+            program.SetSubtitle(QString("Episode %1").arg(i));
+            program.SetRecordingID(i + 1);
+            recordings.push_back(program);
+        }
+
+        qint64 bytes = 0;
+        QBENCHMARK
+        {
+            std::vector<ProgramInfo*> parsed;
+            if (packed)
+            {
+                PackedListWriter writer;
+                for (const auto & program : recordings)
+                    program.ToPackedList(writer);
+                QByteArray data = writer.GetData();
+                bytes = data.size();
+
+                PackedListReader reader(data);
+                for (uint i = 0; i < reader.GetCount(); i++)
+                {
+                    auto *program = new ProgramInfo();
+                    program->FromPackedList(reader);
+                    parsed.push_back(program);
+                }
+            }
+            else
+            {
+                QStringList list(QString::number(recordings.size()));
+                for (const auto & program : recordings)
+                    program.ToStringList(list);
+                QByteArray data = list.join("[]:[]").toUtf8();
+                bytes = data.size();
+
+                QStringList received =
+                    QString::fromUtf8(data).split("[]:[]");
+                QStringList::const_iterator it = received.cbegin() + 1;
+                for (int i = 0; i < received[0].toInt(); i++)
+                    parsed.push_back(new ProgramInfo(it, received.cend()));
+            }
+            QCOMPARE(parsed.size(), recordings.size());
+            qDeleteAll(parsed);
+        }
+        printf("%s: %lld bytes for %d recordings\n",
+               packed ? "packed" : "stringlist", bytes, kRecordings);
+    }
+
     void programSorting_test(void)
     {
         QStringList program_list;
@@ -22,7 +22,7 @@ HEADERS += mythlocale.h storagegroup.h
 HEADERS += mythcoreutil.h mythdownloadmanager.h mythtranslation.h
 HEADERS += unzip.h unzip_p.h zipentry_p.h iso639.h iso3166.h mythmedia.h
 HEADERS += mythmiscutil.h mythhdd.h mythcdrom.h autodeletedeque.h dbutil.h
-HEADERS += mythdeque.h mythlogging.h
+HEADERS += mythdeque.h mythspscqueue.h mythlogging.h
 HEADERS += mythbaseutil.h referencecounter.h referencecounterlist.h
 HEADERS += version.h mythcommandlineparser.h
 HEADERS += mythscheduler.h filesysteminfo.h hardwareprofile.h serverpool.h
@@ -35,7 +35,7 @@ HEADERS += mythsession.h
 HEADERS += ../../external/qjsonwrapper/qjsonwrapper/Json.h
 HEADERS += cleanupguard.h portchecker.h
 HEADERS += mythsorthelper.h mythdbcheck.h
-HEADERS += mythpower.h
+HEADERS += mythpower.h pagecachewindow.h
 
 SOURCES += mthread.cpp mthreadpool.cpp
 SOURCES += mythsocket.cpp
@@ -58,7 +58,7 @@ SOURCES += mythsession.cpp
 SOURCES += ../../external/qjsonwrapper/qjsonwrapper/Json.cpp
 SOURCES += cleanupguard.cpp portchecker.cpp
 SOURCES += mythsorthelper.cpp dbcheckcommon.cpp
-SOURCES += mythpower.cpp
+SOURCES += mythpower.cpp pagecachewindow.cpp
 
 using_qtdbus {
     QT      += dbus
@@ -87,7 +87,7 @@ inc.files += mythsocket.h mythsocket_cb.h mythlogging.h
 inc.files += mythcorecontext.h mythsystem.h storagegroup.h loggingserver.h
 inc.files += mythcoreutil.h mythlocale.h mythdownloadmanager.h
 inc.files += mythtranslation.h iso639.h iso3166.h mythmedia.h mythmiscutil.h
-inc.files += mythcdrom.h autodeletedeque.h dbutil.h mythdeque.h
+inc.files += mythcdrom.h autodeletedeque.h dbutil.h mythdeque.h mythspscqueue.h
 inc.files += referencecounter.h referencecounterlist.h mythcommandlineparser.h
 inc.files += mthread.h mthreadpool.h
 inc.files += filesysteminfo.h hardwareprofile.h bonjourregister.h serverpool.h
@@ -95,6 +95,7 @@ inc.files += plist.h bswap.h signalhandling.h ffmpeg-mmx.h mythdate.h
 inc.files += mythplugin.h mythpluginapi.h mythqtcompat.h
 inc.files += remotefile.h mythsystemlegacy.h mythtypes.h
 inc.files += threadedfilewriter.h mythsingledownload.h mythsession.h
+inc.files += pagecachewindow.h
 inc.files += mythsorthelper.h mythdbcheck.h
 
 # Allow both #include <blah.h> and #include <libmythbase/blah.h>
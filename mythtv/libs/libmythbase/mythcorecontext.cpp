@@ -1370,12 +1370,16 @@ bool MythCoreContext::IsUIThread(void)
  *                      attempt to reconnect and reissue the
  *                      request. If false, this function will not
  *                      attempt to reconnect to the backend.
+ *  \param packed       If not null and the backend responds with a
+ *                      "PACKED" header (\e PACKED \e count \e bytes),
+ *                      the binary list which follows the header is read
+ *                      into this array.
  *
  *  \sa kShortTimeout
  *  \sa kLongTimeout
  */
 bool MythCoreContext::SendReceiveStringList(
-    QStringList &strlist, bool quickTimeout, bool block)
+    QStringList &strlist, bool quickTimeout, bool block, QByteArray *packed)
 {
     QString msg;
     if (HasGUI() && IsUIThread())
@@ -1448,6 +1452,31 @@ bool MythCoreContext::SendReceiveStringList(
             ok = d->m_serverSock->ReadStringList(strlist, timeout);
         }
 
+        if (ok && packed && strlist.size() >= 3 && strlist[0] == "PACKED")
+        {
+            int size = strlist[2].toInt();
+            int offset = 0;
+            packed->resize(size);
+            while (ok && offset < size)
+            {
+                int ret = d->m_serverSock->Read(
+                    packed->data() + offset, size - offset, timeout);
+                if (ret > 0)
+                    offset += ret;
+                else
+                    ok = false;
+            }
+
+            if (!ok)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    QString("Protocol query '%1' packed response short, "
+                            "read %2 of %3 bytes")
+                        .arg(query_type).arg(offset).arg(size));
+                packed->clear();
+            }
+        }
+
         if (!ok)
         {
             if (d->m_serverSock)
@@ -119,7 +119,7 @@ class MBASE_PUBLIC MythCoreContext : public QObject, public MythObservable, publ
     bool IsWOLAllowed() const;
 
     bool SendReceiveStringList(QStringList &strlist, bool quickTimeout = false,
-                               bool block = true);
+                               bool block = true, QByteArray *packed = nullptr);
     void SendMessage(const QString &message);
     void SendEvent(const MythEvent &event);
     void SendSystemEvent(const QString &msg);
@@ -16,7 +16,12 @@
 #include <cstdio>
 #else
 #include <sys/socket.h>
+#include <poll.h>
 #endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include <cerrno>
 #include <unistd.h> // for usleep (and socket code on Q_OS_WIN)
 #include <algorithm> // for min/max
 using std::max;
@@ -534,6 +539,33 @@ int MythSocket::Write(const char *data, int size)
     return ret;
 }
 
+/** \brief Sends part of a file to the socket without copying it through
+ *         user space, using sendfile() where the platform has it.
+ *
+ *  Data written earlier with Write() or WriteStringList() is sent first.
+ *
+ *  \param fd     File to send from, its file offset is left unchanged
+ *  \param offset Position in the file of the first byte to send
+ *  \param size   Number of bytes to send
+ *  \return Number of bytes sent, which is less than size if the end of
+ *          the file was reached, or -1 if nothing could be sent.  -1 is
+ *          also returned where zero copy sends are not supported, the
+ *          caller should then read the file and use Write().
+ */
+int MythSocket::WriteFile(int fd, long long offset, int size)
+{
+    int ret = -1;
+    QMetaObject::invokeMethod(
+        this, "WriteFileReal",
+        (QThread::currentThread() != m_thread->qthread()) ?
+        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        Q_ARG(int, fd),
+        Q_ARG(qlonglong, offset),
+        Q_ARG(int, size),
+        Q_ARG(int*, &ret));
+    return ret;
+}
+
 int MythSocket::Read(char *data, int size, int max_wait_ms)
 {
     int ret = -1;
@@ -961,6 +993,65 @@ void MythSocket::WriteReal(const char *data, int size, int *ret)
     *ret = m_tcpSocket->write(data, size);
 }
 
+void MythSocket::WriteFileReal(int fd, qlonglong offset, int size, int *ret)
+{
+    *ret = -1;
+
+#ifdef __linux__
+    // Anything buffered by the QTcpSocket has to go out first
+    while (m_tcpSocket->bytesToWrite() > 0)
+    {
+        if (!m_tcpSocket->waitForBytesWritten(kLongTimeout))
+            return;
+    }
+
+    int sd = m_tcpSocket->socketDescriptor();
+    if (sd < 0)
+        return;
+
+    off_t pos = offset;
+    int tot = 0;
+    bool failed = false;
+    while (tot < size)
+    {
+        ssize_t sent = sendfile(sd, fd, &pos, size - tot);
+        if (sent > 0)
+        {
+            tot += sent;
+            continue;
+        }
+        if (sent == 0)
+            break; // end of file
+
+        if (errno == EINTR)
+            continue;
+
+        if (errno == EAGAIN)
+        {
+            // The socket is non-blocking, wait for room in the send buffer
+            struct pollfd pfd { sd, POLLOUT, 0 };
+            if (poll(&pfd, 1, kLongTimeout) > 0)
+                continue;
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("WriteFile: timed out after %1 of %2 bytes")
+                    .arg(tot).arg(size));
+        }
+        else if (errno != EINVAL && errno != ENOSYS)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "WriteFile: sendfile failed" + ENO);
+        }
+        failed = true;
+        break;
+    }
+
+    *ret = (failed && tot == 0) ? -1 : tot;
+#else
+    Q_UNUSED(fd);
+    Q_UNUSED(offset);
+    Q_UNUSED(size);
+#endif
+}
+
 void MythSocket::ReadReal(char *data, int size, int max_wait_ms, int *ret)
 {
     MythTimer t; t.start();
@@ -65,6 +65,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
 
     // RemoteFile stuff
     int Write(const char *data, int size);
+    int WriteFile(int fd, long long offset, int size);
     int Read(char *data, int size, int max_wait_ms);
     void Reset(void);
 
@@ -88,6 +89,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     void DisconnectFromHostReal(void);
 
     void WriteReal(const char *data, int size, int *ret);
+    void WriteFileReal(int fd, qlonglong offset, int size, int *ret);
     void ReadReal(char *data, int size, int max_wait_ms, int *ret);
     void ResetReal(void);
 
@@ -0,0 +1,69 @@
+// -*- Mode: c++ -*-
+
+#ifndef MYTH_SPSC_QUEUE_H
+#define MYTH_SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/** \class MythSPSCQueue
+ *  \brief Fixed size, lock free ring buffer with a single producer and a
+ *         single consumer.
+ *
+ *   push() may only be called by one thread at a time and pop() by one
+ *   thread at a time, though these may be different threads and run at
+ *   the same time. Whoever hands the producer or consumer role over to
+ *   another thread must make sure the two are ordered, with a mutex for
+ *   instance. Neither call ever blocks, push() fails when the queue is
+ *   full and pop() fails when it is empty.
+ *
+ *   N must be a power of two and the queue holds at most N items.
+ */
+template<typename T, size_t N>
+class MythSPSCQueue
+{
+    static_assert(N && ((N & (N - 1)) == 0), "N must be a power of two");
+
+  public:
+    /// \brief Adds item to the tail of the queue, false if it is full.
+    bool push(const T &item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= N)
+            return false;
+        m_items[tail & (N - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// \brief Removes item from the head of the queue, false if it is empty.
+    bool pop(T &item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        item = m_items[head & (N - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// \brief Number of items queued, only exact for the consumer.
+    size_t size() const
+    {
+        return m_tail.load(std::memory_order_acquire) -
+               m_head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return N; }
+
+  private:
+    // Keep the producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_head {0};
+    alignas(64) std::atomic<size_t> m_tail {0};
+    alignas(64) std::array<T,N>     m_items {};
+};
+
+#endif // MYTH_SPSC_QUEUE_H
@@ -0,0 +1,180 @@
+// C++ headers
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <vector>
+#endif
+
+// MythTV headers
+#include "mythconfig.h"
+#include "mythlogging.h"
+#include "pagecachewindow.h"
+
+#if HAVE_POSIX_FADVISE < 1
+static int posix_fadvise(int, off_t, off_t, int) { return 0; }
+#define POSIX_FADV_SEQUENTIAL 0
+#define POSIX_FADV_WILLNEED 0
+#define POSIX_FADV_DONTNEED 0
+#endif
+
+#define LOC QString("PageCache(%1): ").arg(m_fd)
+
+const long long PageCacheWindow::kMinAdvice = 1024 * 1024;
+
+/// \brief Changes the distances kept ahead and behind, call before Open().
+void PageCacheWindow::SetWindow(long long ahead, long long behind)
+{
+    QMutexLocker locker(&m_lock);
+    m_ahead  = ahead;
+    m_behind = behind;
+}
+
+/** \fn PageCacheWindow::Open(int, long long, bool)
+ *  \brief Starts giving hints for fd, which is read or written from pos.
+ *
+ *  \param sequential If true the kernel is told the file is read in
+ *                    order, which makes it read further ahead by itself
+ */
+void PageCacheWindow::Open(int fd, long long pos, bool sequential)
+{
+    QMutexLocker locker(&m_lock);
+    m_fd = fd;
+    m_adviseEnd = pos;
+    m_dropStart = (m_behind >= 0) ? std::max(0LL, pos - m_behind) : 0;
+
+    if (m_fd < 0)
+        return;
+
+    if (sequential &&
+        posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL) != 0)
+    {
+        LOG(VB_FILE, LOG_DEBUG, LOC + "fadvise sequential failed: " + ENO);
+    }
+}
+
+/// \brief Stops giving hints, the file descriptor is left open.
+void PageCacheWindow::Close(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_fd = -1;
+}
+
+/// \brief Moves the window after the file position was changed.
+void PageCacheWindow::Seek(long long pos)
+{
+    QMutexLocker locker(&m_lock);
+    m_adviseEnd = pos;
+    m_dropStart = (m_behind >= 0) ? std::max(0LL, pos - m_behind) : 0;
+}
+
+/** \fn PageCacheWindow::Read(long long)
+ *  \brief Moves the window after the file was read up to pos.
+ *
+ *   Read ahead is asked for in steps of half the window, so there is
+ *   one system call per half window read.
+ */
+void PageCacheWindow::Read(long long pos)
+{
+    QMutexLocker locker(&m_lock);
+    if (m_fd < 0)
+        return;
+
+    if (m_ahead > 0 && pos + m_ahead / 2 >= m_adviseEnd)
+    {
+        long long start = std::max(pos, m_adviseEnd);
+        long long end   = pos + m_ahead;
+        if (posix_fadvise(m_fd, start, end - start, POSIX_FADV_WILLNEED) == 0)
+            m_stats.m_willNeed += end - start;
+        else
+            LOG(VB_FILE, LOG_DEBUG, LOC + "fadvise willneed failed: " + ENO);
+        m_adviseEnd = end;
+    }
+
+    Drop(pos);
+}
+
+/// \brief Moves the window after the file was synced to disk up to pos.
+void PageCacheWindow::Written(long long pos)
+{
+    QMutexLocker locker(&m_lock);
+    if (m_fd < 0)
+        return;
+
+    Drop(pos);
+}
+
+/// \brief Drops what is more than the distance behind end, call with lock held.
+void PageCacheWindow::Drop(long long end)
+{
+    if (m_behind < 0)
+        return;
+
+    long long dropEnd = end - m_behind;
+    if (dropEnd - m_dropStart < kMinAdvice)
+        return;
+
+    if (posix_fadvise(m_fd, m_dropStart, dropEnd - m_dropStart,
+                      POSIX_FADV_DONTNEED) == 0)
+    {
+        m_stats.m_dropped += dropEnd - m_dropStart;
+    }
+    else
+    {
+        LOG(VB_FILE, LOG_DEBUG, LOC + "fadvise dontneed failed: " + ENO);
+    }
+    m_dropStart = dropEnd;
+}
+
+PageCacheStats PageCacheWindow::GetStats(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_stats;
+}
+
+/** \fn PageCacheWindow::Resident(int)
+ *  \brief Returns how many bytes of the file are in the page cache,
+ *         or -1 if that can not be found out.
+ *
+ *   The file is mapped and checked a piece at a time, this touches no
+ *   data but takes a few milliseconds for a large recording.
+ */
+long long PageCacheWindow::Resident(int fd)
+{
+#ifdef __linux__
+    struct stat st {};
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return -1;
+
+    const long long kChunk = 256LL * 1024 * 1024;
+    const long      pagesize = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> vec(kChunk / pagesize);
+    long long resident = 0;
+
+    for (long long off = 0; off < st.st_size; off += kChunk)
+    {
+        auto len = static_cast<size_t>(std::min(kChunk, st.st_size - off));
+        void *addr = mmap(nullptr, len, PROT_NONE, MAP_SHARED, fd, off);
+        if (addr == MAP_FAILED)
+            return -1;
+
+        int ret = mincore(addr, len, vec.data());
+        munmap(addr, len);
+        if (ret != 0)
+            return -1;
+
+        size_t pages = (len + pagesize - 1) / pagesize;
+        for (size_t i = 0; i < pages; i++)
+            resident += (vec[i] & 1) * pagesize;
+    }
+
+    return std::min(resident, static_cast<long long>(st.st_size));
+#else
+    (void)fd;
+    return -1;
+#endif
+}
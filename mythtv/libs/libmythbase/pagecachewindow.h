@@ -0,0 +1,69 @@
+#ifndef PAGECACHEWINDOW_H
+#define PAGECACHEWINDOW_H
+
+#include <cstdint>
+
+// Qt headers
+#include <QMutex>
+
+// MythTV headers
+#include "mythbaseexp.h"
+
+/// \brief Counters of the page cache hints given for one file
+struct PageCacheStats
+{
+    uint64_t m_willNeed {0}; ///< bytes the kernel was asked to read ahead
+    uint64_t m_dropped  {0}; ///< bytes the kernel was asked to drop
+};
+
+/** \class PageCacheWindow
+ *  \brief Keeps the page cache used by a file being streamed to a window
+ *         around the current position.
+ *
+ *   Recordings are read and written once, from start to end.  Left to
+ *   itself the kernel keeps every page of them cached until memory runs
+ *   out, pushing out pages that are still wanted, such as those of the
+ *   other recordings being written.  This asks the kernel to read ahead
+ *   of the position and to drop what is more than a set distance behind.
+ *
+ *   Readers call Read() with the position they have read up to, writers
+ *   call Written() with the position that has been synced to disk, since
+ *   dirty pages can not be dropped.
+ *
+ *   A negative distance behind disables dropping pages, a zero distance
+ *   ahead disables the read ahead hints.
+ */
+class MBASE_PUBLIC PageCacheWindow
+{
+  public:
+    PageCacheWindow(long long ahead, long long behind)
+        : m_ahead(ahead), m_behind(behind) {}
+
+    void SetWindow(long long ahead, long long behind);
+    void Open(int fd, long long pos = 0, bool sequential = true);
+    void Close(void);
+    void Seek(long long pos);
+    void Read(long long pos);
+    void Written(long long pos);
+
+    bool IsOpen(void) const { return m_fd >= 0; }
+    PageCacheStats GetStats(void) const;
+
+    static long long Resident(int fd);
+
+  private:
+    void Drop(long long end);
+
+    mutable QMutex  m_lock;
+    int             m_fd         {-1};
+    long long       m_ahead;
+    long long       m_behind;
+    long long       m_adviseEnd  {0}; ///< read ahead was asked for up to here
+    long long       m_dropStart  {0}; ///< everything before here was dropped
+    PageCacheStats  m_stats;
+
+    /// Smallest range worth a system call
+    static const long long kMinAdvice;
+};
+
+#endif // PAGECACHEWINDOW_H
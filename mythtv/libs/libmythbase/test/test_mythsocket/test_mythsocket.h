@@ -0,0 +1,303 @@
+/*
+ *  Class TestMythSocket
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+#include <QHostAddress>
+#include <QTemporaryFile>
+
+#include <iostream>
+using namespace std;
+
+#include "mythcorecontext.h"
+#include "mythsocket.h"
+
+/// Receiving end of a loopback connection to a MythSocket
+class LoopbackPeer
+{
+  public:
+    LoopbackPeer()
+    {
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t len = sizeof(addr);
+        if (bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), len) == 0 &&
+            listen(m_listenFd, 1) == 0 &&
+            getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&addr),
+                        &len) == 0)
+        {
+            m_port = ntohs(addr.sin_port);
+        }
+    }
+
+    ~LoopbackPeer()
+    {
+        if (m_reader.joinable())
+            m_reader.join();
+        if (m_peerFd >= 0)
+            close(m_peerFd);
+        if (m_listenFd >= 0)
+            close(m_listenFd);
+        if (m_socket)
+            m_socket->DecrRef();
+    }
+
+    MythSocket *Connect(void)
+    {
+        if (!m_port)
+            return nullptr;
+        m_socket = new MythSocket();
+        if (!m_socket->ConnectToHost(QHostAddress(QHostAddress::LocalHost),
+                                     m_port))
+            return nullptr;
+        m_peerFd = accept(m_listenFd, nullptr, nullptr);
+        return (m_peerFd >= 0) ? m_socket : nullptr;
+    }
+
+    /// Reads expected bytes on another thread, keeping them if asked to
+    void StartReading(qint64 expected, bool keep)
+    {
+        m_received.clear();
+        m_receivedSize = 0;
+        m_reader = std::thread([this, expected, keep]()
+        {
+            std::vector<char> buf(256 * 1024);
+            while (m_receivedSize < expected)
+            {
+                ssize_t len = read(m_peerFd, buf.data(),
+                                   std::min<qint64>(buf.size(),
+                                                    expected - m_receivedSize));
+                if (len <= 0)
+                    break;
+                if (keep)
+                    m_received.append(buf.data(), len);
+                m_receivedSize += len;
+            }
+        });
+    }
+
+    qint64 WaitForData(void)
+    {
+        if (m_reader.joinable())
+            m_reader.join();
+        return m_receivedSize;
+    }
+
+    QByteArray  m_received;
+
+  private:
+    int         m_listenFd     {-1};
+    int         m_peerFd       {-1};
+    quint16     m_port         {0};
+    MythSocket *m_socket       {nullptr};
+    std::thread m_reader;
+    qint64      m_receivedSize {0};
+};
+
+class TestMythSocket: public QObject
+{
+    Q_OBJECT
+
+    QTemporaryFile m_file;
+    QByteArray     m_data;
+
+    static constexpr int kFileSize  = 32 * 1024 * 1024;
+    static constexpr int kBlockSize = 256 * 1024;
+
+    static double cpu_seconds(void)
+    {
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+            (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+    }
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void)
+    {
+        gCoreContext = new MythCoreContext("bin_version", nullptr);
+
+        m_data.resize(kFileSize);
+        for (int i = 0; i < kFileSize; i++)
+            m_data[i] = static_cast<char>((i * 7) ^ (i >> 11));
+
+        QVERIFY(m_file.open());
+        QCOMPARE(m_file.write(m_data), qint64(kFileSize));
+        QVERIFY(m_file.flush());
+    }
+
+    // called at the end of these sets of tests
+    static void cleanupTestCase(void)
+    {
+    }
+
+    void writeFile_sendsFileData(void)
+    {
+        LoopbackPeer peer;
+        MythSocket *sock = peer.Connect();
+        QVERIFY(sock != nullptr);
+
+        const int offset = 12345;
+        const int size   = 3 * kBlockSize + 17;
+        peer.StartReading(size, true);
+
+        int sent = sock->WriteFile(m_file.handle(), offset, size);
+        if (sent < 0)
+        {
+            sock->DisconnectFromHost();
+            peer.WaitForData();
+            QSKIP("Zero copy sends are not supported on this platform");
+        }
+
+        QCOMPARE(sent, size);
+        QCOMPARE(peer.WaitForData(), qint64(size));
+        QVERIFY(peer.m_received == m_data.mid(offset, size));
+
+        // The file offset is left alone
+        QCOMPARE(lseek(m_file.handle(), 0, SEEK_CUR), m_file.pos());
+    }
+
+    void writeFile_sendsBufferedDataFirst(void)
+    {
+        LoopbackPeer peer;
+        MythSocket *sock = peer.Connect();
+        QVERIFY(sock != nullptr);
+
+        QByteArray header("HEADER");
+        peer.StartReading(header.size() + kBlockSize, true);
+
+        QCOMPARE(sock->Write(header.constData(), header.size()),
+                 header.size());
+        int sent = sock->WriteFile(m_file.handle(), 0, kBlockSize);
+        if (sent < 0)
+        {
+            sock->DisconnectFromHost();
+            peer.WaitForData();
+            QSKIP("Zero copy sends are not supported on this platform");
+        }
+
+        QCOMPARE(sent, kBlockSize);
+        QCOMPARE(peer.WaitForData(), qint64(header.size() + kBlockSize));
+        QVERIFY(peer.m_received == header + m_data.left(kBlockSize));
+    }
+
+    void writeFile_stopsAtEndOfFile(void)
+    {
+        LoopbackPeer peer;
+        MythSocket *sock = peer.Connect();
+        QVERIFY(sock != nullptr);
+
+        const int available = 1000;
+        peer.StartReading(available, true);
+
+        int sent = sock->WriteFile(m_file.handle(), kFileSize - available,
+                                   kBlockSize);
+        if (sent < 0)
+        {
+            sock->DisconnectFromHost();
+            peer.WaitForData();
+            QSKIP("Zero copy sends are not supported on this platform");
+        }
+
+        QCOMPARE(sent, available);
+        QCOMPARE(peer.WaitForData(), qint64(available));
+        QVERIFY(peer.m_received == m_data.right(available));
+
+        // Nothing is left to send at the end of the file
+        QCOMPARE(sock->WriteFile(m_file.handle(), kFileSize, kBlockSize), 0);
+    }
+
+    void benchmarkWriteFile_data(void)
+    {
+        QTest::addColumn<bool>("zerocopy");
+        QTest::newRow("read+Write") << false;
+        QTest::newRow("WriteFile")  << true;
+    }
+
+    /// Sends the whole file in FileTransfer sized blocks over loopback
+    void benchmarkWriteFile(void)
+    {
+        QFETCH(bool, zerocopy);
+
+        std::vector<char> buf(kBlockSize);
+        QElapsedTimer timer;
+        double cpu = 0;
+        qint64 elapsed = 0;
+        qint64 total = 0;
+        int runs = 0;
+
+        QBENCHMARK
+        {
+            LoopbackPeer peer;
+            MythSocket *sock = peer.Connect();
+            QVERIFY(sock != nullptr);
+            peer.StartReading(kFileSize, false);
+
+            double cpu_start = cpu_seconds();
+            timer.start();
+            for (int pos = 0; pos < kFileSize; pos += kBlockSize)
+            {
+                int sent = -1;
+                if (zerocopy)
+                {
+                    sent = sock->WriteFile(m_file.handle(), pos, kBlockSize);
+                }
+                else
+                {
+                    ssize_t len = pread(m_file.handle(), buf.data(),
+                                        kBlockSize, pos);
+                    if (len > 0)
+                        sent = sock->Write(buf.data(), len);
+                }
+                if (sent < 0)
+                    break;
+            }
+            qint64 received = peer.WaitForData();
+            elapsed += timer.elapsed();
+            total += received;
+            cpu += cpu_seconds() - cpu_start;
+            runs++;
+
+            if (zerocopy && received == 0)
+                QSKIP("Zero copy sends are not supported on this platform");
+            QCOMPARE(received, qint64(kFileSize));
+        }
+
+        if (elapsed > 0)
+        {
+            cout << QString("%1: %2 MB/s, %3 ms CPU per run")
+                .arg(zerocopy ? "WriteFile" : "read+Write")
+                .arg(total / 1048576.0 / (elapsed / 1000.0),
+                     0, 'f', 1)
+                .arg(cpu * 1000 / runs, 0, 'f', 1)
+                .toLocal8Bit().constData() << endl;
+        }
+    }
+};
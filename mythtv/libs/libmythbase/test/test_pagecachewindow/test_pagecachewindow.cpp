@@ -0,0 +1,3 @@
+#include "test_pagecachewindow.h"
+
+QTEST_APPLESS_MAIN(TestPageCacheWindow)
@@ -0,0 +1,113 @@
+/*
+ *  Class TestPageCacheWindow
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+
+#include "pagecachewindow.h"
+
+#define MB (1024LL * 1024LL)
+
+class TestPageCacheWindow : public QObject
+{
+    Q_OBJECT
+
+    QTemporaryFile m_file;
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void)
+    {
+        QVERIFY(m_file.open());
+        QByteArray block(MB, 'x');
+        for (int i = 0; i < 32; i++)
+            QCOMPARE(m_file.write(block), MB);
+        QVERIFY(m_file.flush());
+    }
+
+    void readAheadAndDrop(void)
+    {
+        PageCacheWindow window(4 * MB, 8 * MB);
+        window.Open(m_file.handle(), 0);
+        for (long long pos = 0; pos <= 32 * MB; pos += 256 * 1024)
+            window.Read(pos);
+
+        // Read ahead is asked for up to 4MB past the end position,
+        // and everything but the last 8MB is dropped
+        PageCacheStats stats = window.GetStats();
+        QCOMPARE(stats.m_willNeed, uint64_t(36 * MB));
+        QCOMPARE(stats.m_dropped,  uint64_t(24 * MB));
+    }
+
+    void seekMovesWindow(void)
+    {
+        PageCacheWindow window(0, 8 * MB);
+        window.Open(m_file.handle(), 0);
+        window.Seek(20 * MB);
+        window.Read(20 * MB);
+
+        // Nothing before the seek is dropped, only what is read past it
+        QCOMPARE(window.GetStats().m_dropped, uint64_t(0));
+        window.Read(30 * MB);
+        QCOMPARE(window.GetStats().m_dropped, uint64_t(10 * MB));
+        QCOMPARE(window.GetStats().m_willNeed, uint64_t(0));
+    }
+
+    void writerDropsSynced(void)
+    {
+        PageCacheWindow window(0, 16 * MB);
+        window.Open(m_file.handle(), 0, false);
+
+        // Drops are batched into at least 1MB
+        window.Written(16 * MB + 512 * 1024);
+        QCOMPARE(window.GetStats().m_dropped, uint64_t(0));
+        window.Written(32 * MB);
+        QCOMPARE(window.GetStats().m_dropped, uint64_t(16 * MB));
+    }
+
+    void keepEverything(void)
+    {
+        PageCacheWindow window(MB, -1);
+        window.Open(m_file.handle(), 0);
+        window.Read(32 * MB);
+        QCOMPARE(window.GetStats().m_dropped, uint64_t(0));
+    }
+
+    void closedDoesNothing(void)
+    {
+        PageCacheWindow window(MB, 0);
+        window.Open(m_file.handle(), 0);
+        window.Close();
+        QVERIFY(!window.IsOpen());
+        window.Read(32 * MB);
+        QCOMPARE(window.GetStats().m_dropped, uint64_t(0));
+        QCOMPARE(window.GetStats().m_willNeed, uint64_t(0));
+    }
+
+    void resident(void)
+    {
+        long long resident = PageCacheWindow::Resident(m_file.handle());
+#ifdef __linux__
+        QVERIFY(resident >= 0);
+        QVERIFY(resident <= 32 * MB);
+#else
+        QCOMPARE(resident, -1LL);
+#endif
+        QCOMPARE(PageCacheWindow::Resident(-1), -1LL);
+    }
+};
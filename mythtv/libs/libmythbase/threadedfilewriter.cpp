@@ -8,6 +8,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
 
 // Qt headers
 #include <QString>
@@ -23,6 +26,21 @@
 
 #define LOC QString("TFW(%1:%2): ").arg(m_filename).arg(m_fd)
 
+#ifdef _WIN32
+struct iovec
+{
+    void   *iov_base;
+    size_t  iov_len;
+};
+
+/// There is no writev() on Windows, write the first vector only and
+/// let the caller loop over the rest as with a short write.
+static ssize_t writev(int fd, const struct iovec *iov, int /*iovcnt*/)
+{
+    return write(fd, iov[0].iov_base, iov[0].iov_len);
+}
+#endif
+
 /// \brief Runs ThreadedFileWriter::DiskLoop(void)
 void TFWWriteThread::run(void)
 {
@@ -42,6 +60,7 @@ void TFWSyncThread::run(void)
 const uint ThreadedFileWriter::kMaxBufferSize   = 8 * 1024 * 1024;
 const uint ThreadedFileWriter::kMinWriteSize    = 64 * 1024;
 const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
+const uint ThreadedFileWriter::kMaxWriteVectors = 64;
 
 /** \class ThreadedFileWriter
  *  \brief This class supports the writing of recordings to disk.
@@ -68,6 +87,8 @@ bool ThreadedFileWriter::ReOpen(const QString& newFilename)
 
     if (m_fd >= 0)
     {
+        LOG(VB_FILE, LOG_INFO, LOC + StatsString(CollectStats()));
+        m_cacheWindow.Close();
         close(m_fd);
         m_fd = -1;
     }
@@ -111,6 +132,15 @@ bool ThreadedFileWriter::Open(void)
     gCoreContext->RegisterFileForWrite(m_filename);
     m_registered = true;
 
+    if (m_filename != "-")
+    {
+        // Megabytes written before the last sync that are kept cached for
+        // readers following the recording, or -1 to leave it to the kernel
+        int window = gCoreContext->GetNumSetting("RecordingCacheWindow", 16);
+        m_cacheWindow.SetWindow(0, (window < 0) ? -1 : window * 1024LL * 1024);
+        m_cacheWindow.Open(m_fd, lseek(m_fd, 0, SEEK_CUR), false);
+    }
+
     LOG(VB_FILE, LOG_INFO, LOC + "Open() successful");
 
 #ifdef _WIN32
@@ -171,12 +201,28 @@ ThreadedFileWriter::~ThreadedFileWriter()
         m_syncThread = nullptr;
     }
 
+    LOG(VB_FILE, LOG_INFO, LOC + StatsString(GetStats()));
+
     if (m_fd >= 0)
     {
+        m_cacheWindow.Close();
         close(m_fd);
         m_fd = -1;
     }
 
+    if (VERBOSE_LEVEL_CHECK(VB_FILE, LOG_INFO) && m_filename != "-")
+    {
+        // The writer may not be able to map the file, so look with a reader
+        QByteArray fname = m_filename.toLocal8Bit();
+        int fd = open(fname.constData(), O_RDONLY);
+        if (fd >= 0)
+        {
+            LOG(VB_FILE, LOG_INFO, LOC + QString("%1 bytes left in the page cache")
+                .arg(PageCacheWindow::Resident(fd)));
+            close(fd);
+        }
+    }
+
     gCoreContext->UnregisterFileForWrite(m_filename);
     m_registered = false;
 }
@@ -215,6 +261,7 @@ int ThreadedFileWriter::Write(const void *data, uint count)
                     "\n\t\t\tThis generally indicates your disk performance "
                     "\n\t\t\tis insufficient to deal with the number of on-going "
                     "\n\t\t\trecordings, or you have a disk failure.");
+                LOG(VB_GENERAL, LOG_ERR, LOC + StatsString(CollectStats()));
                 m_ignoreWrites = true;
                 return -1;
             }
@@ -224,6 +271,7 @@ int ThreadedFileWriter::Write(const void *data, uint count)
                     "Maximum buffer size exceeded."
                     "\n\t\t\tThis generally indicates your disk performance "
                     "\n\t\t\tis insufficient or you have a disk failure.");
+                LOG(VB_GENERAL, LOG_WARNING, LOC + StatsString(CollectStats()));
                 m_warned = true;
             }
             // wait until some was written to disk, and try again
@@ -267,6 +315,10 @@ int ThreadedFileWriter::Write(const void *data, uint count)
         buf->lastUsed = MythDate::current();
 
         m_writeBuffers.push_back(buf);
+        m_stats.m_maxQueueDepth =
+            max(m_stats.m_maxQueueDepth, uint(m_writeBuffers.size()));
+        m_stats.m_maxQueueBytes =
+            max(m_stats.m_maxQueueBytes, m_totalBufferUse);
 
         if ((m_writeBuffers.size() > 1) || (buf->data.size() >= kMinWriteSize))
         {
@@ -340,7 +392,9 @@ void ThreadedFileWriter::Flush(void)
  *  mechanism available (fdatasync then fsync). The second is
  *  by telling the kernel we do not intend to use the data just
  *  written anytime soon so other processes time-slices will
- *  not be used to deal with our excess dirty pages.
+ *  not be used to deal with our excess dirty pages. This is
+ *  done by SyncLoop(), which drops what was synced except for
+ *  the "RecordingCacheWindow" megabytes before the end.
  *
  *  \note We used to also use sync_file_range on Linux, however
  *  this is incompatible with newer filesystems such as BRTFS and
@@ -389,7 +443,11 @@ void ThreadedFileWriter::SyncLoop(void)
     {
         locker.unlock();
 
+        // Everything written before the sync is clean after it
+        off_t synced = (m_fd >= 0) ? lseek(m_fd, 0, SEEK_CUR) : -1;
         Sync();
+        if (synced > 0)
+            m_cacheWindow.Written(synced);
 
         locker.relock();
 
@@ -467,33 +525,45 @@ void ThreadedFileWriter::DiskLoop(void)
             continue;
         }
 
-        TFWBuffer *buf = m_writeBuffers.front();
-        m_writeBuffers.pop_front();
-        m_totalBufferUse -= buf->data.size();
+        // Gather the queued buffers so that they can be handed to the
+        // kernel in a single writev() call instead of one write() each.
+        QList<TFWBuffer*> bufs;
+        vector<struct iovec> iov;
+        uint sz = 0;
+        while (!m_writeBuffers.empty() && (bufs.size() < int(kMaxWriteVectors)) &&
+               (sz < kMaxBlockSize))
+        {
+            TFWBuffer *buf = m_writeBuffers.front();
+            m_writeBuffers.pop_front();
+            m_totalBufferUse -= buf->data.size();
+            sz += buf->data.size();
+            iov.push_back({ buf->data.data(), buf->data.size() });
+            bufs.push_back(buf);
+        }
         m_bufferWasFreed.wakeAll();
         minWriteTimer.start();
 
         //////////////////////////////////////////
 
-        const void *data = &(buf->data[0]);
-        uint sz = buf->data.size();
-
         bool write_ok = true;
         uint tot = 0;
         uint errcnt = 0;
+        size_t first = 0;
 
-        LOG(VB_FILE, LOG_DEBUG, LOC + QString("write(%1) cnt %2 total %3")
-                .arg(sz).arg(m_writeBuffers.size())
+        LOG(VB_FILE, LOG_DEBUG, LOC + QString("write(%1 in %2) cnt %3 total %4")
+                .arg(sz).arg(bufs.size()).arg(m_writeBuffers.size())
                 .arg(m_totalBufferUse));
 
         MythTimer writeTimer;
         writeTimer.start();
+        uint calls = 0;
 
         while ((tot < sz) && !m_inDtor)
         {
             locker.unlock();
 
-            int ret = write(m_fd, (char *)data + tot, sz - tot);
+            ssize_t ret = writev(m_fd, &iov[first], int(iov.size() - first));
+            calls++;
 
             if (ret < 0)
             {
@@ -522,6 +592,18 @@ void ThreadedFileWriter::DiskLoop(void)
                 LOG(VB_FILE, LOG_DEBUG, LOC +
                     QString("total written so far: %1 bytes")
                     .arg(total_written));
+
+                // Skip over the vectors that are done, and adjust the
+                // first partially written one after a short write.
+                auto done = static_cast<size_t>(ret);
+                while ((first < iov.size()) && (done >= iov[first].iov_len))
+                    done -= iov[first++].iov_len;
+                if (done)
+                {
+                    iov[first].iov_base =
+                        static_cast<char*>(iov[first].iov_base) + done;
+                    iov[first].iov_len -= done;
+                }
             }
 
             locker.relock();
@@ -532,6 +614,14 @@ void ThreadedFileWriter::DiskLoop(void)
 
         //////////////////////////////////////////
 
+        int64_t elapsed = writeTimer.elapsed();
+        m_stats.m_bytesWritten   += tot;
+        m_stats.m_batches        += 1;
+        m_stats.m_writeCalls     += calls;
+        m_stats.m_buffersWritten += bufs.size();
+        m_stats.m_totalWriteMs   += elapsed;
+        m_stats.m_maxWriteMs      = max(m_stats.m_maxWriteMs, elapsed);
+
         if (lastRegisterTimer.elapsed() >= 10000)
         {
             gCoreContext->RegisterFileForWrite(m_filename, total_written);
@@ -539,15 +629,19 @@ void ThreadedFileWriter::DiskLoop(void)
             lastRegisterTimer.restart();
         }
 
-        buf->lastUsed = MythDate::current();
-        m_emptyBuffers.push_back(buf);
+        QDateTime now = MythDate::current();
+        for (auto *buf : qAsConst(bufs))
+        {
+            buf->lastUsed = now;
+            m_emptyBuffers.push_back(buf);
+        }
 
-        if (writeTimer.elapsed() > 1000)
+        if (elapsed > 1000)
         {
             LOG(VB_GENERAL, LOG_WARNING, LOC +
                 QString("write(%1) cnt %2 total %3 -- took a long time, %4 ms")
                     .arg(sz).arg(m_writeBuffers.size())
-                    .arg(m_totalBufferUse).arg(writeTimer.elapsed()));
+                    .arg(m_totalBufferUse).arg(elapsed));
         }
 
         if (!write_ok && ((EFBIG == errno) || (ENOSPC == errno)))
@@ -583,6 +677,40 @@ void ThreadedFileWriter::DiskLoop(void)
     }
 }
 
+/** \fn ThreadedFileWriter::GetStats(void) const
+ *  \brief Returns the write counters gathered since the writer was
+ *         created, across any ReOpen() calls.
+ */
+TFWStats ThreadedFileWriter::GetStats(void) const
+{
+    QMutexLocker locker(&m_bufLock);
+    return CollectStats();
+}
+
+/// \brief Returns the write counters, call with buflock held.
+TFWStats ThreadedFileWriter::CollectStats(void) const
+{
+    TFWStats stats = m_stats;
+    stats.m_cacheDropped = m_cacheWindow.GetStats().m_dropped;
+    return stats;
+}
+
+/// \brief Formats the write counters for logging.
+QString ThreadedFileWriter::StatsString(const TFWStats &stats)
+{
+    uint64_t batches = max(stats.m_batches, uint64_t(1));
+    return QString("Wrote %1 bytes from %2 buffers in %3 batches and %4 "
+                   "writev() calls (avg %5 ms, max %6 ms per batch), "
+                   "max queue %7 buffers/%8 bytes, "
+                   "dropped %9 bytes from the page cache")
+        .arg(stats.m_bytesWritten).arg(stats.m_buffersWritten)
+        .arg(stats.m_batches).arg(stats.m_writeCalls)
+        .arg(stats.m_totalWriteMs / batches)
+        .arg(stats.m_maxWriteMs).arg(stats.m_maxQueueDepth)
+        .arg(stats.m_maxQueueBytes)
+        .arg(stats.m_cacheDropped);
+}
+
 void ThreadedFileWriter::TrimEmptyBuffers(void)
 {
     QDateTime cur = MythDate::current();
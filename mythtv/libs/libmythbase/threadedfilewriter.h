@@ -17,6 +17,7 @@ using namespace std;
 // MythTV headers
 #include "mythbaseexp.h"
 #include "mthread.h"
+#include "pagecachewindow.h"
 
 class ThreadedFileWriter;
 
@@ -40,6 +41,21 @@ class TFWSyncThread : public MThread
     ThreadedFileWriter *m_parent {nullptr};
 };
 
+/// \brief Counters describing how ThreadedFileWriter has been writing
+struct TFWStats
+{
+    uint64_t m_bytesWritten   {0}; ///< bytes handed to the kernel
+    uint64_t m_batches        {0}; ///< groups of buffers written together
+    uint64_t m_writeCalls     {0}; ///< writev() calls, one per batch unless
+                                   ///< the kernel took less than asked for
+    uint64_t m_buffersWritten {0}; ///< number of buffers written
+    uint     m_maxQueueDepth  {0}; ///< most buffers queued at once
+    uint     m_maxQueueBytes  {0}; ///< most bytes queued at once
+    int64_t  m_totalWriteMs   {0}; ///< time spent in write calls
+    int64_t  m_maxWriteMs     {0}; ///< longest batch write
+    uint64_t m_cacheDropped   {0}; ///< bytes dropped from the page cache
+};
+
 class MBASE_PUBLIC ThreadedFileWriter
 {
     friend class TFWWriteThread;
@@ -64,11 +80,14 @@ class MBASE_PUBLIC ThreadedFileWriter
     void Flush(void);
     bool SetBlocking(bool block = true);
     bool WritesFailing(void) const { return m_ignoreWrites; }
+    TFWStats GetStats(void) const;
 
   protected:
     void DiskLoop(void);
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
+    TFWStats CollectStats(void) const;
+    static QString StatsString(const TFWStats &stats);
 
   private:
     // file info
@@ -76,6 +95,7 @@ class MBASE_PUBLIC ThreadedFileWriter
     int             m_flags;
     mode_t          m_mode;
     int             m_fd                 {-1};
+    PageCacheWindow m_cacheWindow        {0, -1};
 
     // state
     bool            m_flush              {false};         // protected by buflock
@@ -83,6 +103,7 @@ class MBASE_PUBLIC ThreadedFileWriter
     bool            m_ignoreWrites       {false};         // protected by buflock
     uint            m_tfwMinWriteSize    {kMinWriteSize}; // protected by buflock
     uint            m_totalBufferUse     {0};             // protected by buflock
+    TFWStats        m_stats;                              // protected by buflock
 
     // buffers
     class TFWBuffer
@@ -111,6 +132,8 @@ class MBASE_PUBLIC ThreadedFileWriter
     static const uint kMinWriteSize;
     /// Maximum block size to write at a time
     static const uint kMaxBlockSize;
+    /// Maximum number of buffers submitted in a single writev() call
+    static const uint kMaxWriteVectors;
 
     bool m_warned                        {false};
     bool m_blocking                      {false};
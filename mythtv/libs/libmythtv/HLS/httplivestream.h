@@ -44,6 +44,7 @@ class MTV_PUBLIC HTTPLiveStream
     QString  GetMetaPlaylistName(void) const;
     QString  GetPlaylistName(bool audioOnly = false) const;
     uint16_t GetSegmentSize(void) const { return m_segmentSize; }
+    uint16_t GetCurrentSegment(void) const { return m_curSegment; }
     QString  GetFilename(uint16_t segmentNumber = 0, bool fileOnly = false,
                          bool audioOnly = false, bool encoded = false) const;
     QString  GetCurrentFilename(
@@ -1522,8 +1522,12 @@ void AvFormatDecoder::InitVideoCodec(AVStream *stream, AVCodecContext *enc,
 
         if (FlagIsSet(kDecodeLowRes))
             enc->lowres = 2; // 1 = 1/2 size, 2 = 1/4 size
+        else if (FlagIsSet(kDecodeHalfSizeHD) && (enc->height > 576))
+            enc->lowres = 1;
     }
-    else if (codec1 && (AV_CODEC_ID_H264 == codec1->id) && FlagIsSet(kDecodeNoLoopFilter))
+    else if (codec1 && ((AV_CODEC_ID_H264 == codec1->id) ||
+                        (AV_CODEC_ID_HEVC == codec1->id)) &&
+             FlagIsSet(kDecodeNoLoopFilter))
     {
         enc->flags &= ~AV_CODEC_FLAG_LOOP_FILTER;
         enc->skip_loop_filter = AVDISCARD_ALL;
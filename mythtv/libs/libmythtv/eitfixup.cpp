@@ -1,6 +1,11 @@
 // C++ headers
 #include <algorithm>
 #include <array>
+#include <vector>
+
+// Qt headers
+#include <QRegularExpression>
+#include <QStringMatcher>
 
 // MythTV headers
 #include "eitfixup.h"
@@ -46,47 +51,118 @@ const QString shortContext =
         QString(R"((?:^|\.)(\s*\(*\s*%1[\s)]*(?:[).:]|$)))").arg(shortEp);
 
 
-static const QRegularExpression kAtvSubtitle { R"(,{0,1}\sFolge\s(\d{1,3})$)" };
-static const QRegularExpression kDeDisneyChannelSubtitle { R"(,([^,]+?)\s{0,1}(\d{4})$)" };
+/** \class EITFixUpPattern
+ *  \brief A regular expression that can only match text containing at
+ *         least one of its key strings.
+ *
+ *   Most events contain none of the keys, and looking for a few literal
+ *   strings is much cheaper than running the expression, so the
+ *   expression is only run when a key is present.
+ */
+class EITFixUpPattern
+{
+  public:
+    EITFixUpPattern(const QString &pattern, const QStringList &keys,
+                    QRegularExpression::PatternOptions options =
+                    QRegularExpression::NoPatternOption) :
+        m_re(pattern, options)
+    {
+        Qt::CaseSensitivity cs =
+            (options & QRegularExpression::CaseInsensitiveOption) ?
+            Qt::CaseInsensitive : Qt::CaseSensitive;
+        for (const auto & key : keys)
+            m_keys.emplace_back(key, cs);
+    }
+
+    bool MayMatch(const QString &text) const
+    {
+        return std::any_of(m_keys.cbegin(), m_keys.cend(),
+                           [&text](const QStringMatcher &key)
+                           { return key.indexIn(text) >= 0; });
+    }
+
+    QRegularExpressionMatch match(const QString &text, int offset = 0) const
+    {
+        if (!MayMatch(text))
+            return {};
+        return m_re.match(text, offset);
+    }
+
+    void RemoveFrom(QString &text) const
+    {
+        if (MayMatch(text))
+            text.remove(m_re);
+    }
+
+  private:
+    QRegularExpression     m_re;
+    vector<QStringMatcher> m_keys;
+};
+
+static const EITFixUpPattern kAtvSubtitle { R"(,{0,1}\sFolge\s(\d{1,3})$)",
+                                            { "Folge" } };
+static const EITFixUpPattern kDeDisneyChannelSubtitle { R"(,([^,]+?)\s{0,1}(\d{4})$)",
+                                                        { "," } };
 static const QRegularExpression kDePremiereAirdate { R"(\s?([^\s^\.]+)\s((?:1|2)[0-9]{3})\.)" };
-static const QRegularExpression kDePremiereCredits { R"(\sVon\s([^,]+)(?:,|\su\.\sa\.)\smit\s([^\.]*)\.)" };
-static const QRegularExpression kDePremiereLength  { R"(\s?[0-9]+\sMin\.)" };
-static const QRegularExpression kDePremiereOTitle  { R"(\s*\(([^\)]*)\)$)" };
-static const QRegularExpression kDeSkyDescriptionSeasonEpisode { R"(^(\d{1,2}).\sStaffel,\sFolge\s(\d{1,2}):\s)" };
-static const QRegularExpression kHtml { "</?EM>", QRegularExpression::CaseInsensitiveOption };
-static const QRegularExpression kPro7Cast     { "\n\nDarsteller:\n(.*)$",
-                                                QRegularExpression::DotMatchesEverythingOption };
+static const EITFixUpPattern kDePremiereCredits { R"(\sVon\s([^,]+)(?:,|\su\.\sa\.)\smit\s([^\.]*)\.)",
+                                                  { "Von" } };
+static const EITFixUpPattern kDePremiereLength  { R"(\s?[0-9]+\sMin\.)",
+                                                  { "Min." } };
+static const EITFixUpPattern kDePremiereOTitle  { R"(\s*\(([^\)]*)\)$)",
+                                                  { "(" } };
+static const EITFixUpPattern kDeSkyDescriptionSeasonEpisode { R"(^(\d{1,2}).\sStaffel,\sFolge\s(\d{1,2}):\s)",
+                                                              { "Staffel," } };
+static const EITFixUpPattern kHtml { "</?EM>",
+                                     { "<em>", "</em>" },
+                                     QRegularExpression::CaseInsensitiveOption };
+static const EITFixUpPattern kPro7Cast     { "\n\nDarsteller:\n(.*)$",
+                                             { "\n\nDarsteller:\n" },
+                                             QRegularExpression::DotMatchesEverythingOption };
 static const QRegularExpression kPro7CastOne  { R"(^([^\(]*?)\((.*)\)$)" };
-static const QRegularExpression kPro7Crew     { "\n\n(Regie:.*)$",
-                                                QRegularExpression::DotMatchesEverythingOption };
+static const EITFixUpPattern kPro7Crew     { "\n\n(Regie:.*)$",
+                                             { "\n\nRegie:" },
+                                             QRegularExpression::DotMatchesEverythingOption };
 static const QRegularExpression kPro7CrewOne  { R"(^(.*?):\s+(.*)$)" };
-static const QRegularExpression kPro7Subtitle { R"(,{0,1}([^,]*?),([^,]+?)\s{0,1}(\d{4})$)" };
-static const QRegularExpression kStereo { R"(\b\(?[sS]tereo\)?\b)" };
-static const QRegularExpression kUK24ep { R"(^\d{1,2}:00[ap]m to \d{1,2}:00[ap]m: )" };
-static const QRegularExpression kUKAllNew { R"(All New To 4Music!\s?)" };
-static const QRegularExpression kUKAlsoInHD { R"(\s*Also in HD\.)",
-                                              QRegularExpression::CaseInsensitiveOption };
-static const QRegularExpression kUKBBC34 { R"(BBC (?:THREE|FOUR) on BBC (?:ONE|TWO)\.)",
+static const EITFixUpPattern kPro7Subtitle { R"(,{0,1}([^,]*?),([^,]+?)\s{0,1}(\d{4})$)",
+                                             { "," } };
+static const EITFixUpPattern kStereo { R"(\b\(?[sS]tereo\)?\b)",
+                                       { "tereo" } };
+static const EITFixUpPattern kUK24ep { R"(^\d{1,2}:00[ap]m to \d{1,2}:00[ap]m: )",
+                                       { "m to " } };
+static const EITFixUpPattern kUKAllNew { R"(All New To 4Music!\s?)",
+                                         { "All New To 4Music!" } };
+static const EITFixUpPattern kUKAlsoInHD { R"(\s*Also in HD\.)",
+                                           { "also in hd." },
                                            QRegularExpression::CaseInsensitiveOption };
-static const QRegularExpression kUKBBC7rpt { R"(\[Rptd?[^]]+?\d{1,2}\.\d{1,2}[ap]m\]\.)" };
-static const QRegularExpression kUKCC { R"(\[(?:(AD|SL|S|W|HD),?)+\])" };
+static const EITFixUpPattern kUKBBC34 { R"(BBC (?:THREE|FOUR) on BBC (?:ONE|TWO)\.)",
+                                        { " on bbc " },
+                                        QRegularExpression::CaseInsensitiveOption };
+static const EITFixUpPattern kUKBBC7rpt { R"(\[Rptd?[^]]+?\d{1,2}\.\d{1,2}[ap]m\]\.)",
+                                          { "[Rpt" } };
+static const EITFixUpPattern kUKCC { R"(\[(?:(AD|SL|S|W|HD),?)+\])",
+                                     { "[" } };
 static const QRegularExpression kUKCEPQ { R"([:\!\.\?]\s)" };
 static const QRegularExpression kUKColonPeriod { R"([:\.])" };
 static const QRegularExpression kUKCompleteDots { R"(^\.\.+$)" };
-static const QRegularExpression kUKDescriptionRemove { R"(^(?:CBBC\s*?\.|CBeebies\s*?\.|Class TV\s*?:|BBC Switch\.))" };
+static const EITFixUpPattern kUKDescriptionRemove { R"(^(?:CBBC\s*?\.|CBeebies\s*?\.|Class TV\s*?:|BBC Switch\.))",
+                                                    { "CBBC", "CBeebies", "Class TV", "BBC Switch." } };
 static const QRegularExpression kUKDotEnd { R"(\.$)" };
 static const QRegularExpression kUKDotSpaceStart { R"(^\. )" };
 static const QRegularExpression kUKDoubleDotEnd   { R"(\.\.+$)" };
 static const QRegularExpression kUKDoubleDotStart { R"(^\.\.+)" };
 static const QRegularExpression kUKExclusionFromSubtitle { "(starring|stars\\s|drama|seres|sitcom)",
                                                            QRegularExpression::CaseInsensitiveOption };
-static const QRegularExpression kUKLaONoSplit { "^Law & Order: (?:Criminal Intent|LA|Special Victims Unit|Trial by Jury|UK|You the Jury)" };
-static const QRegularExpression kUKNew { R"((New\.|\s*?(Brand New|New)\s*?(Series|Episode)\s*?[:\.\-]))",
-                                         QRegularExpression::CaseInsensitiveOption };
-static const QRegularExpression kUKNewTitle { R"(^(Brand New|New:)\s*)",
-                                              QRegularExpression::CaseInsensitiveOption };
-static const QRegularExpression kUKPart { R"([-(\:,.]\s*(?:Part|Pt)\s*(\d+)\s*(?:(?:of|/)\s*(\d+))?\s*[-):,.])",
-                                          QRegularExpression::CaseInsensitiveOption };
+static const EITFixUpPattern kUKLaONoSplit { "^Law & Order: (?:Criminal Intent|LA|Special Victims Unit|Trial by Jury|UK|You the Jury)",
+                                             { "Law & Order: " } };
+static const EITFixUpPattern kUKNew { R"((New\.|\s*?(Brand New|New)\s*?(Series|Episode)\s*?[:\.\-]))",
+                                      { "new" },
+                                      QRegularExpression::CaseInsensitiveOption };
+static const EITFixUpPattern kUKNewTitle { R"(^(Brand New|New:)\s*)",
+                                           { "new" },
+                                           QRegularExpression::CaseInsensitiveOption };
+static const EITFixUpPattern kUKPart { R"([-(\:,.]\s*(?:Part|Pt)\s*(\d+)\s*(?:(?:of|/)\s*(\d+))?\s*[-):,.])",
+                                       { "part", "pt" },
+                                       QRegularExpression::CaseInsensitiveOption };
 static const QRegularExpression kUKQuotedSubtitle { R"((?:^')([\w\s\-,]+?)(?:\.' ))" };
 // Prefer long format resorting to short format
 // cap0 = long match to remove, cap1 = long season, cap2 = long ep, cap3 = long total,
@@ -95,14 +171,19 @@ static const QRegularExpression kUKSeries { "(?:" + longContext + "|" + shortCon
                                             QRegularExpression::CaseInsensitiveOption };
 static const QRegularExpression kUKSpaceColonStart { R"(^[ |:]*)" };
 static const QRegularExpression kUKSpaceStart { "^ " };
-static const QRegularExpression kUKStarring { R"((?:Western\s)?[Ss]tarring ([\w\s\-']+?)[Aa]nd\s([\w\s\-']+?)[\.|,](?:\s)*(\d{4})?(?:\.\s)?)" };
-static const QRegularExpression kUKThen { R"(\s*?(Then|Followed by) 60 Seconds\.)",
-                                          QRegularExpression::CaseInsensitiveOption };
+static const EITFixUpPattern kUKStarring { R"((?:Western\s)?[Ss]tarring ([\w\s\-']+?)[Aa]nd\s([\w\s\-']+?)[\.|,](?:\s)*(\d{4})?(?:\.\s)?)",
+                                           { "tarring " } };
+static const EITFixUpPattern kUKThen { R"(\s*?(Then|Followed by) 60 Seconds\.)",
+                                       { "60 seconds." },
+                                       QRegularExpression::CaseInsensitiveOption };
 static const QRegularExpression kUKTime { R"(\d{1,2}[\.:]\d{1,2}\s*(am|pm|))" };
-static const QRegularExpression kUKTitleRemove { "^(?:[tT]4:|Schools\\s*?:)" };
-static const QRegularExpression kUKYear { R"([\[\(]([\d]{4})[\)\]])" };
+static const EITFixUpPattern kUKTitleRemove { "^(?:[tT]4:|Schools\\s*?:)",
+                                              { "4:", "Schools" } };
+static const EITFixUpPattern kUKYear { R"([\[\(]([\d]{4})[\)\]])",
+                                       { "(", "[" } };
 static const QRegularExpression kUKYearColon { R"(^[\d]{4}:)" };
-static const QRegularExpression kUnitymediaImdbrating { R"(\s*IMDb Rating: (\d\.\d)\s?/10$)" };
+static const EITFixUpPattern kUnitymediaImdbrating { R"(\s*IMDb Rating: (\d\.\d)\s?/10$)",
+                                                     { "IMDb Rating: " } };
 
 
 EITFixUp::EITFixUp()
@@ -869,25 +950,25 @@ void EITFixUp::FixUK(DBEventEIT &event)
     bool isMovie = event.m_category.startsWith("Movie",Qt::CaseInsensitive) ||
                    event.m_category.startsWith("Film",Qt::CaseInsensitive);
     // BBC three case (could add another record here ?)
-    event.m_description = event.m_description.remove(kUKThen);
-    event.m_description = event.m_description.remove(kUKNew);
-    event.m_title = event.m_title.remove(kUKNewTitle);
+    kUKThen.RemoveFrom(event.m_description);
+    kUKNew.RemoveFrom(event.m_description);
+    kUKNewTitle.RemoveFrom(event.m_title);
 
     // Removal of Class TV, CBBC and CBeebies etc..
-    event.m_title = event.m_title.remove(kUKTitleRemove);
-    event.m_description = event.m_description.remove(kUKDescriptionRemove);
+    kUKTitleRemove.RemoveFrom(event.m_title);
+    kUKDescriptionRemove.RemoveFrom(event.m_description);
 
     // Removal of BBC FOUR and BBC THREE
-    event.m_description = event.m_description.remove(kUKBBC34);
+    kUKBBC34.RemoveFrom(event.m_description);
 
     // BBC 7 [Rpt of ...] case.
-    event.m_description = event.m_description.remove(kUKBBC7rpt);
+    kUKBBC7rpt.RemoveFrom(event.m_description);
 
     // "All New To 4Music!
-    event.m_description = event.m_description.remove(kUKAllNew);
+    kUKAllNew.RemoveFrom(event.m_description);
 
     // Removal of 'Also in HD' text
-    event.m_description = event.m_description.remove(kUKAlsoInHD);
+    kUKAlsoInHD.RemoveFrom(event.m_description);
 
     // Remove [AD,S] etc.
     auto match = kUKCC.match(event.m_description);
@@ -1039,7 +1120,7 @@ void EITFixUp::FixUK(DBEventEIT &event)
     }
 
     if (!event.m_title.startsWith("CSI:") && !event.m_title.startsWith("CD:") &&
-        !event.m_title.contains(kUKLaONoSplit) &&
+        !kUKLaONoSplit.match(event.m_title).hasMatch() &&
         !event.m_title.startsWith("Mission: Impossible"))
     {
         if ((event.m_title.indexOf(kUKDoubleDotEnd) != -1) &&
@@ -1069,17 +1150,14 @@ void EITFixUp::FixUK(DBEventEIT &event)
                  SetUKSubtitle(event);
             }
         }
-        else if (event.m_description.indexOf(kUK24ep) != -1)
+        else if (kUK24ep.match(event.m_description).hasMatch())
         {
             auto match24 = kUK24ep.match(event.m_description);
-            if (match24.hasMatch())
-            {
-                // Special case for episodes of 24.
-                // -2 from the length cause we don't want ": " on the end
-                event.m_subtitle = event.m_description.mid(match24.capturedStart(0),
-                                                           match24.captured(0).length() - 2);
-                event.m_description = event.m_description.remove(match24.captured(0));
-            }
+            // Special case for episodes of 24.
+            // -2 from the length cause we don't want ": " on the end
+            event.m_subtitle = event.m_description.mid(match24.capturedStart(0),
+                                                       match24.captured(0).length() - 2);
+            event.m_description = event.m_description.remove(match24.captured(0));
         }
         else if (event.m_description.indexOf(kUKTime) == -1)
         {
@@ -1922,7 +2000,7 @@ void EITFixUp::FixDisneyChannel(DBEventEIT &event)
 **/
 void EITFixUp::FixATV(DBEventEIT &event)
 {
-    event.m_subtitle.replace(kAtvSubtitle, "");
+    kAtvSubtitle.RemoveFrom(event.m_subtitle);
 }
 
 
@@ -1978,7 +2056,7 @@ void EITFixUp::FixPremiere(DBEventEIT &event)
 {
     QString country = "";
 
-    event.m_description = event.m_description.replace(kDePremiereLength, "");
+    kDePremiereLength.RemoveFrom(event.m_description);
 
     auto match = kDePremiereAirdate.match(event.m_description);
     if ( match.hasMatch())
@@ -2599,7 +2677,7 @@ void EITFixUp::FixDK(DBEventEIT &event) const
 void EITFixUp::FixStripHTML(DBEventEIT &event)
 {
     LOG(VB_EIT, LOG_INFO, QString("Applying html strip to %1").arg(event.m_title));
-    event.m_title.remove(kHtml);
+    kHtml.RemoveFrom(event.m_title);
 }
 
 // Moves the subtitle field into the description since it's just used
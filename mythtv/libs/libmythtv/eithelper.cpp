@@ -21,7 +21,8 @@ using namespace std;
 #include "scheduledrecording.h" // for ScheduledRecording
 #include "compat.h" // for gmtime_r on windows.
 
-const uint EITHelper::kChunkSize = 20;
+const uint EITHelper::kChunkSize = 200;
+const uint EITHelper::kStatsInterval = 5000;
 EITCache *EITHelper::s_eitCache = new EITCache();
 
 static uint get_chan_id_from_db_atsc(uint sourceid,
@@ -35,7 +36,8 @@ static void init_fixup(FixupMap &fix);
 #define LOC QString("EITHelper: ")
 
 EITHelper::EITHelper() :
-    m_eitFixup(new EITFixUp())
+    m_eitFixup(new EITFixUp()),
+    m_writeStats(new DBEventBatchStats())
 {
     init_fixup(m_fixup);
 }
@@ -47,6 +49,7 @@ EITHelper::~EITHelper()
         delete m_dbEvents.dequeue();
 
     delete m_eitFixup;
+    delete m_writeStats;
 }
 
 uint EITHelper::GetListSize(void) const
@@ -58,29 +61,44 @@ uint EITHelper::GetListSize(void) const
 /** \fn EITHelper::ProcessEvents(void)
  *  \brief Inserts events in EIT list.
  *
+ *   Up to kChunkSize events are taken from the list and written to the
+ *   database with one DBEventBatch.
+ *
  *  \return Returns number of events inserted into DB.
  */
 uint EITHelper::ProcessEvents(void)
 {
     QMutexLocker locker(&m_eitListLock);
-    uint insertCount = 0;
 
     if (m_dbEvents.empty())
         return 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
+    QList<DBEventEIT*> events;
     for (uint i = 0; (i < kChunkSize) && (!m_dbEvents.empty()); i++)
-    {
-        DBEventEIT *event = m_dbEvents.dequeue();
-        m_eitListLock.unlock();
+        events.push_back(m_dbEvents.dequeue());
+    m_eitListLock.unlock();
 
+    DBEventBatch batch(1000);
+    for (auto *event : qAsConst(events))
+    {
         m_eitFixup->Fix(*event);
-
-        insertCount += event->UpdateDB(query, 1000);
+        batch.AddEvent(event->m_chanid, event);
         m_maxStarttime = max (m_maxStarttime, event->m_starttime);
+    }
 
-        delete event;
-        m_eitListLock.lock();
+    MSqlQuery query(MSqlQuery::InitCon());
+    uint insertCount = batch.WriteToDB(query);
+    qDeleteAll(events);
+
+    m_eitListLock.lock();
+
+    // Log the write statistics every kStatsInterval events
+    uint before = m_writeStats->m_events;
+    *m_writeStats += batch.GetStats();
+    if (before / kStatsInterval != m_writeStats->m_events / kStatsInterval)
+    {
+        LOG(VB_EIT, LOG_INFO,
+            LOC + "Write stats: " + m_writeStats->toString());
     }
 
     if (!insertCount)
@@ -81,6 +81,7 @@ using FixupValue = uint64_t;
 using FixupMap   = QMap<FixupKey, FixupValue>;
 
 class DBEventEIT;
+class DBEventBatchStats;
 class EITFixUp;
 class EITCache;
 
@@ -160,8 +161,12 @@ class EITHelper
 
     QMap<uint,uint>         m_languagePreferences;
 
-    /// Maximum number of DB inserts per ProcessEvents call.
+    DBEventBatchStats      *m_writeStats   {nullptr}; ///< totals of all ProcessEvents calls
+
+    /// Maximum number of events written per ProcessEvents call.
     static const uint kChunkSize;
+    /// Number of events between write statistics log messages.
+    static const uint kStatsInterval;
 };
 
 #endif // EIT_HELPER_H
@@ -43,6 +43,7 @@ MythAVFormatWriter::~MythAVFormatWriter()
 {
     if (m_ctx)
     {
+        FlushVideoEncoder();
         av_write_trailer(m_ctx);
         avio_closep(&m_ctx->pb);
         for(uint i = 0; i < m_ctx->nb_streams; i++)
@@ -182,6 +183,7 @@ bool MythAVFormatWriter::CloseFile(void)
 {
     if (m_ctx)
     {
+        FlushVideoEncoder();
         av_write_trailer(m_ctx);
         avio_close(m_ctx->pb);
         for(uint i = 0; i < m_ctx->nb_streams; i++)
@@ -226,7 +228,14 @@ int MythAVFormatWriter::WriteVideoFrame(VideoFrame *Frame)
     if (!got_pkt)
         return ret;
 
-    long long tc = Frame->timecode;
+    Frame->timecode = WriteVideoPacket(pkt, Frame->timecode);
+    return 1;
+}
+
+// Mux one encoded video packet and return its timecode
+long long MythAVFormatWriter::WriteVideoPacket(AVPacket &Pkt, long long Timecode)
+{
+    long long tc = Timecode;
 
     if (!m_bufferedVideoFrameTimes.isEmpty())
         tc = m_bufferedVideoFrameTimes.takeFirst();
@@ -235,25 +244,71 @@ int MythAVFormatWriter::WriteVideoFrame(VideoFrame *Frame)
     {
         int pict_type = m_bufferedVideoFrameTypes.takeFirst();
         if (pict_type == AV_PICTURE_TYPE_I)
-            pkt.flags |= AV_PKT_FLAG_KEY;
+            Pkt.flags |= AV_PKT_FLAG_KEY;
     }
 
     if (m_startingTimecodeOffset == -1)
         m_startingTimecodeOffset = tc - 1;
     tc -= m_startingTimecodeOffset;
 
-    pkt.pts = tc * m_videoStream->time_base.den / m_videoStream->time_base.num / 1000;
-    pkt.dts = AV_NOPTS_VALUE;
-    pkt.stream_index= m_videoStream->index;
+    Pkt.pts = tc * m_videoStream->time_base.den / m_videoStream->time_base.num / 1000;
+    Pkt.dts = AV_NOPTS_VALUE;
+    Pkt.stream_index= m_videoStream->index;
 
-    ret = av_interleaved_write_frame(m_ctx, &pkt);
+    int ret = av_interleaved_write_frame(m_ctx, &Pkt);
     if (ret != 0)
         LOG(VB_RECORD, LOG_ERR, LOC + "WriteVideoFrame(): av_interleaved_write_frame couldn't write Video");
 
-    Frame->timecode = tc + m_startingTimecodeOffset;
     m_framesWritten++;
-    av_packet_unref(&pkt);
-    return 1;
+    av_packet_unref(&Pkt);
+    return tc + m_startingTimecodeOffset;
+}
+
+// An encoder with a delay (e.g. x264 with frame threading) returns each
+// packet some frames after it was given the picture. Send null frames to
+// drain it before the trailer is written, or the last frames are lost.
+// The encoder cannot take new frames afterwards.
+void MythAVFormatWriter::FlushVideoEncoder(void)
+{
+    if (!m_ctx || !m_videoStream)
+        return;
+
+    AVCodecContext *avctx = m_codecMap.getCodecContext(m_videoStream);
+    if (!avctx || !avctx->codec ||
+        !(avctx->codec->capabilities & AV_CODEC_CAP_DELAY))
+        return;
+
+    int flushed = 0;
+    while (!m_bufferedVideoFrameTimes.isEmpty())
+    {
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        pkt.data = nullptr;
+        pkt.size = 0;
+        int got_pkt = 0;
+        int ret = avcodec_encode_video2(avctx, &pkt, nullptr, &got_pkt);
+        if (ret < 0)
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC + "FlushVideoEncoder(): avcodec_encode_video2() failed");
+            break;
+        }
+        if (!got_pkt)
+            break;
+        WriteVideoPacket(pkt, m_bufferedVideoFrameTimes.first());
+        flushed++;
+    }
+
+    if (!m_bufferedVideoFrameTimes.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("%1 video frames were not returned by the encoder")
+                .arg(m_bufferedVideoFrameTimes.size()));
+    }
+    m_bufferedVideoFrameTimes.clear();
+    m_bufferedVideoFrameTypes.clear();
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC +
+        QString("Flushed %1 delayed video frames").arg(flushed));
 }
 
 #if HAVE_BIGENDIAN
@@ -381,6 +436,10 @@ bool MythAVFormatWriter::SwitchToNextFile(void)
     return false;
 }
 
+// Continue the stream in a new file (the next HLS segment). The encoder is
+// not drained here: the frames it still holds go to the new file, and the
+// caller only switches when NextFrameIsKeyFrame() says the next packet out
+// starts a GOP. CloseFile() drains the encoder.
 bool MythAVFormatWriter::ReOpen(const QString& Filename)
 {
     bool result = m_buffer->ReOpen(Filename);
@@ -427,7 +486,7 @@ AVStream* MythAVFormatWriter::AddVideoStream(void)
     context->gop_size        = m_keyFrameDist;
     context->pix_fmt         = AV_PIX_FMT_YUV420P;
     context->thread_count    = m_encodingThreadCount;
-    context->thread_type     = FF_THREAD_SLICE;
+    context->thread_type     = m_frameThreading ? (FF_THREAD_FRAME | FF_THREAD_SLICE) : FF_THREAD_SLICE;
 
     if (context->codec_id == AV_CODEC_ID_MPEG2VIDEO)
     {
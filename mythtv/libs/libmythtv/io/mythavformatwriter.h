@@ -36,6 +36,8 @@ class MTV_PUBLIC MythAVFormatWriter : public MythMediaWriter
     bool ReOpen              (const QString& Filename);
 
   private:
+    long long WriteVideoPacket  (AVPacket &Pkt, long long Timecode);
+    void      FlushVideoEncoder (void);
     AVStream* AddVideoStream (void);
     bool      OpenVideo      (void);
     AVStream* AddAudioStream (void);
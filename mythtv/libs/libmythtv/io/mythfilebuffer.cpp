@@ -12,6 +12,7 @@
 #include "compat.h"
 #include "mythcorecontext.h"
 #include "io/mythfilebuffer.h"
+#include "io/mythstreamtap.h"
 
 // Std
 #include <cstdlib>
@@ -54,6 +55,13 @@ MythFileBuffer::MythFileBuffer(const QString &Filename, bool Write, bool UseRead
     m_safeFilename = Filename;
     m_filename = Filename;
 
+    // Megabytes of a local file to have read ahead of the position and to
+    // keep cached behind it, -1 keeps everything that was read
+    int ahead  = gCoreContext->GetNumSetting("PlaybackCacheAhead", 4);
+    int behind = gCoreContext->GetNumSetting("PlaybackCacheBehind", 8);
+    m_cacheWindow.SetWindow(max(ahead, 0) * 1024LL * 1024,
+                            (behind < 0) ? -1 : behind * 1024LL * 1024);
+
     if (Write)
     {
         if (m_filename.startsWith("myth://"))
@@ -102,6 +110,15 @@ MythFileBuffer::~MythFileBuffer()
 
     if (m_fd2 >= 0)
     {
+        if (VERBOSE_LEVEL_CHECK(VB_FILE, LOG_INFO))
+        {
+            PageCacheStats stats = m_cacheWindow.GetStats();
+            LOG(VB_FILE, LOG_INFO, LOC + QString("Page cache: %1 bytes read ahead, %2 bytes dropped, "
+                                                 "%3 bytes still cached")
+                .arg(stats.m_willNeed).arg(stats.m_dropped)
+                .arg(PageCacheWindow::Resident(m_fd2)));
+        }
+        m_cacheWindow.Close();
         close(m_fd2);
         m_fd2 = -1;
     }
@@ -189,10 +206,14 @@ bool MythFileBuffer::OpenFile(const QString &Filename, uint Retry)
 
     if (m_fd2 >= 0)
     {
+        m_cacheWindow.Close();
         close(m_fd2);
         m_fd2 = -1;
     }
 
+    delete m_tap;
+    m_tap = nullptr;
+
     bool islocal = (!m_filename.startsWith("/dev")) &&
                    ((m_filename.startsWith("/")) || QFile::exists(m_filename));
 
@@ -245,20 +266,8 @@ bool MythFileBuffer::OpenFile(const QString &Filename, uint Retry)
                 {
                     if (0 == lseek(m_fd2, 0, SEEK_SET))
                     {
-#ifndef _MSC_VER
-                        if (posix_fadvise(m_fd2, 0, 0, POSIX_FADV_SEQUENTIAL) != 0)
-                        {
-                            LOG(VB_FILE, LOG_DEBUG, LOC +
-                                QString("OpenFile(): fadvise sequential "
-                                        "failed: ") + ENO);
-                        }
-                        if (posix_fadvise(m_fd2, 0, 128*1024, POSIX_FADV_WILLNEED) != 0)
-                        {
-                            LOG(VB_FILE, LOG_DEBUG, LOC +
-                                QString("OpenFile(): fadvise willneed "
-                                        "failed: ") + ENO);
-                        }
-#endif
+                        m_cacheWindow.Open(m_fd2, 0);
+                        m_cacheWindow.Read(0);
                         lasterror = 0;
                         break;
                     }
@@ -279,6 +288,9 @@ bool MythFileBuffer::OpenFile(const QString &Filename, uint Retry)
                 QString extension = file.completeSuffix().toLower();
                 if (IsSubtitlePossible(extension))
                     m_subtitleFilename = LocalSubtitleFilename(file);
+                // A recording in progress may be shared by its recorder
+                if (!m_oldfile)
+                    m_tap = MythStreamTap::Open(m_filename);
                 break;
             }
             case 1:
@@ -433,6 +445,19 @@ int MythFileBuffer::SafeRead(int /*fd*/, void *Buffer, uint Size)
     if (m_stopReads)
         return 0;
 
+    // What the recorder has just written is still in the tap, and may not
+    // have reached the file yet
+    if (m_tap)
+    {
+        long long pos = lseek64(m_fd2, 0, SEEK_CUR);
+        int copied = (pos < 0) ? 0 : m_tap->Read(pos, Buffer, Size);
+        if (copied > 0)
+        {
+            lseek64(m_fd2, pos + copied, SEEK_SET);
+            return copied;
+        }
+    }
+
     struct stat sb {};
 
     while (tot < Size)
@@ -517,6 +542,11 @@ int MythFileBuffer::SafeRead(int /*fd*/, void *Buffer, uint Size)
         if (tot < Size)
             usleep(60000);
     }
+
+    long long pos = (tot > 0) ? lseek64(m_fd2, 0, SEEK_CUR) : -1;
+    if (pos > 0)
+        m_cacheWindow.Read(pos);
+
     return static_cast<int>(tot);
 }
 
@@ -572,8 +602,11 @@ long long MythFileBuffer::GetRealFileSizeInternal(void) const
             result = fstat(m_fd2, &sb);
             if (result == 0 && S_ISREG(sb.st_mode))
             {
+                long long size = sb.st_size;
+                if (m_tap)
+                    size = max(size, m_tap->GetWritten());
                 m_rwLock.unlock();
-                return sb.st_size;
+                return size;
             }
         }
         result = QFileInfo(m_filename).size();
@@ -810,6 +843,8 @@ long long MythFileBuffer::SeekInternal(long long Position, int Whence)
     else
     {
         ret = lseek64(m_fd2, Position, Whence);
+        if (ret >= 0)
+            m_cacheWindow.Seek(ret);
     }
 
     if (ret >= 0)
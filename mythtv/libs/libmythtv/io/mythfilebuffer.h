@@ -3,6 +3,7 @@
 
 // MythTV
 #include "io/mythmediabuffer.h"
+#include "pagecachewindow.h"
 
 class MTV_PUBLIC MythFileBuffer : public MythMediaBuffer
 {
@@ -25,4 +26,7 @@ class MTV_PUBLIC MythFileBuffer : public MythMediaBuffer
     int       SafeRead        (RemoteFile *Remote, void *Buffer, uint Size);
     long long GetRealFileSizeInternal(void) const override;
     long long SeekInternal    (long long Position, int Whence) override;
+
+  private:
+    PageCacheWindow m_cacheWindow { 0, -1 };
 };
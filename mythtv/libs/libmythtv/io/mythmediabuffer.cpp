@@ -7,6 +7,7 @@
 #include "threadedfilewriter.h"
 #include "io/mythfilebuffer.h"
 #include "io/mythstreamingbuffer.h"
+#include "io/mythstreamtap.h"
 #include "mythmiscutil.h"
 #include "livetvchain.h"
 #include "mythcontext.h"
@@ -45,6 +46,13 @@ const int  MythMediaBuffer::kLiveTVOpenTimeout  = 10000;
 
 #define LOC      QString("RingBuf(%1): ").arg(m_filename)
 
+/// Milliseconds of a monotonic clock, for the read-ahead model
+static int64_t readahead_clock(void)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 
 /*
   Locking relations:
@@ -200,6 +208,8 @@ MythMediaBuffer::MythMediaBuffer(MythBufferType Type)
   : MThread("RingBuffer"),
     m_type(Type)
 {
+    if (gCoreContext)
+        m_adaptiveReadAhead = gCoreContext->GetBoolSetting("AdaptiveReadAhead", true);
 }
 
 MythBufferType MythMediaBuffer::GetType(void) const
@@ -231,6 +241,9 @@ MythMediaBuffer::~MythMediaBuffer(void)
         delete m_tfw;
         m_tfw = nullptr;
     }
+
+    delete m_tap;
+    m_tap = nullptr;
 }
 
 /** \fn MythMediaBuffer::Reset(bool, bool, bool)
@@ -366,6 +379,9 @@ void MythMediaBuffer::CalcReadAheadThresh(void)
 
     estbitrate     = static_cast<uint>(max(abs(m_rawBitrate * m_playSpeed), 0.5F * m_rawBitrate));
     estbitrate     = min(m_rawBitrate * 3, estbitrate);
+    // The container may understate the bitrate, trust what was consumed
+    if (m_adaptiveReadAhead)
+        estbitrate = max(estbitrate, m_readAheadModel.ConsumptionRate() / 125);
     int const rbs  = (estbitrate > 18000) ? KB512 :
                      (estbitrate >  9000) ? KB256 :
                      (estbitrate >  5000) ? KB128 :
@@ -579,8 +595,6 @@ void MythMediaBuffer::ResetReadAhead(long long NewInternal)
     m_rbrLock.lockForWrite();
     m_rbwLock.lockForWrite();
 
-    CalcReadAheadThresh();
-
     m_rbrPos          = 0;
     m_rbwPos          = 0;
     m_internalReadPos = NewInternal;
@@ -590,6 +604,24 @@ void MythMediaBuffer::ResetReadAhead(long long NewInternal)
     m_recentSeek      = true;
     m_setSwitchToNext = false;
 
+    // The buffer is empty now, so this is the cheapest time to resize it
+    int64_t now = readahead_clock();
+    if (m_readAheadRunning)
+        m_readAheadModel.Seeked(now);
+    if (m_adaptiveReadAhead && m_readAheadBuffer)
+    {
+        uint size = m_readAheadModel.TargetBufferSize(m_bufferSize, BUFFER_SIZE_MINIMUM, now);
+        uint oldsize = m_bufferSize;
+        if (ResizeReadAheadBuffer(size))
+        {
+            m_readAheadModel.Resized();
+            LOG(VB_FILE, LOG_INFO, LOC + QString("Resized readAheadBuffer after seek: %1Kb -> %2Kb")
+                .arg(oldsize >> 10).arg(size >> 10));
+        }
+    }
+
+    CalcReadAheadThresh();
+
     m_generalWait.wakeAll();
 
     m_rbwLock.unlock();
@@ -769,23 +801,31 @@ bool MythMediaBuffer::PauseAndWait(void)
     return m_requestPause || m_paused;
 }
 
-void MythMediaBuffer::CreateReadAheadBuffer(void)
+/// \brief Returns the buffer size suggested by the type of file and stream.
+/// \warning Must be called with rwlock in locked state.
+uint MythMediaBuffer::BaseBufferSize(void) const
 {
-    m_rwLock.lockForWrite();
-    m_posLock.lockForWrite();
-
-    uint oldsize = m_bufferSize;
-    uint newsize = BUFFER_SIZE_MINIMUM;
+    uint size = BUFFER_SIZE_MINIMUM;
     if (m_remotefile)
     {
-        newsize *= BUFFER_FACTOR_NETWORK;
+        size *= BUFFER_FACTOR_NETWORK;
         if (m_fileIsMatroska)
-            newsize *= BUFFER_FACTOR_MATROSKA;
+            size *= BUFFER_FACTOR_MATROSKA;
         if (m_unknownBitrate)
-            newsize *= BUFFER_FACTOR_BITRATE;
+            size *= BUFFER_FACTOR_BITRATE;
     }
+    return size;
+}
+
+void MythMediaBuffer::CreateReadAheadBuffer(void)
+{
+    m_rwLock.lockForWrite();
+    m_posLock.lockForWrite();
+
+    uint oldsize = m_bufferSize;
+    uint newsize = BaseBufferSize();
 
-    // N.B. Don't try and make it smaller - bad things happen...
+    // Only the read-ahead model makes the buffer smaller
     if (m_readAheadBuffer && (oldsize >= newsize))
     {
         m_posLock.unlock();
@@ -793,28 +833,68 @@ void MythMediaBuffer::CreateReadAheadBuffer(void)
         return;
     }
 
-    m_bufferSize = newsize;
-    if (m_readAheadBuffer)
+    m_rbrLock.lockForWrite();
+    m_rbwLock.lockForWrite();
+    bool created = ResizeReadAheadBuffer(newsize);
+    m_rbwLock.unlock();
+    m_rbrLock.unlock();
+    if (created)
+        CalcReadAheadThresh();
+    m_posLock.unlock();
+    m_rwLock.unlock();
+
+    if (created)
     {
-        char* newbuffer = new char[m_bufferSize + 1024];
-        memcpy(newbuffer, m_readAheadBuffer + m_rbwPos, oldsize - static_cast<uint>(m_rbwPos));
-        memcpy(newbuffer + (oldsize - static_cast<uint>(m_rbwPos)), m_readAheadBuffer, static_cast<uint>(m_rbwPos));
-        delete [] m_readAheadBuffer;
-        m_readAheadBuffer = newbuffer;
-        m_rbrPos = (m_rbrPos > m_rbwPos) ? (m_rbrPos - m_rbwPos) :
-                                           (m_rbrPos + static_cast<int>(oldsize) - m_rbwPos);
-        m_rbwPos = static_cast<int>(oldsize);
+        LOG(VB_FILE, LOG_INFO, LOC + QString("Created readAheadBuffer: %1Mb")
+            .arg(newsize >> 20));
     }
-    else
+}
+
+/** \fn MythMediaBuffer::ResizeReadAheadBuffer(uint)
+ *  \brief Replaces the read-ahead buffer with one of NewSize bytes.
+ *
+ *   The unread data is kept, along with as much of the data before it as
+ *   fits, so short seeks back can still be served from the buffer.  The
+ *   buffer is left alone in internal read mode, or if the unread data
+ *   does not fit in the new buffer.
+ *
+ *  \warning Must be called with rwlock, poslock, rbrlock and rbwlock
+ *           in write lock state.
+ *  \return true if the buffer was replaced
+ */
+bool MythMediaBuffer::ResizeReadAheadBuffer(uint NewSize)
+{
+    if (!m_readAheadBuffer)
     {
+        m_bufferSize = NewSize;
         m_readAheadBuffer = new char[m_bufferSize + 1024];
+        return true;
     }
-    CalcReadAheadThresh();
-    m_posLock.unlock();
-    m_rwLock.unlock();
 
-    LOG(VB_FILE, LOG_INFO, LOC + QString("Created readAheadBuffer: %1Mb")
-        .arg(newsize >> 20));
+    if (m_readInternalMode || NewSize == m_bufferSize)
+        return false;
+
+    int oldsize = static_cast<int>(m_bufferSize);
+    int newsize = static_cast<int>(NewSize);
+    int avail   = (m_rbwPos >= m_rbrPos) ? m_rbwPos - m_rbrPos : oldsize - m_rbrPos + m_rbwPos;
+    int behind  = (m_rbwPos >= m_rbrPos) ? m_rbrPos : m_rbrPos - m_rbwPos;
+    if (avail >= newsize)
+        return false;
+
+    // Copy the last 'keep' bytes written to the start of the new buffer
+    int keep  = min(avail + behind, newsize - 1);
+    int start = (m_rbwPos - keep + oldsize) % oldsize;
+    int first = min(keep, oldsize - start);
+
+    char* newbuffer = new char[NewSize + 1024];
+    memcpy(newbuffer, m_readAheadBuffer + start, static_cast<size_t>(first));
+    memcpy(newbuffer + first, m_readAheadBuffer, static_cast<size_t>(keep - first));
+    delete [] m_readAheadBuffer;
+    m_readAheadBuffer = newbuffer;
+    m_bufferSize      = NewSize;
+    m_rbwPos          = keep;
+    m_rbrPos          = keep - avail;
+    return true;
 }
 
 void MythMediaBuffer::run(void)
@@ -828,6 +908,9 @@ void MythMediaBuffer::run(void)
     bool ignoreForReadTiming = true;
     int  eofreads = 0;
 
+    // Used to sample the buffer use and resize the buffer
+    MythTimer adaptTimer(MythTimer::kStartRunning);
+
     gettimeofday(&lastread, nullptr); // this is just to keep gcc happy
 
     CreateReadAheadBuffer();
@@ -982,6 +1065,7 @@ void MythMediaBuffer::run(void)
                 .arg(QString("(%1Mbps)").arg(static_cast<double>(bps) / 1000000.0))
                 .arg(readTimeAvg));
             UpdateStorageRate(bps);
+            m_readAheadModel.StorageRead(readResult, sr_elapsed);
 
             if (readResult >= 0)
             {
@@ -1029,8 +1113,11 @@ void MythMediaBuffer::run(void)
 
             m_commsError |= (m_numFailures > 5);
 
+            bool readsWereDesired = m_readsDesired;
             m_readsAllowed = used >= 1 || m_ateof || m_setSwitchToNext || m_commsError;
             m_readsDesired = used >= m_fillMin || m_ateof || m_setSwitchToNext || m_commsError;
+            if (!readsWereDesired && used >= m_fillMin)
+                m_readAheadModel.Refilled();
 
             if ((0 == readResult) && (oldreadposition == m_readPos))
             {
@@ -1098,6 +1185,39 @@ void MythMediaBuffer::run(void)
             eofreads = 0;
         }
 
+        if (adaptTimer.elapsed() >= 1000)
+        {
+            adaptTimer.restart();
+            m_readAheadModel.Occupancy(used, m_bufferSize);
+
+            uint size = m_bufferSize;
+            if (m_adaptiveReadAhead && !m_readInternalMode)
+                size = m_readAheadModel.TargetBufferSize(m_bufferSize, BUFFER_SIZE_MINIMUM, readahead_clock());
+            if (size != m_bufferSize)
+            {
+                m_rwLock.unlock();
+                m_rwLock.lockForWrite();
+                m_posLock.lockForWrite();
+                m_rbrLock.lockForWrite();
+                m_rbwLock.lockForWrite();
+                uint oldsize = m_bufferSize;
+                bool resized = ResizeReadAheadBuffer(size);
+                m_rbwLock.unlock();
+                m_rbrLock.unlock();
+                if (resized)
+                {
+                    CalcReadAheadThresh();
+                    m_readAheadModel.Resized();
+                    LOG(VB_FILE, LOG_INFO, LOC + QString("Resized readAheadBuffer: %1Kb -> %2Kb")
+                        .arg(oldsize >> 10).arg(size >> 10));
+                }
+                m_posLock.unlock();
+                m_rwLock.unlock();
+                m_rwLock.lockForRead();
+                used = static_cast<int>(m_bufferSize) - ReadBufFree();
+            }
+        }
+
         LOG(VB_FILE, LOG_DEBUG, LOC + "@ end of read ahead loop");
 
         if (!m_readsAllowed || m_commsError || m_ateof || m_setSwitchToNext ||
@@ -1150,7 +1270,11 @@ void MythMediaBuffer::run(void)
     m_rbrLock.unlock();
     m_rwLock.unlock();
 
-    LOG(VB_FILE, LOG_INFO, LOC + QString("Exiting readahead thread"));
+    MythReadAheadStats stats = m_readAheadModel.GetStats();
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Exiting readahead thread: %1 stalls (%2 ms) "
+                                         "%3 refills %4 resizes %5% average use")
+        .arg(stats.m_stalls).arg(stats.m_stallTime).arg(stats.m_refills)
+        .arg(stats.m_resizes).arg(stats.m_occupancy));
 
     RunEpilog();
 }
@@ -1368,6 +1492,8 @@ int MythMediaBuffer::ReadPriv(void *Buffer, int Count, bool Peek)
     }
 
     int available = ReadBufAvail();
+    bool starved = (available == 0) && !m_readInternalMode && !m_ateof &&
+                   !m_liveTVChain && !m_beingWritten;
     MythTimer timer(MythTimer::kStartRunning);
 
     // Wait up to 10000 ms for any data
@@ -1390,6 +1516,8 @@ int MythMediaBuffer::ReadPriv(void *Buffer, int Count, bool Peek)
         LOG(VB_GENERAL, LOG_WARNING, LOC + desc + QString(" -- waited %1 ms for avail(%2) > count(%3)")
             .arg(timer.elapsed()).arg(available).arg(Count));
     }
+    if (starved && !m_stopReads && !m_requestPause)
+        m_readAheadModel.Stalled(timer.elapsed(), readahead_clock());
 
     if (m_readInternalMode)
     {
@@ -1485,6 +1613,7 @@ int MythMediaBuffer::Read(void *Buffer, int Count)
         m_readPos += ret;
         m_posLock.unlock();
         UpdateDecoderRate(static_cast<uint64_t>(ret));
+        m_readAheadModel.Consumed(ret, readahead_clock());
     }
 
     return ret;
@@ -1548,6 +1677,11 @@ uint MythMediaBuffer::GetBufferSize(void) const
     return m_bufferSize;
 }
 
+MythReadAheadStats MythMediaBuffer::GetReadAheadStats(void) const
+{
+    return m_readAheadModel.GetStats();
+}
+
 uint64_t MythMediaBuffer::UpdateDecoderRate(uint64_t Latest)
 {
     if (!m_bitrateMonitorEnabled)
@@ -1640,6 +1774,8 @@ int MythMediaBuffer::Write(const void *Buffer, uint Count)
     if (result > 0)
     {
         m_posLock.lockForWrite();
+        if (m_tap)
+            m_tap->Write(m_writePos, Buffer, static_cast<uint>(result));
         m_writePos += result;
         m_posLock.unlock();
     }
@@ -1676,6 +1812,10 @@ long long MythMediaBuffer::WriterSeek(long long Position, int Whence, bool HasLo
         m_writePos = result;
     }
 
+    // What is written next may replace what the tap holds
+    if (m_tap)
+        m_tap->Disable();
+
     m_posLock.unlock();
 
     if (!HasLock)
@@ -1695,6 +1835,19 @@ void MythMediaBuffer::WriterFlush(void)
     m_rwLock.unlock();
 }
 
+/** \brief Shares what is written from now on with readers of the file in
+ *         other processes, through a MythStreamTap.
+ *  \param CPUBudget Percent of one CPU core that analysis of the stream may use
+ */
+bool MythMediaBuffer::EnableWriteTap(int CPUBudget)
+{
+    QWriteLocker lock(&m_rwLock);
+    if (!m_tfw || m_tap)
+        return m_tap != nullptr;
+    m_tap = MythStreamTap::Create(m_filename, CPUBudget);
+    return m_tap != nullptr;
+}
+
 /** \fn MythMediaBuffer::WriterSetBlocking(bool)
  *  \brief Calls ThreadedFileWriter::SetBlocking(bool)
  */
@@ -12,6 +12,7 @@
 #include "mythtvexp.h"
 #include "mythconfig.h"
 #include "mthread.h"
+#include "io/mythreadaheadmodel.h"
 
 // FFmpeg
 extern "C" {
@@ -30,6 +31,7 @@ extern "C" {
 #define DEFAULT_CHUNK_SIZE 32768
 
 class ThreadedFileWriter;
+class MythStreamTap;
 class MythDVDBuffer;
 class MythBDBuffer;
 class LiveTVChain;
@@ -80,6 +82,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     QString   GetStorageRate       (void);
     QString   GetAvailableBuffer   (void);
     uint      GetBufferSize        (void) const;
+    MythReadAheadStats GetReadAheadStats(void) const;
     bool      IsNearEnd            (double Framerate, uint Frames) const;
     long long GetWritePosition     (void) const;
     long long GetRealFileSize      (void) const;
@@ -118,6 +121,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     void      Sync                 (void);
     long long WriterSeek           (long long Position, int Whence, bool HasLock = false);
     bool      WriterSetBlocking    (bool Lock = true);
+    bool      EnableWriteTap       (int CPUBudget);
 
     virtual long long GetReadPosition   (void) const = 0;
     virtual bool      IsOpen            (void) const = 0;
@@ -139,6 +143,8 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
 
     void     run(void) override;
     void     CreateReadAheadBuffer (void);
+    uint     BaseBufferSize        (void) const;
+    bool     ResizeReadAheadBuffer (uint NewSize);
     void     CalcReadAheadThresh   (void);
     bool     PauseAndWait          (void);
     int      ReadPriv              (void *Buffer, int Count, bool Peek);
@@ -184,6 +190,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     QString                m_subtitleFilename;
     QString                m_lastError;
     ThreadedFileWriter    *m_tfw              { nullptr };
+    MythStreamTap         *m_tap              { nullptr };
     int                    m_fd2              { -1 };
     bool                   m_writeMode        { false   };
     RemoteFile            *m_remotefile       { nullptr };
@@ -221,6 +228,8 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     // End of section protected by rwLock
 
     bool                   m_bitrateMonitorEnabled { false };
+    bool                   m_adaptiveReadAhead { true };
+    MythReadAheadModel     m_readAheadModel;
     QMutex                 m_decoderReadLock;
     QMap<qint64, uint64_t> m_decoderReads;
     QMutex                 m_storageReadLock;
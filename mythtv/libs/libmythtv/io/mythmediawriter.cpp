@@ -96,6 +96,12 @@ void MythMediaWriter::SetThreadCount(int Count)
     m_encodingThreadCount = Count;
 }
 
+/// Lets the video encoder work on several frames at once, at the cost of latency
+void MythMediaWriter::SetFrameThreading(bool Enable)
+{
+    m_frameThreading = Enable;
+}
+
 void MythMediaWriter::SetTimecodeOffset(long long Offset)
 {
     m_startingTimecodeOffset = Offset;
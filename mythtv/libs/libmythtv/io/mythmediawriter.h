@@ -39,6 +39,7 @@ class MTV_PUBLIC MythMediaWriter
     void         SetAudioFrameRate (int Rate);
     void         SetAudioFormat    (AudioFormat Format);
     void         SetThreadCount    (int Count);
+    void         SetFrameThreading (bool Enable);
     void         SetTimecodeOffset (long long Offset);
     void         SetEncodingPreset (const QString& Preset);
     void         SetEncodingTune   (const QString& Tune);
@@ -63,6 +64,7 @@ class MTV_PUBLIC MythMediaWriter
     AudioFormat m_audioFormat            { FORMAT_S16 };
     int         m_audioFrameSize         { -1     };
     int         m_encodingThreadCount    { 1      };
+    bool        m_frameThreading         { false  };
     long long   m_framesWritten          { 0      };
     long long   m_startingTimecodeOffset { -1     };
     QString     m_encodingPreset;
@@ -0,0 +1,188 @@
+// Std
+#include <algorithm>
+#include <cmath>
+
+// MythTV
+#include "io/mythreadaheadmodel.h"
+
+const uint MythReadAheadModel::kMaxBufferSize = 64 * 1024 * 1024;
+
+// Consumption is measured over windows of at least this many ms, and a
+// window with a longer gap between two reads (pause, still frame) is dropped
+static constexpr int64_t kRateWindow    = 1000;
+static constexpr int64_t kRateGap       = 5000;
+// Playback to cover normally, and while the viewer is seeking around
+static constexpr int64_t kCoverMs       = 2000;
+static constexpr int64_t kSeekingCoverMs = 1000;
+// Extra playback to cover per recent stall, and how many stalls count
+static constexpr int64_t kStallCoverMs  = 1000;
+static constexpr size_t  kMaxStalls     = 4;
+static constexpr int64_t kStallMemory   = 60000;
+// This many seeks within the window means the viewer is seeking around
+static constexpr size_t  kSeekBurst     = 3;
+static constexpr int64_t kSeekWindow    = 10000;
+// Storage reads that can go slow in a row before the decoder runs dry
+static constexpr int     kSlowReads     = 4;
+static constexpr uint    kSizeStep      = 1024 * 1024;
+
+void MythReadAheadModel::Reset(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_stats = MythReadAheadStats();
+    m_windowStart = -1;
+    m_windowBytes = 0;
+    m_rate = 0.0;
+    m_latency = 0.0;
+    m_peakLatency = 0.0;
+    m_occupancy = 0.0;
+    m_recentSeeks.clear();
+    m_recentStalls.clear();
+}
+
+void MythReadAheadModel::Seeked(int64_t Now)
+{
+    QMutexLocker locker(&m_lock);
+    m_stats.m_seeks++;
+    m_windowStart = -1;
+    m_windowBytes = 0;
+    m_recentSeeks.push_back(Now);
+    while (m_recentSeeks.size() > kSeekBurst)
+        m_recentSeeks.pop_front();
+}
+
+/// Records data handed to the decoder
+void MythReadAheadModel::Consumed(int Bytes, int64_t Now)
+{
+    QMutexLocker locker(&m_lock);
+    if (m_windowStart < 0)
+    {
+        m_windowStart = Now;
+        m_windowBytes = 0;
+        return;
+    }
+
+    int64_t elapsed = Now - m_windowStart;
+    if (elapsed > kRateGap)
+    {
+        m_windowStart = Now;
+        m_windowBytes = 0;
+        return;
+    }
+
+    m_windowBytes += Bytes;
+    if (elapsed < kRateWindow)
+        return;
+
+    double rate = m_windowBytes * 1000.0 / elapsed;
+    m_rate = (m_rate > 0.0) ? (m_rate * 3.0 + rate) / 4.0 : rate;
+    m_stats.m_consumption = static_cast<uint>(m_rate);
+    m_windowStart = Now;
+    m_windowBytes = 0;
+}
+
+/// Records the time a read from storage took
+void MythReadAheadModel::StorageRead(int Bytes, int Elapsed)
+{
+    if (Bytes <= 0)
+        return;
+
+    QMutexLocker locker(&m_lock);
+    double elapsed = std::min(Elapsed, 10000);
+    m_latency = (m_latency * 7.0 + elapsed) / 8.0;
+    m_peakLatency = std::max(elapsed, m_peakLatency * 15.0 / 16.0);
+    m_stats.m_latency = static_cast<uint>(std::lround(m_latency));
+}
+
+/// Records a read by the decoder that waited for the read-ahead thread
+void MythReadAheadModel::Stalled(int Elapsed, int64_t Now)
+{
+    QMutexLocker locker(&m_lock);
+    m_stats.m_stalls++;
+    m_stats.m_stallTime += static_cast<uint64_t>(std::max(Elapsed, 0));
+    m_recentStalls.push_back(Now);
+    while (m_recentStalls.size() > kMaxStalls)
+        m_recentStalls.pop_front();
+}
+
+void MythReadAheadModel::Refilled(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_stats.m_refills++;
+}
+
+void MythReadAheadModel::Occupancy(int Used, uint Size)
+{
+    if (!Size)
+        return;
+
+    QMutexLocker locker(&m_lock);
+    double used = std::max(Used, 0) * 100.0 / Size;
+    m_occupancy = (m_occupancy * 31.0 + used) / 32.0;
+    m_stats.m_occupancy = static_cast<uint>(std::lround(m_occupancy));
+}
+
+void MythReadAheadModel::Resized(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_stats.m_resizes++;
+}
+
+/// Returns the bytes per second consumed by the decoder, 0 if not known yet
+uint MythReadAheadModel::ConsumptionRate(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return static_cast<uint>(m_rate);
+}
+
+/** \fn MythReadAheadModel::TargetBufferSize(uint, uint, int64_t) const
+ *  \brief Returns the buffer size to use from now on.
+ *
+ *   Current is returned unless the wanted size is at least a quarter
+ *   larger, or no more than half the size, so the buffer is not resized
+ *   over small changes in the bitrate.
+ *
+ *  \param Current Size of the buffer now
+ *  \param Minimum Smallest size that may be returned
+ */
+uint MythReadAheadModel::TargetBufferSize(uint Current, uint Minimum,
+                                          int64_t Now) const
+{
+    QMutexLocker locker(&m_lock);
+    if (m_rate <= 0.0)
+        return Current;
+
+    int64_t cover = kCoverMs;
+    if (m_recentSeeks.size() >= kSeekBurst &&
+        Now - m_recentSeeks.front() < kSeekWindow)
+    {
+        cover = kSeekingCoverMs;
+    }
+    else
+    {
+        cover += static_cast<int64_t>(std::count_if(
+            m_recentStalls.cbegin(), m_recentStalls.cend(),
+            [Now](int64_t stall) { return Now - stall < kStallMemory; })) *
+            kStallCoverMs;
+    }
+    cover += static_cast<int64_t>(std::lround(m_peakLatency)) * kSlowReads;
+
+    // The read-ahead thread stops filling at 7/8 of the buffer
+    double wanted = m_rate * cover / 1000.0 * 8.0 / 7.0;
+    wanted = std::ceil(wanted / kSizeStep) * kSizeStep;
+    uint target = static_cast<uint>(std::clamp(
+        wanted, static_cast<double>(Minimum),
+        static_cast<double>(std::max(Minimum, kMaxBufferSize))));
+
+    if (target > Current &&
+        target - Current >= std::max(Current / 4, kSizeStep))
+        return target;
+    if (target < Current && target <= Current / 2)
+        return target;
+    return Current;
+}
+
+MythReadAheadStats MythReadAheadModel::GetStats(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_stats;
+}
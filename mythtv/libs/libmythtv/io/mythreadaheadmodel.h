@@ -0,0 +1,72 @@
+#ifndef MYTHREADAHEADMODEL_H
+#define MYTHREADAHEADMODEL_H
+
+// Qt
+#include <QMutex>
+
+// MythTV
+#include "mythtvexp.h"
+
+// Std
+#include <cstdint>
+#include <deque>
+
+/// Read-ahead counters, reported with the playback data
+struct MythReadAheadStats
+{
+    uint64_t m_stalls       { 0 }; ///< Reads that had to wait for data
+    uint64_t m_stallTime    { 0 }; ///< Milliseconds spent waiting in those reads
+    uint64_t m_refills      { 0 }; ///< Times the buffer was filled up to the read minimum
+    uint64_t m_resizes      { 0 }; ///< Times the buffer was resized
+    uint64_t m_seeks        { 0 }; ///< Seeks that discarded the buffer
+    uint     m_occupancy    { 0 }; ///< Average percentage of the buffer in use
+    uint     m_consumption  { 0 }; ///< Bytes per second read by the decoder
+    uint     m_latency      { 0 }; ///< Average milliseconds per storage read
+};
+
+/** \class MythReadAheadModel
+ *  \brief Sizes the read-ahead buffer of a MythMediaBuffer from what is
+ *         seen while it is played.
+ *
+ *   The size chosen when the file is opened is based on the bitrate the
+ *   container claims, which is often wrong.  This model measures the rate
+ *   the decoder actually consumes data at and the time the storage takes
+ *   to answer, and asks for enough buffer to cover a couple of seconds of
+ *   playback plus a few slow storage reads.  Every stall of the decoder
+ *   adds another second for a while.  While the viewer seeks around the
+ *   data read ahead is mostly thrown away, so only a second is covered.
+ *
+ *   All times are in milliseconds of a monotonic clock supplied by the
+ *   caller.
+ */
+class MTV_PUBLIC MythReadAheadModel
+{
+  public:
+    void     Reset           (void);
+    void     Seeked          (int64_t Now);
+    void     Consumed        (int Bytes, int64_t Now);
+    void     StorageRead     (int Bytes, int Elapsed);
+    void     Stalled         (int Elapsed, int64_t Now);
+    void     Refilled        (void);
+    void     Occupancy       (int Used, uint Size);
+    void     Resized         (void);
+    uint     ConsumptionRate (void) const;
+    uint     TargetBufferSize(uint Current, uint Minimum, int64_t Now) const;
+    MythReadAheadStats GetStats(void) const;
+
+    static const uint kMaxBufferSize;
+
+  private:
+    mutable QMutex      m_lock;
+    MythReadAheadStats  m_stats;
+    int64_t             m_windowStart  { -1 };
+    int64_t             m_windowBytes  { 0 };
+    double              m_rate         { 0.0 };
+    double              m_latency      { 0.0 };
+    double              m_peakLatency  { 0.0 };
+    double              m_occupancy    { 0.0 };
+    std::deque<int64_t> m_recentSeeks;
+    std::deque<int64_t> m_recentStalls;
+};
+
+#endif // MYTHREADAHEADMODEL_H
@@ -0,0 +1,236 @@
+// Std
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+// Qt
+#include <QFileInfo>
+
+// MythTV
+#include "mythlogging.h"
+#include "io/mythstreamtap.h"
+
+#define LOC QString("StreamTap(%1): ").arg(m_memory.key())
+
+// Enough for about 25 seconds of a 20Mb/s stream
+const uint MythStreamTap::kRingSize = 64 * 1024 * 1024;
+
+static const uint32_t kTapMagic    = 0x5041544D; // "MTAP"
+
+enum MythStreamTapState : uint32_t
+{
+    kTapLive     = 0, ///< being written
+    kTapFinished = 1, ///< no longer written, what is there is still good
+    kTapBroken   = 2, ///< the file changed behind the tap, nothing is good
+};
+
+/*
+ * Lives at the start of the shared memory, followed by the ring. Byte N of
+ * the file is at N % kRingSize of the ring. m_writing is moved on before
+ * the writer copies into the ring and m_written after, so a reader can
+ * tell whether the bytes it copied were overwritten while it copied them.
+ */
+struct MythStreamTapHeader
+{
+    uint32_t              m_magic      { kTapMagic };
+    uint32_t              m_ringSize   { MythStreamTap::kRingSize };
+    int32_t               m_cpuBudget  { 0 };
+    std::atomic<uint32_t> m_state      { kTapLive };
+    std::atomic<int64_t>  m_start      { -1 }; ///< first byte seen
+    std::atomic<int64_t>  m_writing    { -1 }; ///< end of the copy in progress
+    std::atomic<int64_t>  m_written    { -1 }; ///< end of the last copy
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+              std::atomic<int64_t>::is_always_lock_free,
+              "The tap header is shared between processes");
+
+MythStreamTap::MythStreamTap(const QString &Filename)
+  : m_memory(GetKey(Filename))
+{
+}
+
+MythStreamTap::~MythStreamTap()
+{
+    if (m_writer && m_header)
+    {
+        uint32_t live = kTapLive;
+        m_header->m_state.compare_exchange_strong(live, kTapFinished);
+    }
+    m_memory.detach();
+}
+
+QString MythStreamTap::GetKey(const QString &Filename)
+{
+    QFileInfo info(Filename);
+    QString path = info.canonicalFilePath();
+    if (path.isEmpty())
+        path = info.absoluteFilePath();
+    return QString("MythStreamTap:%1").arg(path);
+}
+
+/** \brief Creates the tap for a file about to be written.
+ *  \param CPUBudget Percent of one CPU core that analysis of the stream may use
+ *  \return nullptr if there is no shared memory to be had
+ */
+MythStreamTap *MythStreamTap::Create(const QString &Filename, int CPUBudget)
+{
+    auto *tap = new MythStreamTap(Filename);
+    int size = static_cast<int>(sizeof(MythStreamTapHeader) + kRingSize);
+
+    bool ok = tap->m_memory.create(size);
+    if (!ok && tap->m_memory.error() == QSharedMemory::AlreadyExists &&
+        tap->m_memory.attach())
+    {
+        // Left behind by a recorder that died, it goes once nobody uses it
+        tap->m_memory.detach();
+        ok = tap->m_memory.create(size);
+    }
+
+    if (!ok)
+    {
+        LOG(VB_RECORD, LOG_WARNING, QString("StreamTap(%1): Unable to create: %2")
+            .arg(Filename).arg(tap->m_memory.errorString()));
+        delete tap;
+        return nullptr;
+    }
+
+    auto *data = static_cast<char*>(tap->m_memory.data());
+    tap->m_header = new (data) MythStreamTapHeader;
+    tap->m_header->m_cpuBudget = CPUBudget;
+    tap->m_ring = data + sizeof(MythStreamTapHeader);
+    tap->m_writer = true;
+
+    LOG(VB_RECORD, LOG_INFO, QString("StreamTap(%1): Created, %2 MB, CPU budget %3%")
+        .arg(Filename).arg(kRingSize >> 20).arg(CPUBudget));
+    return tap;
+}
+
+/** \brief Opens the tap of a file being written by another process.
+ *  \return nullptr if the file has no tap
+ */
+MythStreamTap *MythStreamTap::Open(const QString &Filename)
+{
+    auto *tap = new MythStreamTap(Filename);
+    if (!tap->m_memory.attach())
+    {
+        delete tap;
+        return nullptr;
+    }
+
+    auto *data = static_cast<char*>(tap->m_memory.data());
+    auto *header = reinterpret_cast<MythStreamTapHeader*>(data);
+    if (tap->m_memory.size() < static_cast<int>(sizeof(MythStreamTapHeader) + kRingSize) ||
+        header->m_magic != kTapMagic || header->m_ringSize != kRingSize)
+    {
+        LOG(VB_FILE, LOG_WARNING, QString("StreamTap(%1): Ignoring a tap of another version")
+            .arg(Filename));
+        delete tap;
+        return nullptr;
+    }
+
+    tap->m_header = header;
+    tap->m_ring = data + sizeof(MythStreamTapHeader);
+
+    LOG(VB_FILE, LOG_INFO, QString("StreamTap(%1): Opened, CPU budget %2%")
+        .arg(Filename).arg(header->m_cpuBudget));
+    return tap;
+}
+
+/** \brief Copies what was just written to the file at Position into the tap.
+ *
+ *   Never waits on readers. Writes must follow each other through the file,
+ *   anything else means the file no longer matches the tap.
+ */
+void MythStreamTap::Write(long long Position, const void *Buffer, uint Count)
+{
+    if (!m_writer || !Count || m_header->m_state.load(std::memory_order_relaxed) != kTapLive)
+        return;
+
+    int64_t end = m_header->m_written.load(std::memory_order_relaxed);
+    if (end < 0)
+    {
+        end = Position;
+        m_header->m_start.store(Position, std::memory_order_relaxed);
+    }
+
+    if (Position != end || Count > kRingSize)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC + QString("Write of %1 at %2 does not follow %3, "
+                                               "disabling the tap")
+            .arg(Count).arg(Position).arg(end));
+        m_header->m_state.store(kTapBroken, std::memory_order_release);
+        return;
+    }
+
+    m_header->m_writing.store(Position + Count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto offset = static_cast<uint>(Position % kRingSize);
+    uint first = std::min(Count, kRingSize - offset);
+    memcpy(m_ring + offset, Buffer, first);
+    memcpy(m_ring, static_cast<const char*>(Buffer) + first, Count - first);
+
+    m_header->m_written.store(Position + Count, std::memory_order_release);
+}
+
+/** \brief Copies up to Count bytes of the file at Position out of the tap.
+ *  \return The number of bytes copied, 0 if the tap does not hold the
+ *          byte at Position.
+ */
+int MythStreamTap::Read(long long Position, void *Buffer, uint Count) const
+{
+    if (!m_header || !Count)
+        return 0;
+
+    if (m_header->m_state.load(std::memory_order_acquire) == kTapBroken)
+        return 0;
+
+    int64_t written = m_header->m_written.load(std::memory_order_acquire);
+    int64_t start   = m_header->m_start.load(std::memory_order_relaxed);
+    if (Position < start || Position >= written || Position < written - kRingSize)
+        return 0;
+
+    auto count  = static_cast<uint>(std::min<int64_t>(Count, written - Position));
+    auto offset = static_cast<uint>(Position % kRingSize);
+    uint first  = std::min(count, kRingSize - offset);
+    memcpy(Buffer, m_ring + offset, first);
+    memcpy(static_cast<char*>(Buffer) + first, m_ring, count - first);
+
+    // Anything the writer started on since may have overwritten the copy
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (Position < m_header->m_writing.load(std::memory_order_relaxed) - kRingSize ||
+        m_header->m_state.load(std::memory_order_relaxed) == kTapBroken)
+    {
+        return 0;
+    }
+
+    return static_cast<int>(count);
+}
+
+/// End of what has been written, -1 before the first write
+long long MythStreamTap::GetWritten(void) const
+{
+    if (!m_header || m_header->m_state.load(std::memory_order_acquire) == kTapBroken)
+        return -1;
+    return m_header->m_written.load(std::memory_order_acquire);
+}
+
+int MythStreamTap::GetCPUBudget(void) const
+{
+    return m_header ? m_header->m_cpuBudget : 0;
+}
+
+bool MythStreamTap::IsFinished(void) const
+{
+    return !m_header || m_header->m_state.load(std::memory_order_acquire) != kTapLive;
+}
+
+/// Tells readers that the file no longer matches what the tap holds
+void MythStreamTap::Disable(void)
+{
+    if (m_writer && m_header)
+        m_header->m_state.store(kTapBroken, std::memory_order_release);
+}
@@ -0,0 +1,59 @@
+#ifndef MYTHSTREAMTAP_H
+#define MYTHSTREAMTAP_H
+
+// Qt
+#include <QSharedMemory>
+#include <QString>
+
+// MythTV
+#include "mythtvexp.h"
+
+struct MythStreamTapHeader;
+
+/** \class MythStreamTap
+ *  \brief Shares the most recent bytes written to a recording with readers
+ *         in other processes on the same host.
+ *
+ *   A recorder creates a tap for the file it writes, and copies every write
+ *   into a ring of shared memory keyed by the file's path. A reader of the
+ *   same file, such as the commercial flagger following the recording, opens
+ *   the tap and gets what was just written from memory instead of reading it
+ *   back from disk. Reads are lock free; a read of bytes that have already
+ *   been overwritten, or not yet written, returns nothing and the reader
+ *   falls back to the file.
+ *
+ *   The tap only follows a file written from start to end. A write that is
+ *   not at the end of the last one disables it for good.
+ *
+ *   The recorder also publishes the share of a CPU core that analysis of
+ *   the stream may use.
+ */
+class MTV_PUBLIC MythStreamTap
+{
+  public:
+    static MythStreamTap *Create(const QString &Filename, int CPUBudget);
+    static MythStreamTap *Open(const QString &Filename);
+   ~MythStreamTap();
+
+    void      Write        (long long Position, const void *Buffer, uint Count);
+    void      Disable      (void);
+    int       Read         (long long Position, void *Buffer, uint Count) const;
+    long long GetWritten   (void) const;
+    int       GetCPUBudget (void) const;
+    bool      IsFinished   (void) const;
+
+    static QString GetKey  (const QString &Filename);
+
+    /// Bytes of shared memory behind each tap
+    static const uint kRingSize;
+
+  private:
+    explicit MythStreamTap(const QString &Filename);
+
+    QSharedMemory        m_memory;
+    MythStreamTapHeader *m_header  { nullptr };
+    char                *m_ring    { nullptr };
+    bool                 m_writer  { false };
+};
+
+#endif // MYTHSTREAMTAP_H
@@ -153,6 +153,8 @@ HEADERS += io/mythfilebuffer.h
 HEADERS += io/mythstreamingbuffer.h
 HEADERS += io/mythinteractivebuffer.h
 HEADERS += io/mythopticalbuffer.h
+HEADERS += io/mythreadaheadmodel.h
+HEADERS += io/mythstreamtap.h
 HEADERS += metadataimagehelper.h
 HEADERS += mythavutil.h
 HEADERS += recordingfile.h
@@ -189,6 +191,8 @@ SOURCES += io/mythfilebuffer.cpp
 SOURCES += io/mythstreamingbuffer.cpp
 SOURCES += io/mythinteractivebuffer.cpp
 SOURCES += io/mythopticalbuffer.cpp
+SOURCES += io/mythreadaheadmodel.cpp
+SOURCES += io/mythstreamtap.cpp
 SOURCES += metadataimagehelper.cpp
 SOURCES += mythframe.cpp            mythavutil.cpp
 SOURCES += recordingfile.cpp
@@ -435,7 +439,7 @@ using_frontend {
     HEADERS += mythvideooutnull.h
     HEADERS += mythvideooutgpu.h
     HEADERS += mythvideogpu.h
-    HEADERS += videobuffers.h
+    HEADERS += videobuffers.h          mythframepool.h
     HEADERS += jitterometer.h
     HEADERS += videodisplayprofile.h    mythcodecid.h
     HEADERS += videoouttypes.h
@@ -448,7 +452,7 @@ using_frontend {
     SOURCES += mythvideooutnull.cpp
     SOURCES += mythvideooutgpu.cpp
     SOURCES += mythvideogpu.cpp
-    SOURCES += videobuffers.cpp
+    SOURCES += videobuffers.cpp        mythframepool.cpp
     SOURCES += jitterometer.cpp
     SOURCES += videodisplayprofile.cpp  mythcodecid.cpp
     SOURCES += mythvideobounds.cpp
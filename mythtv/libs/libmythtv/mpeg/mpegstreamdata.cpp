@@ -11,6 +11,7 @@ using namespace std;
 #include <QString>
 
 // MythTV headers
+#include "config.h"
 #include "mpegstreamdata.h"
 #include "mpegtables.h"
 #include "mpegtables.h"
@@ -18,6 +19,10 @@ using namespace std;
 #include "atscstreamdata.h"
 #include "atsctables.h"
 
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include <emmintrin.h>
+#endif
+
 //#define DEBUG_MPEG_RADIO // uncomment to strip video streams from TS stream
 #define LOC QString("MPEGStream[%1](0x%2): ").arg(m_cardId).arg((intptr_t)this, QT_POINTER_SIZE, 16, QChar('0'))
 
@@ -28,7 +33,7 @@ using namespace std;
 /** \fn MPEGStreamData::MPEGStreamData(int, bool)
  *  \brief Initializes MPEGStreamData.
  *
- *   This adds the PID of the PAT table to "m_pidsListening"
+ *   This adds the PID of the PAT table to the listening PIDs in "m_pids"
  *
  *  \param desiredProgram If you want rewritten PAT and PMTs, for
  *                        a desired program set this to a value > -1
@@ -136,10 +141,7 @@ void MPEGStreamData::Reset(int desiredProgram)
         DeletePartialPSIP(it.key());
     m_partialPsipPacketCache.clear();
 
-    m_pidsListening.clear();
-    m_pidsNotListening.clear();
-    m_pidsWriting.clear();
-    m_pidsAudio.clear();
+    m_pids.Clear();
 
     m_pidVideoSingleProgram = m_pidPmtSingleProgram = 0xffffffff;
 
@@ -589,11 +591,11 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
             AddListeningPID(cad.PID());
     }
 
-    m_pidsAudio.clear();
+    m_pids.Clear(PIDTable::kAudio);
     for (uint pid : audioPIDs)
         AddAudioPID(pid);
 
-    m_pidsWriting.clear();
+    m_pids.Clear(PIDTable::kWriting);
     m_pidVideoSingleProgram = !videoPIDs.empty() ? videoPIDs[0] : 0xffffffff;
     for (size_t i = 1; i < videoPIDs.size(); i++)
         AddWritingPID(videoPIDs[i]);
@@ -942,8 +944,22 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
 }
 #undef DONE_WITH_PSIP_PACKET
 
+/** \fn MPEGStreamData::ProcessData(const unsigned char*,int)
+ *  \brief Demultiplexes a buffer of TS packets.
+ *
+ *   Packets are handled in batches: ScanTSPackets() first validates the
+ *   sync bytes of a run of consecutive packets and extracts their PIDs,
+ *   then each packet is dispatched with the PID roles from ClassifyPID().
+ *   The roles are only looked up again when the PID changes, or after a
+ *   table packet, since table processing may add or remove PIDs.
+ *
+ *  \return Number of bytes at the end of the buffer that were not
+ *          processed because they do not form a complete packet.
+ */
 int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
 {
+    static constexpr uint kBatchSize { 64 };
+    std::array<uint16_t,kBatchSize> pids {};
     int pos = 0;
     bool resync = false;
 
@@ -970,21 +986,38 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
                 return TSPacket::kSize;
             pos = newpos;
         }
-
-        const auto *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
-        pos += TSPacket::kSize; // Advance to next TS packet
         resync = false;
-        if (!ProcessTSPacket(*pkt))
+
+        uint count = ScanTSPackets(&buffer[pos], len - pos,
+                                   pids.data(), kBatchSize);
+        uint lastpid = 0x2000; // not a valid PID
+        uint roles = kPIDRoleNone;
+        for (uint i = 0; i < count; i++)
         {
-            if (pos + int(TSPacket::kSize) > len)
-                continue;
-            if (buffer[pos] != SYNC_BYTE)
+            const auto *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
+            pos += TSPacket::kSize; // Advance to next TS packet
+
+            if (pids[i] != lastpid)
             {
-                // if ProcessTSPacket fails, and we don't appear to be
-                // in sync on the next packet, then resync. Otherwise
-                // just process the next packet normally.
-                pos -= TSPacket::kSize;
-                resync = true;
+                lastpid = pids[i];
+                roles = ClassifyPID(lastpid);
+            }
+            bool ok = DemuxTSPacket(*pkt, roles);
+            if (roles & kPIDRoleListening)
+                lastpid = 0x2000;
+
+            if (!ok && (i + 1 == count))
+            {
+                if (pos + int(TSPacket::kSize) > len)
+                    continue;
+                if (buffer[pos] != SYNC_BYTE)
+                {
+                    // if DemuxTSPacket fails, and we don't appear to be
+                    // in sync on the next packet, then resync. Otherwise
+                    // just process the next packet normally.
+                    pos -= TSPacket::kSize;
+                    resync = true;
+                }
             }
         }
     }
@@ -993,6 +1026,17 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
 }
 
 bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
+{
+    return DemuxTSPacket(tspacket, ClassifyPID(tspacket.PID()));
+}
+
+/** \fn MPEGStreamData::DemuxTSPacket(const TSPacket&,uint)
+ *  \brief Dispatches a single TS packet to the listeners.
+ *
+ *  \param pidRoles The PIDRole flags of the packet's PID,
+ *                  as returned by ClassifyPID().
+ */
+bool MPEGStreamData::DemuxTSPacket(const TSPacket& tspacket, uint pidRoles)
 {
     bool ok = !tspacket.TransportError();
 
@@ -1024,7 +1068,7 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
         }
     }
 
-    if (IsVideoPID(tspacket.PID()))
+    if (pidRoles & kPIDRoleVideo)
     {
         for (auto & listener : m_tsAvListeners)
             listener->ProcessVideoTSPacket(tspacket);
@@ -1032,7 +1076,7 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
         return true;
     }
 
-    if (IsAudioPID(tspacket.PID()))
+    if (pidRoles & kPIDRoleAudio)
     {
         for (auto & listener : m_tsAvListeners)
             listener->ProcessAudioTSPacket(tspacket);
@@ -1040,13 +1084,13 @@ bool MPEGStreamData::ProcessTSPacket(const TSPacket& tspacket)
         return true;
     }
 
-    if (IsWritingPID(tspacket.PID()))
+    if (pidRoles & kPIDRoleWriting)
     {
         for (auto & listener : m_tsWritingListeners)
             listener->ProcessTSPacket(tspacket);
     }
 
-    if (IsListeningPID(tspacket.PID()) && tspacket.HasPayload())
+    if ((pidRoles & kPIDRoleListening) && tspacket.HasPayload())
     {
         HandleTSTables(&tspacket);
     }
@@ -1059,45 +1103,107 @@ int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
 {
     // Search for two sync bytes 188 bytes apart,
     int pos = curr_pos;
-    int nextpos = pos + TSPacket::kSize;
-    if (nextpos >= len)
+    int last = len - TSPacket::kSize;
+    if (pos >= last)
         return -1; // not enough bytes; caller should try again
 
-    while (buffer[pos] != SYNC_BYTE || buffer[nextpos] != SYNC_BYTE)
+#if (HAVE_SSE2 && ARCH_X86_64)
+    // Skip over 16 bytes at a time that contain no sync byte candidate.
+    // Every load is in bounds since pos < last leaves 188 bytes behind pos.
+    const __m128i sync = _mm_set1_epi8(SYNC_BYTE);
+    while (pos < last)
+    {
+        auto mask = static_cast<uint>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&buffer[pos])),
+            sync)));
+        if (!mask)
+        {
+            pos += 16;
+            continue;
+        }
+        pos += __builtin_ctz(mask);
+        if (pos >= last)
+            break;
+        if (buffer[pos + TSPacket::kSize] == SYNC_BYTE)
+            return pos;
+        pos++;
+    }
+#else
+    while (pos < last)
     {
+        if (buffer[pos] == SYNC_BYTE &&
+            buffer[pos + TSPacket::kSize] == SYNC_BYTE)
+            return pos;
         pos++;
-        nextpos++;
-        if (nextpos == len)
-            return -2; // not found
     }
+#endif
 
-    return pos;
+    return -2; // not found
+}
+
+/** \fn MPEGStreamData::ScanTSPackets(const unsigned char*,int,uint16_t*,uint)
+ *  \brief Batch stage of the demux, extracts the PIDs of a run of packets.
+ *
+ *   Scans packets from the start of the buffer while their sync bytes
+ *   line up, storing the PID of each one in pids.
+ *
+ *  \return Number of complete, synced packets found (at most maxcount).
+ */
+uint MPEGStreamData::ScanTSPackets(const unsigned char *buffer, int len,
+                                   uint16_t *pids, uint maxcount)
+{
+    uint count = 0;
+    for (int pos = 0; count < maxcount && pos + int(TSPacket::kSize) <= len;
+         pos += TSPacket::kSize)
+    {
+        const unsigned char *pkt = &buffer[pos];
+        if (pkt[0] != SYNC_BYTE)
+            break;
+        pids[count++] = ((pkt[1] << 8) | pkt[2]) & 0x1fff;
+    }
+    return count;
 }
 
 bool MPEGStreamData::IsListeningPID(uint pid) const
 {
-    if (m_listeningDisabled || IsNotListeningPID(pid))
+    if (m_listeningDisabled)
         return false;
-    pid_map_t::const_iterator it = m_pidsListening.find(pid);
-    return it != m_pidsListening.end();
+    uint sets = m_pids.Sets(pid);
+    return (sets & (PIDTable::kListening | PIDTable::kNotListening)) ==
+        PIDTable::kListening;
 }
 
 bool MPEGStreamData::IsNotListeningPID(uint pid) const
 {
-    pid_map_t::const_iterator it = m_pidsNotListening.find(pid);
-    return it != m_pidsNotListening.end();
+    return m_pids.Contains(pid, PIDTable::kNotListening);
 }
 
 bool MPEGStreamData::IsWritingPID(uint pid) const
 {
-    pid_map_t::const_iterator it = m_pidsWriting.find(pid);
-    return it != m_pidsWriting.end();
+    return m_pids.Contains(pid, PIDTable::kWriting);
 }
 
 bool MPEGStreamData::IsAudioPID(uint pid) const
 {
-    pid_map_t::const_iterator it = m_pidsAudio.find(pid);
-    return it != m_pidsAudio.end();
+    return m_pids.Contains(pid, PIDTable::kAudio);
+}
+
+/** \fn MPEGStreamData::ClassifyPID(uint) const
+ *  \brief Returns the PIDRole flags for a PID from a single table load.
+ */
+uint MPEGStreamData::ClassifyPID(uint pid) const
+{
+    uint sets  = m_pids.Sets(pid);
+    uint roles = IsVideoPID(pid) ? kPIDRoleVideo : kPIDRoleNone;
+    if (sets & PIDTable::kAudio)
+        roles |= kPIDRoleAudio;
+    if (sets & PIDTable::kWriting)
+        roles |= kPIDRoleWriting;
+    if (!m_listeningDisabled &&
+        (sets & (PIDTable::kListening | PIDTable::kNotListening)) ==
+        PIDTable::kListening)
+        roles |= kPIDRoleListening;
+    return roles;
 }
 
 uint MPEGStreamData::GetPIDs(pid_map_t &pids) const
@@ -1107,14 +1213,20 @@ uint MPEGStreamData::GetPIDs(pid_map_t &pids) const
     if (m_pidVideoSingleProgram < 0x1fff)
         pids[m_pidVideoSingleProgram] = kPIDPriorityHigh;
 
-    for (auto it = m_pidsListening.cbegin(); it != m_pidsListening.cend(); ++it)
-        pids[it.key()] = max(pids[it.key()], *it);
-
-    for (auto it = m_pidsAudio.cbegin(); it != m_pidsAudio.cend(); ++it)
-        pids[it.key()] = max(pids[it.key()], *it);
-
-    for (auto it = m_pidsWriting.cbegin(); it != m_pidsWriting.cend(); ++it)
-        pids[it.key()] = max(pids[it.key()], *it);
+    for (uint pid : m_pids.Active())
+    {
+        uint sets = m_pids.Sets(pid);
+        if (!(sets & (PIDTable::kListening | PIDTable::kAudio |
+                      PIDTable::kWriting)))
+            continue;
+        PIDPriority &priority = pids[pid];
+        for (auto set : { PIDTable::kListening, PIDTable::kAudio,
+                          PIDTable::kWriting })
+        {
+            if (sets & set)
+                priority = max(priority, m_pids.Priority(pid, set));
+        }
+    }
 
     return pids.size() - sz;
 }
@@ -1124,23 +1236,58 @@ PIDPriority MPEGStreamData::GetPIDPriority(uint pid) const
     if (m_pidVideoSingleProgram == pid)
         return kPIDPriorityHigh;
 
-    pid_map_t::const_iterator it;
-    it = m_pidsListening.find(pid);
-    if (it != m_pidsListening.end())
-        return *it;
-    it = m_pidsNotListening.find(pid);
-    if (it != m_pidsNotListening.end())
-        return *it;
-    it = m_pidsWriting.find(pid);
-    if (it != m_pidsWriting.end())
-        return *it;
-    it = m_pidsAudio.find(pid);
-    if (it != m_pidsAudio.end())
-        return *it;
+    uint sets = m_pids.Sets(pid);
+    for (auto set : { PIDTable::kListening, PIDTable::kNotListening,
+                      PIDTable::kWriting, PIDTable::kAudio })
+    {
+        if (sets & set)
+            return m_pids.Priority(pid, set);
+    }
 
     return kPIDPriorityNone;
 }
 
+/** \fn PIDTable::ToMap(PIDSet) const
+ *  \brief Returns the members of one PID set with their priorities.
+ */
+pid_map_t PIDTable::ToMap(PIDSet set) const
+{
+    pid_map_t pids;
+    for (uint pid : m_active)
+    {
+        if (m_entries[pid] & set)
+            pids[pid] = Priority(pid, set);
+    }
+    return pids;
+}
+
+/** \fn PIDTable::Update(uint, uint16_t)
+ *  \brief Stores a new entry for a PID, adding it to or removing it from
+ *         the list of active PIDs when it joins its first set or leaves
+ *         its last one.
+ */
+void PIDTable::Update(uint pid, uint16_t entry)
+{
+    bool was = (m_entries[pid] & 0xf) != 0;
+    bool is  = (entry & 0xf) != 0;
+    m_entries[pid] = entry;
+
+    if (is && !was)
+    {
+        m_active.push_back(pid);
+        m_index[pid] = m_active.size();
+    }
+    else if (was && !is)
+    {
+        uint pos = m_index[pid] - 1;
+        uint16_t last = m_active.back();
+        m_active[pos] = last;
+        m_index[last] = pos + 1;
+        m_active.pop_back();
+        m_index[pid] = 0;
+    }
+}
+
 void MPEGStreamData::SavePartialPSIP(uint pid, PSIPTable* packet)
 {
     pid_psip_map_t::iterator it = m_partialPsipPacketCache.find(pid);
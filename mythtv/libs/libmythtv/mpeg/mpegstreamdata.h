@@ -4,6 +4,7 @@
 #define MPEGSTREAMDATA_H_
 
 // C++
+#include <array>
 #include <cstdint>  // uint64_t
 #include <vector>
 using namespace std;
@@ -82,6 +83,107 @@ enum PIDPriority
 };
 using pid_map_t = QMap<uint, PIDPriority>;
 
+/** \class PIDTable
+ *  \brief Dense registry of PID set membership and priorities.
+ *
+ *   Holds one 16 bit entry for each of the 8192 possible PIDs. The low
+ *   four bits record membership of the listening, not listening, writing
+ *   and audio sets, followed by a two bit PIDPriority for each set. This
+ *   makes the per packet PID lookups a single load instead of a QMap
+ *   search.
+ *
+ *   One more entry holds kAllPIDs (0x2000), which recorders add to ask
+ *   the stream handler for the whole transport stream. It is a member
+ *   of its sets like any PID, so GetPIDs() passes it on.
+ *
+ *   The PIDs in any set are also kept in a dense list, updated as PIDs
+ *   are added and removed, so that GetPIDs() and ToMap() only visit the
+ *   few PIDs in use rather than the whole table.
+ */
+class MTV_PUBLIC PIDTable
+{
+  public:
+    enum PIDSet : uint16_t
+    {
+        kListening    = 0x1,
+        kNotListening = 0x2,
+        kWriting      = 0x4,
+        kAudio        = 0x8,
+    };
+
+    void Insert(uint pid, PIDSet set, PIDPriority priority)
+    {
+        if (pid >= kTableSize)
+            return;
+        uint16_t entry = m_entries[pid] & ~Mask(set);
+        Update(pid, entry | set | (priority << Shift(set)));
+    }
+    void Remove(uint pid, PIDSet set)
+    {
+        if (pid < kTableSize)
+            Update(pid, m_entries[pid] & ~Mask(set));
+    }
+    void Clear(PIDSet set)
+    {
+        // Backwards, as removing a PID moves the last one into its place
+        for (size_t i = m_active.size(); i-- > 0; )
+            Update(m_active[i], m_entries[m_active[i]] & ~Mask(set));
+    }
+    void Clear(void)
+    {
+        m_entries.fill(0);
+        m_index.fill(0);
+        m_active.clear();
+    }
+
+    /// The PIDs that are a member of at least one set, in no order
+    const vector<uint16_t>& Active(void) const { return m_active; }
+
+    /// Returns the PIDSet flags the PID is a member of
+    uint Sets(uint pid) const
+        { return (pid < kTableSize) ? (m_entries[pid] & 0xf) : 0; }
+    bool Contains(uint pid, PIDSet set) const
+        { return (Sets(pid) & set) != 0; }
+    PIDPriority Priority(uint pid, PIDSet set) const
+    {
+        if (!Contains(pid, set))
+            return kPIDPriorityNone;
+        return PIDPriority((m_entries[pid] >> Shift(set)) & 0x3);
+    }
+    pid_map_t ToMap(PIDSet set) const;
+
+    /// Pseudo PID standing for every PID in the transport stream
+    static constexpr uint kAllPIDs   { 0x2000 };
+    static constexpr uint kTableSize { kAllPIDs + 1 };
+
+  private:
+    static constexpr uint Shift(PIDSet set)
+    {
+        return (set == kListening)    ? 4 :
+               (set == kNotListening) ? 6 :
+               (set == kWriting)      ? 8 : 10;
+    }
+    static constexpr uint16_t Mask(PIDSet set)
+        { return set | (0x3 << Shift(set)); }
+    void Update(uint pid, uint16_t entry);
+
+    std::array<uint16_t,kTableSize> m_entries {};
+    /// One plus the position of each PID in m_active, 0 if not there
+    std::array<uint16_t,kTableSize> m_index   {};
+    vector<uint16_t>                m_active;
+};
+
+/// Roles a PID can play in the demux, as returned by
+/// MPEGStreamData::ClassifyPID()
+enum PIDRole
+{
+    kPIDRoleNone      = 0x00,
+    kPIDRoleVideo     = 0x01,
+    kPIDRoleAudio     = 0x02,
+    kPIDRoleWriting   = 0x04,
+    kPIDRoleListening = 0x08,
+};
+
 class MTV_PUBLIC MPEGStreamData : public EITSource
 {
   public:
@@ -119,21 +221,24 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     // Listening
     virtual void AddListeningPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { m_pidsListening[pid] = priority; }
+        { m_pids.Insert(pid, PIDTable::kListening, priority); }
     virtual void AddNotListeningPID(uint pid)
-        { m_pidsNotListening[pid] = kPIDPriorityNormal; }
+        { m_pids.Insert(pid, PIDTable::kNotListening, kPIDPriorityNormal); }
     virtual void AddWritingPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { m_pidsWriting[pid] = priority; }
+        { m_pids.Insert(pid, PIDTable::kWriting, priority); }
     virtual void AddAudioPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { m_pidsAudio[pid] = priority; }
+        { m_pids.Insert(pid, PIDTable::kAudio, priority); }
 
-    virtual void RemoveListeningPID(uint pid) { m_pidsListening.remove(pid);  }
+    virtual void RemoveListeningPID(uint pid)
+        { m_pids.Remove(pid, PIDTable::kListening); }
     virtual void RemoveNotListeningPID(uint pid)
-        { m_pidsNotListening.remove(pid); }
-    virtual void RemoveWritingPID(uint pid) { m_pidsWriting.remove(pid);    }
-    virtual void RemoveAudioPID(uint pid)   { m_pidsAudio.remove(pid);      }
+        { m_pids.Remove(pid, PIDTable::kNotListening); }
+    virtual void RemoveWritingPID(uint pid)
+        { m_pids.Remove(pid, PIDTable::kWriting); }
+    virtual void RemoveAudioPID(uint pid)
+        { m_pids.Remove(pid, PIDTable::kAudio); }
 
     virtual bool IsListeningPID(uint pid) const;
     virtual bool IsNotListeningPID(uint pid) const;
@@ -141,13 +246,14 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     bool IsVideoPID(uint pid) const
         { return m_pidVideoSingleProgram == pid; }
     virtual bool IsAudioPID(uint pid) const;
+    uint ClassifyPID(uint pid) const;
 
-    const pid_map_t& ListeningPIDs(void) const
-        { return m_pidsListening; }
-    const pid_map_t& AudioPIDs(void) const
-        { return m_pidsAudio; }
-    const pid_map_t& WritingPIDs(void) const
-        { return m_pidsWriting; }
+    pid_map_t ListeningPIDs(void) const
+        { return m_pids.ToMap(PIDTable::kListening); }
+    pid_map_t AudioPIDs(void) const
+        { return m_pids.ToMap(PIDTable::kAudio); }
+    pid_map_t WritingPIDs(void) const
+        { return m_pids.ToMap(PIDTable::kWriting); }
 
     uint GetPIDs(pid_map_t &pids) const;
 
@@ -288,8 +394,11 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void ProcessCAT(const ConditionalAccessTable *cat);
     void ProcessPMT(const ProgramMapTable *pmt);
     void ProcessEncryptedPacket(const TSPacket &tspacket);
+    virtual bool DemuxTSPacket(const TSPacket& tspacket, uint pidRoles);
 
     static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
+    static uint ScanTSPackets(const unsigned char *buffer, int len,
+                              uint16_t *pids, uint maxcount);
 
     void UpdateTimeOffset(uint64_t si_utc_time);
 
@@ -316,10 +425,7 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     float                     m_eitRate                     {0.0F};
 
     // Listening
-    pid_map_t                 m_pidsListening;
-    pid_map_t                 m_pidsNotListening;
-    pid_map_t                 m_pidsWriting;
-    pid_map_t                 m_pidsAudio;
+    PIDTable                  m_pids;
     bool                      m_listeningDisabled           {false};
 
     // Encryption monitoring
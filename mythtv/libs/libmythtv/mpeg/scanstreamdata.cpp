@@ -11,7 +11,7 @@ ScanStreamData::ScanStreamData(bool no_default_pid) :
     m_noDefaultPid(no_default_pid)
 {
     if (m_noDefaultPid)
-        m_pidsListening.clear();
+        m_pids.Clear(PIDTable::kListening);
 }
 
 ScanStreamData::~ScanStreamData() { ; }
@@ -63,7 +63,7 @@ void ScanStreamData::Reset(void)
 
     if (m_noDefaultPid)
     {
-        m_pidsListening.clear();
+        m_pids.Clear(PIDTable::kListening);
         return;
     }
 
@@ -76,7 +76,7 @@ void ScanStreamData::Reset(uint desired_netid, uint desired_tsid, int desired_se
 
     if (m_noDefaultPid)
     {
-        m_pidsListening.clear();
+        m_pids.Clear(PIDTable::kListening);
         return;
     }
 
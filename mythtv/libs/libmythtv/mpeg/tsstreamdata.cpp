@@ -15,10 +15,10 @@ TSStreamData::TSStreamData(int cardnum) : MPEGStreamData(-1, cardnum, false)
 {
 }
 
-/** \fn TSStreamData::ProcessTSPacket(const TSPacket& tspacket)
+/** \fn TSStreamData::DemuxTSPacket(const TSPacket&,uint)
  *  \brief Write out all packets without any filtering.
  */
-bool TSStreamData::ProcessTSPacket(const TSPacket& tspacket)
+bool TSStreamData::DemuxTSPacket(const TSPacket& tspacket, uint /*pidRoles*/)
 {
     bool ok = !tspacket.TransportError();
 
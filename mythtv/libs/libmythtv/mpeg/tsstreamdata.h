@@ -14,12 +14,13 @@ class MTV_PUBLIC TSStreamData : public MPEGStreamData
     explicit TSStreamData(int cardnum);
     ~TSStreamData() override { ; }
 
-    bool ProcessTSPacket(const TSPacket& tspacket) override; // MPEGStreamData
-
     using MPEGStreamData::Reset;
     void Reset(int /* desiredProgram */) override { ; } // MPEGStreamData
     bool HandleTables(uint /* pid */, const PSIPTable & /* psip */) override // MPEGStreamData
         { return true; }
+
+  protected:
+    bool DemuxTSPacket(const TSPacket& tspacket, uint pidRoles) override; // MPEGStreamData
 };
 
 #endif
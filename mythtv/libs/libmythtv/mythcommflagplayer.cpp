@@ -5,6 +5,7 @@
 
 #include "mthreadpool.h"
 #include "mythlogging.h"
+#include "io/mythmediabuffer.h"
 
 #include <unistd.h> // for usleep()
 #include <iostream> // for cout()
@@ -228,3 +229,33 @@ bool MythCommFlagPlayer::RebuildSeekTable(
 
     return true;
 }
+
+/** \fn MythCommFlagPlayer::CloneContext(void)
+ *  \brief Creates another player, with the same flags, on the same
+ *         recording so that separate parts of it can be decoded at once.
+ *
+ *   The player must be created in, and only used from, the thread that
+ *   decodes with it. Deleting the context deletes the player and its
+ *   buffer. Returns nullptr if the recording cannot be opened again.
+ */
+PlayerContext *MythCommFlagPlayer::CloneContext(void)
+{
+    if (!m_playerCtx || !m_playerCtx->m_buffer)
+        return nullptr;
+
+    MythMediaBuffer *buffer =
+        MythMediaBuffer::Create(m_playerCtx->m_buffer->GetFilename(), false);
+    if (!buffer)
+        return nullptr;
+
+    auto *ctx = new PlayerContext(m_playerCtx->m_recUsage);
+    m_playerCtx->LockPlayingInfo(__FILE__, __LINE__);
+    ctx->SetPlayingInfo(m_playerCtx->m_playingInfo);
+    m_playerCtx->UnlockPlayingInfo(__FILE__, __LINE__);
+    ctx->SetRingBuffer(buffer);
+
+    auto *player = new MythCommFlagPlayer(m_playerFlags);
+    ctx->SetPlayer(player);
+    player->SetPlayerInfo(nullptr, nullptr, ctx);
+    return ctx;
+}
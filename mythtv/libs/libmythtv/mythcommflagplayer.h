@@ -10,6 +10,7 @@ class MTV_PUBLIC MythCommFlagPlayer : public MythPlayer
     MythCommFlagPlayer(MythCommFlagPlayer& rhs);
     bool RebuildSeekTable(bool showPercentage = true, StatusCallback cb = nullptr,
                           void* cbData = nullptr);
+    PlayerContext *CloneContext(void);
 };
 
 #endif // MYTHCOMMFLAGPLAYER_H
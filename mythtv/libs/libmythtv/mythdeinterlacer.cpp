@@ -1,6 +1,17 @@
+// Qt
+#include <QMutex>
+#include <QWaitCondition>
+
+// Std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
 // MythTV
 #include "config.h"
 #include "mythlogging.h"
+#include "mthread.h"
 #include "mythavutil.h"
 #include "mythdeinterlacer.h"
 
@@ -25,8 +36,146 @@ bool MythDeinterlacer::s_haveSIMD = have_neon(av_get_cpu_flags());
 bool MythDeinterlacer::s_haveSIMD = false;
 #endif
 
+// The AVX2 code is built for the AVX2 target function by function, so it is
+// available without raising the instruction set of the rest of the build.
+#if (HAVE_AVX2 && ARCH_X86_64)
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+bool MythDeinterlacer::s_haveAVX2 = av_get_cpu_flags() & AV_CPU_FLAG_AVX2;
+#else
+bool MythDeinterlacer::s_haveAVX2 = false;
+#endif
+bool MythDeinterlacer::s_useSIMD = MythDeinterlacer::s_haveSIMD;
+bool MythDeinterlacer::s_useAVX2 = MythDeinterlacer::s_haveAVX2;
+
 #define LOC QString("MythDeint: ")
 
+/*! \class MythDeinterlacerPool
+ * \brief Threads that deinterlace slices of a frame alongside the thread
+ * calling MythDeinterlacer::Filter.
+ *
+ * Run() hands the slices of a job out to the pool threads and the calling
+ * thread, and returns once every slice is done. Each slice only writes the
+ * rows it was given, so the field cache set up by SetUpCache() before Run()
+ * is read by every slice without locking, and anything written by one Run()
+ * is seen by the slices of the next.
+ */
+class MythDeinterlacerPool
+{
+  public:
+    explicit MythDeinterlacerPool(uint Threads);
+   ~MythDeinterlacerPool();
+
+    uint Threads(void) const { return static_cast<uint>(m_threads.size()) + 1; }
+    void Run(uint Slices, const std::function<void(uint)> &Job);
+
+  private:
+    Q_DISABLE_COPY(MythDeinterlacerPool)
+
+    class Worker : public MThread
+    {
+      public:
+        explicit Worker(MythDeinterlacerPool &Pool)
+          : MThread("DeintSlice"), m_pool(Pool) {}
+        void run(void) override
+        {
+            RunProlog();
+            m_pool.Work();
+            RunEpilog();
+        }
+
+      private:
+        MythDeinterlacerPool &m_pool;
+    };
+
+    void Work(void);
+    void RunJob(void);
+
+    QMutex           m_lock;
+    QWaitCondition   m_wake;
+    QWaitCondition   m_done;
+    const std::function<void(uint)> *m_job { nullptr };
+    uint             m_slices    { 0 };
+    std::atomic<uint> m_next     { 0 };
+    uint             m_busy      { 0 };
+    uint64_t         m_jobNumber { 0 };
+    bool             m_quit      { false };
+    std::vector<Worker*> m_threads;
+};
+
+/// \brief Starts Threads - 1 threads, as the calling thread takes slices too.
+MythDeinterlacerPool::MythDeinterlacerPool(uint Threads)
+{
+    for (uint i = 1; i < Threads; ++i)
+    {
+        auto *worker = new Worker(*this);
+        m_threads.push_back(worker);
+        worker->start();
+    }
+}
+
+MythDeinterlacerPool::~MythDeinterlacerPool()
+{
+    m_lock.lock();
+    m_quit = true;
+    m_wake.wakeAll();
+    m_lock.unlock();
+
+    for (auto *worker : m_threads)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+void MythDeinterlacerPool::Run(uint Slices, const std::function<void(uint)> &Job)
+{
+    QMutexLocker locker(&m_lock);
+    m_job    = &Job;
+    m_slices = Slices;
+    m_next   = 0;
+    m_busy   = static_cast<uint>(m_threads.size());
+    m_jobNumber++;
+    m_wake.wakeAll();
+    locker.unlock();
+
+    RunJob();
+
+    locker.relock();
+    while (m_busy)
+        m_done.wait(&m_lock);
+    m_job = nullptr;
+}
+
+void MythDeinterlacerPool::RunJob(void)
+{
+    for (uint slice = m_next++; slice < m_slices; slice = m_next++)
+        (*m_job)(slice);
+}
+
+void MythDeinterlacerPool::Work(void)
+{
+    // Starts from 0 rather than the current job, as a thread that starts
+    // late must still take part in the first job
+    uint64_t done = 0;
+    QMutexLocker locker(&m_lock);
+    while (true)
+    {
+        while (!m_quit && (done == m_jobNumber))
+            m_wake.wait(&m_lock);
+        if (m_quit)
+            return;
+        done = m_jobNumber;
+
+        locker.unlock();
+        RunJob();
+        locker.relock();
+
+        if (--m_busy == 0)
+            m_done.wakeAll();
+    }
+}
+
 /*! \class MythDeinterlacer
  * \brief Handles software based deinterlacing of video frames.
  *
@@ -36,9 +185,14 @@ bool MythDeinterlacer::s_haveSIMD = false;
  *
  * The following deinterlacers are used:
  * Basic - onefield/bob using libswcale
- * Medium - linearblend with custom code (SSE2 and Neon assisted where available)
+ * Medium - linearblend with custom code (AVX2, SSE2 and Neon assisted where available)
  * High - libavfilter's yadif (with multithreading)
  *
+ * Linearblend, and the copy of the frame into the field cache, are split into
+ * horizontal slices that are run on a MythDeinterlacerPool when more than one
+ * CPU is allowed. The pool is kept when the deinterlacer is cleaned up, as
+ * some material switches between interlaced and progressive frames.
+ *
  * \note libavfilter frame doubling filters expect frames to be presented
  * in the correct order and will break if they do not receive a frame followed
  * by the retrieval of 2 'fields'.
@@ -47,6 +201,39 @@ bool MythDeinterlacer::s_haveSIMD = false;
 MythDeinterlacer::~MythDeinterlacer()
 {
     Cleanup();
+    delete m_pool;
+}
+
+/*! \brief Sets the number of threads used by the CPU deinterlacers.
+ *
+ * Overrides the number of CPUs set in the display profile, which is used
+ * when Threads is 0. Takes effect when the deinterlacer is next created.
+*/
+void MythDeinterlacer::SetMaxThreads(uint Threads)
+{
+    m_maxThreads = Threads;
+}
+
+uint MythDeinterlacer::GetThreads(VideoDisplayProfile *Profile) const
+{
+    uint threads = m_maxThreads;
+    if (!threads && Profile)
+        threads = Profile->GetMaxCPUs();
+    if (threads < 1 || threads > 8)
+        threads = 1;
+    return threads;
+}
+
+/// \brief Runs Job for each of Slices on the thread pool, if there is one.
+void MythDeinterlacer::RunSlices(uint Slices, const std::function<void(uint)> &Job)
+{
+    if (m_pool)
+    {
+        m_pool->Run(Slices, Job);
+        return;
+    }
+    for (uint slice = 0; slice < Slices; ++slice)
+        Job(slice);
 }
 
 /*! \brief Deinterlace Frame if needed
@@ -308,9 +495,19 @@ bool MythDeinterlacer::Initialise(VideoFrame *Frame, MythDeintType Deinterlacer,
     m_inputFmt  = FrameTypeToPixelFormat(Frame->codec);
     QString name = DeinterlacerName(Deinterlacer | DEINT_CPU, DoubleRate);
 
+    uint threads = GetThreads(Profile);
+
     // simple onefield/bob?
     if (Deinterlacer == DEINT_BASIC || Deinterlacer == DEINT_MEDIUM)
     {
+        if (m_pool && (m_pool->Threads() != threads))
+        {
+            delete m_pool;
+            m_pool = nullptr;
+        }
+        if (!m_pool && (threads > 1))
+            m_pool = new MythDeinterlacerPool(threads);
+
         m_deintType  = Deinterlacer;
         m_doubleRate = DoubleRate;
         m_topFirst   = TopFieldFirst;
@@ -322,7 +519,8 @@ bool MythDeinterlacer::Initialise(VideoFrame *Frame, MythDeintType Deinterlacer,
             if (m_swsContext == nullptr)
                 return false;
         }
-        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1'").arg(name));
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1' (%2 threads)")
+            .arg(name).arg(threads));
         return true;
     }
 
@@ -337,14 +535,6 @@ bool MythDeinterlacer::Initialise(VideoFrame *Frame, MythDeintType Deinterlacer,
     if (!m_graph)
         return false;
 
-    uint threads = 1;
-    if (Profile)
-    {
-        threads = Profile->GetMaxCPUs();
-        if (threads < 1 || threads > 8)
-            threads = 1;
-    }
-
     AVFilterInOut* inputs = nullptr;
     AVFilterInOut* outputs = nullptr;
 
@@ -416,6 +606,22 @@ bool MythDeinterlacer::SetUpCache(VideoFrame *Frame)
     return m_bobFrame->buf != nullptr;
 }
 
+/// \brief Copies Frame into the field cache, in slices.
+void MythDeinterlacer::CopyToCache(VideoFrame *Frame)
+{
+    const size_t size = static_cast<size_t>(m_bobFrame->size);
+    const uint slices = m_pool ? m_pool->Threads() : 1;
+    // Keep slices on 64 byte boundaries
+    const size_t slicesize = (((size + slices - 1) / slices) + 63) & ~static_cast<size_t>(63);
+    auto copy = [&](uint Slice)
+    {
+        size_t start = Slice * slicesize;
+        if (start < size)
+            memcpy(m_bobFrame->buf + start, Frame->buf + start, std::min(slicesize, size - start));
+    };
+    RunSlices(slices, copy);
+}
+
 void MythDeinterlacer::OneField(VideoFrame *Frame, FrameScanType Scan)
 {
     if (!m_swsContext)
@@ -428,7 +634,7 @@ void MythDeinterlacer::OneField(VideoFrame *Frame, FrameScanType Scan)
 
     // copy/cache on first pass
     if (kScan_Interlaced == Scan)
-        memcpy(m_bobFrame->buf, Frame->buf, static_cast<size_t>(m_bobFrame->size));
+        CopyToCache(Frame);
 
     // Convert VideoFrame to AVFrame - no copy
     AVFrame dstframe;
@@ -470,9 +676,11 @@ void MythDeinterlacer::OneField(VideoFrame *Frame, FrameScanType Scan)
     Frame->already_deinterlaced = true;
 }
 
+// Rounds up, as _mm_avg_epu8 and vrhaddq_u8 do, so that every blend
+// function gives the same picture
 inline static uint32_t avg(uint32_t A, uint32_t B)
 {
-    return (((A ^ B) & 0xFEFEFEFEUL) >> 1) + (A & B);
+    return (A | B) - (((A ^ B) & 0xFEFEFEFEUL) >> 1);
 }
 
 // Optimised version with 4x4 alignment
@@ -632,6 +840,146 @@ static inline void BlendSIMD8x4(unsigned char *Src, int Width, int FirstRow, int
 }
 #endif
 
+#if (HAVE_AVX2 && ARCH_X86_64)
+// AVX2 optimised version with 32x4 alignment
+AVX2_TARGET static void BlendAVX2_32x4(unsigned char *Src, int Width, int FirstRow, int LastRow, int Pitch,
+                                       unsigned char *Dst, int DstPitch, bool Second)
+{
+    int srcpitch = Pitch << 1;
+    int dstpitch = DstPitch << 1;
+    int maxrows  = LastRow - 3;
+
+    unsigned char *above   = Src + ((FirstRow - 1) * Pitch);
+    unsigned char *dest1   = Dst + (FirstRow * DstPitch);
+    unsigned char *middle  = above + srcpitch;
+    unsigned char *dest2   = dest1 + dstpitch;
+    unsigned char *below   = middle + srcpitch;
+    unsigned char *dstcpy1 = Dst + ((FirstRow - 1) * DstPitch);
+    unsigned char *dstcpy2 = dstcpy1 + dstpitch;
+
+    srcpitch <<= 1;
+    dstpitch <<= 1;
+
+    // 4 rows per pass
+    for (int row = FirstRow; row < maxrows; row += 4)
+    {
+        if (Second)
+        {
+            // On second pass, copy over the original, current field
+            memcpy(dstcpy1, above,  static_cast<size_t>(DstPitch));
+            memcpy(dstcpy2, middle, static_cast<size_t>(DstPitch));
+            dstcpy1 += dstpitch;
+            dstcpy2 += dstpitch;
+        }
+        for (int col = 0; col < Width; col += 32)
+        {
+            __m256i mid = _mm256_loadu_si256(reinterpret_cast<__m256i*>(&middle[col]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest1[col]),
+                _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<__m256i*>(&above[col])), mid));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest2[col]),
+                _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<__m256i*>(&below[col])), mid));
+        }
+        above  += srcpitch;
+        middle += srcpitch;
+        below  += srcpitch;
+        dest1  += dstpitch;
+        dest2  += dstpitch;
+    }
+}
+
+// AVX2 optimised version with 32x4 alignment for 10/12/16bit video
+AVX2_TARGET static void BlendAVX2_16x4(unsigned char *Src, int Width, int FirstRow, int LastRow, int Pitch,
+                                       unsigned char *Dst, int DstPitch, bool Second)
+{
+    int srcpitch = Pitch << 1;
+    int dstpitch = DstPitch << 1;
+    int maxrows  = LastRow - 3;
+
+    unsigned char *above   = Src + ((FirstRow - 1) * Pitch);
+    unsigned char *dest1   = Dst + (FirstRow * DstPitch);
+    unsigned char *middle  = above + srcpitch;
+    unsigned char *dest2   = dest1 + dstpitch;
+    unsigned char *below   = middle + srcpitch;
+    unsigned char *dstcpy1 = Dst + ((FirstRow - 1) * DstPitch);
+    unsigned char *dstcpy2 = dstcpy1 + dstpitch;
+
+    srcpitch <<= 1;
+    dstpitch <<= 1;
+
+    // 4 rows per pass
+    for (int row = FirstRow; row < maxrows; row += 4)
+    {
+        if (Second)
+        {
+            // On second pass, copy over the original, current field
+            memcpy(dstcpy1, above,  static_cast<size_t>(DstPitch));
+            memcpy(dstcpy2, middle, static_cast<size_t>(DstPitch));
+            dstcpy1 += dstpitch;
+            dstcpy2 += dstpitch;
+        }
+        for (int col = 0; col < Width; col += 32)
+        {
+            __m256i mid = _mm256_loadu_si256(reinterpret_cast<__m256i*>(&middle[col]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest1[col]),
+                _mm256_avg_epu16(_mm256_loadu_si256(reinterpret_cast<__m256i*>(&above[col])), mid));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dest2[col]),
+                _mm256_avg_epu16(_mm256_loadu_si256(reinterpret_cast<__m256i*>(&below[col])), mid));
+        }
+        above  += srcpitch;
+        middle += srcpitch;
+        below  += srcpitch;
+        dest1  += dstpitch;
+        dest2  += dstpitch;
+    }
+}
+#endif
+
+using BlendFunc = void (*)(unsigned char*, int, int, int, int, unsigned char*, int, bool);
+
+/*! \brief Picks the fastest blend for a plane, or nullptr if it cannot be blended.
+ *
+ * Width is set to the number of bytes the chosen function processes per row.
+*/
+static BlendFunc GetBlendFunc(VideoFrame *Src, uint Plane, int &Width,
+                              bool HaveAVX2, bool HaveSIMD)
+{
+    int  height  = height_for_plane(Src->codec, Src->height, static_cast<int>(Plane));
+    bool hidepth = ColorDepth(Src->codec) > 8;
+    bool height4 = (height % 4) == 0;
+    bool width4  = (Src->pitches[Plane] % 4) == 0;
+    Width = hidepth ? pitch_for_plane(Src->codec, Src->width, static_cast<int>(Plane)) :
+                      width_for_plane(Src->codec, Src->width, static_cast<int>(Plane));
+#if (HAVE_AVX2 && ARCH_X86_64)
+    if (HaveAVX2 && height4 && ((Src->pitches[Plane] % 32) == 0))
+        return hidepth ? BlendAVX2_16x4 : BlendAVX2_32x4;
+#endif
+    // N.B. all frames allocated by MythTV should have 16 byte alignment
+    // for all planes
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+    // profiling SSE2 suggests it is usually 4x faster - as expected
+    if (HaveSIMD && height4 && ((Src->pitches[Plane] % 16) == 0))
+        return hidepth ? BlendSIMD8x4 : BlendSIMD16x4;
+#endif
+    // N.B. There is no 10bit support here - but it shouldn't be necessary
+    // as everything should be 16byte aligned and 10/12bit interlaced video
+    // is virtually unheard of.
+    if (width4 && height4 && !hidepth)
+        return BlendC4x4;
+    return nullptr;
+}
+
+/*! \brief Limits the CPU features the linear blend may use.
+ *
+ * Features the CPU does not have stay off. This lets the tests compare each
+ * blend function with the C version, and is not meant to be changed while
+ * frames are being deinterlaced.
+*/
+void MythDeinterlacer::UseCPUFeatures(bool SIMD, bool AVX2)
+{
+    s_useSIMD = SIMD && s_haveSIMD;
+    s_useAVX2 = AVX2 && s_haveAVX2;
+}
+
 void MythDeinterlacer::Blend(VideoFrame *Frame, FrameScanType Scan)
 {
     if (Frame->height < 16 || Frame->width < 16)
@@ -646,58 +994,45 @@ void MythDeinterlacer::Blend(VideoFrame *Frame, FrameScanType Scan)
             return;
         // copy/cache on first pass.
         if (kScan_Interlaced == Scan)
-            memcpy(m_bobFrame->buf, Frame->buf, static_cast<size_t>(m_bobFrame->size));
+            CopyToCache(Frame);
         else
             second = true;
         src = m_bobFrame;
     }
 
-    bool hidepth = ColorDepth(src->codec) > 8;
     bool top = second ? !m_topFirst : m_topFirst;
+    int firstrow = top ? 1 : 2;
     uint count = planes(src->codec);
-    for (uint plane = 0; plane < count; plane++)
-    {
-        int  height  = height_for_plane(src->codec, src->height, plane);
-        int firstrow = top ? 1 : 2;
-        bool height4 = (height % 4) == 0;
-        bool width4  = (src->pitches[plane] % 4) == 0;
-        // N.B. all frames allocated by MythTV should have 16 byte alignment
-        // for all planes
-#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
-        bool width16 = (src->pitches[plane] % 16) == 0;
-        // profiling SSE2 suggests it is usually 4x faster - as expected
-        if (s_haveSIMD && height4 && width16)
-        {
-            if (hidepth)
-            {
-                BlendSIMD8x4(src->buf + src->offsets[plane],
-                             pitch_for_plane(src->codec, src->width, plane),
-                             firstrow, height, src->pitches[plane],
-                             Frame->buf + Frame->offsets[plane], Frame->pitches[plane],
-                             second);
-            }
-            else
-            {
-                BlendSIMD16x4(src->buf + src->offsets[plane],
-                              width_for_plane(src->codec, src->width, plane),
-                              firstrow, height, src->pitches[plane],
-                              Frame->buf + Frame->offsets[plane], Frame->pitches[plane],
-                              second);
-            }
-        }
-        else
-#endif
-        // N.B. There is no 10bit support here - but it shouldn't be necessary
-        // as everything should be 16byte aligned and 10/12bit interlaced video
-        // is virtually unheard of.
-        if (width4 && height4 && !hidepth)
-        {
-            BlendC4x4(src->buf + src->offsets[plane],
-                      width_for_plane(src->codec, src->width, plane),
-                      firstrow, height, src->pitches[plane],
-                      Frame->buf + Frame->offsets[plane], Frame->pitches[plane],
-                      second);
-        }
+    uint slices = m_pool ? m_pool->Threads() : 1;
+
+    // Each plane is cut into slices of whole 4 row passes. A pass only writes
+    // the rows of one field and only reads the other field (or the cache) so
+    // the slices never touch each other's output.
+    std::array<BlendFunc,3> funcs   { nullptr, nullptr, nullptr };
+    std::array<int,3>       widths  { 0, 0, 0 };
+    std::array<int,3>       passes  { 0, 0, 0 };
+    for (uint plane = 0; plane < count && plane < 3; plane++)
+    {
+        int height = height_for_plane(src->codec, src->height, static_cast<int>(plane));
+        funcs[plane]  = GetBlendFunc(src, plane, widths[plane], s_useAVX2, s_useSIMD);
+        passes[plane] = std::max(0, (height - firstrow) / 4);
     }
+
+    auto blend = [&](uint Slice)
+    {
+        uint plane = Slice / slices;
+        uint part  = Slice % slices;
+        if (!funcs[plane])
+            return;
+        int first = (passes[plane] * static_cast<int>(part)) / static_cast<int>(slices);
+        int last  = (passes[plane] * static_cast<int>(part + 1)) / static_cast<int>(slices);
+        if (first >= last)
+            return;
+        funcs[plane](src->buf + src->offsets[plane], widths[plane],
+                     firstrow + (first * 4), firstrow + (last * 4) + 3, src->pitches[plane],
+                     Frame->buf + Frame->offsets[plane], Frame->pitches[plane], second);
+    };
+    RunSlices(std::min(count, 3U) * slices, blend);
+
     Frame->already_deinterlaced = true;
 }
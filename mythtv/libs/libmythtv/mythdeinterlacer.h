@@ -1,7 +1,11 @@
 #ifndef MYTHDEINTERLACER_H
 #define MYTHDEINTERLACER_H
 
+// Std
+#include <functional>
+
 // MythTV
+#include "mythtvexp.h"
 #include "videoouttypes.h"
 #include "mythavutil.h"
 #include "videodisplayprofile.h"
@@ -11,7 +15,9 @@ extern "C" {
 #include "libswscale/swscale.h"
 }
 
-class MythDeinterlacer
+class MythDeinterlacerPool;
+
+class MTV_PUBLIC MythDeinterlacer
 {
   public:
     MythDeinterlacer() = default;
@@ -19,15 +25,22 @@ class MythDeinterlacer
 
     void             Filter       (VideoFrame *Frame, FrameScanType Scan,
                                    VideoDisplayProfile *Profile, bool Force = false);
+    void             SetMaxThreads(uint Threads);
+    static bool      HaveSIMD     (void) { return s_haveSIMD; }
+    static bool      HaveAVX2     (void) { return s_haveAVX2; }
+    static void      UseCPUFeatures(bool SIMD, bool AVX2);
 
   private:
     bool             Initialise   (VideoFrame *Frame, MythDeintType Deinterlacer,
                                    bool DoubleRate, bool TopFieldFirst,
                                    VideoDisplayProfile *Profile);
     inline void      Cleanup      (void);
+    uint             GetThreads   (VideoDisplayProfile *Profile) const;
     void             OneField     (VideoFrame *Frame, FrameScanType Scan);
     void             Blend        (VideoFrame *Frame, FrameScanType Scan);
     bool             SetUpCache   (VideoFrame *Frame);
+    void             CopyToCache  (VideoFrame *Frame);
+    void             RunSlices    (uint Slices, const std::function<void(uint)> &Job);
 
   private:
     Q_DISABLE_COPY(MythDeinterlacer)
@@ -48,7 +61,12 @@ class MythDeinterlacer
     long long        m_discontinuityCounter { 0 };
     bool             m_autoFieldOrder  { false };
     long long        m_lastFieldChange { 0 };
+    uint             m_maxThreads { 0 };
+    MythDeinterlacerPool* m_pool  { nullptr };
     static bool      s_haveSIMD;
+    static bool      s_haveAVX2;
+    static bool      s_useSIMD;
+    static bool      s_useAVX2;
 };
 
 #endif // MYTHDEINTERLACER_H
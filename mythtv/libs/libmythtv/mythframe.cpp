@@ -24,12 +24,31 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <algorithm>
+
 #include <mythtimer.h>
 #include "mythconfig.h"
 #include "mythframe.h"
 #include "mythcorecontext.h"
 #include "mythlogging.h"
 
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#if HAVE_AVX2 && ARCH_X86
+#include <immintrin.h>
+#endif
+
+#if HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+#endif
+
 const char* format_description(VideoFrameType Type)
 {
     switch (Type)
@@ -155,6 +174,14 @@ static inline bool sse4_check()
     return has_sse4;
 }
 
+// AVX2 also needs the OS to save the upper halves of the registers, which
+// libavutil checks for.
+static inline bool avx2_check()
+{
+    static const bool s_avx2 = (av_get_cpu_flags() & AV_CPU_FLAG_AVX2) != 0;
+    return s_avx2;
+}
+
 static inline void SSE_splitplanes(uint8_t* dstu, int dstu_pitch,
                                    uint8_t* dstv, int dstv_pitch,
                                    const uint8_t* src, int src_pitch,
@@ -327,11 +354,487 @@ static void splitplanes(uint8_t* dstu, int dstu_pitch,
     }
 }
 
+static void mergeplanes(uint8_t* dst, int dst_pitch,
+                        const uint8_t* srcu, int srcu_pitch,
+                        const uint8_t* srcv, int srcv_pitch,
+                        int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+/*
+ * 16bit versions of the above, for P010/P016 <-> YUV420P10/YUV420P16.
+ * width is in samples and pitches are in bytes. A positive shift moves
+ * samples down from the top of 16 bits (P010) to the bottom (YUV420P10)
+ * and a negative one moves them back up.
+ */
+static inline uint16_t shift16(uint16_t value, int shift)
+{
+    return static_cast<uint16_t>(shift < 0 ? value << -shift : value >> shift);
+}
+
+static void splitplanes16(uint8_t* dstu, int dstu_pitch,
+                          uint8_t* dstv, int dstv_pitch,
+                          const uint8_t* src, int src_pitch,
+                          int width, int height, int shift)
+{
+    for (int y = 0; y < height; y++)
+    {
+        const auto *s = reinterpret_cast<const uint16_t*>(src);
+        auto *u = reinterpret_cast<uint16_t*>(dstu);
+        auto *v = reinterpret_cast<uint16_t*>(dstv);
+        for (int x = 0; x < width; x++)
+        {
+            u[x] = shift16(s[2*x+0], shift);
+            v[x] = shift16(s[2*x+1], shift);
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void mergeplanes16(uint8_t* dst, int dst_pitch,
+                          const uint8_t* srcu, int srcu_pitch,
+                          const uint8_t* srcv, int srcv_pitch,
+                          int width, int height, int shift)
+{
+    for (int y = 0; y < height; y++)
+    {
+        auto *d = reinterpret_cast<uint16_t*>(dst);
+        const auto *u = reinterpret_cast<const uint16_t*>(srcu);
+        const auto *v = reinterpret_cast<const uint16_t*>(srcv);
+        for (int x = 0; x < width; x++)
+        {
+            d[2*x+0] = shift16(u[x], shift);
+            d[2*x+1] = shift16(v[x], shift);
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+static void shiftplane16(uint8_t* dst, int dst_pitch,
+                         const uint8_t* src, int src_pitch,
+                         int width, int height, int shift)
+{
+    if (!shift)
+    {
+        copyplane(dst, dst_pitch, src, src_pitch, width << 1, height);
+        return;
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        const auto *s = reinterpret_cast<const uint16_t*>(src);
+        auto *d = reinterpret_cast<uint16_t*>(dst);
+        for (int x = 0; x < width; x++)
+            d[x] = shift16(s[x], shift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+#if HAVE_AVX2 && ARCH_X86
+/*
+ * AVX2 versions. These are built for the AVX2 target function by function
+ * and only called once avx2_check() has passed. Loads and stores are
+ * unaligned, as the chroma planes of a 64 byte aligned frame are only
+ * 32 byte aligned and pitches need not be either.
+ */
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static void AVX2_splitplanes(uint8_t* dstu, int dstu_pitch,
+                                         uint8_t* dstv, int dstv_pitch,
+                                         const uint8_t* src, int src_pitch,
+                                         int width, int height)
+{
+    // UVUV... to UUUUUUUUVVVVVVVV within each 128 bit lane
+    const __m256i shuffle = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                                             0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        for (; x < (width & ~31); x += 32)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[2*x]));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[2*x + 32]));
+            a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, shuffle), 0xD8);
+            b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, shuffle), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dstu[x]), _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dstv[x]), _mm256_permute2x128_si256(a, b, 0x31));
+        }
+        for (; x < width; x++)
+        {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+AVX2_TARGET static void AVX2_mergeplanes(uint8_t* dst, int dst_pitch,
+                                         const uint8_t* srcu, int srcu_pitch,
+                                         const uint8_t* srcv, int srcv_pitch,
+                                         int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        for (; x < (width & ~31); x += 32)
+        {
+            __m256i u  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&srcu[x]));
+            __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&srcv[x]));
+            __m256i lo = _mm256_unpacklo_epi8(u, v);
+            __m256i hi = _mm256_unpackhi_epi8(u, v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[2*x]),      _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[2*x + 32]), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+        for (; x < width; x++)
+        {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+// Only one of the two shifts is ever non zero
+#define AVX2_SHIFT16(v) _mm256_sll_epi16(_mm256_srl_epi16((v), right), left)
+
+AVX2_TARGET static void AVX2_splitplanes16(uint8_t* dstu, int dstu_pitch,
+                                           uint8_t* dstv, int dstv_pitch,
+                                           const uint8_t* src, int src_pitch,
+                                           int width, int height, int shift)
+{
+    const __m128i right = _mm_cvtsi32_si128(std::max(shift, 0));
+    const __m128i left  = _mm_cvtsi32_si128(std::max(-shift, 0));
+    // UVUV... to UUUUVVVV within each 128 bit lane
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+                                             0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    for (int y = 0; y < height; y++)
+    {
+        const auto *s = reinterpret_cast<const uint16_t*>(src);
+        auto *u = reinterpret_cast<uint16_t*>(dstu);
+        auto *v = reinterpret_cast<uint16_t*>(dstv);
+        int x = 0;
+        for (; x < (width & ~15); x += 16)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s[2*x]));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s[2*x + 16]));
+            a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, shuffle), 0xD8);
+            b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, shuffle), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&u[x]), AVX2_SHIFT16(_mm256_permute2x128_si256(a, b, 0x20)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&v[x]), AVX2_SHIFT16(_mm256_permute2x128_si256(a, b, 0x31)));
+        }
+        for (; x < width; x++)
+        {
+            u[x] = shift16(s[2*x+0], shift);
+            v[x] = shift16(s[2*x+1], shift);
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+AVX2_TARGET static void AVX2_mergeplanes16(uint8_t* dst, int dst_pitch,
+                                           const uint8_t* srcu, int srcu_pitch,
+                                           const uint8_t* srcv, int srcv_pitch,
+                                           int width, int height, int shift)
+{
+    const __m128i right = _mm_cvtsi32_si128(std::max(shift, 0));
+    const __m128i left  = _mm_cvtsi32_si128(std::max(-shift, 0));
+    for (int y = 0; y < height; y++)
+    {
+        auto *d = reinterpret_cast<uint16_t*>(dst);
+        const auto *u = reinterpret_cast<const uint16_t*>(srcu);
+        const auto *v = reinterpret_cast<const uint16_t*>(srcv);
+        int x = 0;
+        for (; x < (width & ~15); x += 16)
+        {
+            __m256i uu = AVX2_SHIFT16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&u[x])));
+            __m256i vv = AVX2_SHIFT16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&v[x])));
+            __m256i lo = _mm256_unpacklo_epi16(uu, vv);
+            __m256i hi = _mm256_unpackhi_epi16(uu, vv);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[2*x]),      _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[2*x + 16]), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+        for (; x < width; x++)
+        {
+            d[2*x+0] = shift16(u[x], shift);
+            d[2*x+1] = shift16(v[x], shift);
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+AVX2_TARGET static void AVX2_shiftplane16(uint8_t* dst, int dst_pitch,
+                                          const uint8_t* src, int src_pitch,
+                                          int width, int height, int shift)
+{
+    if (!shift)
+    {
+        copyplane(dst, dst_pitch, src, src_pitch, width << 1, height);
+        return;
+    }
+
+    const __m128i right = _mm_cvtsi32_si128(std::max(shift, 0));
+    const __m128i left  = _mm_cvtsi32_si128(std::max(-shift, 0));
+    for (int y = 0; y < height; y++)
+    {
+        const auto *s = reinterpret_cast<const uint16_t*>(src);
+        auto *d = reinterpret_cast<uint16_t*>(dst);
+        int x = 0;
+        for (; x < (width & ~15); x += 16)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&d[x]),
+                AVX2_SHIFT16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&s[x]))));
+        }
+        for (; x < width; x++)
+            d[x] = shift16(s[x], shift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+#undef AVX2_SHIFT16
+#endif // HAVE_AVX2 && ARCH_X86
+
+#if HAVE_INTRINSICS_NEON
+static void NEON_splitplanes(uint8_t* dstu, int dstu_pitch,
+                             uint8_t* dstv, int dstv_pitch,
+                             const uint8_t* src, int src_pitch,
+                             int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        for (; x < (width & ~15); x += 16)
+        {
+            uint8x16x2_t uv = vld2q_u8(&src[2*x]);
+            vst1q_u8(&dstu[x], uv.val[0]);
+            vst1q_u8(&dstv[x], uv.val[1]);
+        }
+        for (; x < width; x++)
+        {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void NEON_mergeplanes(uint8_t* dst, int dst_pitch,
+                             const uint8_t* srcu, int srcu_pitch,
+                             const uint8_t* srcv, int srcv_pitch,
+                             int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        for (; x < (width & ~15); x += 16)
+        {
+            uint8x16x2_t uv;
+            uv.val[0] = vld1q_u8(&srcu[x]);
+            uv.val[1] = vld1q_u8(&srcv[x]);
+            vst2q_u8(&dst[2*x], uv);
+        }
+        for (; x < width; x++)
+        {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+// vshlq shifts right for negative counts
+static void NEON_splitplanes16(uint8_t* dstu, int dstu_pitch,
+                               uint8_t* dstv, int dstv_pitch,
+                               const uint8_t* src, int src_pitch,
+                               int width, int height, int shift)
+{
+    const int16x8_t count = vdupq_n_s16(static_cast<int16_t>(-shift));
+    for (int y = 0; y < height; y++)
+    {
+        const auto *s = reinterpret_cast<const uint16_t*>(src);
+        auto *u = reinterpret_cast<uint16_t*>(dstu);
+        auto *v = reinterpret_cast<uint16_t*>(dstv);
+        int x = 0;
+        for (; x < (width & ~7); x += 8)
+        {
+            uint16x8x2_t uv = vld2q_u16(&s[2*x]);
+            vst1q_u16(&u[x], vshlq_u16(uv.val[0], count));
+            vst1q_u16(&v[x], vshlq_u16(uv.val[1], count));
+        }
+        for (; x < width; x++)
+        {
+            u[x] = shift16(s[2*x+0], shift);
+            v[x] = shift16(s[2*x+1], shift);
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void NEON_mergeplanes16(uint8_t* dst, int dst_pitch,
+                               const uint8_t* srcu, int srcu_pitch,
+                               const uint8_t* srcv, int srcv_pitch,
+                               int width, int height, int shift)
+{
+    const int16x8_t count = vdupq_n_s16(static_cast<int16_t>(-shift));
+    for (int y = 0; y < height; y++)
+    {
+        auto *d = reinterpret_cast<uint16_t*>(dst);
+        const auto *u = reinterpret_cast<const uint16_t*>(srcu);
+        const auto *v = reinterpret_cast<const uint16_t*>(srcv);
+        int x = 0;
+        for (; x < (width & ~7); x += 8)
+        {
+            uint16x8x2_t uv;
+            uv.val[0] = vshlq_u16(vld1q_u16(&u[x]), count);
+            uv.val[1] = vshlq_u16(vld1q_u16(&v[x]), count);
+            vst2q_u16(&d[2*x], uv);
+        }
+        for (; x < width; x++)
+        {
+            d[2*x+0] = shift16(u[x], shift);
+            d[2*x+1] = shift16(v[x], shift);
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+static void NEON_shiftplane16(uint8_t* dst, int dst_pitch,
+                              const uint8_t* src, int src_pitch,
+                              int width, int height, int shift)
+{
+    if (!shift)
+    {
+        copyplane(dst, dst_pitch, src, src_pitch, width << 1, height);
+        return;
+    }
+
+    const int16x8_t count = vdupq_n_s16(static_cast<int16_t>(-shift));
+    for (int y = 0; y < height; y++)
+    {
+        const auto *s = reinterpret_cast<const uint16_t*>(src);
+        auto *d = reinterpret_cast<uint16_t*>(dst);
+        int x = 0;
+        for (; x < (width & ~7); x += 8)
+            vst1q_u16(&d[x], vshlq_u16(vld1q_u16(&s[x]), count));
+        for (; x < width; x++)
+            d[x] = shift16(s[x], shift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+#endif // HAVE_INTRINSICS_NEON
+
+/*
+ * The semi-planar <-> planar conversions, picked once for this CPU the first
+ * time a frame is converted.
+ */
+struct FrameKernels
+{
+    const char *m_name { "C" };
+    void (*m_split)(uint8_t*, int, uint8_t*, int, const uint8_t*, int, int, int) { splitplanes };
+    void (*m_merge)(uint8_t*, int, const uint8_t*, int, const uint8_t*, int, int, int) { mergeplanes };
+    void (*m_split16)(uint8_t*, int, uint8_t*, int, const uint8_t*, int, int, int, int) { splitplanes16 };
+    void (*m_merge16)(uint8_t*, int, const uint8_t*, int, const uint8_t*, int, int, int, int) { mergeplanes16 };
+    void (*m_shift16)(uint8_t*, int, const uint8_t*, int, int, int, int) { shiftplane16 };
+};
+
+static FrameKernels select_kernels(void)
+{
+    FrameKernels kernels;
+#if ARCH_X86
+    if (sse2_check())
+    {
+        kernels.m_name  = "SSE2";
+        kernels.m_split = SSE_splitplanes;
+    }
+#if HAVE_AVX2
+    if (avx2_check())
+    {
+        kernels.m_name    = "AVX2";
+        kernels.m_split   = AVX2_splitplanes;
+        kernels.m_merge   = AVX2_mergeplanes;
+        kernels.m_split16 = AVX2_splitplanes16;
+        kernels.m_merge16 = AVX2_mergeplanes16;
+        kernels.m_shift16 = AVX2_shiftplane16;
+    }
+#endif
+#elif HAVE_INTRINSICS_NEON
+    if (have_neon(av_get_cpu_flags()))
+    {
+        kernels.m_name    = "NEON";
+        kernels.m_split   = NEON_splitplanes;
+        kernels.m_merge   = NEON_mergeplanes;
+        kernels.m_split16 = NEON_splitplanes16;
+        kernels.m_merge16 = NEON_mergeplanes16;
+        kernels.m_shift16 = NEON_shiftplane16;
+    }
+#endif
+    LOG(VB_PLAYBACK, LOG_INFO, QString("Using %1 frame conversions").arg(kernels.m_name));
+    return kernels;
+}
+
+static const FrameKernels& frame_kernels(bool useSIMD)
+{
+    static const FrameKernels s_c;
+    static const FrameKernels s_simd = select_kernels();
+    return useSIMD ? s_simd : s_c;
+}
+
+/// \brief Whether framecopy() converts frames of format Src to Dst, and the
+/// shift between their samples if so.
+static bool convertible(VideoFrameType Src, VideoFrameType Dst, int &Shift)
+{
+    Shift = 0;
+    switch (Src)
+    {
+        case FMT_NV12:      return Dst == FMT_YV12;
+        case FMT_YV12:      return Dst == FMT_NV12;
+        case FMT_P016:      return Dst == FMT_YUV420P16;
+        case FMT_YUV420P16: return Dst == FMT_P016;
+        case FMT_P010:      Shift =  6; return Dst == FMT_YUV420P10;
+        case FMT_YUV420P10: Shift = -6; return Dst == FMT_P010;
+        default: break;
+    }
+    return false;
+}
+
 void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
 {
     VideoFrameType codec = dst->codec;
-    if (!(dst->codec == src->codec ||
-          (src->codec == FMT_NV12 && dst->codec == FMT_YV12)))
+    int shift = 0;
+    bool convert = convertible(src->codec, codec, shift);
+    if (!(dst->codec == src->codec || convert))
         return;
 
     dst->interlaced_frame = src->interlaced_frame;
@@ -344,6 +847,48 @@ void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
     dst->colortransfer    = src->colortransfer;
     dst->chromalocation   = src->chromalocation;
 
+    const FrameKernels &kernels = frame_kernels(useSSE);
+
+    if (convert && (FMT_YV12 != codec))
+    {
+        if (src->width != dst->width || src->height != dst->height)
+            return;
+
+        int width  = src->width;
+        int height = src->height;
+        if (FMT_NV12 == codec)
+        {
+            copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
+                      src->buf + src->offsets[0], src->pitches[0],
+                      width, height);
+            kernels.m_merge(dst->buf + dst->offsets[1], dst->pitches[1],
+                            src->buf + src->offsets[1], src->pitches[1],
+                            src->buf + src->offsets[2], src->pitches[2],
+                            (width+1) / 2, (height+1) / 2);
+        }
+        else if (format_is_nv12(src->codec))
+        {
+            kernels.m_shift16(dst->buf + dst->offsets[0], dst->pitches[0],
+                              src->buf + src->offsets[0], src->pitches[0],
+                              width, height, shift);
+            kernels.m_split16(dst->buf + dst->offsets[1], dst->pitches[1],
+                              dst->buf + dst->offsets[2], dst->pitches[2],
+                              src->buf + src->offsets[1], src->pitches[1],
+                              (width+1) / 2, (height+1) / 2, shift);
+        }
+        else
+        {
+            kernels.m_shift16(dst->buf + dst->offsets[0], dst->pitches[0],
+                              src->buf + src->offsets[0], src->pitches[0],
+                              width, height, shift);
+            kernels.m_merge16(dst->buf + dst->offsets[1], dst->pitches[1],
+                              src->buf + src->offsets[1], src->pitches[1],
+                              src->buf + src->offsets[2], src->pitches[2],
+                              (width+1) / 2, (height+1) / 2, shift);
+        }
+        return;
+    }
+
     if (FMT_YV12 == codec)
     {
         int width   = src->width;
@@ -357,23 +902,10 @@ void framecopy(VideoFrame* dst, const VideoFrame* src, bool useSSE)
             copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
                       src->buf + src->offsets[0], src->pitches[0],
                       width, height);
-#if ARCH_X86
-            if (useSSE && sse2_check())
-            {
-                SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                dst->buf + dst->offsets[2], dst->pitches[2],
-                                src->buf + src->offsets[1], src->pitches[1],
-                                (width+1) / 2, (height+1) / 2);
-                asm volatile ("emms");
-                return;
-            }
-#else
-            Q_UNUSED(useSSE);
-#endif
-            splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                        dst->buf + dst->offsets[2], dst->pitches[2],
-                        src->buf + src->offsets[1], src->pitches[1],
-                        (width+1) / 2, (height+1) / 2);
+            kernels.m_split(dst->buf + dst->offsets[1], dst->pitches[1],
+                            dst->buf + dst->offsets[2], dst->pitches[2],
+                            src->buf + src->offsets[1], src->pitches[1],
+                            (width+1) / 2, (height+1) / 2);
             return;
         }
 
@@ -539,6 +1071,118 @@ static void Copy2d(uint8_t *dst, int dst_pitch,
     }
 }
 
+#if HAVE_AVX2
+/*
+ * AVX2 versions of the above, moving 128 bytes per pass with streaming loads
+ * from the USWC surface and streaming stores to the frame.
+ */
+AVX2_TARGET static void AVX2_CopyFromUswc(uint8_t *dst, int dst_pitch,
+                                          const uint8_t *src, int src_pitch,
+                                          int width, int height)
+{
+    _mm_mfence();
+
+    for (int y = 0; y < height; y++)
+    {
+        const int unaligned = std::min(static_cast<int>((-(uintptr_t)src) & 0x1f), width);
+        int x = 0;
+
+        for (; x < unaligned; x++)
+            dst[x] = src[x];
+
+        for (; x+127 < width; x += 128)
+        {
+            auto *s = reinterpret_cast<__m256i*>(const_cast<uint8_t*>(&src[x]));
+            __m256i a = _mm256_stream_load_si256(s);
+            __m256i b = _mm256_stream_load_si256(s + 1);
+            __m256i c = _mm256_stream_load_si256(s + 2);
+            __m256i d = _mm256_stream_load_si256(s + 3);
+            auto *o = reinterpret_cast<__m256i*>(&dst[x]);
+            _mm256_storeu_si256(o, a);
+            _mm256_storeu_si256(o + 1, b);
+            _mm256_storeu_si256(o + 2, c);
+            _mm256_storeu_si256(o + 3, d);
+        }
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_mfence();
+}
+
+AVX2_TARGET static void AVX2_Copy2d(uint8_t *dst, int dst_pitch,
+                                    const uint8_t *src, int src_pitch,
+                                    int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        int x = 0;
+        const auto *s = reinterpret_cast<const __m256i*>(src);
+        auto *o = reinterpret_cast<__m256i*>(dst);
+
+        if (((intptr_t)dst & 0x1f) == 0)
+        {
+            for (; x+127 < width; x += 128, s += 4, o += 4)
+            {
+                _mm256_stream_si256(o,     _mm256_loadu_si256(s));
+                _mm256_stream_si256(o + 1, _mm256_loadu_si256(s + 1));
+                _mm256_stream_si256(o + 2, _mm256_loadu_si256(s + 2));
+                _mm256_stream_si256(o + 3, _mm256_loadu_si256(s + 3));
+            }
+        }
+        else
+        {
+            for (; x+127 < width; x += 128, s += 4, o += 4)
+            {
+                _mm256_storeu_si256(o,     _mm256_loadu_si256(s));
+                _mm256_storeu_si256(o + 1, _mm256_loadu_si256(s + 1));
+                _mm256_storeu_si256(o + 2, _mm256_loadu_si256(s + 2));
+                _mm256_storeu_si256(o + 3, _mm256_loadu_si256(s + 3));
+            }
+        }
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_sfence();
+}
+#endif // HAVE_AVX2
+
+/// \brief Copies from a USWC surface through a cached bounce buffer.
+static inline void CopyUswcBlock(uint8_t *cache, int cache_pitch,
+                                 const uint8_t *src, int src_pitch,
+                                 int width, int height)
+{
+#if HAVE_AVX2
+    if (avx2_check())
+    {
+        AVX2_CopyFromUswc(cache, cache_pitch, src, src_pitch, width, height);
+        return;
+    }
+#endif
+    CopyFromUswc(cache, cache_pitch, src, src_pitch, width, height);
+}
+
+static inline void CopyCacheBlock(uint8_t *dst, int dst_pitch,
+                                  const uint8_t *cache, int cache_pitch,
+                                  int width, int height)
+{
+#if HAVE_AVX2
+    if (avx2_check())
+    {
+        AVX2_Copy2d(dst, dst_pitch, cache, cache_pitch, width, height);
+        return;
+    }
+#endif
+    Copy2d(dst, dst_pitch, cache, cache_pitch, width, height);
+}
+
 static void SSE_copyplane(uint8_t *dst, int dst_pitch,
                           const uint8_t *src, int src_pitch,
                           uint8_t *cache, int cache_size,
@@ -552,14 +1196,14 @@ static void SSE_copyplane(uint8_t *dst, int dst_pitch,
         const int hblock =  std::min(hstep, height - y);
 
         /* Copy a bunch of line into our cache */
-        CopyFromUswc(cache, w16,
-                     src, src_pitch,
-                     width, hblock);
+        CopyUswcBlock(cache, w16,
+                      src, src_pitch,
+                      width, hblock);
 
         /* Copy from our cache to the destination */
-        Copy2d(dst, dst_pitch,
-               cache, w16,
-               width, hblock);
+        CopyCacheBlock(dst, dst_pitch,
+                       cache, w16,
+                       width, hblock);
 
         /* */
         src += src_pitch * hblock;
@@ -581,12 +1225,12 @@ static void SSE_splitplanes(uint8_t *dstu, int dstu_pitch,
         const int hblock =  std::min(hstep, height - y);
 
         /* Copy a bunch of line into our cache */
-        CopyFromUswc(cache, w16, src, src_pitch,
-                     2*width, hblock);
+        CopyUswcBlock(cache, w16, src, src_pitch,
+                      2*width, hblock);
 
         /* Copy from our cache to the destination */
-        SSE_splitplanes(dstu, dstu_pitch, dstv, dstv_pitch,
-                        cache, w16, width, hblock);
+        frame_kernels(true).m_split(dstu, dstu_pitch, dstv, dstv_pitch,
+                                    cache, w16, width, hblock);
 
         /* */
         src  += src_pitch  * hblock;
@@ -673,10 +1317,10 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
                     copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
                               src->buf + src->offsets[0], src->pitches[0],
                               width, height);
-                    SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                    dst->buf + dst->offsets[2], dst->pitches[2],
-                                    src->buf + src->offsets[1], src->pitches[1],
-                                    (width+1) / 2, (height+1) / 2);
+                    frame_kernels(true).m_split(dst->buf + dst->offsets[1], dst->pitches[1],
+                                                dst->buf + dst->offsets[2], dst->pitches[2],
+                                                src->buf + src->offsets[1], src->pitches[1],
+                                                (width+1) / 2, (height+1) / 2);
                     if (timer->nsecsElapsed() < sse_duration)
                     {
                         m_uswc = uswcState::Use_SW;
@@ -694,10 +1338,10 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
                 copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
                           src->buf + src->offsets[0], src->pitches[0],
                           width, height);
-                SSE_splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                                dst->buf + dst->offsets[2], dst->pitches[2],
-                                src->buf + src->offsets[1], src->pitches[1],
-                                (width+1) / 2, (height+1) / 2);
+                frame_kernels(true).m_split(dst->buf + dst->offsets[1], dst->pitches[1],
+                                            dst->buf + dst->offsets[2], dst->pitches[2],
+                                            src->buf + src->offsets[1], src->pitches[1],
+                                            (width+1) / 2, (height+1) / 2);
             }
             asm volatile ("emms");
             return;
@@ -706,10 +1350,10 @@ void MythUSWCCopy::copy(VideoFrame *dst, const VideoFrame *src)
         copyplane(dst->buf + dst->offsets[0], dst->pitches[0],
                   src->buf + src->offsets[0], src->pitches[0],
                   width, height);
-        splitplanes(dst->buf + dst->offsets[1], dst->pitches[1],
-                    dst->buf + dst->offsets[2], dst->pitches[2],
-                    src->buf + src->offsets[1], src->pitches[1],
-                    (width+1) / 2, (height+1) / 2);
+        frame_kernels(true).m_split(dst->buf + dst->offsets[1], dst->pitches[1],
+                                    dst->buf + dst->offsets[2], dst->pitches[2],
+                                    src->buf + src->offsets[1], src->pitches[1],
+                                    (width+1) / 2, (height+1) / 2);
         return;
     }
 
@@ -561,8 +561,8 @@ static inline void copyplane(uint8_t* dst, int dst_pitch,
  * copy: copy one frame into another
  * copy only works with the following assumptions:
  * frames are of the same resolution
- * destination frame is in YV12 format
- * source frame is either YV12 or NV12 format
+ * frames are of the same format, or one of
+ * NV12 <-> YV12, P010 <-> YUV420P10 and P016 <-> YUV420P16
  */
 static inline void copy(VideoFrame *dst, const VideoFrame *src)
 {
@@ -0,0 +1,237 @@
+// Std
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+// MythTV
+#include "mythlogging.h"
+#include "mythframepool.h"
+
+// FFmpeg
+extern "C" {
+#include "libavutil/mem.h"
+}
+
+#define LOC QString("FramePool: ")
+
+/// Bytes after the end of each buffer, as added by GetAlignedBuffer()
+static const size_t kPadding = 64;
+
+/*! \brief The pool shared by every decoder in the process.
+ *
+ * It is never deleted, so that buffers held by frames that outlive other
+ * static objects can still be released at exit.
+*/
+MythFramePool* MythFramePool::Get(void)
+{
+    static auto *s_pool = new MythFramePool();
+    return s_pool;
+}
+
+/*! \brief Rounds Size up to the next of eight steps between powers of two.
+ *
+ * 1920x1080 YV12 (3133440 bytes) and 1920x1088 YV12 both fall in the
+ * 3145728 byte class for instance. Classes are never finer than 64 bytes.
+*/
+size_t MythFramePool::SizeClass(size_t Size)
+{
+    if (Size <= 64)
+        return 64;
+    int top = 0;
+    for (size_t size = Size; size > 1; size >>= 1)
+        top++;
+    size_t step = static_cast<size_t>(1) << std::max(top - 3, 6);
+    return (Size + step - 1) & ~(step - 1);
+}
+
+MythFramePool::~MythFramePool()
+{
+    Trim(0);
+}
+
+/*! \brief Returns a buffer of at least Size bytes, plus the same padding as
+ * GetAlignedBuffer(), aligned to Alignment.
+ *
+ * Alignment must be a power of two. The buffer is not cleared and must be
+ * given back with Release().
+*/
+unsigned char* MythFramePool::Acquire(size_t Size, size_t Alignment)
+{
+    if (!Size || !Alignment || (Alignment & (Alignment - 1)))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Invalid request for %1 bytes aligned to %2")
+            .arg(Size).arg(Alignment));
+        return nullptr;
+    }
+
+    size_t sizeclass = SizeClass(Size);
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_stats.m_acquires++;
+        // The most recently released buffer is the most likely to be in cache
+        auto match = [&](const Block &Free)
+            { return Free.m_class == sizeclass && Free.m_alignment == Alignment; };
+        auto found = std::find_if(m_free.rbegin(), m_free.rend(), match);
+        if (found != m_free.rend())
+        {
+            Block block = *found;
+            m_free.erase(std::next(found).base());
+            m_used.emplace(block.m_data, block);
+            m_stats.m_hits++;
+            m_stats.m_cached -= sizeclass;
+            m_stats.m_inUse  += sizeclass;
+            m_stats.m_buffers--;
+            return block.m_data;
+        }
+        m_stats.m_misses++;
+    }
+
+    Block block { sizeclass, Alignment, nullptr, nullptr };
+    size_t allocsize = sizeclass + kPadding + Alignment;
+    block.m_raw = av_malloc(allocsize);
+    if (!block.m_raw)
+    {
+        // Give back what the pool is holding on to and try again
+        LOG(VB_GENERAL, LOG_WARNING, LOC + QString("Failed to allocate %1 bytes - trimming %2")
+            .arg(allocsize).arg(GetStatus()));
+        Trim(0);
+        block.m_raw = av_malloc(allocsize);
+        if (!block.m_raw)
+            return nullptr;
+    }
+    auto addr = reinterpret_cast<uintptr_t>(block.m_raw);
+    block.m_data = reinterpret_cast<unsigned char*>((addr + Alignment - 1) & ~(Alignment - 1));
+
+    QMutexLocker locker(&m_lock);
+    m_used.emplace(block.m_data, block);
+    m_stats.m_inUse += sizeclass;
+    m_stats.m_peak = std::max(m_stats.m_peak, m_stats.m_inUse + m_stats.m_cached);
+    return block.m_data;
+}
+
+/*! \brief Gives back a buffer from Acquire() for reuse.
+ *
+ * Buffers that did not come from the pool are freed with av_free(), as
+ * frames may still be handed memory from GetAlignedBuffer().
+*/
+void MythFramePool::Release(unsigned char *Buffer)
+{
+    if (!Buffer)
+        return;
+
+    std::vector<Block> trimmed;
+    {
+        QMutexLocker locker(&m_lock);
+        auto used = m_used.find(Buffer);
+        if (used == m_used.end())
+        {
+            locker.unlock();
+            av_free(Buffer);
+            return;
+        }
+
+        Block block = used->second;
+        m_used.erase(used);
+        m_free.push_back(block);
+        m_stats.m_releases++;
+        m_stats.m_inUse  -= block.m_class;
+        m_stats.m_cached += block.m_class;
+        m_stats.m_buffers++;
+
+        // Keep the buffer just released as it is the most likely to be
+        // asked for next
+        TakeOldest(m_maxCached, 1, trimmed);
+    }
+
+    // Freeing large buffers can be slow, so do it without holding the lock
+    for (auto & block : trimmed)
+        av_free(block.m_raw);
+}
+
+/*! \brief Frees the least recently released buffers until no more than
+ * MaxCached bytes are held for reuse.
+*/
+void MythFramePool::Trim(size_t MaxCached)
+{
+    std::vector<Block> trimmed;
+    {
+        QMutexLocker locker(&m_lock);
+        TakeOldest(MaxCached, 0, trimmed);
+    }
+
+    for (auto & block : trimmed)
+        av_free(block.m_raw);
+}
+
+/// Moves the least recently released buffers, other than the Keep most
+/// recent, into Trimmed until no more than MaxCached bytes are held.
+/// m_lock must be held and the caller frees the buffers taken.
+void MythFramePool::TakeOldest(size_t MaxCached, size_t Keep, std::vector<Block> &Trimmed)
+{
+    while ((m_stats.m_cached > MaxCached) && (m_free.size() > Keep))
+    {
+        Trimmed.push_back(m_free.front());
+        m_free.pop_front();
+        m_stats.m_cached -= Trimmed.back().m_class;
+        m_stats.m_buffers--;
+        m_stats.m_trimmed++;
+    }
+}
+
+/// Registers something that acquires buffers, such as a VideoBuffers
+void MythFramePool::AddClient(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_clients++;
+}
+
+/*! \brief Unregisters a client added with AddClient().
+ *
+ * Once the last client has gone, nothing is likely to ask for the cached
+ * buffers soon, so they are all freed.
+*/
+void MythFramePool::RemoveClient(void)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        if (m_clients > 0)
+            m_clients--;
+        if (m_clients > 0)
+            return;
+    }
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Last client gone - trimming %1")
+        .arg(GetStatus()));
+    Trim(0);
+}
+
+void MythFramePool::SetMaxCached(size_t MaxCached)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_maxCached = MaxCached;
+    }
+    Trim(MaxCached);
+}
+
+size_t MythFramePool::GetMaxCached(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_maxCached;
+}
+
+MythFramePoolStats MythFramePool::GetStats(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_stats;
+}
+
+QString MythFramePool::GetStatus(void) const
+{
+    MythFramePoolStats stats = GetStats();
+    return QString("%1 MB in use, %2 buffers (%3 MB) cached, peak %4 MB, "
+                   "%5 of %6 reused, %7 trimmed")
+        .arg(stats.m_inUse >> 20).arg(stats.m_buffers).arg(stats.m_cached >> 20)
+        .arg(stats.m_peak >> 20).arg(stats.m_hits).arg(stats.m_acquires)
+        .arg(stats.m_trimmed);
+}
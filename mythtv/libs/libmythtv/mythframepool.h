@@ -0,0 +1,93 @@
+#ifndef MYTHFRAMEPOOL_H
+#define MYTHFRAMEPOOL_H
+
+// Qt
+#include <QMutex>
+#include <QString>
+
+// MythTV
+#include "mythtvexp.h"
+
+// Std
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+/// Counters for the frame memory pool
+struct MythFramePoolStats
+{
+    uint64_t m_acquires    {0}; ///< Buffers handed out
+    uint64_t m_hits        {0}; ///< Buffers handed out from the pool
+    uint64_t m_misses      {0}; ///< Buffers that had to be allocated
+    uint64_t m_releases    {0}; ///< Buffers given back
+    uint64_t m_trimmed     {0}; ///< Buffers freed to stay under the limit
+    size_t   m_inUse       {0}; ///< Bytes handed out and not yet given back
+    size_t   m_cached      {0}; ///< Bytes held in the pool for reuse
+    size_t   m_peak        {0}; ///< Most bytes handed out and cached at once
+    size_t   m_buffers     {0}; ///< Buffers held in the pool for reuse
+};
+
+/** \class MythFramePool
+ *  \brief Process wide pool of the memory behind software video frames.
+ *
+ *   Buffers are grouped by size class and alignment. A size is rounded up
+ *   to the next of eight steps between powers of two, so frames of nearby
+ *   sizes share a class while no buffer is more than an eighth larger than
+ *   asked for. Released buffers are kept in the pool and handed out again
+ *   to the next request of the same class, from any decoder, rather than
+ *   going back to the heap.
+ *
+ *   Released buffers are kept up to a limit on the bytes held for reuse,
+ *   past which the least recently released are freed. Everything held is
+ *   freed when the last client (e.g. VideoBuffers) goes away, so memory is
+ *   not kept between playback or transcode sessions.
+ */
+class MTV_PUBLIC MythFramePool
+{
+  public:
+    static MythFramePool* Get(void);
+    static size_t SizeClass(size_t Size);
+
+    MythFramePool() = default;
+   ~MythFramePool();
+
+    unsigned char* Acquire(size_t Size, size_t Alignment = kDefaultAlignment);
+    void           Release(unsigned char *Buffer);
+    void           Trim(size_t MaxCached = 0);
+    void           AddClient(void);
+    void           RemoveClient(void);
+    void           SetMaxCached(size_t MaxCached);
+    size_t         GetMaxCached(void) const;
+    MythFramePoolStats GetStats(void) const;
+    QString        GetStatus(void) const;
+
+    /// The alignment of buffers from GetAlignedBuffer()
+    static const size_t kDefaultAlignment = 64;
+    /// Bytes held for reuse unless SetMaxCached() is called
+    static const size_t kDefaultMaxCached = 64 * 1024 * 1024;
+
+  private:
+    Q_DISABLE_COPY(MythFramePool)
+
+    struct Block
+    {
+        size_t         m_class     {0};
+        size_t         m_alignment {0};
+        void          *m_raw       {nullptr};
+        unsigned char *m_data      {nullptr};
+    };
+
+    void TakeOldest(size_t MaxCached, size_t Keep, std::vector<Block> &Trimmed);
+
+    mutable QMutex     m_lock;
+    /// Released buffers, least recently released first
+    std::deque<Block>  m_free;
+    /// Buffers handed out, by the pointer handed out
+    std::map<unsigned char*, Block> m_used;
+    size_t             m_maxCached { kDefaultMaxCached };
+    int                m_clients   { 0 };
+    MythFramePoolStats m_stats;
+};
+
+#endif // MYTHFRAMEPOOL_H
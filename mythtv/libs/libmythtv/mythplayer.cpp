@@ -4815,6 +4815,10 @@ void MythPlayer::GetPlaybackData(InfoMap &infoMap)
     infoMap.insert("storagerate", m_playerCtx->m_buffer->GetStorageRate());
     infoMap.insert("bufferavail", m_playerCtx->m_buffer->GetAvailableBuffer());
     infoMap.insert("buffersize",  QString::number(m_playerCtx->m_buffer->GetBufferSize() >> 20));
+    MythReadAheadStats readahead = m_playerCtx->m_buffer->GetReadAheadStats();
+    infoMap.insert("bufferstalls",  tr("%1 (%2 ms)").arg(readahead.m_stalls).arg(readahead.m_stallTime));
+    infoMap.insert("bufferrefills", QString::number(readahead.m_refills));
+    infoMap.insert("bufferuse",     QString("%1%").arg(readahead.m_occupancy));
     int avsync = m_avsyncAvg / 1000;
     infoMap.insert("avsync", tr("%1 ms").arg(avsync));
 
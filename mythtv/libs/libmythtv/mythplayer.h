@@ -97,6 +97,7 @@ enum PlayerFlags
     kDecodeAllowGPU       = 0x000040, // VDPAU, VAAPI, DXVA2
     kDecodeAllowEXT       = 0x000080, // VDA, CrystalHD
     kVideoIsNull          = 0x000100,
+    kDecodeHalfSizeHD     = 0x000400, // Half size MPEG-2 HD, for frame analysis
     kAudioMuted           = 0x010000,
     kNoITV                = 0x020000,
     kMusicChoice          = 0x040000,
@@ -15,6 +15,7 @@ using namespace std;
 #include "channelutil.h"
 #include "mythdb.h"
 #include "mythlogging.h"
+#include "mythtimer.h"
 #include "dvbdescriptors.h"
 
 #define LOC      QString("ProgramData: ")
@@ -37,6 +38,25 @@ static QVariant denullify(const QDateTime &dt)
     return dt.isNull() ? QVariant("0000-00-00 00:00:00") : QVariant(dt);
 }
 
+static void add_ratings(MSqlQuery &query, const QList<EventRating> &ratings,
+                        uint chanid, const QDateTime &starttime)
+{
+    for (const auto & rating : qAsConst(ratings))
+    {
+        query.prepare(
+            "INSERT IGNORE INTO programrating "
+            "       ( chanid, starttime, `system`, rating) "
+            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
+        query.bindValue(":CHANID", chanid);
+        query.bindValue(":START",  starttime);
+        query.bindValue(":SYS",    rating.m_system);
+        query.bindValue(":RATING", rating.m_rating);
+
+        if (!query.exec())
+            MythDB::DBError("programrating insert", query);
+    }
+}
+
 static void add_genres(MSqlQuery &query, const QStringList &genres,
                 uint chanid, const QDateTime &starttime)
 {
@@ -164,6 +184,12 @@ uint DBPerson::InsertCreditsDB(MSqlQuery &query, uint personid, uint chanid,
     return 0;
 }
 
+DBEvent::DBEvent(const DBEvent &other) :
+    m_listingsource(other.m_listingsource)
+{
+    *this = other;
+}
+
 DBEvent &DBEvent::operator=(const DBEvent &other)
 {
     if (this == &other)
@@ -333,6 +359,76 @@ uint DBEvent::UpdateDB(
     return UpdateDB(query, chanid, programs, -1);
 }
 
+static const char *kProgramColumns =
+    "SELECT title,          subtitle,      description, "
+    "       category,       category_type, "
+    "       starttime,      endtime, "
+    "       subtitletypes+0,audioprop+0,   videoprop+0, "
+    "       seriesid,       programid, "
+    "       partnumber,     parttotal, "
+    "       syndicatedepisodenumber, "
+    "       airdate,        originalairdate, "
+    "       previouslyshown,listingsource, "
+    "       stars+0, "
+    "       season,         episode,       totalepisodes, "
+    "       inetref "
+    "FROM program ";
+
+// Read the program rows selected with kProgramColumns.
+static uint read_programs(MSqlQuery &query, vector<DBEvent> &programs)
+{
+    uint count = 0;
+    while (query.next())
+    {
+        ProgramInfo::CategoryType category_type =
+            string_to_myth_category_type(query.value(4).toString());
+
+        DBEvent prog(
+            query.value(0).toString(),
+            query.value(1).toString(),
+            query.value(2).toString(),
+            query.value(3).toString(),
+            category_type,
+            MythDate::as_utc(query.value(5).toDateTime()),
+            MythDate::as_utc(query.value(6).toDateTime()),
+            query.value(7).toUInt(),
+            query.value(8).toUInt(),
+            query.value(9).toUInt(),
+            query.value(19).toDouble(),
+            query.value(10).toString(),
+            query.value(11).toString(),
+            query.value(18).toUInt(),
+            query.value(20).toUInt(),  // Season
+            query.value(21).toUInt(),  // Episode
+            query.value(22).toUInt()); // Total Episodes
+
+        prog.m_inetref    = query.value(23).toString();
+        prog.m_partnumber = query.value(12).toUInt();
+        prog.m_parttotal  = query.value(13).toUInt();
+        prog.m_syndicatedepisodenumber = query.value(14).toString();
+        prog.m_airdate    = query.value(15).toUInt();
+        prog.m_originalairdate  = query.value(16).toDate();
+        prog.m_previouslyshown  = query.value(17).toBool();
+
+        programs.push_back(prog);
+        count++;
+    }
+
+    return count;
+}
+
+// The in-memory version of the overlap conditions used in
+// GetOverlappingPrograms(); "prog" overlaps with "event".
+static bool is_overlapping(const DBEvent &event, const DBEvent &prog)
+{
+    return ((prog.m_starttime >= event.m_starttime &&
+             prog.m_starttime <  event.m_endtime) ||
+            (prog.m_endtime   >  event.m_starttime &&
+             prog.m_endtime   <= event.m_endtime) ||
+            (prog.m_starttime <  event.m_starttime &&
+             prog.m_endtime   >  event.m_endtime));
+}
+
 // Get all programs in the database that overlap with our new program.
 // We check for three ways in which we can have an overlap:
 // (1)   Start of old program is inside our new program:
@@ -359,21 +455,8 @@ uint DBEvent::UpdateDB(
 uint DBEvent::GetOverlappingPrograms(
     MSqlQuery &query, uint chanid, vector<DBEvent> &programs) const
 {
-    uint count = 0;
     query.prepare(
-        "SELECT title,          subtitle,      description, "
-        "       category,       category_type, "
-        "       starttime,      endtime, "
-        "       subtitletypes+0,audioprop+0,   videoprop+0, "
-        "       seriesid,       programid, "
-        "       partnumber,     parttotal, "
-        "       syndicatedepisodenumber, "
-        "       airdate,        originalairdate, "
-        "       previouslyshown,listingsource, "
-        "       stars+0, "
-        "       season,         episode,       totalepisodes, "
-        "       inetref "
-        "FROM program "
+        QString(kProgramColumns) +
         "WHERE chanid   = :CHANID AND "
         "      manualid = 0       AND "
         "      ( ( starttime >= :STIME1 AND starttime <  :ETIME1 ) OR "
@@ -393,43 +476,7 @@ uint DBEvent::GetOverlappingPrograms(
         return 0;
     }
 
-    while (query.next())
-    {
-        ProgramInfo::CategoryType category_type =
-            string_to_myth_category_type(query.value(4).toString());
-
-        DBEvent prog(
-            query.value(0).toString(),
-            query.value(1).toString(),
-            query.value(2).toString(),
-            query.value(3).toString(),
-            category_type,
-            MythDate::as_utc(query.value(5).toDateTime()),
-            MythDate::as_utc(query.value(6).toDateTime()),
-            query.value(7).toUInt(),
-            query.value(8).toUInt(),
-            query.value(9).toUInt(),
-            query.value(19).toDouble(),
-            query.value(10).toString(),
-            query.value(11).toString(),
-            query.value(18).toUInt(),
-            query.value(20).toUInt(),  // Season
-            query.value(21).toUInt(),  // Episode
-            query.value(22).toUInt()); // Total Episodes
-
-        prog.m_inetref    = query.value(23).toString();
-        prog.m_partnumber = query.value(12).toUInt();
-        prog.m_parttotal  = query.value(13).toUInt();
-        prog.m_syndicatedepisodenumber = query.value(14).toString();
-        prog.m_airdate    = query.value(15).toUInt();
-        prog.m_originalairdate  = query.value(16).toDate();
-        prog.m_previouslyshown  = query.value(17).toBool();
-
-        programs.push_back(prog);
-        count++;
-    }
-
-    return count;
+    return read_programs(query, programs);
 }
 
 
@@ -675,21 +722,69 @@ static int change_record(MSqlQuery &query, uint chanid,
     return rows;
 }
 
+// Combine our new program data with the matching program; fields we
+// do not know keep the value they have in the database.
+//
+DBEvent DBEvent::MergedWith(const DBEvent &match) const
+{
+    DBEvent merged(m_listingsource | match.m_listingsource);
+
+    merged.m_title       = m_title.isEmpty()       ? match.m_title       : m_title;
+    merged.m_subtitle    = m_subtitle.isEmpty()    ? match.m_subtitle    : m_subtitle;
+    merged.m_description = m_description.isEmpty() ? match.m_description : m_description;
+    merged.m_category    = m_category.isEmpty()    ? match.m_category    : m_category;
+    merged.m_starttime   = m_starttime;
+    merged.m_endtime     = m_endtime;
+    merged.m_airdate     = m_airdate ? m_airdate : match.m_airdate;
+    merged.m_originalairdate = m_originalairdate.isValid() ?
+        m_originalairdate : match.m_originalairdate;
+    merged.m_programId   = m_programId.isEmpty()   ? match.m_programId   : m_programId;
+    merged.m_seriesId    = m_seriesId.isEmpty()    ? match.m_seriesId    : m_seriesId;
+    merged.m_inetref     = m_inetref.isEmpty()     ? match.m_inetref     : m_inetref;
+
+    merged.m_categoryType = m_categoryType;
+    if (!m_categoryType && match.m_categoryType)
+        merged.m_categoryType = match.m_categoryType;
+
+    merged.m_subtitleType = m_subtitleType | match.m_subtitleType;
+    merged.m_audioProps   = m_audioProps   | match.m_audioProps;
+    merged.m_videoProps   = m_videoProps   | match.m_videoProps;
+    merged.m_stars        = m_stars;
+
+    merged.m_season        = match.m_season;
+    merged.m_episode       = match.m_episode;
+    merged.m_totalepisodes = match.m_totalepisodes;
+
+    if (m_season || m_episode || m_totalepisodes)
+    {
+        merged.m_season        = m_season;
+        merged.m_episode       = m_episode;
+        merged.m_totalepisodes = m_totalepisodes;
+    }
+
+    merged.m_partnumber = match.m_partnumber;
+    merged.m_parttotal  = match.m_parttotal;
+
+    if (m_partnumber || m_parttotal)
+    {
+        merged.m_partnumber = m_partnumber;
+        merged.m_parttotal  = m_parttotal;
+    }
+
+    merged.m_previouslyshown = m_previouslyshown || match.m_previouslyshown;
+
+    merged.m_syndicatedepisodenumber = m_syndicatedepisodenumber;
+    if (merged.m_syndicatedepisodenumber.isEmpty())
+        merged.m_syndicatedepisodenumber = match.m_syndicatedepisodenumber;
+
+    return merged;
+}
+
 // Update matched item with current data.
 //
 uint DBEvent::UpdateDB(
     MSqlQuery &query, uint chanid, const DBEvent &match)  const
 {
-    QString  ltitle           = m_title;
-    QString  lsubtitle        = m_subtitle;
-    QString  ldesc            = m_description;
-    QString  lcategory        = m_category;
-    uint16_t lairdate         = m_airdate;
-    QString  lprogramId       = m_programId;
-    QString  lseriesId        = m_seriesId;
-    QString  linetref         = m_inetref;
-    QDate    loriginalairdate = m_originalairdate;
-
     // Update starttime also in database table record so that
     // tables program and record remain consistent.
     if (m_starttime != match.m_starttime)
@@ -706,71 +801,8 @@ uint DBEvent::UpdateDB(
                     .arg(m_title.left(35)));
     }
 
-    if (ltitle.isEmpty() && !match.m_title.isEmpty())
-        ltitle = match.m_title;
-
-    if (lsubtitle.isEmpty() && !match.m_subtitle.isEmpty())
-        lsubtitle = match.m_subtitle;
-
-    if (ldesc.isEmpty() && !match.m_description.isEmpty())
-        ldesc = match.m_description;
-
-    if (lcategory.isEmpty() && !match.m_category.isEmpty())
-        lcategory = match.m_category;
-
-    if (!lairdate && match.m_airdate)
-        lairdate = match.m_airdate;
-
-    if (!loriginalairdate.isValid() && match.m_originalairdate.isValid())
-        loriginalairdate = match.m_originalairdate;
-
-    if (lprogramId.isEmpty() && !match.m_programId.isEmpty())
-        lprogramId = match.m_programId;
-
-    if (lseriesId.isEmpty() && !match.m_seriesId.isEmpty())
-        lseriesId = match.m_seriesId;
-
-    if (linetref.isEmpty() && !match.m_inetref.isEmpty())
-        linetref= match.m_inetref;
-
-    ProgramInfo::CategoryType tmp = m_categoryType;
-    if (!m_categoryType && match.m_categoryType)
-        tmp = match.m_categoryType;
-
-    QString lcattype = myth_category_type_to_string(tmp);
-
-    unsigned char lsubtype = m_subtitleType | match.m_subtitleType;
-    unsigned char laudio   = m_audioProps   | match.m_audioProps;
-    unsigned char lvideo   = m_videoProps   | match.m_videoProps;
-
-    uint lseason = match.m_season;
-    uint lepisode = match.m_episode;
-    uint lepisodeTotal = match.m_totalepisodes;
-
-    if (m_season || m_episode || m_totalepisodes)
-    {
-        lseason = m_season;
-        lepisode = m_episode;
-        lepisodeTotal = m_totalepisodes;
-    }
-
-    uint lpartnumber = match.m_partnumber;
-    uint lparttotal = match.m_parttotal;
-
-    if (m_partnumber || m_parttotal)
-    {
-        lpartnumber = m_partnumber;
-        lparttotal  = m_parttotal;
-    }
-
-    bool lpreviouslyshown = m_previouslyshown || match.m_previouslyshown;
-
-    uint32_t llistingsource = m_listingsource | match.m_listingsource;
-
-    QString lsyndicatedepisodenumber = m_syndicatedepisodenumber;
-    if (lsyndicatedepisodenumber.isEmpty() &&
-        !match.m_syndicatedepisodenumber.isEmpty())
-        lsyndicatedepisodenumber = match.m_syndicatedepisodenumber;
+    DBEvent merged = MergedWith(match);
+    QString lcattype = myth_category_type_to_string(merged.m_categoryType);
 
     query.prepare(
         "UPDATE program "
@@ -795,33 +827,34 @@ uint DBEvent::UpdateDB(
 
     query.bindValue(":CHANID",      chanid);
     query.bindValue(":OLDSTART",    match.m_starttime);
-    query.bindValue(":TITLE",       denullify(ltitle));
-    query.bindValue(":SUBTITLE",    denullify(lsubtitle));
-    query.bindValue(":DESC",        denullify(ldesc));
-    query.bindValue(":CATEGORY",    denullify(lcategory));
+    query.bindValue(":TITLE",       denullify(merged.m_title));
+    query.bindValue(":SUBTITLE",    denullify(merged.m_subtitle));
+    query.bindValue(":DESC",        denullify(merged.m_description));
+    query.bindValue(":CATEGORY",    denullify(merged.m_category));
     query.bindValue(":CATTYPE",     lcattype);
-    query.bindValue(":STARTTIME",   m_starttime);
-    query.bindValue(":ENDTIME",     m_endtime);
-    query.bindValue(":CC",          (lsubtype & SUB_HARDHEAR) != 0);
-    query.bindValue(":HASSUBTITLES",(lsubtype & SUB_NORMAL) != 0);
-    query.bindValue(":STEREO",      (laudio   & AUD_STEREO) != 0);
-    query.bindValue(":HDTV",        (lvideo   & VID_HDTV) != 0);
-    query.bindValue(":SUBTYPE",     lsubtype);
-    query.bindValue(":AUDIOPROP",   laudio);
-    query.bindValue(":VIDEOPROP",   lvideo);
-    query.bindValue(":SEASON",      lseason);
-    query.bindValue(":EPISODE",     lepisode);
-    query.bindValue(":TOTALEPS",    lepisodeTotal);
-    query.bindValue(":PARTNO",      lpartnumber);
-    query.bindValue(":PARTTOTAL",   lparttotal);
-    query.bindValue(":SYNDICATENO", denullify(lsyndicatedepisodenumber));
-    query.bindValue(":AIRDATE",     lairdate ? QString::number(lairdate) : "0000");
-    query.bindValue(":ORIGAIRDATE", loriginalairdate);
-    query.bindValue(":LSOURCE",     llistingsource);
-    query.bindValue(":SERIESID",    denullify(lseriesId));
-    query.bindValue(":PROGRAMID",   denullify(lprogramId));
-    query.bindValue(":PREVSHOWN",   lpreviouslyshown);
-    query.bindValue(":INETREF",     linetref);
+    query.bindValue(":STARTTIME",   merged.m_starttime);
+    query.bindValue(":ENDTIME",     merged.m_endtime);
+    query.bindValue(":CC",          (merged.m_subtitleType & SUB_HARDHEAR) != 0);
+    query.bindValue(":HASSUBTITLES",(merged.m_subtitleType & SUB_NORMAL) != 0);
+    query.bindValue(":STEREO",      (merged.m_audioProps   & AUD_STEREO) != 0);
+    query.bindValue(":HDTV",        (merged.m_videoProps   & VID_HDTV) != 0);
+    query.bindValue(":SUBTYPE",     merged.m_subtitleType);
+    query.bindValue(":AUDIOPROP",   merged.m_audioProps);
+    query.bindValue(":VIDEOPROP",   merged.m_videoProps);
+    query.bindValue(":SEASON",      merged.m_season);
+    query.bindValue(":EPISODE",     merged.m_episode);
+    query.bindValue(":TOTALEPS",    merged.m_totalepisodes);
+    query.bindValue(":PARTNO",      merged.m_partnumber);
+    query.bindValue(":PARTTOTAL",   merged.m_parttotal);
+    query.bindValue(":SYNDICATENO", denullify(merged.m_syndicatedepisodenumber));
+    query.bindValue(":AIRDATE",     merged.m_airdate ?
+                    QString::number(merged.m_airdate) : "0000");
+    query.bindValue(":ORIGAIRDATE", merged.m_originalairdate);
+    query.bindValue(":LSOURCE",     merged.m_listingsource);
+    query.bindValue(":SERIESID",    denullify(merged.m_seriesId));
+    query.bindValue(":PROGRAMID",   denullify(merged.m_programId));
+    query.bindValue(":PREVSHOWN",   merged.m_previouslyshown);
+    query.bindValue(":INETREF",     merged.m_inetref);
 
     if (!query.exec())
     {
@@ -835,20 +868,7 @@ uint DBEvent::UpdateDB(
             credit.InsertDB(query, chanid, m_starttime);
     }
 
-    for (const auto & rating : qAsConst(m_ratings))
-    {
-        query.prepare(
-            "INSERT IGNORE INTO programrating "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    add_ratings(query, m_ratings, chanid, m_starttime);
 
     add_genres(query, m_genres, chanid, m_starttime);
 
@@ -1136,20 +1156,7 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
         return 0;
     }
 
-    for (const auto & rating : qAsConst(m_ratings))
-    {
-        query.prepare(
-            "INSERT IGNORE INTO programrating "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    add_ratings(query, m_ratings, chanid, m_starttime);
 
     if (m_credits)
     {
@@ -1162,6 +1169,384 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
     return 1;
 }
 
+const uint DBEventBatch::kRowsPerStatement = 100;
+
+DBEventBatchStats &DBEventBatchStats::operator+=(const DBEventBatchStats &other)
+{
+    m_events     += other.m_events;
+    m_past       += other.m_past;
+    m_inserted   += other.m_inserted;
+    m_updated    += other.m_updated;
+    m_unchanged  += other.m_unchanged;
+    m_perEvent   += other.m_perEvent;
+    m_snapshots  += other.m_snapshots;
+    m_statements += other.m_statements;
+    m_elapsed    += other.m_elapsed;
+    return *this;
+}
+
+QString DBEventBatchStats::toString(void) const
+{
+    double secs = m_elapsed * 0.001;
+    return QString(
+        "Events:%1 Past:%2 Inserted:%3 Updated:%4 Unchanged:%5 "
+        "Per-event:%6 Snapshots:%7 Statements:%8 Events/s:%9")
+        .arg(m_events).arg(m_past).arg(m_inserted).arg(m_updated)
+        .arg(m_unchanged).arg(m_perEvent).arg(m_snapshots).arg(m_statements)
+        .arg((secs > 0.0) ? m_events / secs : 0.0, 0, 'f', 1);
+}
+
+// Compare the columns written by DBEvent::UpdateDB(query, chanid, match).
+static bool is_same_program_row(const DBEvent &a, const DBEvent &b)
+{
+    return (a.m_title                   == b.m_title                   &&
+            a.m_subtitle                == b.m_subtitle                &&
+            a.m_description             == b.m_description             &&
+            a.m_category                == b.m_category                &&
+            a.m_categoryType            == b.m_categoryType            &&
+            a.m_starttime               == b.m_starttime               &&
+            a.m_endtime                 == b.m_endtime                 &&
+            a.m_subtitleType            == b.m_subtitleType            &&
+            a.m_audioProps              == b.m_audioProps              &&
+            a.m_videoProps              == b.m_videoProps              &&
+            a.m_season                  == b.m_season                  &&
+            a.m_episode                 == b.m_episode                 &&
+            a.m_totalepisodes           == b.m_totalepisodes           &&
+            a.m_partnumber              == b.m_partnumber              &&
+            a.m_parttotal               == b.m_parttotal               &&
+            a.m_syndicatedepisodenumber == b.m_syndicatedepisodenumber &&
+            a.m_airdate                 == b.m_airdate                 &&
+            a.m_originalairdate         == b.m_originalairdate         &&
+            a.m_listingsource           == b.m_listingsource           &&
+            a.m_seriesId                == b.m_seriesId                &&
+            a.m_programId               == b.m_programId               &&
+            a.m_previouslyshown         == b.m_previouslyshown         &&
+            a.m_inetref                 == b.m_inetref);
+}
+
+void DBEventBatch::AddEvent(uint chanid, const DBEvent *event)
+{
+    m_channels[chanid].push_back(event);
+    m_stats.m_events++;
+}
+
+/** \fn DBEventBatch::WriteToDB(MSqlQuery&)
+ *  \brief Writes all events added since the last call.
+ *
+ *   The batch is written inside one transaction; with the default
+ *   MyISAM tables this only saves the multi-row statements.
+ *
+ *  \return Number of programs inserted or updated, as DBEvent::UpdateDB().
+ */
+uint DBEventBatch::WriteToDB(MSqlQuery &query)
+{
+    if (m_channels.empty())
+        return 0;
+
+    MythTimer t;
+    t.start();
+
+    bool transaction = query.exec("START TRANSACTION");
+
+    uint count = 0;
+    for (auto it = m_channels.begin(); it != m_channels.end(); ++it)
+        count += WriteChannelToDB(query, it.key(), *it);
+    Flush(query);
+
+    if (transaction && !query.exec("COMMIT"))
+        MythDB::DBError("DBEventBatch commit", query);
+
+    m_channels.clear();
+    m_stats.m_elapsed += t.elapsed();
+
+    return count;
+}
+
+uint DBEventBatch::WriteChannelToDB(
+    MSqlQuery &query, uint chanid, vector<const DBEvent*> &events)
+{
+    // Do not insert or update programs that are in the past
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    auto past = [&now](const DBEvent *event) { return event->m_endtime < now; };
+    auto last = std::remove_if(events.begin(), events.end(), past);
+    m_stats.m_past += events.end() - last;
+    events.erase(last, events.end());
+
+    if (events.empty())
+        return 0;
+
+    // The events are applied in the order they arrived, a later
+    // event for the same time slot replaces an earlier one.
+    QDateTime start = events.front()->m_starttime;
+    QDateTime end   = events.front()->m_endtime;
+    for (const auto *event : events)
+    {
+        start = min(start, event->m_starttime);
+        end   = max(end,   event->m_endtime);
+    }
+
+    vector<DBEvent> snapshot;
+    bool have_snapshot = LoadSnapshot(query, chanid, start, end, snapshot);
+
+    uint count = 0;
+    for (const auto *event : events)
+    {
+        if (!have_snapshot)
+        {
+            count += event->UpdateDB(query, chanid, m_matchThreshold);
+            m_stats.m_perEvent++;
+            continue;
+        }
+
+        LOG(VB_EIT, LOG_DEBUG,
+            QString("EIT: new program: %1 %2 '%3' chanid %4")
+                    .arg(event->m_starttime.toString(Qt::ISODate))
+                    .arg(event->m_endtime.toString(Qt::ISODate))
+                    .arg(event->m_title.left(35))
+                    .arg(chanid));
+
+        vector<DBEvent> programs;
+        vector<size_t>  rows;
+        for (size_t j = 0; j < snapshot.size(); j++)
+        {
+            if (is_overlapping(*event, snapshot[j]))
+            {
+                programs.push_back(snapshot[j]);
+                rows.push_back(j);
+            }
+        }
+
+        if (programs.empty())
+        {
+            LOG(VB_EIT, LOG_DEBUG,
+                QString("EIT: insert '%1'").arg(event->m_title.left(35)));
+            // Merging with an empty program gives our own column values.
+            DBEvent row = event->MergedWith(DBEvent(event->m_listingsource));
+            snapshot.push_back(row);
+            QueueRow(chanid, row, event);
+            m_stats.m_inserted++;
+            count++;
+            continue;
+        }
+
+        int i     = -1;
+        int match = event->GetMatch(programs, i);
+
+        if (match >= m_matchThreshold && programs.size() == 1 &&
+            programs[0].m_starttime == event->m_starttime)
+        {
+            DBEvent row = event->MergedWith(programs[0]);
+            if (is_same_program_row(row, programs[0]))
+            {
+                LOG(VB_EIT, LOG_DEBUG,
+                    QString("EIT: unchanged '%1'")
+                            .arg(event->m_title.left(35)));
+                // The row is left alone, but the per-event code would still
+                // add the credits, ratings and genres the event carries.
+                if (!event->m_ratings.isEmpty() || !event->m_genres.isEmpty() ||
+                    (event->m_credits && !event->m_credits->empty()))
+                {
+                    m_pendingExtras.emplace_back(chanid, event);
+                }
+                m_stats.m_unchanged++;
+                continue;
+            }
+
+            LOG(VB_EIT, LOG_DEBUG,
+                QString("EIT: update '%1' with '%2'")
+                        .arg(programs[0].m_title.left(35))
+                        .arg(event->m_title.left(35)));
+            snapshot[rows[0]] = row;
+            QueueRow(chanid, row, event);
+            m_stats.m_updated++;
+            count++;
+            continue;
+        }
+
+        // Everything else moves other programs around, which is left
+        // to the per-event code working on the database itself.
+        Flush(query);
+        count += event->UpdateDB(query, chanid, programs,
+                                 (match >= m_matchThreshold) ? i : -1);
+        m_stats.m_perEvent++;
+
+        snapshot.clear();
+        have_snapshot = LoadSnapshot(query, chanid, start, end, snapshot);
+    }
+
+    return count;
+}
+
+bool DBEventBatch::LoadSnapshot(
+    MSqlQuery &query, uint chanid,
+    const QDateTime &start, const QDateTime &end,
+    vector<DBEvent> &snapshot)
+{
+    // A superset of the overlaps of all events in [start, end],
+    // is_overlapping() picks the ones for each event.
+    query.prepare(
+        QString(kProgramColumns) +
+        "WHERE chanid    = :CHANID    AND "
+        "      manualid  = 0          AND "
+        "      starttime <= :ENDTIME  AND "
+        "      endtime   >= :STARTTIME");
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":STARTTIME", start);
+    query.bindValue(":ENDTIME",   end);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("DBEventBatch::LoadSnapshot", query);
+        return false;
+    }
+
+    read_programs(query, snapshot);
+    m_stats.m_snapshots++;
+
+    return true;
+}
+
+void DBEventBatch::QueueRow(uint chanid, const DBEvent &row,
+                            const DBEvent *event)
+{
+    m_pending.emplace_back(chanid, row);
+    m_pendingExtras.emplace_back(chanid, event);
+}
+
+/** \fn DBEventBatch::Flush(MSqlQuery&)
+ *  \brief Writes the queued rows with multi-row statements, followed by
+ *         the credits, ratings and genres of their events and of the
+ *         events that left their row unchanged.
+ *
+ *   Rows that already exist are updated like DBEvent::UpdateDB() does,
+ *   which leaves the star rating alone; new rows are inserted like
+ *   DBEvent::InsertDB().
+ */
+void DBEventBatch::Flush(MSqlQuery &query)
+{
+    for (size_t first = 0; first < m_pending.size(); first += kRowsPerStatement)
+    {
+        size_t last = min(first + kRowsPerStatement, m_pending.size());
+
+        QStringList  value_clauses;
+        MSqlBindings bindings;
+        for (size_t i = first; i < last; i++)
+        {
+            const DBEvent &row = m_pending[i].m_row;
+            QString n = QString::number(i - first);
+
+            value_clauses << QString(
+                "(:CHANID%1, :TITLE%1, :SUBTITLE%1, :DESCRIPTION%1, "
+                " :CATEGORY%1, :CATTYPE%1, :STARTTIME%1, :ENDTIME%1, "
+                " :CC%1, :STEREO%1, :HDTV%1, :HASSUBTITLES%1, "
+                " :SUBTYPES%1, :AUDIOPROP%1, :VIDEOPROP%1, "
+                " :STARS%1, :PARTNUMBER%1, :PARTTOTAL%1, :SYNDICATENO%1, "
+                " :AIRDATE%1, :ORIGAIRDATE%1, :LSOURCE%1, "
+                " :SERIESID%1, :PROGRAMID%1, :PREVSHOWN%1, "
+                " :SEASON%1, :EPISODE%1, :TOTALEPISODES%1, :INETREF%1)").arg(n);
+
+            bindings[":CHANID"+n]      = m_pending[i].m_chanid;
+            bindings[":TITLE"+n]       = denullify(row.m_title);
+            bindings[":SUBTITLE"+n]    = denullify(row.m_subtitle);
+            bindings[":DESCRIPTION"+n] = denullify(row.m_description);
+            bindings[":CATEGORY"+n]    = denullify(row.m_category);
+            bindings[":CATTYPE"+n]     =
+                myth_category_type_to_string(row.m_categoryType);
+            bindings[":STARTTIME"+n]   = row.m_starttime;
+            bindings[":ENDTIME"+n]     = row.m_endtime;
+            bindings[":CC"+n]          = (row.m_subtitleType & SUB_HARDHEAR) != 0;
+            bindings[":STEREO"+n]      = (row.m_audioProps   & AUD_STEREO) != 0;
+            bindings[":HDTV"+n]        = (row.m_videoProps   & VID_HDTV) != 0;
+            bindings[":HASSUBTITLES"+n]= (row.m_subtitleType & SUB_NORMAL) != 0;
+            bindings[":SUBTYPES"+n]    = row.m_subtitleType;
+            bindings[":AUDIOPROP"+n]   = row.m_audioProps;
+            bindings[":VIDEOPROP"+n]   = row.m_videoProps;
+            bindings[":STARS"+n]       = row.m_stars;
+            bindings[":PARTNUMBER"+n]  = row.m_partnumber;
+            bindings[":PARTTOTAL"+n]   = row.m_parttotal;
+            bindings[":SYNDICATENO"+n] = denullify(row.m_syndicatedepisodenumber);
+            bindings[":AIRDATE"+n]     = row.m_airdate ?
+                QString::number(row.m_airdate) : "0000";
+            bindings[":ORIGAIRDATE"+n] = row.m_originalairdate;
+            bindings[":LSOURCE"+n]     = row.m_listingsource;
+            bindings[":SERIESID"+n]    = denullify(row.m_seriesId);
+            bindings[":PROGRAMID"+n]   = denullify(row.m_programId);
+            bindings[":PREVSHOWN"+n]   = row.m_previouslyshown;
+            bindings[":SEASON"+n]      = row.m_season;
+            bindings[":EPISODE"+n]     = row.m_episode;
+            bindings[":TOTALEPISODES"+n] = row.m_totalepisodes;
+            bindings[":INETREF"+n]     = row.m_inetref;
+        }
+
+        query.prepare(QString(
+            "INSERT INTO program ("
+            "  chanid,         title,          subtitle,        description, "
+            "  category,       category_type, "
+            "  starttime,      endtime, "
+            "  closecaptioned, stereo,         hdtv,            subtitled, "
+            "  subtitletypes,  audioprop,      videoprop, "
+            "  stars,          partnumber,     parttotal, "
+            "  syndicatedepisodenumber, "
+            "  airdate,        originalairdate,listingsource, "
+            "  seriesid,       programid,      previouslyshown, "
+            "  season,         episode,        totalepisodes, "
+            "  inetref ) "
+            "VALUES %1 "
+            "ON DUPLICATE KEY UPDATE "
+            "  title          = VALUES(title), "
+            "  subtitle       = VALUES(subtitle), "
+            "  description    = VALUES(description), "
+            "  category       = VALUES(category), "
+            "  category_type  = VALUES(category_type), "
+            "  endtime        = VALUES(endtime), "
+            "  closecaptioned = VALUES(closecaptioned), "
+            "  stereo         = VALUES(stereo), "
+            "  hdtv           = VALUES(hdtv), "
+            "  subtitled      = VALUES(subtitled), "
+            "  subtitletypes  = VALUES(subtitletypes), "
+            "  audioprop      = VALUES(audioprop), "
+            "  videoprop      = VALUES(videoprop), "
+            "  partnumber     = VALUES(partnumber), "
+            "  parttotal      = VALUES(parttotal), "
+            "  syndicatedepisodenumber = VALUES(syndicatedepisodenumber), "
+            "  airdate        = VALUES(airdate), "
+            "  originalairdate = VALUES(originalairdate), "
+            "  listingsource  = VALUES(listingsource), "
+            "  seriesid       = VALUES(seriesid), "
+            "  programid      = VALUES(programid), "
+            "  previouslyshown = VALUES(previouslyshown), "
+            "  season         = VALUES(season), "
+            "  episode        = VALUES(episode), "
+            "  totalepisodes  = VALUES(totalepisodes), "
+            "  inetref        = VALUES(inetref)")
+            .arg(value_clauses.join(",")));
+        query.bindValues(bindings);
+
+        if (!query.exec())
+            MythDB::DBError("DBEventBatch::Flush", query);
+        m_stats.m_statements++;
+    }
+
+    for (const auto &pending : m_pendingExtras)
+    {
+        uint           chanid = pending.first;
+        const DBEvent &event  = *pending.second;
+
+        add_ratings(query, event.m_ratings, chanid, event.m_starttime);
+
+        if (event.m_credits)
+        {
+            for (auto & credit : *event.m_credits)
+                credit.InsertDB(query, chanid, event.m_starttime);
+        }
+
+        add_genres(query, event.m_genres, chanid, event.m_starttime);
+    }
+
+    m_pending.clear();
+    m_pendingExtras.clear();
+}
+
 ProgInfo::ProgInfo(const ProgInfo &other) :
     DBEvent(other.m_listingsource)
 {
@@ -1397,6 +1782,9 @@ static bool start_time_less_than(const DBEvent *a, const DBEvent *b)
 
 void ProgramData::FixProgramList(QList<ProgInfo*> &fixlist)
 {
+    if (fixlist.isEmpty())
+        return;
+
     std::stable_sort(fixlist.begin(), fixlist.end(), start_time_less_than);
 
     QList<ProgInfo*>::iterator it = fixlist.begin();
@@ -1488,24 +1876,9 @@ void ProgramData::HandlePrograms(
         if (mapiter.key().isEmpty())
             continue;
 
-        query.prepare(
-            "SELECT chanid "
-            "FROM channel "
-            "WHERE deleted  IS NULL AND "
-            "      sourceid = :ID AND "
-            "      xmltvid  = :XMLTVID");
-        query.bindValue(":ID",      sourceid);
-        query.bindValue(":XMLTVID", mapiter.key());
-
-        if (!query.exec())
-        {
-            MythDB::DBError("ProgramData::HandlePrograms", query);
-            continue;
-        }
-
         vector<uint> chanids;
-        while (query.next())
-            chanids.push_back(query.value(0).toUInt());
+        if (!GetChanIds(query, sourceid, mapiter.key(), chanids))
+            continue;
 
         if (chanids.empty())
         {
@@ -1532,6 +1905,164 @@ void ProgramData::HandlePrograms(
                 .arg(updated) .arg(unchanged));
 }
 
+/**
+ *  \brief Looks up the channels of a video source which take their
+ *         listings from the given XMLTV channel identifier.
+ *
+ *  \return false if the lookup failed, true otherwise (chanids may
+ *          be empty for an unknown identifier)
+ */
+bool ProgramData::GetChanIds(MSqlQuery &query, uint sourceid,
+                             const QString &xmltvid, vector<uint> &chanids)
+{
+    query.prepare(
+        "SELECT chanid "
+        "FROM channel "
+        "WHERE deleted  IS NULL AND "
+        "      sourceid = :ID AND "
+        "      xmltvid  = :XMLTVID");
+    query.bindValue(":ID",      sourceid);
+    query.bindValue(":XMLTVID", xmltvid);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::GetChanIds", query);
+        return false;
+    }
+
+    chanids.clear();
+    while (query.next())
+        chanids.push_back(query.value(0).toUInt());
+
+    return true;
+}
+
+// Existing program rows of one channel, keyed on start time and holding
+// the columns compared by ProgramData::IsUnchanged().
+using ProgSnapshot = QMultiMap<QDateTime, ProgInfo>;
+
+static bool load_prog_snapshot(MSqlQuery &query, uint chanid,
+                               const QList<ProgInfo*> &sortlist,
+                               ProgSnapshot &snapshot)
+{
+    QDateTime first;
+    QDateTime last;
+    for (auto *pinfo : qAsConst(sortlist))
+    {
+        if (!first.isValid() || pinfo->m_starttime < first)
+            first = pinfo->m_starttime;
+        if (!last.isValid() || pinfo->m_starttime > last)
+            last = pinfo->m_starttime;
+    }
+    if (!first.isValid())
+        return true;
+
+    query.prepare(
+        "SELECT starttime,      endtime,        title, "
+        "       subtitle,       description,    category, "
+        "       category_type,  airdate,        stars, "
+        "       previouslyshown,title_pronounce,audioprop+0, "
+        "       videoprop+0,    subtitletypes+0,partnumber, "
+        "       parttotal,      seriesid,       showtype, "
+        "       colorcode,      syndicatedepisodenumber, "
+        "       programid,      season,         episode, "
+        "       totalepisodes,  inetref "
+        "FROM program "
+        "WHERE chanid     = :CHANID AND "
+        "      starttime >= :FIRST  AND "
+        "      starttime <= :LAST");
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":FIRST",  first);
+    query.bindValue(":LAST",   last);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::HandlePrograms snapshot", query);
+        return false;
+    }
+
+    while (query.next())
+    {
+        ProgInfo row;
+        row.m_starttime       = MythDate::as_utc(query.value(0).toDateTime());
+        row.m_endtime         = MythDate::as_utc(query.value(1).toDateTime());
+        row.m_title           = query.value(2).toString();
+        row.m_subtitle        = query.value(3).toString();
+        row.m_description     = query.value(4).toString();
+        row.m_category        = query.value(5).toString();
+        row.m_categoryType    =
+            string_to_myth_category_type(query.value(6).toString());
+        row.m_airdate         = query.value(7).toUInt();
+        row.m_stars           = query.value(8).toFloat();
+        row.m_previouslyshown = query.value(9).toBool();
+        row.m_title_pronounce = query.value(10).toString();
+        row.m_audioProps      = query.value(11).toUInt();
+        row.m_videoProps      = query.value(12).toUInt();
+        row.m_subtitleType    = query.value(13).toUInt();
+        row.m_partnumber      = query.value(14).toUInt();
+        row.m_parttotal       = query.value(15).toUInt();
+        row.m_seriesId        = query.value(16).toString();
+        row.m_showtype        = query.value(17).toString();
+        row.m_colorcode       = query.value(18).toString();
+        row.m_syndicatedepisodenumber = query.value(19).toString();
+        row.m_programId       = query.value(20).toString();
+        row.m_season          = query.value(21).toUInt();
+        row.m_episode         = query.value(22).toUInt();
+        row.m_totalepisodes   = query.value(23).toUInt();
+        row.m_inetref         = query.value(24).toString();
+        snapshot.insert(row.m_starttime, row);
+    }
+
+    return true;
+}
+
+// The text columns of the program table use a case insensitive collation,
+// so the query in ProgramData::IsUnchanged() matches text that only differs
+// in case.  Null and empty strings compare equal, as they are both stored
+// as empty strings.
+static inline bool same_text(const QString &a, const QString &b)
+{
+    return a.compare(b, Qt::CaseInsensitive) == 0;
+}
+
+// In memory equivalent of ProgramData::IsUnchanged().
+static bool is_unchanged(const ProgSnapshot &snapshot, const ProgInfo &pi)
+{
+    auto it = snapshot.constFind(pi.m_starttime);
+    for (; it != snapshot.constEnd() && it.key() == pi.m_starttime; ++it)
+    {
+        const ProgInfo &row = *it;
+        if (row.m_endtime         == pi.m_endtime &&
+            same_text(row.m_title, pi.m_title) &&
+            same_text(row.m_subtitle, pi.m_subtitle) &&
+            same_text(row.m_description, pi.m_description) &&
+            same_text(row.m_category, pi.m_category) &&
+            row.m_categoryType    == pi.m_categoryType &&
+            row.m_airdate         == pi.m_airdate &&
+            qAbs(row.m_stars - pi.m_stars) <= 0.001F &&
+            row.m_previouslyshown == pi.m_previouslyshown &&
+            same_text(row.m_title_pronounce, pi.m_title_pronounce) &&
+            row.m_audioProps      == pi.m_audioProps &&
+            row.m_videoProps      == pi.m_videoProps &&
+            row.m_subtitleType    == pi.m_subtitleType &&
+            row.m_partnumber      == pi.m_partnumber &&
+            row.m_parttotal       == pi.m_parttotal &&
+            same_text(row.m_seriesId, pi.m_seriesId) &&
+            same_text(row.m_showtype, pi.m_showtype) &&
+            same_text(row.m_colorcode, pi.m_colorcode) &&
+            same_text(row.m_syndicatedepisodenumber, pi.m_syndicatedepisodenumber) &&
+            same_text(row.m_programId, pi.m_programId) &&
+            row.m_season          == pi.m_season &&
+            row.m_episode         == pi.m_episode &&
+            row.m_totalepisodes   == pi.m_totalepisodes &&
+            same_text(row.m_inetref, pi.m_inetref))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  *  \brief Called from HandlePrograms to bulk insert data into the
  *  program database.
@@ -1549,9 +2080,16 @@ void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint &unchanged,
                                  uint &updated)
 {
+    // Compare against one snapshot of the channel's existing rows rather
+    // than issuing a query per program; fall back to the per program
+    // query if the snapshot can not be loaded.
+    ProgSnapshot snapshot;
+    bool have_snapshot = load_prog_snapshot(query, chanid, sortlist, snapshot);
+
     for (auto *pinfo : qAsConst(sortlist))
     {
-        if (IsUnchanged(query, chanid, *pinfo))
+        if (have_snapshot ? is_unchanged(snapshot, *pinfo) :
+            IsUnchanged(query, chanid, *pinfo))
         {
             unchanged++;
             continue;
@@ -105,6 +105,8 @@ class MTV_PUBLIC DBEvent
     {
     }
 
+    DBEvent(const DBEvent &other);
+
     virtual ~DBEvent() { delete m_credits; }
 
     void AddPerson(DBPerson::Role role, const QString &name);
@@ -118,6 +120,8 @@ class MTV_PUBLIC DBEvent
     DBEvent &operator=(const DBEvent &other);
 
   protected:
+    friend class DBEventBatch;
+
     uint GetOverlappingPrograms(
         MSqlQuery &query, uint chanid, vector<DBEvent> &programs) const;
     int  GetMatch(
@@ -126,6 +130,7 @@ class MTV_PUBLIC DBEvent
         MSqlQuery &q, uint chanid, const vector<DBEvent> &p, int match) const;
     uint UpdateDB(
         MSqlQuery &query, uint chanid, const DBEvent &match) const;
+    DBEvent MergedWith(const DBEvent &match) const;
     bool MoveOutOfTheWayDB(
         MSqlQuery &query, uint chanid, const DBEvent &prog) const;
     virtual uint InsertDB(MSqlQuery &query, uint chanid) const;
@@ -210,6 +215,82 @@ class MTV_PUBLIC DBEventEIT : public DBEvent
     QMap<QString,QString> m_items;
 };
 
+/** \class DBEventBatchStats
+ *  \brief Throughput counters for DBEventBatch.
+ */
+class MTV_PUBLIC DBEventBatchStats
+{
+  public:
+    DBEventBatchStats &operator+=(const DBEventBatchStats &other);
+    QString toString(void) const;
+
+    uint    m_events     {0}; ///< events handed to the batch
+    uint    m_past       {0}; ///< events skipped because they have ended
+    uint    m_inserted   {0}; ///< rows inserted by multi-row statements
+    uint    m_updated    {0}; ///< rows updated by multi-row statements
+    uint    m_unchanged  {0}; ///< events matching their row exactly
+    uint    m_perEvent   {0}; ///< events written with DBEvent::UpdateDB()
+    uint    m_snapshots  {0}; ///< program snapshots loaded
+    uint    m_statements {0}; ///< multi-row statements issued
+    qint64  m_elapsed    {0}; ///< msec spent writing
+};
+
+/** \class DBEventBatch
+ *  \brief Writes a batch of EIT events to the program table.
+ *
+ *   The events of each channel are matched in memory against a single
+ *   snapshot of the program rows they span, instead of a SELECT per
+ *   event.  New programs and programs updated in place are written with
+ *   multi-row INSERT ... ON DUPLICATE KEY UPDATE statements and events
+ *   which would not change their row only have their credits, ratings
+ *   and genres written, as DBEvent::UpdateDB() would.  Events
+ *   that require other programs to be moved out of the way, or that move
+ *   the program they match, are written with DBEvent::UpdateDB() and the
+ *   snapshot is reloaded afterwards.
+ *
+ *   The events are owned by the caller and must outlive WriteToDB().
+ */
+class MTV_PUBLIC DBEventBatch
+{
+  public:
+    explicit DBEventBatch(int match_threshold) :
+        m_matchThreshold(match_threshold) {}
+
+    void AddEvent(uint chanid, const DBEvent *event);
+    uint WriteToDB(MSqlQuery &query);
+
+    const DBEventBatchStats &GetStats(void) const { return m_stats; }
+
+  private:
+    uint WriteChannelToDB(MSqlQuery &query, uint chanid,
+                          vector<const DBEvent*> &events);
+    bool LoadSnapshot(MSqlQuery &query, uint chanid,
+                      const QDateTime &start, const QDateTime &end,
+                      vector<DBEvent> &snapshot);
+    void QueueRow(uint chanid, const DBEvent &row, const DBEvent *event);
+    void Flush(MSqlQuery &query);
+
+    class PendingRow
+    {
+      public:
+        PendingRow(uint chanid, DBEvent row) :
+            m_chanid(chanid), m_row(std::move(row)) {}
+
+        uint           m_chanid;
+        DBEvent        m_row;   ///< column values to write
+    };
+
+    int                                 m_matchThreshold;
+    QMap<uint, vector<const DBEvent*> > m_channels;
+    vector<PendingRow>                  m_pending;
+    /// Events whose credits, ratings and genres are still to be written
+    vector<pair<uint, const DBEvent*> > m_pendingExtras;
+    DBEventBatchStats                   m_stats;
+
+    /// Maximum number of rows per multi-row statement.
+    static const uint kRowsPerStatement;
+};
+
 class MTV_PUBLIC ProgInfo : public DBEvent
 {
   public:
@@ -241,6 +322,13 @@ class MTV_PUBLIC ProgramData
   public:
     static void HandlePrograms(uint sourceid,
                                QMap<QString, QList<ProgInfo> > &proglist);
+    static bool GetChanIds(MSqlQuery &query, uint sourceid,
+                           const QString &xmltvid, vector<uint> &chanids);
+    static void FixProgramList(QList<ProgInfo*> &fixlist);
+    static void HandlePrograms(
+        MSqlQuery &query, uint chanid,
+        const QList<ProgInfo*> &sortlist,
+        uint &unchanged, uint &updated);
 
     static int  fix_end_times(void);
     static bool ClearDataByChannel(
@@ -255,11 +343,6 @@ class MTV_PUBLIC ProgramData
         bool use_channel_time_offset);
 
   private:
-    static void FixProgramList(QList<ProgInfo*> &fixlist);
-    static void HandlePrograms(
-        MSqlQuery &query, uint chanid,
-        const QList<ProgInfo*> &sortlist,
-        uint &unchanged, uint &updated);
     static bool IsUnchanged(
         MSqlQuery &query, uint chanid, const ProgInfo &pi);
     static bool DeleteOverlaps(
@@ -10,11 +10,9 @@ using namespace std;
 
 #ifndef _WIN32
 #include <sys/poll.h>
+#include <sys/uio.h>
 #endif
 
-/// Set this to 1 to report on statistics
-#define REPORT_RING_STATS 0
-
 #define LOC QString("DevRdB(%1): ").arg(m_videoDevice)
 
 DeviceReadBuffer::DeviceReadBuffer(
@@ -95,6 +93,10 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
     m_avgBufWriteCnt = 0;
     m_avgBufReadCnt  = 0;
     m_avgBufSleepCnt = 0;
+    m_devReadCnt     = 0;
+    m_devReadBytes   = 0;
+    m_devReadMax     = 0;
+    m_pollCnt        = 0;
     m_lastReport.start();
 
     LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB").arg(m_size/1024));
@@ -280,11 +282,12 @@ void DeviceReadBuffer::IncrWritePointer(uint len)
     m_used     += len;
     m_writePtr += len;
     m_writePtr  = (m_writePtr >= m_endPtr) ? m_buffer + (m_writePtr - m_endPtr) : m_writePtr;
-#if REPORT_RING_STATS
-    m_maxUsed = max(m_used, m_maxUsed);
-    m_avgUsed = ((m_avgUsed * m_avgBufWriteCnt) + m_used) / (m_avgBufWriteCnt+1);
-    ++m_avgBufWriteCnt;
-#endif
+    if (VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
+    {
+        m_maxUsed = max(m_used, m_maxUsed);
+        m_avgUsed = ((m_avgUsed * m_avgBufWriteCnt) + m_used) / (m_avgBufWriteCnt+1);
+        ++m_avgBufWriteCnt;
+    }
     m_dataWait.wakeAll();
 }
 
@@ -294,9 +297,8 @@ void DeviceReadBuffer::IncrReadPointer(uint len)
     m_used    -= len;
     m_readPtr += len;
     m_readPtr  = (m_readPtr == m_endPtr) ? m_buffer : m_readPtr;
-#if REPORT_RING_STATS
-    ++m_avgBufReadCnt;
-#endif
+    if (VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
+        ++m_avgBufReadCnt;
 }
 
 void DeviceReadBuffer::run(void)
@@ -327,8 +329,13 @@ void DeviceReadBuffer::run(void)
             continue;
         }
 
-        if (m_usingPoll && !Poll())
-            continue;
+        if (m_usingPoll)
+        {
+            if (!Poll())
+                continue;
+            if (VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
+                ++m_pollCnt;
+        }
 
         {
             QMutexLocker locker(&m_lock);
@@ -351,15 +358,10 @@ void DeviceReadBuffer::run(void)
             // if read_size > 0 do the read...
             if (read_size)
             {
-                len = read(m_streamFd, m_writePtr, read_size);
+                len = ReadDevice(read_size);
                 if (!CheckForErrors(len, read_size, errcnt))
                     break;
                 errcnt = 0;
-
-                // if we wrote past the official end of the buffer,
-                // copy to start
-                if (m_writePtr + len > m_endPtr)
-                    memcpy(m_buffer, m_endPtr, m_writePtr + len - m_endPtr);
                 IncrWritePointer(len);
                 total += len;
             }
@@ -385,6 +387,51 @@ void DeviceReadBuffer::run(void)
     RunEpilog();
 }
 
+/** \fn DeviceReadBuffer::ReadDevice(size_t)
+ *  \brief Reads up to read_size bytes from the device into the ring.
+ *
+ *   When the free space wraps around the end of the ring the read is
+ *   split over both pieces with a single readv(), so the data lands in
+ *   place instead of being copied back from the overflow area.
+ */
+ssize_t DeviceReadBuffer::ReadDevice(size_t read_size)
+{
+    size_t contiguous = m_endPtr - m_writePtr;
+    ssize_t len = 0;
+
+#ifndef _WIN32
+    if (read_size > contiguous)
+    {
+        std::array<struct iovec,2> iov {};
+        iov[0].iov_base = m_writePtr;
+        iov[0].iov_len  = contiguous;
+        iov[1].iov_base = m_buffer;
+        iov[1].iov_len  = read_size - contiguous;
+        len = readv(m_streamFd, iov.data(), iov.size());
+    }
+    else
+    {
+        len = read(m_streamFd, m_writePtr, read_size);
+    }
+#else
+    len = read(m_streamFd, m_writePtr, read_size);
+
+    // if we wrote past the official end of the buffer,
+    // copy to start
+    if ((len > 0) && (static_cast<size_t>(len) > contiguous))
+        memcpy(m_buffer, m_endPtr, len - contiguous);
+#endif
+
+    if ((len > 0) && VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
+    {
+        ++m_devReadCnt;
+        m_devReadBytes += len;
+        m_devReadMax = max(m_devReadMax, static_cast<size_t>(len));
+    }
+
+    return len;
+}
+
 bool DeviceReadBuffer::HandlePausing(void)
 {
     if (IsPauseRequested())
@@ -643,9 +690,7 @@ uint DeviceReadBuffer::Read(unsigned char *buf, const uint count)
         IncrReadPointer(cnt);
     }
 
-#if REPORT_RING_STATS
     ReportStats();
-#endif
 
     return cnt;
 }
@@ -697,9 +742,13 @@ uint DeviceReadBuffer::WaitForUsed(uint needed, uint max_wait) const
     return avail;
 }
 
+/// Logs the ring buffer statistics every 20 seconds with -v record
+/// --loglevel debug, the statistics are only gathered then.
 void DeviceReadBuffer::ReportStats(void)
 {
-#if REPORT_RING_STATS
+    if (!VERBOSE_LEVEL_CHECK(VB_RECORD, LOG_DEBUG))
+        return;
+
     static const int secs = 20;
     static const double d1_s = 1.0 / secs;
     if (m_lastReport.elapsed() > secs * 1000 /* msg every 20 seconds */)
@@ -710,18 +759,27 @@ void DeviceReadBuffer::ReportStats(void)
         msg         += QString("fill max(%1%) ").arg(m_maxUsed*rsize,5,'f',2);
         msg         += QString("writes/sec(%1) ").arg(m_avgBufWriteCnt*d1_s);
         msg         += QString("reads/sec(%1) ").arg(m_avgBufReadCnt*d1_s);
-        msg         += QString("sleeps/sec(%1)").arg(m_avgBufSleepCnt*d1_s);
+        msg         += QString("sleeps/sec(%1) ").arg(m_avgBufSleepCnt*d1_s);
+        msg         += QString("polls/sec(%1) ").arg(m_pollCnt*d1_s);
+        msg         += QString("dev reads/sec(%1) ").arg(m_devReadCnt*d1_s);
+        msg         += QString("dev read avg(%1 KB) ")
+            .arg(m_devReadCnt ? m_devReadBytes / m_devReadCnt / 1024.0 : 0.0,
+                 0, 'f', 1);
+        msg         += QString("dev read max(%1 KB)").arg(m_devReadMax / 1024);
 
         m_avgUsed        = 0;
         m_avgBufWriteCnt = 0;
         m_avgBufReadCnt  = 0;
         m_avgBufSleepCnt = 0;
         m_maxUsed        = 0;
+        m_devReadCnt     = 0;
+        m_devReadBytes   = 0;
+        m_devReadMax     = 0;
+        m_pollCnt        = 0;
         m_lastReport.start();
 
-        LOG(VB_GENERAL, LOG_INFO, LOC + msg);
+        LOG(VB_RECORD, LOG_DEBUG, LOC + msg);
     }
-#endif
 }
 
 /*
@@ -69,6 +69,7 @@ class DeviceReadBuffer : protected MThread
     void IncrReadPointer(uint len);
 
     bool HandlePausing(void);
+    ssize_t ReadDevice(size_t read_size);
     bool Poll(void) const;
     void WakePoll(void) const;
     uint WaitForUnused(uint needed) const;
@@ -123,6 +124,10 @@ class DeviceReadBuffer : protected MThread
     size_t                  m_avgBufWriteCnt        {0};
     size_t                  m_avgBufReadCnt         {0};
     size_t                  m_avgBufSleepCnt        {0};
+    size_t                  m_devReadCnt            {0};
+    size_t                  m_devReadBytes          {0};
+    size_t                  m_devReadMax            {0};
+    size_t                  m_pollCnt               {0};
     MythTimer               m_lastReport;
 };
 
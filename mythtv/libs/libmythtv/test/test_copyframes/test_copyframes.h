@@ -18,6 +18,9 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <chrono>
+#include <iostream>
+
 #include <QtTest/QtTest>
 
 #include "mythcorecontext.h"
@@ -32,6 +35,69 @@ class TestCopyFrames: public QObject
 {
     Q_OBJECT
 
+    /// Bytes of picture in a row of a plane, leaving out the padding
+    static int visible(VideoFrameType type, int width, uint plane)
+    {
+        int bytes = ColorDepth(type) > 8 ? 2 : 1;
+        if (plane == 0)
+            return width * bytes;
+        int chroma = ((width + 1) / 2) * bytes;
+        return format_is_nv12(type) ? chroma * 2 : chroma;
+    }
+
+    static unsigned char* create(VideoFrame &frame, VideoFrameType type,
+                                 int width, int height)
+    {
+        int size = GetBufferSize(type, width, height);
+        auto *buf = (unsigned char*)av_mallocz(size);
+        init(&frame, type, buf, width, height, size);
+        return buf;
+    }
+
+    /// Fills the picture with samples that are valid for the format
+    static void fill(VideoFrame &frame)
+    {
+        int depth = ColorDepth(frame.codec);
+        for (uint plane = 0; plane < planes(frame.codec); plane++)
+        {
+            int rows = height_for_plane(frame.codec, frame.height, plane);
+            int bytes = visible(frame.codec, frame.width, plane);
+            for (int i = 0; i < rows; i++)
+            {
+                unsigned char *row = frame.buf + frame.offsets[plane] + frame.pitches[plane] * i;
+                if (depth == 8)
+                {
+                    for (int j = 0; j < bytes; j++)
+                        row[j] = (i * 7 + j * 13 + plane) % 251;
+                    continue;
+                }
+                auto *samples = reinterpret_cast<uint16_t*>(row);
+                for (int j = 0; j < bytes / 2; j++)
+                {
+                    auto value = static_cast<uint16_t>((i * 7 + j * 13 + plane) % ((1 << depth) - 1));
+                    // P010 holds its 10 bits at the top
+                    samples[j] = format_is_nv12(frame.codec) ? value << (16 - depth) : value;
+                }
+            }
+        }
+    }
+
+    static bool same(const VideoFrame &a, const VideoFrame &b)
+    {
+        for (uint plane = 0; plane < planes(a.codec); plane++)
+        {
+            int rows = height_for_plane(a.codec, a.height, plane);
+            int bytes = visible(a.codec, a.width, plane);
+            for (int i = 0; i < rows; i++)
+            {
+                if (memcmp(a.buf + a.offsets[plane] + a.pitches[plane] * i,
+                           b.buf + b.offsets[plane] + b.pitches[plane] * i, bytes) != 0)
+                    return false;
+            }
+        }
+        return true;
+    }
+
   private slots:
     // called at the beginning of these sets of tests
     static void initTestCase(void)
@@ -1273,6 +1339,107 @@ class TestCopyFrames: public QObject
             }
         }
 
+        av_freep(&bufsrc);
+        av_freep(&bufdst);
+    }
+    static void convert_data(void)
+    {
+        QTest::addColumn<int>("from");
+        QTest::addColumn<int>("to");
+        QTest::addColumn<int>("width");
+        for (int width : { 1920, 1918, 300 })
+        {
+            QByteArray size = QByteArray::number(width);
+            QTest::newRow("NV12 -> YV12 " + size) << (int)FMT_NV12 << (int)FMT_YV12 << width;
+            QTest::newRow("YV12 -> NV12 " + size) << (int)FMT_YV12 << (int)FMT_NV12 << width;
+            QTest::newRow("P010 -> YUV420P10 " + size) << (int)FMT_P010 << (int)FMT_YUV420P10 << width;
+            QTest::newRow("YUV420P10 -> P010 " + size) << (int)FMT_YUV420P10 << (int)FMT_P010 << width;
+            QTest::newRow("P016 -> YUV420P16 " + size) << (int)FMT_P016 << (int)FMT_YUV420P16 << width;
+            QTest::newRow("YUV420P16 -> P016 " + size) << (int)FMT_YUV420P16 << (int)FMT_P016 << width;
+        }
+    }
+
+    // The SIMD conversions must match the C ones, and convert back to the
+    // original
+    static void convert(void)
+    {
+        QFETCH(int, from);
+        QFETCH(int, to);
+        QFETCH(int, width);
+        VideoFrame src {};
+        VideoFrame simd {};
+        VideoFrame purec {};
+        VideoFrame back {};
+        auto *bufsrc   = create(src,   (VideoFrameType)from, width, HEIGHT);
+        auto *bufsimd  = create(simd,  (VideoFrameType)to,   width, HEIGHT);
+        auto *bufpurec = create(purec, (VideoFrameType)to,   width, HEIGHT);
+        auto *bufback  = create(back,  (VideoFrameType)from, width, HEIGHT);
+        fill(src);
+
+        framecopy(&simd, &src, true);
+        framecopy(&purec, &src, false);
+        QVERIFY(same(simd, purec));
+
+        framecopy(&back, &simd, true);
+        QVERIFY(same(back, src));
+
+        av_freep(&bufsrc);
+        av_freep(&bufsimd);
+        av_freep(&bufpurec);
+        av_freep(&bufback);
+    }
+
+    static void throughput_data(void)
+    {
+        QTest::addColumn<int>("from");
+        QTest::addColumn<int>("to");
+        QTest::addColumn<bool>("SIMD");
+        QTest::newRow("YV12 -> YV12")             << (int)FMT_YV12      << (int)FMT_YV12      << true;
+        QTest::newRow("NV12 -> YV12")             << (int)FMT_NV12      << (int)FMT_YV12      << true;
+        QTest::newRow("NV12 -> YV12 Pure C")      << (int)FMT_NV12      << (int)FMT_YV12      << false;
+        QTest::newRow("YV12 -> NV12")             << (int)FMT_YV12      << (int)FMT_NV12      << true;
+        QTest::newRow("YV12 -> NV12 Pure C")      << (int)FMT_YV12      << (int)FMT_NV12      << false;
+        QTest::newRow("P010 -> YUV420P10")        << (int)FMT_P010      << (int)FMT_YUV420P10 << true;
+        QTest::newRow("P010 -> YUV420P10 Pure C") << (int)FMT_P010      << (int)FMT_YUV420P10 << false;
+        QTest::newRow("YUV420P10 -> P010")        << (int)FMT_YUV420P10 << (int)FMT_P010      << true;
+        QTest::newRow("YUV420P10 -> P010 Pure C") << (int)FMT_YUV420P10 << (int)FMT_P010      << false;
+        QTest::newRow("P016 -> YUV420P16")        << (int)FMT_P016      << (int)FMT_YUV420P16 << true;
+        QTest::newRow("YUV420P16 -> P016")        << (int)FMT_YUV420P16 << (int)FMT_P016      << true;
+    }
+
+    // Frames per second and picture bytes per second of each conversion
+    // at 1080p
+    static void throughput(void)
+    {
+        QFETCH(int, from);
+        QFETCH(int, to);
+        QFETCH(bool, SIMD);
+        const int kWidth  = 1920;
+        const int kHeight = 1080;
+        VideoFrame src {};
+        VideoFrame dst {};
+        auto *bufsrc = create(src, (VideoFrameType)from, kWidth, kHeight);
+        auto *bufdst = create(dst, (VideoFrameType)to,   kWidth, kHeight);
+        fill(src);
+
+        double bytes = 0;
+        for (uint plane = 0; plane < planes(src.codec); plane++)
+            bytes += double(visible(src.codec, kWidth, plane)) * height_for_plane(src.codec, kHeight, plane);
+
+        auto start = std::chrono::steady_clock::now();
+        QBENCHMARK_ONCE
+        {
+            for (int i = 0; i < ITER; i++)
+                framecopy(&dst, &src, SIMD);
+        }
+        std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+        std::cout << QString("%1: %2 fps, %3 MB/s")
+            .arg(QTest::currentDataTag())
+            .arg(ITER / secs.count(), 0, 'f', 0)
+            .arg(ITER * bytes / secs.count() / (1024 * 1024), 0, 'f', 0)
+            .toLocal8Bit().constData() << std::endl;
+
         av_freep(&bufsrc);
         av_freep(&bufdst);
     }
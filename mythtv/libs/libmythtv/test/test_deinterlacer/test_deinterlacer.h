@@ -0,0 +1,241 @@
+/*
+ *  Class TestDeinterlacer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include <QtTest/QtTest>
+
+#include "mythframe.h"
+#include "mythdeinterlacer.h"
+
+#define WIDTH   1920
+#define HEIGHT  1080
+
+Q_DECLARE_METATYPE(VideoFrameType)
+
+class TestDeinterlacer : public QObject
+{
+    Q_OBJECT
+
+    /// A 1080i frame set up for linearblend in software
+    static void create(VideoFrame &frame, unsigned char *&buf,
+                       VideoFrameType type = FMT_YV12)
+    {
+        int size = static_cast<int>(GetBufferSize(type, WIDTH, HEIGHT));
+        buf = static_cast<unsigned char*>(av_malloc(static_cast<size_t>(size)));
+        init(&frame, type, buf, WIDTH, HEIGHT, size);
+        frame.deinterlace_single  = DEINT_MEDIUM | DEINT_CPU;
+        frame.deinterlace_allowed = DEINT_ALL;
+        frame.top_field_first     = true;
+    }
+
+    /// Fills the frame with fields that differ, so every blended row changes
+    static void fill(VideoFrame &frame, int seed)
+    {
+        for (int i = 0; i < frame.size; i++)
+            frame.buf[i] = static_cast<unsigned char>((i * 7) + ((i / WIDTH) & 1) * 128 + seed);
+    }
+
+    /// Deinterlaces one pass of the frame, as the player does once per field
+    /// at double rate and once per frame at single rate
+    static void deinterlace(MythDeinterlacer &deint, VideoFrame &frame,
+                            FrameScanType scan, bool doublerate)
+    {
+        frame.deinterlace_double = doublerate ? (DEINT_MEDIUM | DEINT_CPU) : DEINT_NONE;
+        frame.already_deinterlaced = false;
+        deint.Filter(&frame, scan, nullptr);
+    }
+
+  private slots:
+    // Give the blend every CPU feature back after each test
+    static void cleanup(void)
+    {
+        MythDeinterlacer::UseCPUFeatures(true, true);
+    }
+
+    static void threads_data(void)
+    {
+        QTest::addColumn<uint>("threads");
+        QTest::addColumn<bool>("doublerate");
+        QTest::newRow("2 threads single rate") << 2U << false;
+        QTest::newRow("2 threads double rate") << 2U << true;
+        QTest::newRow("3 threads single rate") << 3U << false;
+        QTest::newRow("3 threads double rate") << 3U << true;
+        QTest::newRow("8 threads double rate") << 8U << true;
+    }
+
+    // Slices must give exactly the same picture as a single thread
+    static void threads(void)
+    {
+        QFETCH(uint, threads);
+        QFETCH(bool, doublerate);
+
+        VideoFrame single {};
+        VideoFrame sliced {};
+        unsigned char *buf1 = nullptr;
+        unsigned char *buf2 = nullptr;
+        create(single, buf1);
+        create(sliced, buf2);
+        const auto size = static_cast<size_t>(single.size);
+
+        MythDeinterlacer deint1;
+        deint1.SetMaxThreads(1);
+        MythDeinterlacer deint2;
+        deint2.SetMaxThreads(threads);
+
+        // A few frames in a row, so the field cache is reused
+        for (int seed = 0; seed < 3; seed++)
+        {
+            fill(single, seed);
+            memcpy(sliced.buf, single.buf, size);
+
+            deinterlace(deint1, single, kScan_Interlaced, doublerate);
+            deinterlace(deint2, sliced, kScan_Interlaced, doublerate);
+            QVERIFY(sliced.already_deinterlaced);
+            QVERIFY(memcmp(single.buf, sliced.buf, size) == 0);
+
+            if (doublerate)
+            {
+                deinterlace(deint1, single, kScan_Intr2ndField, doublerate);
+                deinterlace(deint2, sliced, kScan_Intr2ndField, doublerate);
+                QVERIFY(memcmp(single.buf, sliced.buf, size) == 0);
+            }
+        }
+
+        av_free(buf1);
+        av_free(buf2);
+    }
+
+    static void kernels_data(void)
+    {
+        QTest::addColumn<VideoFrameType>("type");
+        QTest::addColumn<bool>("refSIMD");
+        QTest::addColumn<bool>("avx2");
+        QTest::addColumn<bool>("doublerate");
+        // There is no C blend for more than 8 bits, SIMD is the reference
+        QTest::newRow("SIMD 8 bit single rate") << FMT_YV12 << false << false << false;
+        QTest::newRow("SIMD 8 bit double rate") << FMT_YV12 << false << false << true;
+        QTest::newRow("AVX2 8 bit single rate") << FMT_YV12 << false << true << false;
+        QTest::newRow("AVX2 8 bit double rate") << FMT_YV12 << false << true << true;
+        QTest::newRow("AVX2 10 bit single rate") << FMT_YUV420P10 << true << true << false;
+        QTest::newRow("AVX2 10 bit double rate") << FMT_YUV420P10 << true << true << true;
+    }
+
+    // Each blend function must give exactly the same picture as the
+    // reference, C for 8 bit video
+    static void kernels(void)
+    {
+        QFETCH(VideoFrameType, type);
+        QFETCH(bool, refSIMD);
+        QFETCH(bool, avx2);
+        QFETCH(bool, doublerate);
+        if (!MythDeinterlacer::HaveSIMD())
+            QSKIP("No SIMD blend on this CPU");
+        if (avx2 && !MythDeinterlacer::HaveAVX2())
+            QSKIP("No AVX2 on this CPU");
+
+        VideoFrame reference {};
+        VideoFrame tested {};
+        unsigned char *buf1 = nullptr;
+        unsigned char *buf2 = nullptr;
+        create(reference, buf1, type);
+        create(tested, buf2, type);
+        const auto size = static_cast<size_t>(reference.size);
+
+        MythDeinterlacer deint1;
+        deint1.SetMaxThreads(1);
+        MythDeinterlacer deint2;
+        deint2.SetMaxThreads(1);
+
+        for (int seed = 0; seed < 3; seed++)
+        {
+            fill(reference, seed);
+            memcpy(tested.buf, reference.buf, size);
+
+            MythDeinterlacer::UseCPUFeatures(refSIMD, false);
+            deinterlace(deint1, reference, kScan_Interlaced, doublerate);
+            MythDeinterlacer::UseCPUFeatures(true, avx2);
+            deinterlace(deint2, tested, kScan_Interlaced, doublerate);
+            QVERIFY(tested.already_deinterlaced);
+            QVERIFY(memcmp(reference.buf, tested.buf, size) == 0);
+
+            if (doublerate)
+            {
+                MythDeinterlacer::UseCPUFeatures(refSIMD, false);
+                deinterlace(deint1, reference, kScan_Intr2ndField, doublerate);
+                MythDeinterlacer::UseCPUFeatures(true, avx2);
+                deinterlace(deint2, tested, kScan_Intr2ndField, doublerate);
+                QVERIFY(memcmp(reference.buf, tested.buf, size) == 0);
+            }
+        }
+
+        av_free(buf1);
+        av_free(buf2);
+    }
+
+    static void benchmark1080i_data(void)
+    {
+        QTest::addColumn<uint>("threads");
+        QTest::addColumn<bool>("doublerate");
+        QTest::newRow("1 thread single rate")  << 1U << false;
+        QTest::newRow("1 thread double rate")  << 1U << true;
+        QTest::newRow("2 threads single rate") << 2U << false;
+        QTest::newRow("2 threads double rate") << 2U << true;
+        QTest::newRow("4 threads single rate") << 4U << false;
+        QTest::newRow("4 threads double rate") << 4U << true;
+    }
+
+    // Frames per second of linearblend on 1080i, counting both fields at
+    // double rate as one frame
+    static void benchmark1080i(void)
+    {
+        QFETCH(uint, threads);
+        QFETCH(bool, doublerate);
+        const int kFrames = 300;
+
+        VideoFrame frame {};
+        unsigned char *buf = nullptr;
+        create(frame, buf);
+        fill(frame, 0);
+
+        MythDeinterlacer deint;
+        deint.SetMaxThreads(threads);
+        // Set up the cache and the threads first
+        deinterlace(deint, frame, kScan_Interlaced, doublerate);
+
+        auto start = std::chrono::steady_clock::now();
+        QBENCHMARK_ONCE
+        {
+            for (int i = 0; i < kFrames; i++)
+            {
+                deinterlace(deint, frame, kScan_Interlaced, doublerate);
+                if (doublerate)
+                    deinterlace(deint, frame, kScan_Intr2ndField, doublerate);
+            }
+        }
+        std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+        cout << QString("1080i %1, %2 threads: %3 fps")
+            .arg(doublerate ? "double rate" : "single rate").arg(threads)
+            .arg(kFrames / secs.count(), 0, 'f', 1)
+            .toLocal8Bit().constData() << endl;
+
+        av_free(buf);
+    }
+};
@@ -19,6 +19,7 @@
  */
 
 #include <cstdio>
+#include <QElapsedTimer>
 #include "test_eitfixups.h"
 #include "eitfixup.h"
 #include "programdata.h"
@@ -822,4 +823,111 @@ void TestEITFixups::test64BitEnum(void)
     QVERIFY(1<<31 & 1ULL<<32);
 }
 
+void TestEITFixups::testUKRemovals(void)
+{
+    EITFixUp fixup;
+
+    DBEventEIT event(4164,
+                     "Schools: Look and Read",
+                     "Rpt of 12.30pm. BBC THREE on BBC TWO. Story of a boy. ALSO IN HD. Then 60 Seconds. [AD,S]",
+                     QDateTime::fromString("2015-02-28T19:40:00Z", Qt::ISODate),
+                     QDateTime::fromString("2015-02-28T20:00:00Z", Qt::ISODate),
+                     EITFixUp::kFixUK,
+                     SUB_UNKNOWN,
+                     AUD_STEREO,
+                     VID_UNKNOWN);
+
+    fixup.Fix(event);
+    PRINT_EVENT(event);
+    QCOMPARE(event.m_title, QString("Look and Read"));
+    QVERIFY(!event.m_description.contains("BBC THREE"));
+    QVERIFY(!event.m_description.contains("ALSO IN HD", Qt::CaseInsensitive));
+    QVERIFY(!event.m_description.contains("60 Seconds"));
+    QVERIFY(!event.m_description.contains("[AD,S]"));
+    QVERIFY(event.m_audioProps & AUD_VISUALIMPAIR);
+    QVERIFY(event.m_subtitleType & SUB_NORMAL);
+}
+
+// Number of events fixed per benchmark iteration
+static const int kBenchmarkEvents = 1000;
+
+void TestEITFixups::benchmarkFixups_data(void)
+{
+    QTest::addColumn<quint64>("fixup");
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<QString>("subtitle");
+    QTest::addColumn<QString>("description");
+
+    QTest::newRow("UK")
+        << (quint64)EITFixUp::kFixUK
+        << "Book of the Week" << ""
+        << "Girl in the Dark: Anna Lyndsey's account of finding light in the darkness after illness changed her life. 3/5. A Descent into Darkness: The disquieting persistence of the light.";
+    QTest::newRow("UK plain")
+        << (quint64)EITFixUp::kFixUK
+        << "Antiques Roadshow" << ""
+        << "Fiona Bruce and the team of experts visit the gardens of a stately home, where the items include a collection of toy soldiers.";
+    QTest::newRow("UK HTML")
+        << (quint64)(EITFixUp::kFixHTML | EITFixUp::kFixUK)
+        << "<EM>New: Jericho</EM>" << ""
+        << "Drama set in 1870s Yorkshire. In her desperation to protect her son, Annie unwittingly opens the door for Bamford the railway detective, who has returned to Jericho. [AD,S]";
+    QTest::newRow("Pro7Sat1")
+        << (quint64)EITFixUp::kFixP7S1
+        << "Criminal Minds" << "<episode title>, Crime-Serie, USA 2011"
+        << "<plot summary>\n\nRegie: Frau Regisseur\nDrehbuch: Lieschen Mueller, Frau Meier\n\nDarsteller:\nHerr Schauspieler (in einer (kleinen) Rolle)\nFrau Schauspielerin (in einer Rolle)";
+    QTest::newRow("Premiere")
+        << (quint64)EITFixUp::kFixPremiere
+        << "Titel" << "Subtitle"
+        << "4. Staffel, Folge 16: Viele Mitglieder einer christlichen Gemeinde erkranken nach einem Giftanschlag. 50 Min. USA 2008. Von Leslie Libman, mit Rob Morrow, David Krumholtz, Judd Hirsch. Ab 12 Jahren";
+    QTest::newRow("Unitymedia")
+        << (quint64)EITFixUp::kFixUnitymedia
+        << "Titel" << "Beschreib"
+        << "Beschreibung ... IMDb Rating: 8.9 /10";
+    QTest::newRow("ATV")
+        << (quint64)EITFixUp::kFixATV
+        << "Gilmore Girls" << "Eine Hochzeit und ein Todesfall, Folge 17"
+        << "Lorelai und Rory helfen Luke in seinem Café aus.";
+    QTest::newRow("DisneyChannel")
+        << (quint64)EITFixUp::kFixDisneyChannel
+        << "Phineas und Ferb" << "Das Achterbahn - Musical Zeichentrick-Serie, USA 2011"
+        << "...";
+}
+
+/// Fix kBenchmarkEvents copies of an event per iteration and report the
+/// throughput in events per second for each provider.
+void TestEITFixups::benchmarkFixups(void)
+{
+    QFETCH(quint64, fixup);
+    QFETCH(QString, title);
+    QFETCH(QString, subtitle);
+    QFETCH(QString, description);
+
+    EITFixUp fixer;
+    QDateTime start = QDateTime::fromString("2015-02-28T19:40:00Z", Qt::ISODate);
+    QDateTime end   = QDateTime::fromString("2015-02-28T20:00:00Z", Qt::ISODate);
+
+    qint64 events = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK
+    {
+        for (int i = 0; i < kBenchmarkEvents; i++)
+        {
+            DBEventEIT event(1, title, subtitle, description, "",
+                             ProgramInfo::kCategoryNone, start, end,
+                             fixup, SUB_UNKNOWN, AUD_STEREO, VID_UNKNOWN,
+                             0.0F, "", "", 0, 0, 0);
+            fixer.Fix(event);
+        }
+        events += kBenchmarkEvents;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+
+    QVERIFY(events > 0);
+    if (elapsed > 0)
+    {
+        printf("%s: %.0f events/sec\n", QTest::currentDataTag(),
+               events * 1e9 / elapsed);
+    }
+}
+
 QTEST_APPLESS_MAIN(TestEITFixups)
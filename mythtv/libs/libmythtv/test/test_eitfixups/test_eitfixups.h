@@ -47,6 +47,9 @@ class TestEITFixups : public QObject
     static void testDeDisneyChannel(void);
     static void testATV(void);
     static void test64BitEnum(void);
+    static void testUKRemovals(void);
+    static void benchmarkFixups_data(void);
+    static void benchmarkFixups(void);
 
   private:
     static DBEventEIT *SimpleDBEventEIT (FixupValue fix, const QString& title, const QString& subtitle, const QString& description);
@@ -0,0 +1,3 @@
+#include "test_framepool.h"
+
+QTEST_APPLESS_MAIN(TestFramePool)
@@ -0,0 +1,205 @@
+/*
+ *  Class TestFramePool
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include <QtTest/QtTest>
+
+#include "mythframepool.h"
+#include "videobuffers.h"
+
+class TestFramePool : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void sizeClass(void)
+    {
+        QCOMPARE(MythFramePool::SizeClass(1), static_cast<size_t>(64));
+        QCOMPARE(MythFramePool::SizeClass(1000), static_cast<size_t>(1024));
+        QCOMPARE(MythFramePool::SizeClass(1025), static_cast<size_t>(1152));
+        // 1080 and 1088 line YV12 frames share a class
+        size_t yv12 = GetBufferSize(FMT_YV12, 1920, 1080);
+        QCOMPARE(MythFramePool::SizeClass(yv12),
+                 MythFramePool::SizeClass(GetBufferSize(FMT_YV12, 1920, 1088)));
+        for (size_t size = 1; size < (1 << 24); size = (size * 3) + 1)
+        {
+            size_t sizeclass = MythFramePool::SizeClass(size);
+            QVERIFY(sizeclass >= size);
+            QVERIFY(sizeclass - size <= std::max(size / 8, static_cast<size_t>(64)));
+        }
+    }
+
+    static void acquire_reusesReleased(void)
+    {
+        MythFramePool pool;
+        unsigned char *first = pool.Acquire(100000);
+        QVERIFY(first != nullptr);
+        memset(first, 0, 100000 + 64);
+        pool.Release(first);
+
+        // Same class, same alignment
+        unsigned char *second = pool.Acquire(99000);
+        QCOMPARE(second, first);
+        // Another alignment is another buffer
+        unsigned char *third = pool.Acquire(99000, 4096);
+        QVERIFY(third != first);
+        QCOMPARE(reinterpret_cast<uintptr_t>(third) & 4095, static_cast<uintptr_t>(0));
+        pool.Release(second);
+        pool.Release(third);
+
+        MythFramePoolStats stats = pool.GetStats();
+        QCOMPARE(stats.m_acquires, static_cast<uint64_t>(3));
+        QCOMPARE(stats.m_hits, static_cast<uint64_t>(1));
+        QCOMPARE(stats.m_misses, static_cast<uint64_t>(2));
+        QCOMPARE(stats.m_releases, static_cast<uint64_t>(3));
+        QCOMPARE(stats.m_inUse, static_cast<size_t>(0));
+        QCOMPARE(stats.m_buffers, static_cast<size_t>(2));
+        QCOMPARE(stats.m_cached, MythFramePool::SizeClass(100000) * 2);
+    }
+
+    static void release_trimsOldest(void)
+    {
+        MythFramePool pool;
+        const size_t size = 1 << 20;
+        pool.SetMaxCached(2 * size);
+        unsigned char *bufs[4];
+        for (auto & buf : bufs)
+            buf = pool.Acquire(size);
+        for (auto & buf : bufs)
+            pool.Release(buf);
+
+        MythFramePoolStats stats = pool.GetStats();
+        QCOMPARE(stats.m_trimmed, static_cast<uint64_t>(2));
+        QCOMPARE(stats.m_buffers, static_cast<size_t>(2));
+        QCOMPARE(stats.m_cached, 2 * size);
+        // The most recently released comes back first
+        QCOMPARE(pool.Acquire(size), bufs[3]);
+        QCOMPARE(pool.Acquire(size), bufs[2]);
+
+        pool.Release(bufs[2]);
+        pool.Release(bufs[3]);
+        pool.Trim(0);
+        QCOMPARE(pool.GetStats().m_buffers, static_cast<size_t>(0));
+        QCOMPARE(pool.GetStats().m_cached, static_cast<size_t>(0));
+    }
+
+    static void removeClient_trimsWhenLast(void)
+    {
+        MythFramePool pool;
+        pool.AddClient();
+        pool.AddClient();
+        pool.Release(pool.Acquire(100000));
+        pool.RemoveClient();
+        QCOMPARE(pool.GetStats().m_buffers, static_cast<size_t>(1));
+        pool.RemoveClient();
+        QCOMPARE(pool.GetStats().m_buffers, static_cast<size_t>(0));
+        QCOMPARE(pool.GetStats().m_cached, static_cast<size_t>(0));
+    }
+
+    static void videoBuffers_trimPoolWhenGone(void)
+    {
+        MythFramePool *pool = MythFramePool::Get();
+        {
+            VideoBuffers buffers;
+            QVERIFY(buffers.DiscardAndRecreate(kCodec_MPEG2, QSize(720, 576), 2));
+            buffers.DeleteBuffers();
+            QVERIFY(pool->GetStats().m_buffers > 0);
+        }
+        QCOMPARE(pool->GetStats().m_buffers, static_cast<size_t>(0));
+        QCOMPARE(pool->GetStats().m_cached, static_cast<size_t>(0));
+    }
+
+    static void release_freesForeignBuffers(void)
+    {
+        MythFramePool pool;
+        pool.Release(GetAlignedBuffer(1000));
+        pool.Release(nullptr);
+        QCOMPARE(pool.GetStats().m_releases, static_cast<uint64_t>(0));
+        QCOMPARE(pool.GetStats().m_buffers, static_cast<size_t>(0));
+    }
+
+    static void recreate_reusesFrames(void)
+    {
+        MythFramePool *pool = MythFramePool::Get();
+        pool->Trim(0);
+        VideoBuffers buffers;
+        QVERIFY(buffers.DiscardAndRecreate(kCodec_MPEG2, QSize(1920, 1080), 2));
+        uint64_t misses = pool->GetStats().m_misses;
+
+        // Back and forth between sizes, as with adverts in another resolution
+        QVERIFY(buffers.DiscardAndRecreate(kCodec_MPEG2, QSize(720, 576), 2));
+        QVERIFY(buffers.DiscardAndRecreate(kCodec_MPEG2, QSize(1920, 1080), 2));
+        uint64_t allocated = pool->GetStats().m_misses - misses;
+        QVERIFY(buffers.DiscardAndRecreate(kCodec_MPEG2, QSize(720, 576), 2));
+        QVERIFY(buffers.DiscardAndRecreate(kCodec_MPEG2, QSize(1920, 1088), 2));
+        QCOMPARE(pool->GetStats().m_misses - misses, allocated);
+
+        // Frames re-initialised by the decoder stay in the pool too
+        VideoFrame *frame = buffers.At(0);
+        QVERIFY(VideoBuffers::ReinitBuffer(frame, FMT_YV12, kCodec_MPEG2, 720, 576));
+        QVERIFY(VideoBuffers::ReinitBuffer(frame, FMT_YV12, kCodec_MPEG2, 1920, 1080));
+        QCOMPARE(pool->GetStats().m_misses - misses, allocated);
+        buffers.DeleteBuffers();
+        QCOMPARE(pool->GetStats().m_inUse, static_cast<size_t>(0));
+    }
+
+    static void benchmarkRecreate_data(void)
+    {
+        QTest::addColumn<bool>("pooled");
+        QTest::newRow("heap") << false;
+        QTest::newRow("pool") << true;
+    }
+
+    /// Switches between 1080p and 576p, as a channel with adverts in
+    /// another resolution does, and reports how long each switch takes
+    static void benchmarkRecreate(void)
+    {
+        QFETCH(bool, pooled);
+        const int kSwitches = 100;
+
+        MythFramePool *pool = MythFramePool::Get();
+        size_t maxcached = pool->GetMaxCached();
+        pool->Trim(0);
+        if (!pooled)
+            pool->SetMaxCached(0);
+
+        VideoBuffers buffers;
+        auto start = std::chrono::steady_clock::now();
+        QBENCHMARK_ONCE
+        {
+            for (int i = 0; i < kSwitches; i++)
+            {
+                QSize size = (i & 1) ? QSize(720, 576) : QSize(1920, 1080);
+                buffers.DiscardAndRecreate(kCodec_MPEG2, size, 2);
+            }
+        }
+        std::chrono::duration<double, std::milli> msecs =
+            std::chrono::steady_clock::now() - start;
+        buffers.DeleteBuffers();
+
+        cout << QString("Recreate from %1: %2 ms per switch, %3")
+            .arg(pooled ? "pool" : "heap").arg(msecs.count() / kSwitches, 0, 'f', 2)
+            .arg(pool->GetStatus())
+            .toLocal8Bit().constData() << endl;
+
+        pool->SetMaxCached(maxcached);
+        pool->Trim(0);
+    }
+};
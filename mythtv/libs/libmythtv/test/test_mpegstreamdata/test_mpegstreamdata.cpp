@@ -0,0 +1,252 @@
+/*
+ *  Class TestMPEGStreamData
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_mpegstreamdata.h"
+
+#include "mpegstreamdata.h"
+
+class PacketCounter : public TSPacketListener
+{
+  public:
+    bool ProcessTSPacket(const TSPacket& /*tspacket*/) override
+    {
+        m_count++;
+        return true;
+    }
+    uint m_count {0};
+};
+
+/// Builds a stream of null payload packets cycling through a few PIDs
+static QByteArray build_stream(uint packets, const QVector<uint> &pids)
+{
+    QByteArray stream(static_cast<int>(packets * TSPacket::kSize),
+                      static_cast<char>(0xff));
+    auto *data = reinterpret_cast<unsigned char*>(stream.data());
+    for (uint i = 0; i < packets; i++)
+    {
+        unsigned char *pkt = &data[i * TSPacket::kSize];
+        uint pid = pids[static_cast<int>((i / 8) % pids.size())];
+        pkt[0] = SYNC_BYTE;
+        pkt[1] = (pid >> 8) & 0x1f;
+        pkt[2] = pid & 0xff;
+        pkt[3] = 0x10 | (i & 0xf);
+    }
+    return stream;
+}
+
+void TestMPEGStreamData::remainder_test(void)
+{
+    MPEGStreamData sd(-1, 0, false);
+    QByteArray stream = build_stream(4, {0x100});
+    stream.chop(94);
+
+    int left = sd.ProcessData(
+        reinterpret_cast<const unsigned char*>(stream.constData()),
+        stream.size());
+    QCOMPARE(left, 94);
+}
+
+void TestMPEGStreamData::resync_test(void)
+{
+    MPEGStreamData sd(-1, 0, false);
+    PacketCounter counter;
+    sd.AddWritingPID(0x100);
+    sd.AddWritingListener(&counter);
+
+    QByteArray stream = build_stream(10, {0x100});
+    stream.insert(5 * static_cast<int>(TSPacket::kSize), QByteArray(37, 0x00));
+    stream.prepend(QByteArray(21, 0x00));
+
+    int left = sd.ProcessData(
+        reinterpret_cast<const unsigned char*>(stream.constData()),
+        stream.size());
+    QCOMPARE(left, 0);
+    QCOMPARE(counter.m_count, 10U);
+}
+
+void TestMPEGStreamData::pid_table_test(void)
+{
+    MPEGStreamData sd(-1, 0, false);
+    sd.AddListeningPID(0x12, kPIDPriorityLow);
+    sd.AddWritingPID(0x12, kPIDPriorityHigh);
+    sd.AddAudioPID(0x44);
+    sd.AddWritingPID(0x2001); // out of range, ignored
+
+    QVERIFY(sd.IsListeningPID(MPEG_PAT_PID));
+    QVERIFY(sd.IsListeningPID(0x12));
+    QVERIFY(sd.IsWritingPID(0x12));
+    QVERIFY(!sd.IsAudioPID(0x12));
+    QVERIFY(sd.IsAudioPID(0x44));
+    QVERIFY(!sd.IsWritingPID(0x2001));
+    QVERIFY(!sd.IsWritingPID(0x2000));
+    QCOMPARE(sd.GetPIDPriority(0x12), kPIDPriorityLow);
+    QCOMPARE(sd.ClassifyPID(0x12),
+             uint(kPIDRoleListening | kPIDRoleWriting));
+
+    sd.AddNotListeningPID(0x12);
+    QVERIFY(!sd.IsListeningPID(0x12));
+    QCOMPARE(sd.ClassifyPID(0x12), uint(kPIDRoleWriting));
+
+    pid_map_t pids;
+    sd.GetPIDs(pids);
+    QCOMPARE(pids.value(0x12), kPIDPriorityHigh);
+    QCOMPARE(pids.value(0x44), kPIDPriorityHigh);
+    QCOMPARE(sd.WritingPIDs().size(), 1);
+
+    sd.RemoveWritingPID(0x12);
+    QVERIFY(!sd.IsWritingPID(0x12));
+    QVERIFY(sd.IsNotListeningPID(0x12));
+    QCOMPARE(sd.GetPIDPriority(0x12), kPIDPriorityLow);
+
+    // The whole transport stream, as the DVB, HDHR and Sat>IP recorders ask
+    sd.AddListeningPID(0x2000);
+    sd.AddWritingPID(0x2000);
+    QVERIFY(sd.IsListeningPID(0x2000));
+    QVERIFY(sd.IsWritingPID(0x2000));
+    QCOMPARE(sd.ClassifyPID(0x2000),
+             uint(kPIDRoleListening | kPIDRoleWriting));
+    pids.clear();
+    sd.GetPIDs(pids);
+    QVERIFY(pids.contains(0x2000));
+    QVERIFY(sd.ListeningPIDs().contains(0x2000));
+    sd.RemoveListeningPID(0x2000);
+    QVERIFY(!sd.IsListeningPID(0x2000));
+}
+
+void TestMPEGStreamData::pid_table_active_test(void)
+{
+    PIDTable table;
+    QVERIFY(table.Active().empty());
+
+    table.Insert(0x100, PIDTable::kListening, kPIDPriorityNormal);
+    table.Insert(0x100, PIDTable::kWriting, kPIDPriorityHigh);
+    table.Insert(0x200, PIDTable::kAudio, kPIDPriorityHigh);
+    table.Insert(0x300, PIDTable::kWriting, kPIDPriorityLow);
+    table.Insert(PIDTable::kAllPIDs, PIDTable::kListening, kPIDPriorityLow);
+    table.Insert(0x2001, PIDTable::kListening, kPIDPriorityLow);
+    QCOMPARE(table.Active().size(), size_t(4));
+
+    // Still in the writing set
+    table.Remove(0x100, PIDTable::kListening);
+    QCOMPARE(table.Active().size(), size_t(4));
+    // Removing from the middle keeps the others
+    table.Remove(0x200, PIDTable::kAudio);
+    table.Remove(0x200, PIDTable::kAudio);
+    QCOMPARE(table.Active().size(), size_t(3));
+    QCOMPARE(table.ToMap(PIDTable::kWriting).keys(),
+             QList<uint>({ 0x100, 0x300 }));
+
+    table.Clear(PIDTable::kWriting);
+    QCOMPARE(table.Active().size(), size_t(1));
+    QCOMPARE(uint(table.Active().front()), PIDTable::kAllPIDs);
+    table.Insert(0x300, PIDTable::kNotListening, kPIDPriorityNormal);
+    QCOMPARE(table.Active().size(), size_t(2));
+
+    table.Clear();
+    QVERIFY(table.Active().empty());
+    QCOMPARE(table.Sets(0x300), 0U);
+}
+
+void TestMPEGStreamData::pid_lookup_benchmark(void)
+{
+    MPEGStreamData sd(-1, 0, false);
+    for (uint pid = 0x100; pid < 0x140; pid++)
+        sd.AddWritingPID(pid);
+    for (uint pid = 0x1000; pid < 0x1020; pid++)
+        sd.AddListeningPID(pid);
+
+    uint hits = 0;
+    QBENCHMARK
+    {
+        for (uint i = 0; i < 1000000; i++)
+        {
+            uint pid = (i * 2654435761U) & 0x1fff;
+            hits += sd.ClassifyPID(pid) ? 1 : 0;
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+/// GetPIDs() as the stream handlers call it on every pass of their loop
+void TestMPEGStreamData::get_pids_benchmark(void)
+{
+    MPEGStreamData sd(-1, 0, false);
+    for (uint pid = 0x100; pid < 0x110; pid++)
+        sd.AddWritingPID(pid);
+    sd.AddListeningPID(0x1ffb);
+
+    uint count = 0;
+    QBENCHMARK
+    {
+        pid_map_t pids;
+        count += sd.GetPIDs(pids);
+    }
+    QVERIFY(count > 0);
+}
+
+void TestMPEGStreamData::demux_benchmark(void)
+{
+    MPEGStreamData sd(-1, 0, false);
+    PacketCounter counter;
+    sd.AddWritingPID(0x100);
+    sd.AddWritingPID(0x101);
+    sd.AddAudioPID(0x102);
+    sd.AddWritingListener(&counter);
+
+    // 7 packets per 1316 byte UDP frame is a common delivery unit
+    static constexpr int kChunk { 7 * TSPacket::kSize };
+    QByteArray stream = build_stream(50000, {0x100, 0x101, 0x102, 0x1fff});
+    const auto *data = reinterpret_cast<const unsigned char*>(stream.constData());
+
+    QBENCHMARK
+    {
+        for (int pos = 0; pos < stream.size(); pos += kChunk)
+            sd.ProcessData(&data[pos], std::min(kChunk, stream.size() - pos));
+    }
+    QVERIFY(counter.m_count > 0);
+}
+
+void TestMPEGStreamData::capture_benchmark(void)
+{
+    QString filename = qEnvironmentVariable("MYTHTV_TEST_TS_FILE");
+    if (filename.isEmpty())
+        QSKIP("MYTHTV_TEST_TS_FILE not set");
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        QSKIP("Unable to open MYTHTV_TEST_TS_FILE");
+    QByteArray stream = file.read(64 * 1024 * 1024);
+    const auto *data = reinterpret_cast<const unsigned char*>(stream.constData());
+
+    MPEGStreamData sd(-1, 0, false);
+    PacketCounter counter;
+    sd.AddWritingListener(&counter);
+    for (uint pid = 0x10; pid < 0x1fff; pid++)
+        sd.AddWritingPID(pid);
+
+    // Same read size as DeviceReadBuffer hands to the stream handlers
+    static constexpr int kChunk { 1000 * TSPacket::kSize };
+    QBENCHMARK
+    {
+        for (int pos = 0; pos < stream.size(); pos += kChunk)
+            sd.ProcessData(&data[pos], std::min(kChunk, stream.size() - pos));
+    }
+    QVERIFY(counter.m_count > 0);
+}
+
+QTEST_APPLESS_MAIN(TestMPEGStreamData)
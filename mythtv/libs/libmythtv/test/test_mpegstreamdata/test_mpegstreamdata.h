@@ -0,0 +1,46 @@
+/*
+ *  Class TestMPEGStreamData
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+class TestMPEGStreamData: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /** a trailing partial packet is returned as the remainder */
+    static void remainder_test(void);
+
+    /** garbage in front of and between packets is skipped */
+    static void resync_test(void);
+
+    /** PID set membership and priorities survive the flat PID table */
+    static void pid_table_test(void);
+    static void pid_table_active_test(void);
+
+    /** cost of the per packet PID lookups */
+    static void pid_lookup_benchmark(void);
+    static void get_pids_benchmark(void);
+
+    /** demux throughput over a synthetic multiplex */
+    static void demux_benchmark(void);
+
+    /** demux throughput over a captured transport stream, the file is
+     *  taken from the MYTHTV_TEST_TS_FILE environment variable */
+    static void capture_benchmark(void);
+};
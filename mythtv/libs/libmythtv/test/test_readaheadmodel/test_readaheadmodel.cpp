@@ -0,0 +1,3 @@
+#include "test_readaheadmodel.h"
+
+QTEST_APPLESS_MAIN(TestReadAheadModel)
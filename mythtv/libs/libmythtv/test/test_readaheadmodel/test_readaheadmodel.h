@@ -0,0 +1,136 @@
+/*
+ *  Class TestReadAheadModel
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "io/mythreadaheadmodel.h"
+
+#define MB (1024U * 1024U)
+
+class TestReadAheadModel : public QObject
+{
+    Q_OBJECT
+
+    /// Plays Seconds of a stream consuming Rate bytes per second in
+    /// 64KB reads, with storage reads taking Latency ms each
+    static int64_t play(MythReadAheadModel &model, int64_t now,
+                        uint rate, int seconds, int latency)
+    {
+        const int block = 64 * 1024;
+        int reads = static_cast<int>((static_cast<uint64_t>(rate) * seconds) / block);
+        int64_t step = (1000LL * block) / rate;
+        for (int i = 0; i < reads; i++, now += step)
+        {
+            model.Consumed(block, now);
+            model.StorageRead(block, latency);
+        }
+        return now;
+    }
+
+  private slots:
+    static void unknownRateKeepsSize(void)
+    {
+        MythReadAheadModel model;
+        QCOMPARE(model.TargetBufferSize(8 * MB, 4 * MB, 0), 8 * MB);
+        QCOMPARE(model.ConsumptionRate(), 0U);
+    }
+
+    static void highBitrateGrows(void)
+    {
+        // 80 Mb/s UHD stream from slow storage
+        MythReadAheadModel model;
+        int64_t now = play(model, 0, 10 * MB, 10, 40);
+        QVERIFY(model.ConsumptionRate() > 9 * MB);
+        QVERIFY(model.ConsumptionRate() < 11 * MB);
+
+        uint target = model.TargetBufferSize(4 * MB, 4 * MB, now);
+        QVERIFY(target >= 20 * MB);
+        QVERIFY(target <= MythReadAheadModel::kMaxBufferSize);
+        QCOMPARE(target % MB, 0U);
+    }
+
+    static void lowBitrateShrinks(void)
+    {
+        // 2.5 Mb/s SD stream on a buffer sized for the network
+        MythReadAheadModel model;
+        int64_t now = play(model, 0, 320 * 1024, 30, 5);
+        QCOMPARE(model.TargetBufferSize(32 * MB, 4 * MB, now), 4 * MB);
+    }
+
+    static void smallChangesKeepSize(void)
+    {
+        MythReadAheadModel model;
+        int64_t now = play(model, 0, 10 * MB, 10, 40);
+        uint target = model.TargetBufferSize(4 * MB, 4 * MB, now);
+        QCOMPARE(model.TargetBufferSize(target - MB, 4 * MB, now), target - MB);
+        QCOMPARE(model.TargetBufferSize(target + MB, 4 * MB, now), target + MB);
+    }
+
+    static void stallsGrow(void)
+    {
+        MythReadAheadModel model;
+        int64_t now = play(model, 0, 4 * MB, 10, 10);
+        uint before = model.TargetBufferSize(4 * MB, 4 * MB, now);
+
+        model.Stalled(500, now);
+        model.Stalled(500, now + 1000);
+        now += 2000;
+        uint after = model.TargetBufferSize(before, 4 * MB, now);
+        QVERIFY(after > before);
+
+        MythReadAheadStats stats = model.GetStats();
+        QCOMPARE(stats.m_stalls, 2ULL);
+        QCOMPARE(stats.m_stallTime, 1000ULL);
+
+        // Stalls are forgotten after a minute
+        QCOMPARE(model.TargetBufferSize(before, 4 * MB, now + 120000), before);
+    }
+
+    static void seekingShrinks(void)
+    {
+        MythReadAheadModel model;
+        int64_t now = play(model, 0, 10 * MB, 10, 40);
+        QCOMPARE(model.TargetBufferSize(32 * MB, 4 * MB, now), 32 * MB);
+
+        for (int i = 0; i < 3; i++)
+            model.Seeked(now + i * 500);
+        now += 1500;
+        now = play(model, now, 10 * MB, 2, 40);
+        QVERIFY(model.TargetBufferSize(32 * MB, 4 * MB, now) < 32 * MB);
+        QCOMPARE(model.GetStats().m_seeks, 3ULL);
+    }
+
+    static void pausesAreIgnored(void)
+    {
+        MythReadAheadModel model;
+        int64_t now = play(model, 0, 4 * MB, 10, 10);
+        uint rate = model.ConsumptionRate();
+
+        // A read after a long pause does not count as a slow window
+        model.Consumed(64 * 1024, now + 60000);
+        QCOMPARE(model.ConsumptionRate(), rate);
+    }
+
+    static void occupancy(void)
+    {
+        MythReadAheadModel model;
+        for (int i = 0; i < 200; i++)
+            model.Occupancy(6 * MB, 8 * MB);
+        QCOMPARE(model.GetStats().m_occupancy, 75U);
+    }
+};
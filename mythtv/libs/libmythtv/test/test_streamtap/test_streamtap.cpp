@@ -0,0 +1,3 @@
+#include "test_streamtap.h"
+
+QTEST_APPLESS_MAIN(TestStreamTap)
@@ -0,0 +1,140 @@
+/*
+ *  Class TestStreamTap
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "io/mythstreamtap.h"
+
+class TestStreamTap : public QObject
+{
+    Q_OBJECT
+
+    static QString filename(const char *name)
+    {
+        return QString("%1/test_streamtap_%2_%3.ts").arg(QDir::tempPath())
+            .arg(QCoreApplication::applicationPid()).arg(name);
+    }
+
+    /// Bytes that differ from one position of the file to the next
+    static std::vector<char> block(long long pos, uint count)
+    {
+        std::vector<char> data(count);
+        for (uint i = 0; i < count; i++)
+            data[i] = static_cast<char>((pos + i) * 7 + ((pos + i) >> 16));
+        return data;
+    }
+
+    static void write(MythStreamTap *tap, long long pos, uint count)
+    {
+        std::vector<char> data = block(pos, count);
+        tap->Write(pos, data.data(), count);
+    }
+
+    static bool readBack(const MythStreamTap *tap, long long pos, uint count)
+    {
+        std::vector<char> data(count);
+        return tap->Read(pos, data.data(), count) == static_cast<int>(count) &&
+            data == block(pos, count);
+    }
+
+  private slots:
+    static void noTap(void)
+    {
+        QVERIFY(MythStreamTap::Open(filename("none")) == nullptr);
+    }
+
+    static void readsWhatWasWritten(void)
+    {
+        MythStreamTap *writer = MythStreamTap::Create(filename("rw"), 50);
+        QVERIFY(writer != nullptr);
+        MythStreamTap *reader = MythStreamTap::Open(filename("rw"));
+        QVERIFY(reader != nullptr);
+        QCOMPARE(reader->GetCPUBudget(), 50);
+        QCOMPARE(reader->GetWritten(), -1LL);
+
+        write(writer, 0, 188 * 100);
+        write(writer, 188 * 100, 188 * 50);
+        QCOMPARE(reader->GetWritten(), 188LL * 150);
+        QVERIFY(readBack(reader, 0, 188 * 150));
+        QVERIFY(readBack(reader, 1000, 2000));
+
+        // Only what has been written
+        std::vector<char> data(188 * 10);
+        QCOMPARE(reader->Read(188 * 145, data.data(), 188 * 10), 188 * 5);
+        QCOMPARE(reader->Read(188 * 150, data.data(), 188 * 10), 0);
+
+        QVERIFY(!reader->IsFinished());
+        delete writer;
+        QVERIFY(reader->IsFinished());
+        QVERIFY(readBack(reader, 0, 188 * 150));
+        delete reader;
+    }
+
+    static void readsAcrossTheWrap(void)
+    {
+        MythStreamTap *writer = MythStreamTap::Create(filename("wrap"), 0);
+        QVERIFY(writer != nullptr);
+        MythStreamTap *reader = MythStreamTap::Open(filename("wrap"));
+        QVERIFY(reader != nullptr);
+
+        const uint chunk = 1024 * 1024 - 188;
+        long long pos = 0;
+        while (pos < MythStreamTap::kRingSize + 4LL * chunk)
+        {
+            write(writer, pos, chunk);
+            pos += chunk;
+        }
+
+        // Overwritten
+        std::vector<char> data(chunk);
+        QCOMPARE(reader->Read(0, data.data(), chunk), 0);
+        QCOMPARE(reader->Read(pos - MythStreamTap::kRingSize - 1, data.data(), 1), 0);
+
+        // Still there, including across the end of the ring
+        QVERIFY(readBack(reader, pos - MythStreamTap::kRingSize, chunk));
+        long long wrap = (pos / MythStreamTap::kRingSize) * MythStreamTap::kRingSize;
+        QVERIFY(readBack(reader, wrap - 1000, 2000));
+        QVERIFY(readBack(reader, pos - chunk, chunk));
+
+        delete reader;
+        delete writer;
+    }
+
+    static void writeElsewhereDisables(void)
+    {
+        MythStreamTap *writer = MythStreamTap::Create(filename("seek"), 0);
+        QVERIFY(writer != nullptr);
+        MythStreamTap *reader = MythStreamTap::Open(filename("seek"));
+        QVERIFY(reader != nullptr);
+
+        write(writer, 4096, 4096);
+        QVERIFY(readBack(reader, 4096, 4096));
+        std::vector<char> data(4096);
+        QCOMPARE(reader->Read(0, data.data(), 4096), 0);
+
+        write(writer, 0, 4096);
+        QCOMPARE(reader->Read(4096, data.data(), 4096), 0);
+        QCOMPARE(reader->GetWritten(), -1LL);
+        QVERIFY(reader->IsFinished());
+
+        delete reader;
+        delete writer;
+    }
+};
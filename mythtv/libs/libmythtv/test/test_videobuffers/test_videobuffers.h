@@ -0,0 +1,323 @@
+/*
+ *  Class TestVideoBuffers
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "videobuffers.h"
+
+class TestVideoBuffers : public QObject
+{
+    Q_OBJECT
+
+    static const uint kBuffers = 8;
+
+    static void create(VideoBuffers &buffers, int width, int height)
+    {
+        buffers.Init(kBuffers, false, 1, 4, 2);
+        QVERIFY(buffers.CreateBuffers(FMT_YV12, width, height));
+    }
+
+    /// What the display saw in one run of benchmark4K60Jitter()
+    struct Jitter
+    {
+        int                 m_missed {0};
+        std::vector<double> m_handoff;
+        std::vector<double> m_late;
+    };
+
+    /// Decodes frames numbered from 1 until stop is set, or failed is set
+    /// when no frame comes free
+    static void decode(VideoBuffers &buffers, const std::atomic<bool> &stop,
+                       bool fill, std::atomic<bool> &failed)
+    {
+        for (long long n = 1; !stop; n++)
+        {
+            VideoFrame *frame = buffers.GetNextFreeFrame();
+            if (!frame)
+            {
+                failed = true;
+                return;
+            }
+            // Stands in for a software decoder writing out the picture
+            if (fill)
+                memset(frame->buf, static_cast<int>(n & 0xff),
+                       static_cast<size_t>(frame->size));
+            frame->frameNumber = n;
+            buffers.ReleaseFrame(frame);
+        }
+    }
+
+  private slots:
+    static void releaseFrame_keepsOrder(void)
+    {
+        VideoBuffers buffers;
+        create(buffers, 64, 64);
+
+        for (int i = 1; i <= 4; i++)
+        {
+            VideoFrame *frame = buffers.GetNextFreeFrame();
+            QVERIFY(frame);
+            frame->frameNumber = i;
+            buffers.ReleaseFrame(frame);
+            QCOMPARE(buffers.GetLastDecodedFrame(), frame);
+        }
+        QCOMPARE(buffers.ValidVideoFrames(), 4U);
+        QCOMPARE(buffers.FreeVideoFrames(), kBuffers - 4);
+
+        for (int i = 1; i <= 4; i++)
+        {
+            buffers.StartDisplayingFrame();
+            VideoFrame *frame = buffers.GetLastShownFrame();
+            QCOMPARE(frame->frameNumber, static_cast<long long>(i));
+            buffers.DoneDisplayingFrame(frame);
+        }
+        QCOMPARE(buffers.ValidVideoFrames(), 0U);
+        QCOMPARE(buffers.FreeVideoFrames(), kBuffers);
+    }
+
+    /// A frame released while another thread holds the lock is queued, and
+    /// must be the last decoded frame as soon as the lock is free again
+    static void releaseFrame_whileLocked(void)
+    {
+        VideoBuffers buffers;
+        create(buffers, 64, 64);
+
+        VideoFrame *first = buffers.GetNextFreeFrame();
+        QVERIFY(first);
+        buffers.ReleaseFrame(first);
+        VideoFrame *frame = buffers.GetNextFreeFrame();
+        QVERIFY(frame);
+
+        std::atomic<bool> locked {false};
+        std::atomic<bool> unlock {false};
+        std::thread holder([&buffers, &locked, &unlock]()
+        {
+            buffers.BeginLock(kVideoBuffer_used);
+            locked = true;
+            while (!unlock)
+                std::this_thread::yield();
+            buffers.EndLock();
+        });
+        while (!locked)
+            std::this_thread::yield();
+
+        buffers.ReleaseFrame(frame);
+        unlock = true;
+        VideoFrame *last = buffers.GetLastDecodedFrame();
+        holder.join();
+
+        QCOMPARE(last, frame);
+        QCOMPARE(buffers.ValidVideoFrames(), 2U);
+    }
+
+    static void discardFrames_takesHandedOverFrames(void)
+    {
+        VideoBuffers buffers;
+        create(buffers, 64, 64);
+
+        for (int i = 0; i < 3; i++)
+        {
+            VideoFrame *frame = buffers.GetNextFreeFrame();
+            QVERIFY(frame);
+            buffers.ReleaseFrame(frame);
+        }
+        buffers.StartDisplayingFrame();
+        buffers.DoneDisplayingFrame(buffers.GetLastShownFrame());
+
+        buffers.DiscardFrames(true);
+        QCOMPARE(buffers.Size(kVideoBuffer_used), 0U);
+        QCOMPARE(buffers.Size(kVideoBuffer_finished), 0U);
+        QCOMPARE(buffers.FreeVideoFrames(), kBuffers);
+    }
+
+    static void handOff_betweenThreads(void)
+    {
+        VideoBuffers buffers;
+        create(buffers, 64, 64);
+
+        std::atomic<bool> stop {false};
+        std::atomic<bool> failed {false};
+        std::thread decoder(decode, std::ref(buffers), std::cref(stop), false,
+                            std::ref(failed));
+
+        long long last = 0;
+        while (last < 20000 && !failed)
+        {
+            if (!buffers.ValidVideoFrames())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            buffers.StartDisplayingFrame();
+            VideoFrame *frame = buffers.GetLastShownFrame();
+            QCOMPARE(frame->frameNumber, last + 1);
+            last = frame->frameNumber;
+            buffers.DoneDisplayingFrame(frame);
+        }
+
+        stop = true;
+        buffers.DiscardFrames(true);
+        decoder.join();
+        buffers.DiscardFrames(true);
+        QVERIFY(!failed);
+        QCOMPARE(buffers.FreeVideoFrames(), kBuffers);
+    }
+
+    /// Decodes 4K frames in software as fast as buffers come free while
+    /// the display takes one every 1/60 s, first with every hand-off taking
+    /// the lock, as before the rings, and then without. Reports for both
+    /// how long the display spent handing frames over, and how late past
+    /// each vsync it was done.
+    static void benchmark4K60Jitter(void)
+    {
+        Jitter before;
+        Jitter after;
+        QBENCHMARK_ONCE
+        {
+            run4K60(true, before);
+            run4K60(false, after);
+        }
+        QVERIFY(!before.m_late.empty());
+        QVERIFY(!after.m_late.empty());
+
+        report("locked", before);
+        report("lock-free", after);
+        compare("hand-off", before.m_handoff, after.m_handoff);
+        compare("done after vsync", before.m_late, after.m_late);
+    }
+
+  private:
+    static void run4K60(bool locked, Jitter &result)
+    {
+        using clock = std::chrono::steady_clock;
+        const int kTicks = 240;
+        const auto kInterval = std::chrono::microseconds(16667);
+
+        VideoBuffers buffers;
+        create(buffers, 3840, 2160);
+        buffers.SetLockedHandOff(locked);
+
+        std::atomic<bool> stop {false};
+        std::atomic<bool> failed {false};
+        std::thread decoder(decode, std::ref(buffers), std::cref(stop), true,
+                            std::ref(failed));
+        while (!buffers.EnoughDecodedFrames() && !failed)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        long long last = 0;
+        bool ordered = true;
+        auto vsync = clock::now();
+        for (int i = 0; i < kTicks && !failed; i++)
+        {
+            vsync += kInterval;
+            std::this_thread::sleep_until(vsync);
+            auto start = clock::now();
+            if (!buffers.ValidVideoFrames())
+            {
+                result.m_missed++;
+                continue;
+            }
+            buffers.StartDisplayingFrame();
+            VideoFrame *frame = buffers.GetLastShownFrame();
+            ordered = ordered && (frame->frameNumber > last);
+            last = frame->frameNumber;
+            buffers.DoneDisplayingFrame(frame);
+            auto done = clock::now();
+            result.m_handoff.push_back(
+                std::chrono::duration<double, std::micro>(done - start).count());
+            result.m_late.push_back(
+                std::chrono::duration<double, std::micro>(done - vsync).count());
+        }
+
+        stop = true;
+        buffers.DiscardFrames(true);
+        decoder.join();
+
+        QVERIFY(!failed);
+        QVERIFY(ordered);
+        std::sort(result.m_handoff.begin(), result.m_handoff.end());
+        std::sort(result.m_late.begin(), result.m_late.end());
+    }
+
+    static double mean(const std::vector<double> &times)
+    {
+        double sum = 0;
+        for (double us : times)
+            sum += us;
+        return sum / times.size();
+    }
+
+    static double stddev(const std::vector<double> &times)
+    {
+        double m = mean(times);
+        double dev = 0;
+        for (double us : times)
+            dev += (us - m) * (us - m);
+        return sqrt(dev / times.size());
+    }
+
+    /// \param times must be sorted
+    static double percentile99(const std::vector<double> &times)
+    {
+        return times[(times.size() * 99) / 100];
+    }
+
+    static void report(const char *mode, const Jitter &jitter)
+    {
+        cout << QString("4K60 %1: %2 of %3 vsyncs missed").arg(mode)
+            .arg(jitter.m_missed)
+            .arg(jitter.m_missed + static_cast<int>(jitter.m_late.size()))
+            .toLocal8Bit().constData() << endl;
+        report(mode, "hand-off", jitter.m_handoff);
+        report(mode, "done after vsync", jitter.m_late);
+    }
+
+    /// \param times must be sorted
+    static void report(const char *mode, const char *name,
+                       const std::vector<double> &times)
+    {
+        cout << QString("4K60 %1: %2 mean %3 us, stddev %4 us, 99% %5 us, "
+                        "max %6 us")
+            .arg(mode).arg(name)
+            .arg(mean(times), 0, 'f', 1).arg(stddev(times), 0, 'f', 1)
+            .arg(percentile99(times), 0, 'f', 1)
+            .arg(times.back(), 0, 'f', 1)
+            .toLocal8Bit().constData() << endl;
+    }
+
+    /// Prints the lock-free jitter against the locked jitter
+    static void compare(const char *name, const std::vector<double> &before,
+                        const std::vector<double> &after)
+    {
+        cout << QString("4K60 %1: stddev %2 -> %3 us, 99% %4 -> %5 us, "
+                        "max %6 -> %7 us")
+            .arg(name)
+            .arg(stddev(before), 0, 'f', 1).arg(stddev(after), 0, 'f', 1)
+            .arg(percentile99(before), 0, 'f', 1)
+            .arg(percentile99(after), 0, 'f', 1)
+            .arg(before.back(), 0, 'f', 1).arg(after.back(), 0, 'f', 1)
+            .toLocal8Bit().constData() << endl;
+    }
+};
@@ -153,6 +153,7 @@ bool TVRec::Init(void)
     m_transcodeFirst    =
         gCoreContext->GetBoolSetting("AutoTranscodeBeforeAutoCommflag", false);
     m_earlyCommFlag     = gCoreContext->GetBoolSetting("AutoCommflagWhileRecording", false);
+    m_commFlagTapBudget = gCoreContext->GetNumSetting("CommFlagTapCPUBudget", 0);
     m_runJobOnHostOnly  = gCoreContext->GetBoolSetting("JobsRunOnRecordHost", false);
     m_eitTransportTimeout =
         max(gCoreContext->GetNumSetting("EITTransportTimeout", 5) * 60, 6);
@@ -339,6 +340,31 @@ QDateTime TVRec::GetRecordEndTime(const ProgramInfo *pi) const
     return pi->GetRecordingEndTime().addSecs(secs);
 }
 
+/** \brief Shares what is written with the commercial flagging job that
+ *         follows the recording, when it runs on this host.
+ *
+ *   The flagger reads the stream from memory rather than from the disk, and
+ *   keeps within m_commFlagTapBudget percent of one CPU core.
+ */
+void TVRec::EnableCommFlagTap(const RecordingInfo *rec,
+                              MythMediaBuffer *buffer) const
+{
+    if (!m_earlyCommFlag || m_commFlagTapBudget <= 0 || !rec || !buffer)
+        return;
+
+    if (!JobQueue::JobIsInMask(JOB_COMMFLAG, rec->GetAutoRunJobs()) ||
+        rec->IsCommercialFree())
+    {
+        return;
+    }
+
+    if (!buffer->EnableWriteTap(m_commFlagTapBudget))
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC +
+            "Commercial flagging will read the recording from disk");
+    }
+}
+
 /** \fn TVRec::CancelNextRecording(bool)
  *  \brief Tells TVRec to cancel the upcoming recording.
  *  \sa RecordPending(const ProgramInfo*, int, bool),
@@ -4218,6 +4244,8 @@ void TVRec::TuningNewRecorder(MPEGStreamData *streamData)
             ClearFlags(kFlagPendingActions, __FILE__, __LINE__);
             goto err_ret;
         }
+        if (write)
+            EnableCommFlagTap(rec, m_buffer);
     }
 
     if (!m_buffer)
@@ -4814,6 +4842,9 @@ RecordingInfo *TVRec::SwitchRecordingRingBuffer(const RecordingInfo &rcinfo)
         return nullptr;
     }
 
+    if (write)
+        EnableCommFlagTap(ri, buffer);
+
     m_recorder->SetNextRecording(ri, buffer);
     SetFlags(kFlagRingBufferReady, __FILE__, __LINE__);
     m_recordEndTime = GetRecordEndTime(ri);
@@ -320,6 +320,8 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     void StartedRecording(RecordingInfo *curRec);
     void FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq);
     QDateTime GetRecordEndTime(const ProgramInfo *pi) const;
+    void EnableCommFlagTap(const RecordingInfo *rec,
+                           MythMediaBuffer *buffer) const;
     void CheckForRecGroupChange(void);
     void NotifySchedulerOfRecording(RecordingInfo *rec);
     enum AutoRunInitType { kAutoRunProfile, kAutoRunNone, };
@@ -357,6 +359,7 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     // Configuration variables from database
     bool               m_transcodeFirst           {false};
     bool               m_earlyCommFlag            {false};
+    int                m_commFlagTapBudget        {0};
     bool               m_runJobOnHostOnly         {false};
     int                m_eitCrawlIdleStart        {60};
     int                m_eitTransportTimeout      {5*60};
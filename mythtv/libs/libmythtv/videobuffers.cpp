@@ -8,6 +8,7 @@
 #include "compat.h"
 #include "mythlogging.h"
 #include "mythcodecid.h"
+#include "mythframepool.h"
 #include "videobuffers.h"
 
 // FFmpeg
@@ -15,10 +16,6 @@ extern "C" {
 #include "libavcodec/avcodec.h"
 }
 
-// Std
-#include <chrono>
-#include <thread>
-
 #define TRY_LOCK_SPINS                 2000
 #define TRY_LOCK_SPINS_BEFORE_WARNING  9999
 #define TRY_LOCK_SPIN_WAIT             1000 /* usec */
@@ -129,6 +126,19 @@ static inline void DoDiscard(vector<AVBufferRef *> &Discards)
  *        decoder (in the decode queue) then it is placed in the finished queue
  *        until the decoder is no longer using it (not in the decode queue).
  *
+ *  The frames passed to ReleaseFrame() and DoneDisplayingFrame(), which are
+ *  called for every frame played, do not wait for the lock. Unless
+ *  ReleaseFrame() finds the lock free, they are pushed onto single producer,
+ *  single consumer rings and moved into the queues above by Flush(), which
+ *  every method taking the lock calls first. The last decoded frame is only
+ *  updated once a released frame is flushed, as m_vbufferMap must not be
+ *  read without the lock, so GetLastDecodedFrame() takes the lock too. So
+ *  anything done under the lock sees the queues just as if those calls had
+ *  taken the lock themselves, which keeps seeks, DiscardFrames() and
+ *  DiscardAndRecreate() as they were. Should another thread be releasing
+ *  or finishing a frame at the same moment, or a ring be full, the call
+ *  falls back to taking the lock.
+ *
  * \see VideoOutput
  */
 
@@ -163,9 +173,21 @@ uint VideoBuffers::GetNumBuffers(int PixelFormat, int MaxReferenceFrames, bool D
     return 30;
 }
 
+VideoBuffers::VideoBuffers()
+{
+    MythFramePool::Get()->AddClient();
+}
+
 VideoBuffers::~VideoBuffers()
 {
+    vector<AVBufferRef*> discards;
+    m_globalLock.lock();
+    Flush();
+    TakeDiscards(discards);
+    m_globalLock.unlock();
+    DoDiscard(discards);
     DeleteBuffers();
+    MythFramePool::Get()->RemoveClient();
 }
 
 /*! \brief Creates buffers and sets various buffer management parameters.
@@ -291,6 +313,7 @@ void VideoBuffers::SetDeinterlacingFlags(VideoFrame &Frame, MythDeintType Single
 void VideoBuffers::Reset()
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     m_available.clear();
     m_used.clear();
     m_limbo.clear();
@@ -313,7 +336,9 @@ void VideoBuffers::SetPrebuffering(bool Normal)
 
 VideoFrame *VideoBuffers::GetNextFreeFrameInternal(BufferType EnqueueTo)
 {
-    QMutexLocker locker(&m_globalLock);
+    vector<AVBufferRef*> discards;
+    m_globalLock.lock();
+    Flush();
     VideoFrame *frame = nullptr;
 
     // Try to get a frame not being used by the decoder
@@ -336,6 +361,10 @@ VideoFrame *VideoBuffers::GetNextFreeFrameInternal(BufferType EnqueueTo)
 
     if (frame)
         SafeEnqueue(EnqueueTo, frame);
+    TakeDiscards(discards);
+    m_globalLock.unlock();
+
+    DoDiscard(discards);
     return frame;
 }
 
@@ -372,7 +401,12 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(BufferType EnqueueTo)
                 QString("GetNextFreeFrame() TryLock has "
                         "spun %1 times, this is a lot.").arg(tries));
         }
-        std::this_thread::sleep_for(std::chrono::microseconds(TRY_LOCK_SPIN_WAIT));
+
+        // Wake as soon as the display hands a frame back
+        m_doneLock.lock();
+        if (m_done.empty())
+            m_frameDone.wait(&m_doneLock, TRY_LOCK_SPIN_WAIT / 1000);
+        m_doneLock.unlock();
     }
 
     return nullptr;
@@ -386,9 +420,33 @@ VideoFrame *VideoBuffers::GetNextFreeFrame(BufferType EnqueueTo)
  */
 void VideoBuffers::ReleaseFrame(VideoFrame *Frame)
 {
-    QMutexLocker locker(&m_globalLock);
+    if (!m_lockedHandOff && m_globalLock.tryLock())
+    {
+        Flush();
+        m_vpos = m_vbufferMap[Frame];
+        ReleaseFrameLocked(Frame);
+        m_globalLock.unlock();
+        return;
+    }
+
+    // m_vpos is updated by Flush(), which looks the frame up under the lock
+    if (!m_lockedHandOff && !m_releasing.test_and_set(std::memory_order_acquire))
+    {
+        bool queued = m_released.push(Frame);
+        m_releasing.clear(std::memory_order_release);
+        if (queued)
+            return;
+    }
 
+    QMutexLocker locker(&m_globalLock);
+    Flush();
     m_vpos = m_vbufferMap[Frame];
+    ReleaseFrameLocked(Frame);
+}
+
+/// \warning Must be called with m_globalLock held.
+void VideoBuffers::ReleaseFrameLocked(VideoFrame *Frame)
+{
     m_limbo.remove(Frame);
     //non directrendering frames are ffmpeg handled
     if (Frame->directrendering)
@@ -406,6 +464,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *Frame)
     vector<AVBufferRef*> discards;
 
     m_globalLock.lock();
+    Flush();
 
     if (m_limbo.contains(Frame))
         m_limbo.remove(Frame);
@@ -422,6 +481,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *Frame)
     while (m_decode.contains(Frame))
         m_decode.remove(Frame);
 
+    TakeDiscards(discards);
     m_globalLock.unlock();
 
     DoDiscard(discards);
@@ -434,6 +494,7 @@ void VideoBuffers::DeLimboFrame(VideoFrame *Frame)
 void VideoBuffers::StartDisplayingFrame(void)
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     m_rpos = m_vbufferMap[m_used.head()];
 }
 
@@ -443,10 +504,41 @@ void VideoBuffers::StartDisplayingFrame(void)
  */
 void VideoBuffers::DoneDisplayingFrame(VideoFrame *Frame)
 {
-    vector<AVBufferRef*> discards;
+    if (!m_lockedHandOff && !m_finishing.test_and_set(std::memory_order_acquire))
+    {
+        bool queued = m_done.push(Frame);
+        m_finishing.clear(std::memory_order_release);
+        if (queued)
+        {
+            m_frameDone.wakeAll();
+            return;
+        }
+    }
 
+    vector<AVBufferRef*> discards;
     m_globalLock.lock();
+    Flush();
+    DoneDisplayingFrameLocked(Frame);
+    TakeDiscards(discards);
+    m_globalLock.unlock();
+    DoDiscard(discards);
+}
+
+/**
+ * \fn VideoBuffers::SetLockedHandOff(bool)
+ *  Makes ReleaseFrame() and DoneDisplayingFrame() always take the lock, as
+ *  they did before the rings. Only for comparing the two in test_videobuffers.
+ */
+void VideoBuffers::SetLockedHandOff(bool Locked)
+{
+    QMutexLocker locker(&m_globalLock);
+    Flush();
+    m_lockedHandOff = Locked;
+}
 
+/// \warning Must be called with m_globalLock held.
+void VideoBuffers::DoneDisplayingFrameLocked(VideoFrame *Frame)
+{
     if(m_used.contains(Frame))
         Remove(kVideoBuffer_used, Frame);
 
@@ -459,14 +551,45 @@ void VideoBuffers::DoneDisplayingFrame(VideoFrame *Frame)
         if (!m_decode.contains(it))
         {
             Remove(kVideoBuffer_finished, it);
-            ReleaseDecoderResources(it, discards);
+            ReleaseDecoderResources(it, m_discards);
             Enqueue(kVideoBuffer_avail, it);
         }
     }
+}
 
-    m_globalLock.unlock();
+/*! \brief Moves the frames handed over by ReleaseFrame() and
+ *         DoneDisplayingFrame() into their queues.
+ *
+ * The released frames are moved first, as a frame must have been released
+ * before it can be displayed. The const accessors call this too, which is
+ * safe as it does not change what the queues hold as far as any caller
+ * can tell.
+ *
+ * \warning Must be called with m_globalLock held.
+ */
+void VideoBuffers::Flush(void)
+{
+    // DoneDisplayingFrameLocked() comes back here through Enqueue()
+    if (m_flushing)
+        return;
+    m_flushing = true;
+    VideoFrame *frame = nullptr;
+    while (m_released.pop(frame))
+    {
+        m_vpos = m_vbufferMap[frame];
+        ReleaseFrameLocked(frame);
+    }
+    while (m_done.pop(frame))
+        DoneDisplayingFrameLocked(frame);
+    m_flushing = false;
+}
 
-    DoDiscard(discards);
+/// \brief Hands the references dropped by Flush() to the caller, which must
+/// release them once m_globalLock is released.
+void VideoBuffers::TakeDiscards(vector<AVBufferRef*> &Discards)
+{
+    Discards.insert(Discards.end(), m_discards.cbegin(), m_discards.cend());
+    m_discards.clear();
 }
 
 /**
@@ -478,8 +601,10 @@ void VideoBuffers::DiscardFrame(VideoFrame *Frame)
 {
     vector<AVBufferRef*> discards;
     m_globalLock.lock();
+    Flush();
     ReleaseDecoderResources(Frame, discards);
     SafeEnqueue(kVideoBuffer_avail, Frame);
+    TakeDiscards(discards);
     m_globalLock.unlock();
     DoDiscard(discards);
 }
@@ -489,12 +614,14 @@ void VideoBuffers::DiscardPauseFrames(void)
     vector<AVBufferRef*> discards;
 
     m_globalLock.lock();
+    Flush();
     while (Size(kVideoBuffer_pause))
     {
         VideoFrame* frame = Tail(kVideoBuffer_pause);
         ReleaseDecoderResources(frame, discards);
         SafeEnqueue(kVideoBuffer_avail, frame);
     }
+    TakeDiscards(discards);
     m_globalLock.unlock();
 
     DoDiscard(discards);
@@ -512,6 +639,7 @@ bool VideoBuffers::DiscardAndRecreate(MythCodecID CodecID, QSize VideoDim, int R
     vector<AVBufferRef*> refs;
 
     m_globalLock.lock();
+    Flush();
     LOG(VB_PLAYBACK, LOG_INFO, QString("DiscardAndRecreate: %1").arg(GetStatus()));
 
     // Remove pause frames (cutdown version of DiscardPauseFrames)
@@ -604,6 +732,7 @@ bool VideoBuffers::DiscardAndRecreate(MythCodecID CodecID, QSize VideoDim, int R
     }
 
     LOG(VB_PLAYBACK, LOG_INFO, QString("DiscardAndRecreate: %1").arg(GetStatus()));
+    TakeDiscards(refs);
     m_globalLock.unlock();
 
     // and finally release references now that the lock is released
@@ -666,6 +795,7 @@ const VideoFrame* VideoBuffers::At(uint FrameNum) const
 VideoFrame *VideoBuffers::Dequeue(BufferType Type)
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     frame_queue_t *queue = Queue(Type);
     if (!queue)
         return nullptr;
@@ -675,6 +805,7 @@ VideoFrame *VideoBuffers::Dequeue(BufferType Type)
 VideoFrame *VideoBuffers::Head(BufferType Type)
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     frame_queue_t *queue = Queue(Type);
     if (!queue)
         return nullptr;
@@ -686,6 +817,7 @@ VideoFrame *VideoBuffers::Head(BufferType Type)
 VideoFrame *VideoBuffers::Tail(BufferType Type)
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     frame_queue_t *queue = Queue(Type);
     if (!queue)
         return nullptr;
@@ -702,6 +834,7 @@ void VideoBuffers::Enqueue(BufferType Type, VideoFrame *Frame)
     if (!queue)
         return;
     m_globalLock.lock();
+    Flush();
     queue->remove(Frame);
     queue->enqueue(Frame);
     if (Type == kVideoBuffer_pause)
@@ -715,6 +848,7 @@ void VideoBuffers::Remove(BufferType Type, VideoFrame *Frame)
         return;
 
     QMutexLocker locker(&m_globalLock);
+    Flush();
     if ((Type & kVideoBuffer_avail) == kVideoBuffer_avail)
         m_available.remove(Frame);
     if ((Type & kVideoBuffer_used) == kVideoBuffer_used)
@@ -734,6 +868,7 @@ void VideoBuffers::Remove(BufferType Type, VideoFrame *Frame)
 void VideoBuffers::Requeue(BufferType Dest, BufferType Source, int Count)
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     Count = (Count <= 0) ? Size(Source) : Count;
     for (uint i=0; i<(uint)Count; i++)
     {
@@ -748,6 +883,7 @@ void VideoBuffers::SafeEnqueue(BufferType Type, VideoFrame* Frame)
     if (!Frame)
         return;
     QMutexLocker locker(&m_globalLock);
+    Flush();
     Remove(kVideoBuffer_all, Frame);
     Enqueue(Type, Frame);
 }
@@ -760,6 +896,7 @@ void VideoBuffers::SafeEnqueue(BufferType Type, VideoFrame* Frame)
 frame_queue_t::iterator VideoBuffers::BeginLock(BufferType Type)
 {
     m_globalLock.lock();
+    Flush();
     frame_queue_t *queue = Queue(Type);
     if (queue)
         return queue->begin();
@@ -774,6 +911,7 @@ void VideoBuffers::EndLock(void)
 frame_queue_t::iterator VideoBuffers::End(BufferType Type)
 {
     QMutexLocker locker(&m_globalLock);
+    Flush();
     frame_queue_t *queue = Queue(Type);
     return (queue ? queue->end() : m_available.end());
 }
@@ -781,6 +919,7 @@ frame_queue_t::iterator VideoBuffers::End(BufferType Type)
 uint VideoBuffers::Size(BufferType Type) const
 {
     QMutexLocker locker(&m_globalLock);
+    const_cast<VideoBuffers*>(this)->Flush();
     const frame_queue_t *queue = Queue(Type);
     if (queue)
         return queue->size();
@@ -790,6 +929,7 @@ uint VideoBuffers::Size(BufferType Type) const
 bool VideoBuffers::Contains(BufferType Type, VideoFrame *Frame) const
 {
     QMutexLocker locker(&m_globalLock);
+    const_cast<VideoBuffers*>(this)->Flush();
     const frame_queue_t *queue = Queue(Type);
     if (queue)
         return queue->contains(Frame);
@@ -810,6 +950,9 @@ VideoFrame *VideoBuffers::GetScratchFrame(void)
 
 VideoFrame* VideoBuffers::GetLastDecodedFrame(void)
 {
+    // A frame released while another thread held the lock is still queued
+    QMutexLocker locker(&m_globalLock);
+    Flush();
     return At(m_vpos);
 }
 
@@ -853,6 +996,8 @@ bool VideoBuffers::EnoughDecodedFrames(void) const
 
 const VideoFrame* VideoBuffers::GetLastDecodedFrame(void) const
 {
+    QMutexLocker locker(&m_globalLock);
+    const_cast<VideoBuffers*>(this)->Flush();
     return At(m_vpos);
 }
 
@@ -874,6 +1019,7 @@ void VideoBuffers::DiscardFrames(bool NextFrameIsKeyFrame)
 {
     vector<AVBufferRef*> refs;
     m_globalLock.lock();
+    Flush();
     LOG(VB_PLAYBACK, LOG_INFO, QString("VideoBuffers::DiscardFrames(%1): %2")
             .arg(NextFrameIsKeyFrame).arg(GetStatus()));
 
@@ -888,6 +1034,7 @@ void VideoBuffers::DiscardFrames(bool NextFrameIsKeyFrame)
         LOG(VB_PLAYBACK, LOG_INFO,
             QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
                 .arg(NextFrameIsKeyFrame).arg(GetStatus()));
+        TakeDiscards(refs);
         m_globalLock.unlock();
         DoDiscard(refs);
         return;
@@ -945,6 +1092,7 @@ void VideoBuffers::DiscardFrames(bool NextFrameIsKeyFrame)
         QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
             .arg(NextFrameIsKeyFrame).arg(GetStatus()));
 
+    TakeDiscards(refs);
     m_globalLock.unlock();
     DoDiscard(refs);
 }
@@ -962,6 +1110,7 @@ void VideoBuffers::ClearAfterSeek(void)
     vector<AVBufferRef*> discards;
     {
         QMutexLocker locker(&m_globalLock);
+        Flush();
 
         for (uint i = 0; i < Size(); i++)
             At(i)->timecode = 0;
@@ -988,7 +1137,7 @@ void VideoBuffers::ClearAfterSeek(void)
                     m_available.enqueue(buffer);
                     ReleaseDecoderResources(buffer, discards);
                     m_vpos = m_vbufferMap[buffer];
-                    m_rpos = m_vpos;
+                    m_rpos = m_vpos.load();
                     break;
                 }
             }
@@ -997,6 +1146,7 @@ void VideoBuffers::ClearAfterSeek(void)
         {
             m_vpos = m_rpos = 0;
         }
+        TakeDiscards(discards);
     }
 
     DoDiscard(discards);
@@ -1025,11 +1175,12 @@ bool VideoBuffers::CreateBuffers(VideoFrameType Type, int Width, int Height)
         return success;
     }
 
-    // Software buffers
+    // Software buffers, reusing the memory of earlier buffers where possible
     size_t bufsize = GetBufferSize(Type, Width, Height);
+    MythFramePool *pool = MythFramePool::Get();
     for (uint i = 0; i < Size(); i++)
     {
-        unsigned char *data = GetAlignedBuffer(bufsize);
+        unsigned char *data = pool->Acquire(bufsize);
         if (!data)
             LOG(VB_GENERAL, LOG_CRIT, "Failed to allocate video buffer memory");
         init(&m_buffers[i], Type, data, Width, Height, static_cast<int>(bufsize));
@@ -1039,6 +1190,7 @@ bool VideoBuffers::CreateBuffers(VideoFrameType Type, int Width, int Height)
     Clear();
     LOG(VB_PLAYBACK, LOG_INFO, QString("Created %1 %2 (%3x%4) video buffers")
        .arg(Size()).arg(format_description(Type)).arg(Width).arg(Height));
+    LOG(VB_PLAYBACK, LOG_INFO, QString("Frame pool: %1").arg(pool->GetStatus()));
     return success;
 }
 
@@ -1054,8 +1206,12 @@ bool VideoBuffers::CreateBuffer(int Width, int Height, uint Number,
 void VideoBuffers::DeleteBuffers(void)
 {
     next_dbg_str = 0;
+    MythFramePool *pool = MythFramePool::Get();
     for (uint i = 0; i < Size(); i++)
-        av_freep(&(m_buffers[i].buf));
+    {
+        pool->Release(m_buffers[i].buf);
+        m_buffers[i].buf = nullptr;
+    }
 }
 
 bool VideoBuffers::ReinitBuffer(VideoFrame *Frame, VideoFrameType Type, MythCodecID CodecID,
@@ -1076,12 +1232,12 @@ bool VideoBuffers::ReinitBuffer(VideoFrame *Frame, VideoFrameType Type, MythCode
     bool newbuf = false;
     if ((Frame->size != static_cast<int>(size)) || !buf)
     {
-        // Free existing buffer
-        av_freep(&buf);
+        // Give back the existing buffer and take one of the new size. If
+        // both sizes fall in the same class this is the same memory.
+        MythFramePool *pool = MythFramePool::Get();
+        pool->Release(buf);
         Frame->buf = nullptr;
-
-        // Initialise new
-        buf = GetAlignedBuffer(size);
+        buf = pool->Acquire(size);
         if (!buf)
         {
             LOG(VB_GENERAL, LOG_ERR, "Failed to reallocate frame buffer");
@@ -1113,6 +1269,7 @@ QString VideoBuffers::GetStatus(uint Num) const
     QString str("");
     if (m_globalLock.tryLock())
     {
+        const_cast<VideoBuffers*>(this)->Flush();
         int count = Size();
         unsigned long long a = to_bitmap(m_available, count);
         unsigned long long u = to_bitmap(m_used, count);
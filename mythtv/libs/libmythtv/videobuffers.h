@@ -5,19 +5,25 @@
 #include <QSize>
 #include <QMutex>
 #include <QString>
+#include <QWaitCondition>
 
 // MythTV
 #include "mythtvexp.h"
 #include "mythframe.h"
 #include "mythdeque.h"
+#include "mythspscqueue.h"
 #include "mythcodecid.h"
 
 // Std
+#include <atomic>
 #include <vector>
 #include <map>
 using namespace std;
 
+struct AVBufferRef;
+
 using frame_queue_t  = MythDeque<VideoFrame*> ;
+using frame_ring_t   = MythSPSCQueue<VideoFrame*,128>;
 using frame_vector_t = vector<VideoFrame>;
 using vbuffer_map_t  = map<const VideoFrame*, uint>;
 
@@ -39,7 +45,7 @@ enum BufferType
 class MTV_PUBLIC VideoBuffers
 {
   public:
-    VideoBuffers() = default;
+    VideoBuffers();
     virtual ~VideoBuffers();
 
     static uint GetNumBuffers(int PixelFormat, int MaxReferenceFrames = 16, bool Decoder = false);
@@ -68,6 +74,7 @@ class MTV_PUBLIC VideoBuffers
     void DiscardFrame(VideoFrame *Frame);
     void DiscardPauseFrames(void);
     bool DiscardAndRecreate(MythCodecID CodecID, QSize VideoDim, int References);
+    void SetLockedHandOff(bool Locked);
 
     VideoFrame *At(uint FrameNum);
     VideoFrame *Dequeue(BufferType Type);
@@ -107,6 +114,10 @@ class MTV_PUBLIC VideoBuffers
     frame_queue_t       *Queue(BufferType Type);
     const frame_queue_t *Queue(BufferType Type) const;
     VideoFrame          *GetNextFreeFrameInternal(BufferType EnqueueTo);
+    void                 Flush(void);
+    void                 ReleaseFrameLocked(VideoFrame *Frame);
+    void                 DoneDisplayingFrameLocked(VideoFrame *Frame);
+    void                 TakeDiscards(vector<AVBufferRef*> &Discards);
     static void          SetDeinterlacingFlags(VideoFrame &Frame, MythDeintType Single,
                                                MythDeintType Double, MythCodecID CodecID);
 
@@ -125,9 +136,22 @@ class MTV_PUBLIC VideoBuffers
     uint                 m_needPrebufferFramesNormal { 0 };
     uint                 m_needPrebufferFramesSmall  { 0 };
     bool                 m_createdPauseFrame         { false };
-    uint                 m_rpos                      { 0 };
-    uint                 m_vpos                      { 0 };
+    atomic<uint>         m_rpos                      { 0 };
+    atomic<uint>         m_vpos                      { 0 };
     mutable QMutex       m_globalLock                { QMutex::Recursive };
+
+    // Frames handed from the decoder to the display and back without
+    // taking m_globalLock, moved into the queues above by Flush()
+    frame_ring_t         m_released;
+    frame_ring_t         m_done;
+    atomic_flag          m_releasing                 = ATOMIC_FLAG_INIT;
+    atomic_flag          m_finishing                 = ATOMIC_FLAG_INIT;
+    QMutex               m_doneLock;
+    QWaitCondition       m_frameDone;
+    /// Decoder references dropped by Flush(), released without the lock
+    vector<AVBufferRef*> m_discards;
+    bool                 m_flushing                  { false };
+    atomic<bool>         m_lockedHandOff             { false };
 };
 
 #endif // VIDEOBUFFERS_H
@@ -9,6 +9,7 @@ AutoExpire  *expirer      = nullptr;
 JobQueue    *jobqueue     = nullptr;
 HouseKeeper *housekeeping = nullptr;
 MediaServer *g_pUPnp      = nullptr;
+RecordedCache *recordedCache = nullptr;
 BackendContext *gBackendContext = nullptr;
 QString      pidfile;
 QString      logfile;
@@ -13,6 +13,7 @@ class Scheduler;
 class JobQueue;
 class HouseKeeper;
 class MediaServer;
+class RecordedCache;
 class BackendContext;
 
 extern QMap<int, EncoderLink *> tvList;
@@ -20,6 +21,7 @@ extern AutoExpire  *expirer;
 extern JobQueue    *jobqueue;
 extern HouseKeeper *housekeeping;
 extern MediaServer *g_pUPnp;
+extern RecordedCache *recordedCache;
 extern BackendContext *gBackendContext;
 extern QString      pidfile;
 extern QString      logfile;
@@ -24,6 +24,13 @@ void MythBackendCommandLineParser::LoadArguments(void)
          << add("--testsched", "testsched", false,
                 "do some scheduler testing.", "")
 //                    ->SetDeprecated("use mythutil instead")
+         << add("--benchsched", "benchsched", false,
+                "Time the scheduler's placement phases on a synthetic "
+                "guide and rule set.",
+                "Builds a fixed set of channels, listings, recording "
+                "rules and inputs in memory, schedules them several "
+                "times and prints the time spent in each phase along "
+                "with a digest of the resulting schedule.")
          << add("--resched", "resched", false,
                 "Trigger a run of the recording scheduler on the existing "
                 "master backend.",
@@ -1,3 +1,6 @@
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
@@ -5,20 +8,27 @@
 
 #include "filetransfer.h"
 #include "io/mythmediabuffer.h"
+#include "mythcorecontext.h"
 #include "mythdate.h"
 #include "mythsocket.h"
+#include "mythtimer.h"
 #include "programinfo.h"
 #include "mythlogging.h"
 
+#define LOC QString("FileTransfer: ")
+
+// Returned by SendBlock() when the file can not be sent without copying
+static constexpr int kZeroCopyUnsupported = -2;
+
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, int timeout_ms) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
     m_rbuffer(MythMediaBuffer::Create(filename, false, usereadahead, timeout_ms, true)),
-    m_sock(remote)
+    m_sock(remote), m_timeoutMs(timeout_ms)
 {
     m_pginfo = new ProgramInfo(filename);
     m_pginfo->MarkAsInUse(true, kFileTransferInUseID);
-    if (m_rbuffer && m_rbuffer->IsOpen())
+    if (m_rbuffer && m_rbuffer->IsOpen() && !OpenZeroCopy())
         m_rbuffer->Start();
 }
 
@@ -40,6 +50,8 @@ FileTransfer::~FileTransfer()
 {
     Stop();
 
+    CloseZeroCopy();
+
     if (m_sock) // FileTransfer becomes responsible for deleting the socket
         m_sock->DecrRef();
 
@@ -56,6 +68,59 @@ FileTransfer::~FileTransfer()
     }
 }
 
+/** \fn FileTransfer::OpenZeroCopy(void)
+ *  \brief Opens the file for sending straight from the page cache to the
+ *         socket with MythSocket::WriteFile().
+ *
+ *   This is only done for local files, which the buffer would otherwise
+ *   read into user space and hand unchanged to MythSocket::Write().  The
+ *   read ahead thread of the buffer is not started while the file is sent
+ *   this way, the buffer is only used for the file size.
+ */
+bool FileTransfer::OpenZeroCopy(void)
+{
+#ifdef __linux__
+    if (m_rbuffer->GetType() != kMythBufferFile ||
+        !gCoreContext->GetBoolSetting("FileTransferZeroCopy", true))
+        return false;
+
+    QString filename = m_rbuffer->GetFilename();
+    if (!filename.startsWith('/'))
+        return false;
+
+    m_zeroCopyFd = open(filename.toLocal8Bit().constData(), O_RDONLY);
+    if (m_zeroCopyFd < 0)
+        return false;
+
+    // The same page cache window as MythFileBuffer would keep
+    int ahead  = gCoreContext->GetNumSetting("PlaybackCacheAhead", 4);
+    int behind = gCoreContext->GetNumSetting("PlaybackCacheBehind", 8);
+    m_cacheWindow.SetWindow(max(ahead, 0) * 1024LL * 1024,
+                            (behind < 0) ? -1 : behind * 1024LL * 1024);
+    m_cacheWindow.Open(m_zeroCopyFd, 0);
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Sending %1 without copying")
+        .arg(filename));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FileTransfer::CloseZeroCopy(void)
+{
+    if (m_zeroCopyFd < 0)
+        return;
+
+    PageCacheStats stats = m_cacheWindow.GetStats();
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Sent %1 bytes of %2 without copying, "
+                                         "%3 bytes dropped from the page cache")
+        .arg(m_zeroCopySent).arg(m_rbuffer->GetFilename()).arg(stats.m_dropped));
+    m_cacheWindow.Close();
+    close(m_zeroCopyFd);
+    m_zeroCopyFd = -1;
+}
+
 bool FileTransfer::isOpen(void)
 {
     return m_rbuffer && m_rbuffer->IsOpen();
@@ -131,6 +196,26 @@ int FileTransfer::RequestBlock(int size)
     while (m_readsLocked)
         m_readsUnlockedCond.wait(&m_lock, 100 /*ms*/);
 
+    if (m_zeroCopyFd >= 0)
+    {
+        ret = SendBlock(size);
+        if (ret != kZeroCopyUnsupported)
+        {
+            if (m_pginfo)
+                m_pginfo->UpdateInUseMark();
+            return ret;
+        }
+
+        // Carry on through the buffer from where the sends stopped
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            "Zero copy send failed, reading through the buffer instead");
+        long long pos = m_zeroCopyPos;
+        CloseZeroCopy();
+        m_rbuffer->Start();
+        m_rbuffer->Seek(pos, SEEK_SET);
+        ret = 0;
+    }
+
     m_requestBuffer.resize(max((size_t)max(size,0) + 128, m_requestBuffer.size()));
     char *buf = &m_requestBuffer[0];
     while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
@@ -159,6 +244,55 @@ int FileTransfer::RequestBlock(int size)
     return (ret < 0) ? -1 : tot;
 }
 
+/** \fn FileTransfer::SendBlock(int)
+ *  \brief Sends the next block of the file with MythSocket::WriteFile().
+ *
+ *   At the end of a file which may still be being written this waits up
+ *   to the timeout given by the client for it to grow, as the buffer
+ *   would, unless some data was sent already or the client said the file
+ *   is old.  m_lock must be held, it is released while waiting so that
+ *   the transfer can be paused or stopped meanwhile.
+ *
+ *  \return the number of bytes sent, -1 on error, or
+ *          kZeroCopyUnsupported if nothing was ever sent this way.
+ */
+int FileTransfer::SendBlock(int size)
+{
+    int tot = 0;
+    MythTimer waited;
+
+    while (tot < size && m_readthreadlive && !m_readsLocked)
+    {
+        int ret = m_sock->WriteFile(m_zeroCopyFd, m_zeroCopyPos, size - tot);
+        if (ret < 0)
+        {
+            if (m_zeroCopySent == 0)
+                return kZeroCopyUnsupported;
+            return -1;
+        }
+
+        if (ret > 0)
+        {
+            tot += ret;
+            m_zeroCopyPos += ret;
+            m_zeroCopySent += ret;
+            m_cacheWindow.Read(m_zeroCopyPos);
+            continue;
+        }
+
+        // End of file
+        if (tot > 0 || m_oldFile)
+            break;
+        if (!waited.isRunning())
+            waited.start();
+        else if (waited.elapsed() >= m_timeoutMs)
+            break;
+        m_readsUnlockedCond.wait(&m_lock, 60 /*ms*/);
+    }
+
+    return tot;
+}
+
 int FileTransfer::WriteBlock(int size)
 {
     if (!m_writemode || !m_rbuffer)
@@ -232,6 +366,21 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
 
     m_ateof = false;
 
+    QMutexLocker locker(&m_lock);
+    if (m_zeroCopyFd >= 0)
+    {
+        long long desired = pos;
+        if (whence == SEEK_CUR)
+            desired = curpos + pos;
+        else if (whence == SEEK_END)
+            desired = m_rbuffer->GetRealFileSize() + pos;
+
+        m_zeroCopyPos = max(desired, 0LL);
+        m_cacheWindow.Seek(m_zeroCopyPos);
+        return m_zeroCopyPos;
+    }
+    locker.unlock();
+
     Pause();
 
     if (whence == SEEK_CUR)
@@ -275,6 +424,9 @@ void FileTransfer::SetTimeout(bool fast)
 
     if (m_rbuffer)
         m_rbuffer->SetOldFile(fast);
+
+    QMutexLocker locker(&m_lock);
+    m_oldFile = fast;
 }
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -11,6 +11,7 @@ using namespace std;
 #include <QWaitCondition>
 
 // MythTV headers
+#include "pagecachewindow.h"
 #include "referencecounter.h"
 
 class ProgramInfo;
@@ -49,6 +50,10 @@ class FileTransfer : public ReferenceCounter
   private:
    ~FileTransfer() override;
 
+    bool OpenZeroCopy(void);
+    void CloseZeroCopy(void);
+    int  SendBlock(int size);
+
     volatile bool   m_readthreadlive    {true};
     bool            m_readsLocked       {false};
     QWaitCondition  m_readsUnlockedCond;
@@ -60,6 +65,14 @@ class FileTransfer : public ReferenceCounter
 
     vector<char>    m_requestBuffer;
 
+    // Zero copy sends, protected by m_lock
+    int             m_zeroCopyFd        {-1};
+    long long       m_zeroCopyPos       {0};
+    long long       m_zeroCopySent      {0};
+    PageCacheWindow m_cacheWindow       {0, -1};
+    bool            m_oldFile           {false};
+    int             m_timeoutMs         {2000};
+
     QMutex          m_lock              {QMutex::NonRecursive};
 
     bool            m_writemode         {false};
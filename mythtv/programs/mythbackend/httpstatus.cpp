@@ -41,6 +41,8 @@
 #include "upnp.h"
 #include "mythdate.h"
 #include "tv_rec.h"
+#include "backendcontext.h"
+#include "recordedcache.h"
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -559,6 +561,26 @@ void HttpStatus::FillStatusXML( QDomDocument *pDoc )
         guide.setAttribute("guideDays", qdtNow.daysTo(GuideDataThrough));
     }
 
+    // Recorded programs cache ---------
+
+    if (recordedCache)
+    {
+        RecordedCacheStats stats = recordedCache->GetStats();
+
+        QDomElement cache = pDoc->createElement("RecordedCache");
+        mInfo.appendChild(cache);
+
+        cache.setAttribute("size"         , stats.m_size);
+        cache.setAttribute("age"          , (qlonglong)stats.m_age);
+        cache.setAttribute("hits"         , (qulonglong)stats.m_hits);
+        cache.setAttribute("misses"       , (qulonglong)stats.m_misses);
+        cache.setAttribute("refreshes"    , (qulonglong)stats.m_refreshes);
+        cache.setAttribute("refreshedRows", (qulonglong)stats.m_refreshedRows);
+        cache.setAttribute("expired"      , (qulonglong)stats.m_expired);
+        cache.setAttribute("invalidations", (qulonglong)stats.m_invalidations);
+        cache.setAttribute("stale"        , stats.m_stale);
+    }
+
     // Add Miscellaneous information
 
     QString info_script = gCoreContext->GetSetting("MiscStatusScript");
@@ -1441,6 +1463,39 @@ int HttpStatus::PrintMachineInfo( QTextStream &os, const QDomElement& info )
                    << "Have you run mythfilldatabase?";
         }
     }
+
+    // Recorded programs cache ---------
+
+    node = info.namedItem( "RecordedCache" );
+
+    if (!node.isNull())
+    {
+        QDomElement e = node.toElement();
+
+        if (!e.isNull())
+        {
+            qlonglong nAge = e.attribute( "age", "-1" ).toLongLong();
+
+            os << "<br />\r\n    Recorded programs cache: ";
+
+            if (nAge < 0)
+                os << "not loaded yet.";
+            else
+            {
+                os << e.attribute( "size", "0" ) << " recordings, loaded "
+                   << nAge << " seconds ago, "
+                   << e.attribute( "stale", "0" ) << " changed since.";
+            }
+
+            os << "<br />\r\n    "
+               << e.attribute( "hits"     , "0" ) << " hits, "
+               << e.attribute( "misses"   , "0" ) << " full loads ("
+               << e.attribute( "expired"  , "0" ) << " due to age), "
+               << e.attribute( "refreshes", "0" ) << " refreshes of "
+               << e.attribute( "refreshedRows", "0" ) << " changed rows, "
+               << e.attribute( "invalidations", "0" ) << " change events.";
+        }
+    }
     os << "\r\n  </div>\r\n";
 
     return( 1 );
@@ -31,10 +31,12 @@
 #include "scheduledrecording.h"
 #include "autoexpire.h"
 #include "scheduler.h"
+#include "schedulerbench.h"
 #include "mainserver.h"
 #include "encoderlink.h"
 #include "remoteutil.h"
 #include "backendhousekeeper.h"
+#include "recordedcache.h"
 
 #include "mythcontext.h"
 #include "mythversion.h"
@@ -285,6 +287,9 @@ void cleanup(void)
     delete mainServer;
     mainServer = nullptr;
 
+    delete recordedCache;
+    recordedCache = nullptr;
+
      delete gBackendContext;
      gBackendContext = nullptr;
 
@@ -400,6 +405,15 @@ int handle_command(const MythBackendCommandLineParser &cmdline)
         return GENERIC_EXIT_OK;
     }
 
+    if (cmdline.toBool("benchsched"))
+    {
+        auto *sched = new Scheduler(false, &tvList);
+        SchedulerBench bench(sched);
+        int ret = bench.Run();
+        delete sched;
+        return ret;
+    }
+
     if (cmdline.toBool("resched"))
     {
         bool ok = false;
@@ -680,6 +694,8 @@ int run_backend(MythBackendCommandLineParser &cmdline)
     if (!cmdline.toBool("nojobqueue"))
         jobqueue = new JobQueue(ismaster);
 
+    recordedCache = new RecordedCache();
+
     // ----------------------------------------------------------------------
     //
     // ----------------------------------------------------------------------
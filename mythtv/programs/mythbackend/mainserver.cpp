@@ -55,6 +55,8 @@ using namespace std;
 #include "scheduler.h"
 #include "requesthandler/fileserverutil.h"
 #include "programinfo.h"
+#include "packedlist.h"
+#include "recordedcache.h"
 #include "mythtimezone.h"
 #include "recordinginfo.h"
 #include "recordingrule.h"
@@ -540,10 +542,19 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_RECORDINGS")
     {
-        if (tokens.size() != 2)
+        if (tokens.size() == 2)
+            HandleQueryRecordings(tokens[1], pbs, false);
+        else if (tokens.size() == 3 && tokens[2] == "Packed")
+            HandleQueryRecordings(tokens[1], pbs, true);
+        else
             SendErrorResponse(pbs, "Bad QUERY_RECORDINGS query");
+    }
+    else if (command == "QUERY_RECORDINGS_CHANGES")
+    {
+        if (tokens.size() <= 2)
+            HandleQueryRecordingsChanges(tokens.value(1), pbs);
         else
-            HandleQueryRecordings(tokens[1], pbs);
+            SendErrorResponse(pbs, "Bad QUERY_RECORDINGS_CHANGES query");
     }
     else if (command == "QUERY_RECORDING")
     {
@@ -1514,6 +1525,13 @@ void MainServer::customEvent(QEvent *e)
         if (me->Message() == "IMAGE_GET_METADATA")
             ImageManagerBe::getInstance()->HandleGetMetadata(me->ExtraData());
 
+        if (me->Message().startsWith("RECORDING_LIST_CHANGE") ||
+            me->Message().startsWith("MASTER_UPDATE_REC_INFO") ||
+            me->Message().startsWith("UPDATE_FILE_SIZE"))
+        {
+            UpdateRecordingChangeLog(me->Message());
+        }
+
         MythEvent mod_me("");
         if (me->Message().startsWith("MASTER_UPDATE_REC_INFO"))
         {
@@ -2152,13 +2170,17 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
 
 /**
  * \addtogroup myth_network_protocol
- * \par        QUERY_RECORDINGS \e type
+ * \par        QUERY_RECORDINGS \e type [Packed]
  * The \e type parameter can be either "Recording", "Unsorted", "Ascending",
  * or "Descending".
  * Returns programinfo (title, subtitle, description, category, chanid,
  * channum, callsign, channel.name, fileURL, \e et \e cetera)
+ *
+ * With "Packed" the response is PACKED \e count \e bytes, followed by
+ * \e bytes of binary list as built by ProgramInfo::ToPackedList().
  */
-void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
+void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs,
+                                       bool packed)
 {
     MythSocket *pbssock = pbs->getSocket();
     QString playbackhost = pbs->getHostname();
@@ -2180,108 +2202,265 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
         sort = -1;
 
     ProgramList destination;
-    LoadFromRecorded(
-        destination, (type == "Recording"),
-        inUseMap, isJobRunning, recMap, sort);
+    if (recordedCache)
+    {
+        recordedCache->GetRecordings(
+            destination, (type == "Recording"),
+            inUseMap, isJobRunning, recMap, sort);
+    }
+    else
+    {
+        LoadFromRecorded(
+            destination, (type == "Recording"),
+            inUseMap, isJobRunning, recMap, sort);
+    }
 
     QMap<QString,ProgramInfo*>::iterator mit = recMap.begin();
     for (; mit != recMap.end(); mit = recMap.erase(mit))
         delete *mit;
 
     QStringList outputlist(QString::number(destination.size()));
+    PackedListWriter packedlist;
     QMap<QString, int> backendPortMap;
-    int port = gCoreContext->GetBackendServerPort();
-    QString host = gCoreContext->GetHostName();
 
-    auto it = destination.begin();
-    for (it = destination.begin(); it != destination.end(); ++it)
+    for (auto *proginfo : destination)
     {
-        ProgramInfo *proginfo = *it;
-        PlaybackSock *slave = nullptr;
+        FillRecordingInfo(proginfo, playbackhost, backendPortMap);
 
-        if (proginfo->GetHostname() != gCoreContext->GetHostName())
-            slave = GetSlaveByHostname(proginfo->GetHostname());
+        if (packed)
+            proginfo->ToPackedList(packedlist);
+        else
+            proginfo->ToStringList(outputlist);
+    }
+
+    if (!packed)
+    {
+        SendResponse(pbssock, outputlist);
+        return;
+    }
+
+    QByteArray data = packedlist.GetData();
+    QStringList header("PACKED");
+    header << QString::number(packedlist.GetCount())
+           << QString::number(data.size());
+    SendResponse(pbssock, header);
 
-        if ((proginfo->GetHostname() == gCoreContext->GetHostName()) ||
-            (!slave && m_masterBackendOverride))
+    int written = 0;
+    while (written < data.size() && pbssock->IsConnected())
+    {
+        int ret = pbssock->Write(data.constData() + written,
+                                 data.size() - written);
+        if (ret <= 0)
+            break;
+        written += ret;
+    }
+    if (written < data.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("HandleQueryRecordings() wrote only %1 of %2 bytes")
+                .arg(written).arg(data.size()));
+    }
+}
+
+/**
+ * \fn MainServer::FillRecordingInfo(ProgramInfo*, const QString&, QMap<QString,int>&)
+ * \brief Sets the pathname and file size of a recording loaded for a
+ *        client, asking the slave holding it where needed.
+ */
+void MainServer::FillRecordingInfo(ProgramInfo *proginfo,
+                                   const QString &playbackhost,
+                                   QMap<QString, int> &backendPortMap)
+{
+    int port = gCoreContext->GetBackendServerPort();
+    QString host = gCoreContext->GetHostName();
+    PlaybackSock *slave = nullptr;
+
+    if (proginfo->GetHostname() != gCoreContext->GetHostName())
+        slave = GetSlaveByHostname(proginfo->GetHostname());
+
+    if ((proginfo->GetHostname() == gCoreContext->GetHostName()) ||
+        (!slave && m_masterBackendOverride))
+    {
+        proginfo->SetPathname(MythCoreContext::GenMythURL(host,port,
+                                                          proginfo->GetBasename()));
+        if (!proginfo->GetFilesize())
         {
-            proginfo->SetPathname(MythCoreContext::GenMythURL(host,port,
-                                                              proginfo->GetBasename()));
-            if (!proginfo->GetFilesize())
+            QString tmpURL = GetPlaybackURL(proginfo);
+            if (tmpURL.startsWith('/'))
             {
-                QString tmpURL = GetPlaybackURL(proginfo);
-                if (tmpURL.startsWith('/'))
+                QFile checkFile(tmpURL);
+                if (!tmpURL.isEmpty() && checkFile.exists())
                 {
-                    QFile checkFile(tmpURL);
-                    if (!tmpURL.isEmpty() && checkFile.exists())
+                    proginfo->SetFilesize(checkFile.size());
+                    if (proginfo->GetRecordingEndTime() <
+                        MythDate::current())
                     {
-                        proginfo->SetFilesize(checkFile.size());
-                        if (proginfo->GetRecordingEndTime() <
-                            MythDate::current())
-                        {
-                            proginfo->SaveFilesize(proginfo->GetFilesize());
-                        }
+                        proginfo->SaveFilesize(proginfo->GetFilesize());
                     }
                 }
             }
         }
-        else if (!slave)
+    }
+    else if (!slave)
+    {
+        proginfo->SetPathname(GetPlaybackURL(proginfo));
+        if (proginfo->GetPathname().isEmpty())
         {
-            proginfo->SetPathname(GetPlaybackURL(proginfo));
-            if (proginfo->GetPathname().isEmpty())
-            {
-                LOG(VB_GENERAL, LOG_ERR, LOC +
-                    QString("HandleQueryRecordings() "
-                            "Couldn't find backend for:\n\t\t\t%1")
-                        .arg(proginfo->toString(ProgramInfo::kTitleSubtitle)));
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("HandleQueryRecordings() "
+                        "Couldn't find backend for:\n\t\t\t%1")
+                    .arg(proginfo->toString(ProgramInfo::kTitleSubtitle)));
 
-                proginfo->SetFilesize(0);
-                proginfo->SetPathname("file not found");
-            }
+            proginfo->SetFilesize(0);
+            proginfo->SetPathname("file not found");
         }
-        else
+    }
+    else
+    {
+        if (!proginfo->GetFilesize())
         {
-            if (!proginfo->GetFilesize())
+            if (!slave->FillProgramInfo(*proginfo, playbackhost))
             {
-                if (!slave->FillProgramInfo(*proginfo, playbackhost))
-                {
-                    LOG(VB_GENERAL, LOG_ERR, LOC +
-                        "MainServer::HandleQueryRecordings()"
-                        "\n\t\t\tCould not fill program info "
-                        "from backend");
-                }
-                else
-                {
-                    if (proginfo->GetRecordingEndTime() <
-                        MythDate::current())
-                    {
-                        proginfo->SaveFilesize(proginfo->GetFilesize());
-                    }
-                }
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    "MainServer::HandleQueryRecordings()"
+                    "\n\t\t\tCould not fill program info "
+                    "from backend");
             }
             else
             {
-                ProgramInfo *p      = proginfo;
-                QString hostname    = p->GetHostname();
+                if (proginfo->GetRecordingEndTime() <
+                    MythDate::current())
+                {
+                    proginfo->SaveFilesize(proginfo->GetFilesize());
+                }
+            }
+        }
+        else
+        {
+            ProgramInfo *p      = proginfo;
+            QString hostname    = p->GetHostname();
 
-                if (!backendPortMap.contains(hostname))
-                    backendPortMap[hostname] = gCoreContext->GetBackendServerPort(hostname);
+            if (!backendPortMap.contains(hostname))
+                backendPortMap[hostname] = gCoreContext->GetBackendServerPort(hostname);
 
-                p->SetPathname(MythCoreContext::GenMythURL(hostname,
-                                                           backendPortMap[hostname],
-                                                           p->GetBasename()));
-            }
+            p->SetPathname(MythCoreContext::GenMythURL(hostname,
+                                                       backendPortMap[hostname],
+                                                       p->GetBasename()));
         }
+    }
 
-        if (slave)
-            slave->DecrRef();
+    if (slave)
+        slave->DecrRef();
+}
 
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDINGS_CHANGES \e cursor
+ * Returns the recordings changed since the list a client loaded at
+ * \e cursor, so the client need not load the whole list again.
+ *
+ * The response is CHANGES \e newcursor \e ndeleted, the recordedid of
+ * each deleted recording, \e nchanged and the programinfo of each added
+ * or changed recording.  If the cursor is empty, from before a backend
+ * restart or too old, the response is FULL \e newcursor and the client
+ * must load the whole list with QUERY_RECORDINGS.  In either case the
+ * client asks with \e newcursor next time.
+ */
+void MainServer::HandleQueryRecordingsChanges(const QString &cursor,
+                                              PlaybackSock *pbs)
+{
+    MythSocket *pbssock = pbs->getSocket();
+    QString playbackhost = pbs->getHostname();
+
+    QString newcursor;
+    QList<uint> changed;
+    QList<uint> deleted;
+    if (!m_recordingChanges.GetChanges(cursor, newcursor, changed, deleted))
+    {
+        QStringList outputlist("FULL");
+        outputlist << newcursor;
+        SendResponse(pbssock, outputlist);
+        return;
+    }
+
+    ProgramList destination;
+    if (!changed.isEmpty())
+    {
+        QMap<QString,ProgramInfo*> recMap;
+        if (m_sched)
+            recMap = m_sched->GetRecording();
+
+        QMap<QString,uint32_t> inUseMap = ProgramInfo::QueryInUseMap();
+        QMap<QString,bool> isJobRunning =
+            ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
+
+        LoadFromRecorded(destination, false, inUseMap, isJobRunning, recMap,
+                         0, "", changed);
+
+        QMap<QString,ProgramInfo*>::iterator mit = recMap.begin();
+        for (; mit != recMap.end(); mit = recMap.erase(mit))
+            delete *mit;
+    }
+
+    // A recording changed and then deleted before the query reaches
+    // the database is reported as deleted
+    QSet<uint> found;
+    for (auto *proginfo : destination)
+        found.insert(proginfo->GetRecordingID());
+    for (uint recordedid : qAsConst(changed))
+    {
+        if (!found.contains(recordedid))
+            deleted.push_back(recordedid);
+    }
+
+    QStringList outputlist("CHANGES");
+    outputlist << newcursor << QString::number(deleted.size());
+    for (uint recordedid : qAsConst(deleted))
+        outputlist << QString::number(recordedid);
+
+    outputlist << QString::number(destination.size());
+    QMap<QString, int> backendPortMap;
+    for (auto *proginfo : destination)
+    {
+        FillRecordingInfo(proginfo, playbackhost, backendPortMap);
         proginfo->ToStringList(outputlist);
     }
 
     SendResponse(pbssock, outputlist);
 }
 
+/**
+ * \fn MainServer::UpdateRecordingChangeLog(const QString&)
+ * \brief Feeds a recording list event to the log used to answer
+ *        QUERY_RECORDINGS_CHANGES and to the recorded programs cache.
+ */
+void MainServer::UpdateRecordingChangeLog(const QString &message)
+{
+    QStringList tokens = message.simplified().split(" ");
+
+    if (tokens[0] == "RECORDING_LIST_CHANGE")
+    {
+        uint recordedid = (tokens.size() >= 3) ? tokens[2].toUInt() : 0;
+        if (!recordedid)
+            m_recordingChanges.Reset();
+        else if (tokens[1] == "DELETE")
+            m_recordingChanges.Deleted(recordedid);
+        else
+            m_recordingChanges.Changed(recordedid);
+
+        if (recordedCache)
+            recordedCache->Invalidate(recordedid);
+    }
+    else if (tokens.size() >= 2)
+    {
+        // MASTER_UPDATE_REC_INFO and UPDATE_FILE_SIZE
+        m_recordingChanges.Changed(tokens[1].toUInt());
+
+        if (recordedCache && tokens[1].toUInt())
+            recordedCache->Invalidate(tokens[1].toUInt());
+    }
+}
+
 /**
  * \addtogroup myth_network_protocol
  * \par        QUERY_RECORDING BASENAME \e basename
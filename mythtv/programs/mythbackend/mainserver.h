@@ -27,6 +27,7 @@ using namespace std;
 #include "mythsocket.h"
 #include "mythdeque.h"
 #include "mythdownloadmanager.h"
+#include "recordingchangelog.h"
 
 #ifdef DeleteFile
 #undef DeleteFile
@@ -177,7 +178,13 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(QStringList &slist, PlaybackSock *pbs);
     bool HandleDeleteFile(const QString& filename, const QString& storagegroup,
                           PlaybackSock *pbs = nullptr);
-    void HandleQueryRecordings(const QString& type, PlaybackSock *pbs);
+    void HandleQueryRecordings(const QString& type, PlaybackSock *pbs,
+                               bool packed);
+    void HandleQueryRecordingsChanges(const QString &cursor,
+                                      PlaybackSock *pbs);
+    void FillRecordingInfo(ProgramInfo *proginfo, const QString &playbackhost,
+                           QMap<QString, int> &backendPortMap);
+    void UpdateRecordingChangeLog(const QString &message);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
@@ -360,6 +367,8 @@ class MainServer : public QObject, public MythSocketCBs
     QList<FileSystemInfo> m_fsInfosCache;
     QMutex                m_fsInfosCacheLock;
 
+    RecordingChangeLog         m_recordingChanges;
+
     QMutex                     m_downloadURLsLock;
     QMap<QString, QString>     m_downloadURLs;
 
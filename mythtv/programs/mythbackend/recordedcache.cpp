@@ -0,0 +1,227 @@
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QMutexLocker>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythdate.h"
+#include "mythlogging.h"
+
+#include "recordedcache.h"
+
+#define LOC QString("RecordedCache: ")
+
+const int64_t RecordedCache::kMaxAge = 10 * 60 * 1000;
+
+static bool start_time_less(const std::shared_ptr<const ProgramInfo> &a,
+                            const std::shared_ptr<const ProgramInfo> &b)
+{
+    return a->GetRecordingStartTime() < b->GetRecordingStartTime();
+}
+
+/// Sets the parts of a cached recording which LoadFromRecorded() takes
+/// from the state of the backend rather than from the database.
+static void set_current_state(ProgramInfo &pginfo, const QDateTime &rectime,
+                              const QMap<QString,uint32_t> &inUseMap,
+                              const QMap<QString,bool> &isJobRunning,
+                              const QMap<QString,ProgramInfo*> &recMap)
+{
+    QString key = pginfo.MakeUniqueKey();
+
+    if (pginfo.GetRecordingEndTime() > rectime && recMap.contains(key))
+        pginfo.SetRecordingStatus(RecStatus::Recording);
+    else
+        pginfo.SetRecordingStatus(RecStatus::Recorded);
+
+    uint32_t flags = pginfo.GetProgramFlags();
+    flags &= ~(FL_INUSERECORDING | FL_INUSEPLAYING | FL_INUSEOTHER);
+    flags |= inUseMap.value(key);
+
+    if (((flags & FL_COMMPROCESSING) != 0U) && !isJobRunning.contains(key))
+        flags &= ~FL_COMMPROCESSING;
+
+    flags &= ~FL_EDITING;
+    if (((flags & FL_REALLYEDITING) != 0U) ||
+        ((flags & COMM_FLAG_PROCESSING) != 0U))
+        flags |= FL_EDITING;
+
+    pginfo.SetProgramFlags(flags);
+}
+
+/** \fn RecordedCache::Invalidate(uint)
+ *  \brief Marks a recording as changed, it is reloaded before the next
+ *         list is handed out.
+ */
+void RecordedCache::Invalidate(uint recordedid)
+{
+    QMutexLocker locker(&m_lock);
+    m_stats.m_invalidations++;
+    if (recordedid)
+        m_changed.insert(recordedid);
+    else
+        m_reload = true;
+    m_stale = true;
+}
+
+/** \fn RecordedCache::InvalidateAll(void)
+ *  \brief Makes the next list load the whole table again.
+ */
+void RecordedCache::InvalidateAll(void)
+{
+    Invalidate(0);
+}
+
+/** \fn RecordedCache::GetRecordings(ProgramList&, bool, const QMap<QString,uint32_t>&, const QMap<QString,bool>&, const QMap<QString,ProgramInfo*>&, int)
+ *  \brief Fills destination with copies of the recordings, as
+ *         LoadFromRecorded() would without a sortBy string.
+ */
+void RecordedCache::GetRecordings(ProgramList &destination,
+                                  bool possiblyInProgressRecordingsOnly,
+                                  const QMap<QString,uint32_t> &inUseMap,
+                                  const QMap<QString,bool> &isJobRunning,
+                                  const QMap<QString,ProgramInfo*> &recMap,
+                                  int sort)
+{
+    destination.clear();
+
+    SnapshotPtr snap = std::atomic_load(&m_snapshot);
+    if (!snap || m_stale || snap->m_age.elapsed() >= kMaxAge)
+        snap = Update(inUseMap, isJobRunning, recMap);
+    else
+        m_hits++;
+
+    QDateTime now = MythDate::current();
+    QDateTime rectime = now.addSecs(
+        -gCoreContext->GetNumSetting("RecordOverTime"));
+
+    auto add = [&](const std::shared_ptr<const ProgramInfo> &cached)
+    {
+        if (possiblyInProgressRecordingsOnly &&
+            (cached->GetRecordingEndTime() < now ||
+             cached->GetRecordingStartTime() > now))
+            return;
+
+        auto *pginfo = new ProgramInfo(*cached);
+        set_current_state(*pginfo, rectime, inUseMap, isJobRunning, recMap);
+        destination.push_back(pginfo);
+    };
+
+    if (sort < 0)
+        std::for_each(snap->m_list.crbegin(), snap->m_list.crend(), add);
+    else
+        std::for_each(snap->m_list.cbegin(), snap->m_list.cend(), add);
+}
+
+/** \fn RecordedCache::Update(const QMap<QString,uint32_t>&, const QMap<QString,bool>&, const QMap<QString,ProgramInfo*>&)
+ *  \brief Builds and publishes a snapshot holding the current contents
+ *         of the recorded table.
+ *
+ *   Only the rows marked as changed are loaded, unless the whole table
+ *   has to be loaded again.  Another reader may have brought the snapshot
+ *   up to date while this one waited for m_updateLock, in which case it
+ *   is returned as is.
+ */
+RecordedCache::SnapshotPtr RecordedCache::Update(
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString,ProgramInfo*> &recMap)
+{
+    QMutexLocker updateLocker(&m_updateLock);
+    SnapshotPtr snap = std::atomic_load(&m_snapshot);
+
+    QMutexLocker locker(&m_lock);
+    bool expired = snap && snap->m_age.elapsed() >= kMaxAge;
+    bool reload = !snap || m_reload || expired;
+    QSet<uint> changed;
+    changed.swap(m_changed);
+    m_reload = false;
+    m_stale = false;
+    locker.unlock();
+
+    if (!reload && changed.isEmpty())
+    {
+        m_hits++;
+        return snap;
+    }
+
+    auto next = std::make_shared<Snapshot>();
+    ProgramList rows(false);
+
+    if (reload)
+    {
+        LoadFromRecorded(rows, false, inUseMap, isJobRunning, recMap, 1);
+
+        next->m_list.reserve(rows.size());
+        for (auto *pginfo : rows)
+            next->m_list.emplace_back(pginfo);
+        next->m_age.start();
+
+        LOG(VB_GENERAL, LOG_DEBUG, LOC +
+            QString("Loaded %1 recordings").arg(next->m_list.size()));
+    }
+    else
+    {
+        LoadFromRecorded(rows, false, inUseMap, isJobRunning, recMap,
+                         0, "", changed.values());
+
+        next->m_list.reserve(snap->m_list.size() + rows.size());
+        for (const auto & cached : snap->m_list)
+        {
+            if (!changed.contains(cached->GetRecordingID()))
+                next->m_list.push_back(cached);
+        }
+
+        // Rows no longer in the table were deleted and are left out
+        for (auto *pginfo : rows)
+        {
+            std::shared_ptr<const ProgramInfo> row(pginfo);
+            auto pos = std::upper_bound(next->m_list.begin(),
+                                        next->m_list.end(),
+                                        row, start_time_less);
+            next->m_list.insert(pos, row);
+        }
+        next->m_age = snap->m_age;
+    }
+
+    std::atomic_store(&m_snapshot, SnapshotPtr(next));
+
+    locker.relock();
+    if (reload)
+    {
+        // LoadFromRecorded() does not report a failed query, so an empty
+        // table is loaded again by the next reader
+        if (next->m_list.empty())
+        {
+            m_reload = true;
+            m_stale = true;
+        }
+        m_stats.m_misses++;
+        if (expired)
+            m_stats.m_expired++;
+    }
+    else
+    {
+        m_stats.m_refreshes++;
+        m_stats.m_refreshedRows += changed.size();
+    }
+
+    return next;
+}
+
+RecordedCacheStats RecordedCache::GetStats(void) const
+{
+    SnapshotPtr snap = std::atomic_load(&m_snapshot);
+
+    QMutexLocker locker(&m_lock);
+    RecordedCacheStats stats = m_stats;
+    stats.m_hits = m_hits;
+    stats.m_stale = m_changed.size();
+    if (snap)
+    {
+        stats.m_size = snap->m_list.size();
+        stats.m_age = snap->m_age.elapsed() / 1000;
+    }
+    return stats;
+}
@@ -0,0 +1,102 @@
+#ifndef RECORDEDCACHE_H
+#define RECORDEDCACHE_H
+
+// C++ headers
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+// MythTV headers
+#include "programinfo.h"
+
+/// Counters reported on the status page
+struct RecordedCacheStats
+{
+    uint64_t m_hits          {0}; ///< Lists served from the snapshot as is
+    uint64_t m_misses        {0}; ///< Lists that loaded the whole table
+    uint64_t m_refreshes     {0}; ///< Lists that reloaded changed rows first
+    uint64_t m_refreshedRows {0}; ///< Rows reloaded by those refreshes
+    uint64_t m_invalidations {0}; ///< Change events received
+    uint64_t m_expired       {0}; ///< Whole table loads due to the age limit
+    uint     m_size          {0}; ///< Recordings in the current snapshot
+    uint     m_stale         {0}; ///< Rows changed since the snapshot
+    int64_t  m_age           {-1}; ///< Age of the snapshot in seconds
+};
+
+/** \class RecordedCache
+ *  \brief Backend wide cache of the recordings listed by
+ *         LoadFromRecorded().
+ *
+ *   The recordings are held in an immutable snapshot sorted by start
+ *   time.  Readers pick up the current snapshot without locking and copy
+ *   the recordings they need, so any number of protocol, services and
+ *   status requests can be served at the same time.
+ *
+ *   The change events for single recordings mark those rows stale, and
+ *   the next reader reloads just those rows into a new snapshot that
+ *   shares every other recording with the old one.  A change event that
+ *   names no recording, or a snapshot older than kMaxAge, makes the next
+ *   reader load the whole table again.
+ *
+ *   The recording status and the in use and commercial flagging flags
+ *   depend on the moment a list is asked for, so they are set on the
+ *   copies handed out rather than held in the snapshot.
+ */
+class RecordedCache
+{
+  public:
+    RecordedCache() = default;
+
+    void Invalidate(uint recordedid);
+    void InvalidateAll(void);
+
+    void GetRecordings(ProgramList &destination,
+                       bool possiblyInProgressRecordingsOnly,
+                       const QMap<QString,uint32_t> &inUseMap,
+                       const QMap<QString,bool> &isJobRunning,
+                       const QMap<QString,ProgramInfo*> &recMap,
+                       int sort = 0);
+
+    RecordedCacheStats GetStats(void) const;
+
+  private:
+    using RecordedList = std::vector<std::shared_ptr<const ProgramInfo> >;
+
+    struct Snapshot
+    {
+        RecordedList  m_list;
+        QElapsedTimer m_age;
+    };
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    SnapshotPtr Update(const QMap<QString,uint32_t> &inUseMap,
+                       const QMap<QString,bool> &isJobRunning,
+                       const QMap<QString,ProgramInfo*> &recMap);
+
+    // Readers load this with std::atomic_load(), writers replace it with
+    // std::atomic_store() while holding m_updateLock.
+    SnapshotPtr             m_snapshot;
+    std::atomic<bool>       m_stale       {true};
+    std::atomic<uint64_t>   m_hits        {0};
+
+    /// Serializes the rebuilding of the snapshot
+    QMutex                  m_updateLock;
+
+    mutable QMutex          m_lock;
+    QSet<uint>              m_changed;
+    bool                    m_reload      {true};
+    RecordedCacheStats      m_stats;
+
+    /// Milliseconds a snapshot is used before the whole table is loaded
+    static const int64_t    kMaxAge;
+};
+
+#endif // RECORDEDCACHE_H
@@ -0,0 +1,99 @@
+// Qt headers
+#include <QMutexLocker>
+#include <QStringList>
+
+// MythTV headers
+#include "mythdate.h"
+
+#include "recordingchangelog.h"
+
+const int RecordingChangeLog::kMaxChanges = 10000;
+
+RecordingChangeLog::RecordingChangeLog() :
+    m_instance(QString::number(MythDate::current().toMSecsSinceEpoch(), 36))
+{
+}
+
+void RecordingChangeLog::Add(uint recordedid, ChangeType type)
+{
+    if (!recordedid)
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_byRecording.find(recordedid);
+    if (it != m_byRecording.end())
+        m_bySeq.remove(it->m_seq);
+
+    m_seq++;
+    m_byRecording[recordedid] = { m_seq, type };
+    m_bySeq[m_seq] = recordedid;
+
+    if (m_bySeq.size() > kMaxChanges)
+    {
+        // A cursor from before the dropped change could have missed it
+        auto oldest = m_bySeq.begin();
+        m_oldest = oldest.key();
+        m_byRecording.remove(*oldest);
+        m_bySeq.erase(oldest);
+    }
+}
+
+/** \fn RecordingChangeLog::Reset(void)
+ *  \brief Forgets all the changes and refuses every cursor handed out so
+ *         far, for changes that do not name a recording.
+ */
+void RecordingChangeLog::Reset(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_seq++;
+    m_oldest = m_seq;
+    m_byRecording.clear();
+    m_bySeq.clear();
+}
+
+QString RecordingChangeLog::GetCursor(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return MakeCursor();
+}
+
+QString RecordingChangeLog::MakeCursor(void) const
+{
+    return QString("%1:%2").arg(m_instance).arg(m_seq);
+}
+
+/** \fn RecordingChangeLog::GetChanges(const QString&, QString&, QList<uint>&, QList<uint>&) const
+ *  \brief Returns the recordings changed and deleted since a cursor.
+ *
+ *  \param cursor    Cursor returned by an earlier call, or empty
+ *  \param newcursor Set to the cursor of the list after these changes
+ *  \return false if the cursor can not be answered, in which case the
+ *          client must load the whole list and use newcursor from then on.
+ */
+bool RecordingChangeLog::GetChanges(
+    const QString &cursor, QString &newcursor,
+    QList<uint> &changed, QList<uint> &deleted) const
+{
+    QMutexLocker locker(&m_lock);
+    newcursor = MakeCursor();
+
+    QStringList parts = cursor.split(':');
+    if (parts.size() != 2 || parts[0] != m_instance)
+        return false;
+
+    bool ok = false;
+    uint64_t seq = parts[1].toULongLong(&ok);
+    if (!ok || seq < m_oldest || seq > m_seq)
+        return false;
+
+    for (auto it = m_bySeq.upperBound(seq); it != m_bySeq.end(); ++it)
+    {
+        if (m_byRecording[*it].m_type == kDeleted)
+            deleted.push_back(*it);
+        else
+            changed.push_back(*it);
+    }
+
+    return true;
+}
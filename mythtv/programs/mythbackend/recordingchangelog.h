@@ -0,0 +1,70 @@
+#ifndef RECORDINGCHANGELOG_H
+#define RECORDINGCHANGELOG_H
+
+// C++ headers
+#include <cstdint>
+
+// Qt headers
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/** \class RecordingChangeLog
+ *  \brief Remembers which recordings changed since a client last loaded
+ *         its recording list.
+ *
+ *   Every RECORDING_LIST_CHANGE seen by the backend bumps a sequence
+ *   number, and the latest change of each recording is kept along with
+ *   the sequence number it was seen at.  A client holds a cursor naming
+ *   the sequence number of its list and asks only for the recordings
+ *   changed after it.
+ *
+ *   The cursor also names the backend instance, so cursors handed out
+ *   before a restart are refused.  Cursors older than the changes still
+ *   held, or older than a change that did not say which recording it
+ *   was about, are refused as well and the client must load the whole
+ *   list again.
+ */
+class RecordingChangeLog
+{
+  public:
+    enum ChangeType
+    {
+        kChanged = 0,
+        kDeleted = 1,
+    };
+
+    RecordingChangeLog();
+
+    void Changed(uint recordedid) { Add(recordedid, kChanged); }
+    void Deleted(uint recordedid) { Add(recordedid, kDeleted); }
+    void Reset(void);
+
+    QString GetCursor(void) const;
+    bool GetChanges(const QString &cursor, QString &newcursor,
+                    QList<uint> &changed, QList<uint> &deleted) const;
+
+  private:
+    void Add(uint recordedid, ChangeType type);
+    QString MakeCursor(void) const;
+
+    struct Change
+    {
+        uint64_t   m_seq;
+        ChangeType m_type;
+    };
+
+    mutable QMutex          m_lock;
+    QString                 m_instance;
+    uint64_t                m_seq      {0};
+    /// Oldest sequence number a cursor may name and still be answered
+    uint64_t                m_oldest   {0};
+    QMap<uint, Change>      m_byRecording;
+    QMap<uint64_t, uint>    m_bySeq;
+
+    /// Recordings remembered before the oldest change is dropped
+    static const int kMaxChanges;
+};
+
+#endif // RECORDINGCHANGELOG_H
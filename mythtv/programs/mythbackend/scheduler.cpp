@@ -1,5 +1,6 @@
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <list>
 #include <chrono> // for milliseconds
 #include <thread> // for sleep_for
@@ -25,7 +26,10 @@ using namespace std;
 #include <QRegExp>
 #include <QMutex>
 #include <QFile>
+#include <QHash>
 #include <QMap>
+#include <QRunnable>
+#include <QDataStream>
 
 #include "mythmiscutil.h"
 #include "mythsystemlegacy.h"
@@ -67,6 +71,7 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
 {
     char *debug = getenv("DEBUG_CONFLICTS");
     debugConflicts = (debug != nullptr);
+    m_verifyPlacement = (getenv("VERIFY_PLACEMENT") != nullptr);
 
     if (master_sched)
         master_sched->GetAllPending(m_recList);
@@ -435,49 +440,105 @@ static bool comp_retry(RecordingInfo *a, RecordingInfo *b)
     return a->GetChanID() > b->GetChanID();
 }
 
+void SchedPhaseTimer::Start(const QString &name)
+{
+    Stop();
+    LOG(VB_SCHEDULE, LOG_INFO, name + "...");
+    m_name = name;
+    m_timer.start();
+}
+
+void SchedPhaseTimer::Stop(void)
+{
+    if (m_name.isEmpty())
+        return;
+    m_phases.push_back(Phase(m_name, m_timer.nsecsElapsed() / 1000));
+    m_name.clear();
+}
+
+qint64 SchedPhaseTimer::Total(void) const
+{
+    qint64 total = 0;
+    for (const auto & phase : m_phases)
+        total += phase.second;
+    return total;
+}
+
+QString SchedPhaseTimer::toString(void) const
+{
+    QStringList parts;
+    for (const auto & phase : m_phases)
+    {
+        parts << QString("%1 %2").arg(phase.first)
+            .arg(phase.second / 1000.0, 0, 'f', 2);
+    }
+    return QString("%1 ms total = ").arg(Total() / 1000.0, 0, 'f', 2) +
+        parts.join(" + ");
+}
+
 bool Scheduler::FillRecordList(void)
 {
     QReadLocker tvlocker(&TVRec::s_inputsLock);
 
     m_schedTime = MythDate::current();
+    m_phaseTimer.Clear();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "BuildWorkList...");
+    m_phaseTimer.Start("BuildWorkList");
     BuildWorkList();
 
     m_schedLock.unlock();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "AddNewRecords...");
+    m_phaseTimer.Start("AddNewRecords");
     AddNewRecords();
-    LOG(VB_SCHEDULE, LOG_INFO, "AddNotListed...");
+    m_phaseTimer.Start("AddNotListed");
     AddNotListed();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
+    bool res = PlaceWorkList();
+
+    LOG(VB_SCHEDULE, LOG_INFO, "Placement phases: " + m_phaseTimer.toString());
+
+    return res;
+}
+
+/** \fn Scheduler::PlaceWorkList(void)
+ *  \brief Schedules the entries of m_workList and moves the result
+ *         to m_recList.
+ *
+ *   This is the part of FillRecordList() that works purely in memory.
+ *   It must be called with m_schedLock released, and returns with it
+ *   held.  Each step is timed in m_phaseTimer.
+ */
+bool Scheduler::PlaceWorkList(void)
+{
+    m_phaseTimer.Start("Sort by time (overlaps)");
     SORT_RECLIST(m_workList, comp_overlap);
-    LOG(VB_SCHEDULE, LOG_INFO, "PruneOverlaps...");
+    m_phaseTimer.Start("PruneOverlaps");
     PruneOverlaps();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "Sort by priority...");
+    m_phaseTimer.Start("Sort by priority");
     SORT_RECLIST(m_workList, comp_priority);
-    LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
+    m_phaseTimer.Start("BuildListMaps");
     BuildListMaps();
-    LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
+    m_phaseTimer.Start("SchedNewRecords");
     SchedNewRecords();
-    LOG(VB_SCHEDULE, LOG_INFO, "SchedLiveTV...");
+    m_phaseTimer.Start("SchedLiveTV");
     SchedLiveTV();
-    LOG(VB_SCHEDULE, LOG_INFO, "ClearListMaps...");
+    m_phaseTimer.Start("ClearListMaps");
     ClearListMaps();
+    m_phaseTimer.Stop();
 
     m_schedLock.lock();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
+    m_phaseTimer.Start("Sort by time (redundants)");
     SORT_RECLIST(m_workList, comp_redundant);
-    LOG(VB_SCHEDULE, LOG_INFO, "PruneRedundants...");
+    m_phaseTimer.Start("PruneRedundants");
     PruneRedundants();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
+    m_phaseTimer.Start("Sort by start time");
     SORT_RECLIST(m_workList, comp_recstart);
-    LOG(VB_SCHEDULE, LOG_INFO, "ClearWorkList...");
+    m_phaseTimer.Start("ClearWorkList");
     bool res = ClearWorkList();
+    m_phaseTimer.Stop();
 
     return res;
 }
@@ -1029,8 +1090,8 @@ void Scheduler::BuildListMaps(void)
                 continue;
             }
             conflictlist->push_back(p);
-            m_titleListMap[p->GetTitle().toLower()].push_back(p);
-            m_recordIdListMap[p->GetRecordingRuleID()].push_back(p);
+            m_placement.m_titleListMap[p->GetTitle().toLower()].push_back(p);
+            m_placement.m_recordIdListMap[p->GetRecordingRuleID()].push_back(p);
         }
     }
 
@@ -1047,25 +1108,33 @@ void Scheduler::ClearListMaps(void)
 {
     for (auto & conflict : m_conflictLists)
         conflict->clear();
+    m_placement.clear();
+}
+
+void SchedPlacement::clear(void)
+{
+    m_workList.clear();
+    m_newList.clear();
+    m_sublevels.clear();
     m_titleListMap.clear();
     m_recordIdListMap.clear();
     m_cacheIsSameProgram.clear();
 }
 
 bool Scheduler::IsSameProgram(
-    const RecordingInfo *a, const RecordingInfo *b) const
+    SchedPlacement &pl, const RecordingInfo *a, const RecordingInfo *b)
 {
     IsSameKey X(a,b);
-    IsSameCacheType::const_iterator it = m_cacheIsSameProgram.constFind(X);
-    if (it != m_cacheIsSameProgram.constEnd())
+    IsSameCacheType::const_iterator it = pl.m_cacheIsSameProgram.constFind(X);
+    if (it != pl.m_cacheIsSameProgram.constEnd())
         return *it;
 
     IsSameKey Y(b,a);
-    it = m_cacheIsSameProgram.constFind(Y);
-    if (it != m_cacheIsSameProgram.constEnd())
+    it = pl.m_cacheIsSameProgram.constFind(Y);
+    if (it != pl.m_cacheIsSameProgram.constEnd())
         return *it;
 
-    return m_cacheIsSameProgram[X] = a->IsDuplicateProgram(*b);
+    return pl.m_cacheIsSameProgram[X] = a->IsDuplicateProgram(*b);
 }
 
 bool Scheduler::FindNextConflict(
@@ -1188,26 +1257,27 @@ const RecordingInfo *Scheduler::FindConflict(
     return nullptr;
 }
 
-void Scheduler::MarkOtherShowings(RecordingInfo *p)
+void Scheduler::MarkOtherShowings(SchedPlacement &pl, RecordingInfo *p)
 {
-    RecList *showinglist = &m_titleListMap[p->GetTitle().toLower()];
-    MarkShowingsList(*showinglist, p);
+    RecList *showinglist = &pl.m_titleListMap[p->GetTitle().toLower()];
+    MarkShowingsList(pl, *showinglist, p);
 
     if (p->GetRecordingRuleType() == kOneRecord ||
         p->GetRecordingRuleType() == kDailyRecord ||
         p->GetRecordingRuleType() == kWeeklyRecord)
     {
-        showinglist = &m_recordIdListMap[p->GetRecordingRuleID()];
-        MarkShowingsList(*showinglist, p);
+        showinglist = &pl.m_recordIdListMap[p->GetRecordingRuleID()];
+        MarkShowingsList(pl, *showinglist, p);
     }
     else if (p->GetRecordingRuleType() == kOverrideRecord && p->GetFindID())
     {
-        showinglist = &m_recordIdListMap[p->GetParentRecordingRuleID()];
-        MarkShowingsList(*showinglist, p);
+        showinglist = &pl.m_recordIdListMap[p->GetParentRecordingRuleID()];
+        MarkShowingsList(pl, *showinglist, p);
     }
 }
 
-void Scheduler::MarkShowingsList(RecList &showinglist, RecordingInfo *p)
+void Scheduler::MarkShowingsList(SchedPlacement &pl, RecList &showinglist,
+                                 RecordingInfo *p)
 {
     for (auto *q : showinglist)
     {
@@ -1222,7 +1292,7 @@ void Scheduler::MarkShowingsList(RecList &showinglist, RecordingInfo *p)
             q->SetRecordingStatus(RecStatus::LaterShowing);
         else if (q->GetRecordingRuleType() != kSingleRecord &&
                  q->GetRecordingRuleType() != kOverrideRecord &&
-                 IsSameProgram(q,p))
+                 IsSameProgram(pl, q, p))
         {
             if (q->GetRecordingStartTime() < p->GetRecordingStartTime())
                 q->SetRecordingStatus(RecStatus::LaterShowing);
@@ -1232,24 +1302,24 @@ void Scheduler::MarkShowingsList(RecList &showinglist, RecordingInfo *p)
     }
 }
 
-void Scheduler::BackupRecStatus(void)
+void Scheduler::BackupRecStatus(SchedPlacement &pl)
 {
-    for (auto *p : m_workList)
+    for (auto *p : pl.m_workList)
     {
         p->m_savedrecstatus = p->GetRecordingStatus();
     }
 }
 
-void Scheduler::RestoreRecStatus(void)
+void Scheduler::RestoreRecStatus(SchedPlacement &pl)
 {
-    for (auto *p : m_workList)
+    for (auto *p : pl.m_workList)
     {
         p->SetRecordingStatus(p->m_savedrecstatus);
     }
 }
 
-bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
-                                   bool livetv)
+bool Scheduler::TryAnotherShowing(SchedPlacement &pl, RecordingInfo *p,
+                                  bool samePriority, bool livetv)
 {
     PrintRec(p, "    >");
 
@@ -1259,7 +1329,7 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
         p->GetRecordingStatus() == RecStatus::Pending)
         return false;
 
-    RecList *showinglist = &m_recordIdListMap[p->GetRecordingRuleID()];
+    RecList *showinglist = &pl.m_recordIdListMap[p->GetRecordingRuleID()];
 
     RecStatus::Type oldstatus = p->GetRecordingStatus();
     p->SetRecordingStatus(RecStatus::LaterShowing);
@@ -1289,7 +1359,7 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
 
         if (!p->IsSameTitleStartTimeAndChannel(*q))
         {
-            if (!IsSameProgram(p,q))
+            if (!IsSameProgram(pl, p, q))
                 continue;
             if ((p->GetRecordingRuleType() == kSingleRecord ||
                  p->GetRecordingRuleType() == kOverrideRecord))
@@ -1344,9 +1414,9 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
         }
 
         best->SetRecordingStatus(RecStatus::WillRecord);
-        MarkOtherShowings(best);
-        if (best->GetRecordingStartTime() < m_livetvTime)
-            m_livetvTime = best->GetRecordingStartTime();
+        MarkOtherShowings(pl, best);
+        if (best->GetRecordingStartTime() < pl.m_livetvTime)
+            pl.m_livetvTime = best->GetRecordingStartTime();
         PrintRec(p, "    -");
         PrintRec(best, "    +");
         return true;
@@ -1356,6 +1426,23 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
     return false;
 }
 
+/// Places one part of the work list on the scheduler's thread pool.
+class SchedPlacementRunnable : public QRunnable
+{
+  public:
+    SchedPlacementRunnable(Scheduler &sched, SchedPlacement &placement) :
+        m_sched(sched), m_placement(placement) {}
+
+    void run(void) override // QRunnable
+    {
+        m_sched.SchedNewLevels(m_placement);
+    }
+
+  private:
+    Scheduler      &m_sched;
+    SchedPlacement &m_placement;
+};
+
 void Scheduler::SchedNewRecords(void)
 {
     if (VERBOSE_LEVEL_CHECK(VB_SCHEDULE, LOG_DEBUG))
@@ -1378,10 +1465,12 @@ void Scheduler::SchedNewRecords(void)
             "- = unschedule a showing in favor of another one");
     }
 
-    m_livetvTime = MythDate::current().addSecs(3600);
+    m_placement.m_livetvTime = MythDate::current().addSecs(3600);
     m_openEnd =
         (OpenEndType)gCoreContext->GetNumSetting("SchedOpenEnd", openEndNever);
 
+    m_placement.m_workList = m_workList;
+
     auto i = m_workList.begin();
     for ( ; i != m_workList.end(); ++i)
     {
@@ -1389,43 +1478,542 @@ void Scheduler::SchedNewRecords(void)
             (*i)->GetRecordingStatus() != RecStatus::Tuning &&
             (*i)->GetRecordingStatus() != RecStatus::Pending)
             break;
-        MarkOtherShowings(*i);
+        MarkOtherShowings(m_placement, *i);
     }
 
-    while (i != m_workList.end())
+    m_placement.m_newList.assign(i, m_workList.end());
+    BuildSublevels(m_placement);
+
+    if (gCoreContext->GetBoolSetting("SchedIncrementalPlacement", false))
+    {
+        PlaceIncremental();
+        return;
+    }
+    m_placementCache.clear();
+
+    vector<SchedPlacement> parts;
+    if (!m_parallelPlacement ||
+        !SplitPlacement(parts, static_cast<size_t>(
+                            m_placeThreadPool.maxThreadCount())))
+    {
+        SchedNewLevels(m_placement);
+        return;
+    }
+
+    LOG(VB_SCHEDULE, LOG_INFO, QString("Placing %1 entries in %2 parts")
+        .arg(m_placement.m_newList.size()).arg(parts.size()));
+
+    for (auto & part : parts)
+    {
+        m_placeThreadPool.start(new SchedPlacementRunnable(*this, part),
+                                "SchedPlacement");
+    }
+    m_placeThreadPool.waitForDone();
+
+    for (const auto & part : parts)
     {
-        auto levelStart = i;
-        int recpriority = (*i)->GetRecordingPriority();
+        if (part.m_livetvTime < m_placement.m_livetvTime)
+            m_placement.m_livetvTime = part.m_livetvTime;
+    }
+}
 
-        while (i != m_workList.end())
+/** \fn Scheduler::BuildSublevels(SchedPlacement&)
+ *  \brief Splits the new entries of a placement into runs of equal
+ *         recpriority and recpriority2, the units that SchedNewLevels()
+ *         schedules in turn.
+ */
+void Scheduler::BuildSublevels(SchedPlacement &pl)
+{
+    pl.m_sublevels.clear();
+
+    for (size_t k = 0; k < pl.m_newList.size(); ++k)
+    {
+        const RecordingInfo *p = pl.m_newList[k];
+        const RecordingInfo *next = (k + 1 < pl.m_newList.size()) ?
+            pl.m_newList[k + 1] : nullptr;
+
+        if (next &&
+            next->GetRecordingPriority() == p->GetRecordingPriority() &&
+            next->GetRecordingPriority2() == p->GetRecordingPriority2())
+            continue;
+
+        SchedSublevel sublevel;
+        sublevel.m_end = k + 1;
+        sublevel.m_levelEnd =
+            !next || next->GetRecordingPriority() != p->GetRecordingPriority();
+        pl.m_sublevels.push_back(sublevel);
+    }
+}
+
+/** \fn Scheduler::SplitPlacement(vector<SchedPlacement>&,size_t) const
+ *  \brief Divides m_placement into parts that can be placed concurrently.
+ *
+ *   Placing an entry only looks at, and changes, the entries that share
+ *   its conflict list, its title, or its recording rule (or the parent
+ *   rule of an override).  The work list is partitioned into the
+ *   connected components of those relations, and the components are
+ *   packed into at most \a maxParts parts.
+ *
+ *   Each part keeps the work list order, the map list order and the
+ *   sublevel boundaries of the whole list, so placing the parts gives
+ *   exactly the result of placing m_placement.
+ *
+ *   \return false if there is only one part, in which case \a parts
+ *           is left empty.
+ */
+bool Scheduler::SplitPlacement(vector<SchedPlacement> &parts,
+                               size_t maxParts) const
+{
+    const RecList &worklist = m_placement.m_workList;
+    size_t count = worklist.size();
+    if (count < 2 || maxParts < 2)
+        return false;
+
+    vector<size_t> root(count);
+    for (size_t k = 0; k < count; ++k)
+        root[k] = k;
+    auto findRoot = [&root](size_t k)
+    {
+        while (root[k] != k)
         {
-            if (i == m_workList.end() ||
-                (*i)->GetRecordingPriority() != recpriority)
-                break;
+            root[k] = root[root[k]];
+            k = root[k];
+        }
+        return k;
+    };
+    auto unite = [&root, &findRoot](size_t a, size_t b)
+    {
+        a = findRoot(a);
+        b = findRoot(b);
+        if (a < b)
+            root[b] = a;
+        else if (b < a)
+            root[a] = b;
+    };
+
+    QHash<const RecList*, size_t> firstByList;
+    QHash<QString, size_t>        firstByTitle;
+    QHash<uint, size_t>           firstByRule;
+    for (size_t k = 0; k < count; ++k)
+    {
+        const RecordingInfo *p = worklist[k];
+
+        auto sit = m_sinputInfoMap.constFind(p->GetInputID());
+        if (sit != m_sinputInfoMap.constEnd() && sit->m_conflictList)
+        {
+            auto lit = firstByList.constFind(sit->m_conflictList);
+            if (lit != firstByList.constEnd())
+                unite(*lit, k);
+            else
+                firstByList.insert(sit->m_conflictList, k);
+        }
+
+        QString title = p->GetTitle().toLower();
+        auto tit = firstByTitle.constFind(title);
+        if (tit != firstByTitle.constEnd())
+            unite(*tit, k);
+        else
+            firstByTitle.insert(title, k);
+
+        std::array<uint,2> rules { p->GetRecordingRuleID(),
+                                   p->GetParentRecordingRuleID() };
+        for (uint rule : rules)
+        {
+            if (!rule)
+                continue;
+            auto rit = firstByRule.constFind(rule);
+            if (rit != firstByRule.constEnd())
+                unite(*rit, k);
+            else
+                firstByRule.insert(rule, k);
+        }
+    }
+
+    // Size up the components, then pack them largest first into the
+    // least loaded part.
+    QMap<size_t, size_t> componentSize;
+    for (size_t k = 0; k < count; ++k)
+        ++componentSize[findRoot(k)];
+    if (componentSize.size() < 2)
+        return false;
+
+    vector<pair<size_t, size_t> > components; // size, root
+    for (auto it = componentSize.cbegin(); it != componentSize.cend(); ++it)
+        components.emplace_back(it.value(), it.key());
+    stable_sort(components.begin(), components.end(),
+                [](const pair<size_t, size_t> &a,
+                   const pair<size_t, size_t> &b)
+                { return a.first > b.first; });
+
+    size_t nparts = min(components.size(), maxParts);
+    vector<size_t> load(nparts, 0);
+    QHash<size_t, size_t> partOfRoot;
+    for (const auto & component : components)
+    {
+        auto best = static_cast<size_t>(
+            min_element(load.begin(), load.end()) - load.begin());
+        load[best] += component.first;
+        partOfRoot.insert(component.second, best);
+    }
+
+    parts.resize(nparts);
+    QHash<const RecordingInfo*, size_t> partOf;
+    for (size_t k = 0; k < count; ++k)
+    {
+        size_t part = partOfRoot.value(findRoot(k));
+        partOf.insert(worklist[k], part);
+        parts[part].m_workList.push_back(worklist[k]);
+    }
+
+    // Carry the sublevel boundaries over, so that no part merges two
+    // runs that the whole list schedules separately.
+    vector<bool> inSublevel(nparts, false);
+    vector<bool> inLevel(nparts, false);
+    size_t start = 0;
+    for (const auto & sublevel : m_placement.m_sublevels)
+    {
+        for (size_t k = start; k < sublevel.m_end; ++k)
+        {
+            size_t part = partOf.value(m_placement.m_newList[k]);
+            parts[part].m_newList.push_back(m_placement.m_newList[k]);
+            inSublevel[part] = true;
+        }
+        for (size_t part = 0; part < nparts; ++part)
+        {
+            if (inSublevel[part])
+            {
+                SchedSublevel partsub;
+                partsub.m_end = parts[part].m_newList.size();
+                parts[part].m_sublevels.push_back(partsub);
+                inSublevel[part] = false;
+                inLevel[part] = true;
+            }
+            if (sublevel.m_levelEnd && inLevel[part])
+            {
+                parts[part].m_sublevels.back().m_levelEnd = true;
+                inLevel[part] = false;
+            }
+        }
+        start = sublevel.m_end;
+    }
+
+    for (auto it = m_placement.m_titleListMap.cbegin();
+         it != m_placement.m_titleListMap.cend(); ++it)
+    {
+        for (auto *p : it.value())
+            parts[partOf.value(p)].m_titleListMap[it.key()].push_back(p);
+    }
+    for (auto it = m_placement.m_recordIdListMap.cbegin();
+         it != m_placement.m_recordIdListMap.cend(); ++it)
+    {
+        for (auto *p : it.value())
+            parts[partOf.value(p)].m_recordIdListMap[it.key()].push_back(p);
+    }
+
+    for (auto & part : parts)
+        part.m_livetvTime = m_placement.m_livetvTime;
+
+    return true;
+}
+
+/** \fn Scheduler::PlaceIncremental(void)
+ *  \brief Places m_placement one connected part at a time, reusing the
+ *         result of the last reschedule for every part that has not
+ *         changed since.
+ *
+ *   A RescheduleMatch for one rule, source or multiplex only changes the
+ *   work list entries it matched, and the parts of the list that share a
+ *   conflict list, title or rule with them.  Every other part holds the
+ *   same entries, in the same order and with the same status, as last
+ *   time, so placing it again would give the same statuses.
+ *
+ *   Parts are compared by PlacementKey(), which holds everything that
+ *   placing a part reads.  Anything outside the parts that placement
+ *   depends on is in PlacementScope(), and a change there drops every
+ *   saved result.  Only the results of this placement are kept.
+ *
+ *   With VERIFY_PLACEMENT set in the environment, the whole list is then
+ *   placed again from scratch and compared, see VerifyPlacement().
+ */
+void Scheduler::PlaceIncremental(void)
+{
+    QByteArray scope = PlacementScope();
+    if (scope != m_placementScope)
+    {
+        m_placementCache.clear();
+        m_placementScope = scope;
+    }
+
+    vector<RecStatus::Type> before;
+    if (m_verifyPlacement)
+    {
+        before.reserve(m_placement.m_workList.size());
+        for (const auto *p : m_placement.m_workList)
+            before.push_back(p->GetRecordingStatus());
+    }
+
+    vector<SchedPlacement> parts;
+    vector<SchedPlacement*> components;
+    if (SplitPlacement(parts, numeric_limits<size_t>::max()))
+    {
+        for (auto & part : parts)
+            components.push_back(&part);
+    }
+    else
+    {
+        components.push_back(&m_placement);
+    }
+
+    // Placing a part only ever moves m_livetvTime earlier.  Start each
+    // part far in the future, so that its result does not depend on the
+    // time this placement started from.
+    QDateTime initialLivetvTime = m_placement.m_livetvTime;
+    QDateTime livetvTime = initialLivetvTime;
+    QDateTime never = m_schedTime.addYears(100);
 
-            auto sublevelStart = i;
-            int recpriority2 = (*i)->GetRecordingPriority2();
-            LOG(VB_SCHEDULE, LOG_DEBUG, QString("Trying priority %1/%2...")
-                .arg(recpriority).arg(recpriority2));
-            // First pass for anything in this priority sublevel.
-            SchedNewFirstPass(i, m_workList.end(), recpriority, recpriority2);
+    QHash<QByteArray, SchedPlacementResult> results;
+    vector<QByteArray> keys(components.size());
+    vector<SchedPlacement*> placed;
+    uint reused = 0;
+    for (size_t k = 0; k < components.size(); ++k)
+    {
+        SchedPlacement *pl = components[k];
+        keys[k] = PlacementKey(*pl);
 
-            LOG(VB_SCHEDULE, LOG_DEBUG, QString("Retrying priority %1/%2...")
-                .arg(recpriority).arg(recpriority2));
-            SchedNewRetryPass(sublevelStart, i, true);
+        auto it = m_placementCache.constFind(keys[k]);
+        if (it != m_placementCache.constEnd() &&
+            it->m_status.size() == pl->m_workList.size())
+        {
+            for (size_t j = 0; j < pl->m_workList.size(); ++j)
+                pl->m_workList[j]->SetRecordingStatus(it->m_status[j]);
+            livetvTime = min(livetvTime, it->m_livetvTime);
+            results.insert(keys[k], *it);
+            ++reused;
+            continue;
         }
 
-        // Retry pass for anything in this priority level.
-        LOG(VB_SCHEDULE, LOG_DEBUG, QString("Retrying priority %1/*...")
-            .arg(recpriority));
-        SchedNewRetryPass(levelStart, i, false);
+        pl->m_livetvTime = never;
+        placed.push_back(pl);
+    }
+
+    if (m_parallelPlacement && placed.size() > 1)
+    {
+        for (auto *pl : placed)
+        {
+            m_placeThreadPool.start(new SchedPlacementRunnable(*this, *pl),
+                                    "SchedPlacement");
+        }
+        m_placeThreadPool.waitForDone();
+    }
+    else
+    {
+        for (auto *pl : placed)
+            SchedNewLevels(*pl);
+    }
+
+    for (size_t k = 0; k < components.size(); ++k)
+    {
+        SchedPlacement *pl = components[k];
+        if (results.contains(keys[k]))
+            continue;
+
+        SchedPlacementResult result;
+        result.m_status.reserve(pl->m_workList.size());
+        for (const auto *p : pl->m_workList)
+            result.m_status.push_back(p->GetRecordingStatus());
+        result.m_livetvTime = pl->m_livetvTime;
+        livetvTime = min(livetvTime, pl->m_livetvTime);
+        results.insert(keys[k], result);
+    }
+    m_placementCache.swap(results);
+
+    m_placementParts = components.size();
+    m_placementReused = reused;
+    LOG(VB_SCHEDULE, LOG_INFO,
+        QString("Placed %1 entries in %2 parts, reused %3 parts")
+        .arg(m_placement.m_newList.size()).arg(components.size())
+        .arg(reused));
+
+    m_placement.m_livetvTime = livetvTime;
+
+    if (m_verifyPlacement)
+        VerifyPlacement(before, initialLivetvTime);
+}
+
+/** \fn Scheduler::PlacementScope(void) const
+ *  \brief Returns what placing any part of the work list depends on
+ *         besides the entries of the part: the input topology and the
+ *         settings read by placement.
+ */
+QByteArray Scheduler::PlacementScope(void) const
+{
+    QByteArray scope;
+    QDataStream ds(&scope, QIODevice::WriteOnly);
+
+    ds << static_cast<int>(m_openEnd)
+       << ProgramInfo::UsingProgramIDAuthority();
+
+    for (auto it = m_sinputInfoMap.cbegin(); it != m_sinputInfoMap.cend(); ++it)
+    {
+        const SchedInputInfo &info = *it;
+        auto list = find(m_conflictLists.cbegin(), m_conflictLists.cend(),
+                         info.m_conflictList);
+        ds << it.key() << info.m_inputId << info.m_sgroupId
+           << info.m_schedGroup
+           << static_cast<qint64>(list - m_conflictLists.cbegin());
+        ds << static_cast<quint32>(info.m_conflictingInputs.size());
+        for (uint input : info.m_conflictingInputs)
+            ds << input;
+    }
+
+    return scope;
+}
+
+/** \fn Scheduler::PlacementKey(const SchedPlacement&) const
+ *  \brief Returns everything that placing \a pl reads: its sublevels and,
+ *         in work list order, every field of its entries that placement
+ *         looks at.
+ *
+ *   Entries are recreated from the database on each reschedule, so they
+ *   are compared by value.  Comparisons with the scheduling time are
+ *   stored as their outcome, so an unchanged part matches from one
+ *   reschedule to the next.
+ */
+QByteArray Scheduler::PlacementKey(const SchedPlacement &pl) const
+{
+    QByteArray key;
+    QDataStream ds(&key, QIODevice::WriteOnly);
+
+    // As in comp_retry()
+    QDateTime pasttime = MythDate::current().addSecs(-30);
+
+    ds << static_cast<quint64>(pl.m_workList.size())
+       << static_cast<quint64>(pl.m_newList.size());
+    for (const auto & sublevel : pl.m_sublevels)
+        ds << static_cast<quint64>(sublevel.m_end) << sublevel.m_levelEnd;
+
+    for (const auto *p : pl.m_workList)
+    {
+        ds << static_cast<int>(p->GetRecordingStatus())
+           << p->GetInputID() << p->m_sgroupId << p->m_mplexId
+           << p->GetChanID() << p->GetChannelSchedulingID()
+           << p->GetTitle() << p->GetSubtitle() << p->GetDescription()
+           << p->GetProgramID() << static_cast<int>(p->GetCategoryType())
+           << p->GetRecordingRuleID() << p->GetParentRecordingRuleID()
+           << static_cast<int>(p->GetRecordingRuleType())
+           << static_cast<int>(p->GetDuplicateCheckMethod())
+           << p->GetFindID()
+           << p->GetRecordingPriority() << p->GetRecordingPriority2()
+           << p->m_schedOrder << p->IsReactivated()
+           << p->GetScheduledStartTime()
+           << p->GetRecordingStartTime() << p->GetRecordingEndTime()
+           << (p->GetRecordingStartTime() < m_schedTime)
+           << (p->GetRecordingStartTime() < pasttime);
+    }
+
+    return key;
+}
+
+/** \fn Scheduler::VerifyPlacement(const vector<RecStatus::Type>&,const QDateTime&)
+ *  \brief Places m_placement again from scratch, and logs every entry
+ *         whose status differs from the incremental placement.
+ *
+ *   \a before holds the statuses of m_placement.m_workList before the
+ *   incremental placement, and \a livetvTime the time it started from.
+ *   The result of the full placement is kept.
+ */
+void Scheduler::VerifyPlacement(const vector<RecStatus::Type> &before,
+                                const QDateTime &livetvTime)
+{
+    RecList &worklist = m_placement.m_workList;
+    vector<RecStatus::Type> incremental;
+    incremental.reserve(worklist.size());
+    for (size_t k = 0; k < worklist.size(); ++k)
+    {
+        incremental.push_back(worklist[k]->GetRecordingStatus());
+        worklist[k]->SetRecordingStatus(before[k]);
+    }
+    QDateTime incrementalLivetvTime = m_placement.m_livetvTime;
+    m_placement.m_livetvTime = livetvTime;
+
+    SchedNewLevels(m_placement);
+
+    uint mismatches = 0;
+    for (size_t k = 0; k < worklist.size(); ++k)
+    {
+        const RecordingInfo *p = worklist[k];
+        if (p->GetRecordingStatus() == incremental[k])
+            continue;
+        ++mismatches;
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Incremental placement gave %1 for '%2' on input %3 "
+                    "at %4, full placement gave %5")
+            .arg(RecStatus::toString(incremental[k], p->GetRecordingRuleType()))
+            .arg(p->GetTitle()).arg(p->GetInputID())
+            .arg(p->GetRecordingStartTime(MythDate::ISODate))
+            .arg(RecStatus::toString(p->GetRecordingStatus(),
+                                     p->GetRecordingRuleType())));
+    }
+    if (m_placement.m_livetvTime != incrementalLivetvTime)
+    {
+        ++mismatches;
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Incremental placement avoids LiveTV from %1, "
+                    "full placement from %2")
+            .arg(incrementalLivetvTime.toString(Qt::ISODate))
+            .arg(m_placement.m_livetvTime.toString(Qt::ISODate)));
+    }
+
+    m_placementMismatches += mismatches;
+    LOG(VB_SCHEDULE, LOG_INFO,
+        QString("Checked incremental placement against a full placement, "
+                "%1 differences").arg(mismatches));
+}
+
+/** \fn Scheduler::SchedNewLevels(SchedPlacement&)
+ *  \brief Schedules the new entries of a placement, one priority
+ *         sublevel at a time, with a retry pass after each sublevel
+ *         and after each priority level.
+ */
+void Scheduler::SchedNewLevels(SchedPlacement &pl)
+{
+    auto levelStart = pl.m_newList.begin();
+    auto sublevelStart = levelStart;
+
+    for (const auto & sublevel : pl.m_sublevels)
+    {
+        auto sublevelEnd = pl.m_newList.begin() + sublevel.m_end;
+        int recpriority = (*sublevelStart)->GetRecordingPriority();
+        int recpriority2 = (*sublevelStart)->GetRecordingPriority2();
+
+        LOG(VB_SCHEDULE, LOG_DEBUG, QString("Trying priority %1/%2...")
+            .arg(recpriority).arg(recpriority2));
+        // First pass for anything in this priority sublevel.
+        auto i = sublevelStart;
+        SchedNewFirstPass(pl, i, sublevelEnd, recpriority, recpriority2);
+
+        LOG(VB_SCHEDULE, LOG_DEBUG, QString("Retrying priority %1/%2...")
+            .arg(recpriority).arg(recpriority2));
+        SchedNewRetryPass(pl, sublevelStart, sublevelEnd, true);
+
+        if (sublevel.m_levelEnd)
+        {
+            // Retry pass for anything in this priority level.
+            LOG(VB_SCHEDULE, LOG_DEBUG, QString("Retrying priority %1/*...")
+                .arg(recpriority));
+            SchedNewRetryPass(pl, levelStart, sublevelEnd, false);
+            levelStart = sublevelEnd;
+        }
+
+        sublevelStart = sublevelEnd;
     }
 }
 
 // Perform the first pass for scheduling new recordings for programs
 // in the same priority sublevel.  For each program/starttime, choose
 // the first one with the highest affinity that doesn't conflict.
-void Scheduler::SchedNewFirstPass(RecIter &start, const RecIter& end,
+void Scheduler::SchedNewFirstPass(SchedPlacement &pl, RecIter &start,
+                                  const RecIter& end,
                                   int recpriority, int recpriority2)
 {
     RecIter &i = start;
@@ -1493,9 +2081,9 @@ void Scheduler::SchedNewFirstPass(RecIter &start, const RecIter& end,
         {
             PrintRec(best, "  +");
             best->SetRecordingStatus(RecStatus::WillRecord);
-            MarkOtherShowings(best);
-            if (best->GetRecordingStartTime() < m_livetvTime)
-                m_livetvTime = best->GetRecordingStartTime();
+            MarkOtherShowings(pl, best);
+            if (best->GetRecordingStartTime() < pl.m_livetvTime)
+                pl.m_livetvTime = best->GetRecordingStartTime();
         }
     }
 }
@@ -1503,7 +2091,8 @@ void Scheduler::SchedNewFirstPass(RecIter &start, const RecIter& end,
 // Perform the retry passes for scheduling new recordings.  For each
 // unscheduled program, try to move the conflicting programs to
 // another time or tuner using the given constraints.
-void Scheduler::SchedNewRetryPass(const RecIter& start, const RecIter& end,
+void Scheduler::SchedNewRetryPass(SchedPlacement &pl, const RecIter& start,
+                                  const RecIter& end,
                                   bool samePriority, bool livetv)
 {
     RecList retry_list;
@@ -1526,28 +2115,31 @@ void Scheduler::SchedNewRetryPass(const RecIter& start, const RecIter& end,
             PrintRec(p, "  ?");
 
         // Assume we can successfully move all of the conflicts.
-        BackupRecStatus();
+        BackupRecStatus(pl);
         p->SetRecordingStatus(RecStatus::WillRecord);
         if (!livetv)
-            MarkOtherShowings(p);
+            MarkOtherShowings(pl, p);
 
         // Try to move each conflict.  Restore the old status if we
         // can't.
-        RecList &conflictlist = *m_sinputInfoMap[p->GetInputID()].m_conflictList;
+        // Only read the input map here, it is shared by concurrent
+        // placements.
+        RecList &conflictlist =
+            *m_sinputInfoMap.constFind(p->GetInputID())->m_conflictList;
         auto k = conflictlist.cbegin();
         for ( ; FindNextConflict(conflictlist, p, k); ++k)
         {
-            if (!TryAnotherShowing(*k, samePriority, livetv))
+            if (!TryAnotherShowing(pl, *k, samePriority, livetv))
             {
-                RestoreRecStatus();
+                RestoreRecStatus(pl);
                 break;
             }
         }
 
         if (!livetv && p->GetRecordingStatus() == RecStatus::WillRecord)
         {
-            if (p->GetRecordingStartTime() < m_livetvTime)
-                m_livetvTime = p->GetRecordingStartTime();
+            if (p->GetRecordingStartTime() < pl.m_livetvTime)
+                pl.m_livetvTime = p->GetRecordingStartTime();
             PrintRec(p, "  +");
         }
     }
@@ -2286,6 +2878,71 @@ void Scheduler::ResetDuplicates(uint recordid, uint findid,
     }
  }
 
+/** \fn SchedMatchScope::Covers(const SchedMatchScope&) const
+ *  \brief Returns true if matching this scope also rebuilds all of
+ *         the recordmatch rows of the other scope.
+ */
+bool SchedMatchScope::Covers(const SchedMatchScope &other) const
+{
+    if (m_recordId && m_recordId != other.m_recordId)
+        return false;
+    if (m_sourceId && m_sourceId != other.m_sourceId)
+        return false;
+    if (m_mplexId && m_mplexId != other.m_mplexId)
+        return false;
+    if (!m_maxStartTime.isValid())
+        return true;
+    return other.m_maxStartTime.isValid() &&
+        other.m_maxStartTime <= m_maxStartTime;
+}
+
+/** \fn Scheduler::AddMatchScope(QList<SchedMatchScope>&,SchedMatchScope)
+ *  \brief Adds a match request to the list of pending recordmatch updates,
+ *         dropping any work that is already, or now, covered.
+ *
+ *   Requests for the same rule, source and multiplex are merged into one
+ *   with the later start time limit.
+ */
+void Scheduler::AddMatchScope(QList<SchedMatchScope> &scopes,
+                              SchedMatchScope scope)
+{
+    for (const auto & existing : qAsConst(scopes))
+    {
+        if (existing.Covers(scope))
+            return;
+    }
+
+    auto it = scopes.begin();
+    while (it != scopes.end())
+    {
+        if (it->SameRows(scope))
+        {
+            if (!it->m_maxStartTime.isValid() ||
+                !scope.m_maxStartTime.isValid())
+                scope.m_maxStartTime = QDateTime();
+            else
+                scope.m_maxStartTime = max(scope.m_maxStartTime,
+                                           it->m_maxStartTime);
+            it = scopes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    it = scopes.begin();
+    while (it != scopes.end())
+    {
+        if (scope.Covers(*it))
+            it = scopes.erase(it);
+        else
+            ++it;
+    }
+
+    scopes.push_back(scope);
+}
+
 bool Scheduler::HandleReschedule(void)
 {
     // We might have been inactive for a long time, so make
@@ -2299,6 +2956,8 @@ bool Scheduler::HandleReschedule(void)
     QString msg;
     bool deleteFuture = false;
     bool runCheck = false;
+    QList<SchedMatchScope> matches;
+    uint matchRequests = 0;
 
     while (HaveQueuedRequests())
     {
@@ -2338,11 +2997,9 @@ bool Scheduler::HandleReschedule(void)
             QDateTime maxstarttime = MythDate::fromString(tokens[4]);
             deleteFuture = true;
             runCheck = true;
-            m_schedLock.unlock();
-            m_recordMatchLock.lock();
-            UpdateMatches(recordid, sourceid, mplexid, maxstarttime);
-            m_recordMatchLock.unlock();
-            m_schedLock.lock();
+            AddMatchScope(matches, SchedMatchScope(recordid, sourceid,
+                                                   mplexid, maxstarttime));
+            matchRequests++;
         }
         else if (tokens[0] == "CHECK")
         {
@@ -2376,6 +3033,26 @@ bool Scheduler::HandleReschedule(void)
         }
     }
 
+    // Rebuild each affected slice of recordmatch once. Requests whose
+    // slice is contained in another one are dropped. Running the
+    // matches after the CHECK requests is equivalent, since freshly
+    // matched rows are always marked for a duplicate recheck.
+    if (!matches.empty())
+    {
+        LOG(VB_SCHEDULE, LOG_INFO,
+            QString("Coalesced %1 match requests into %2 updates")
+            .arg(matchRequests).arg(matches.size()));
+        m_schedLock.unlock();
+        m_recordMatchLock.lock();
+        for (const auto & scope : qAsConst(matches))
+        {
+            UpdateMatches(scope.m_recordId, scope.m_sourceId,
+                          scope.m_mplexId, scope.m_maxStartTime);
+        }
+        m_recordMatchLock.unlock();
+        m_schedLock.lock();
+    }
+
     // Delete future oldrecorded entries that no longer
     // match any potential recordings.
     if (deleteFuture)
@@ -5592,7 +6269,7 @@ void Scheduler::SchedLiveTV(void)
 {
     int prerollseconds = gCoreContext->GetNumSetting("RecordPreRoll", 0);
     QDateTime curtime = MythDate::current();
-    int secsleft = curtime.secsTo(m_livetvTime);
+    int secsleft = curtime.secsTo(m_placement.m_livetvTime);
 
     // This check needs to be longer than the related one in
     // HandleRecording().
@@ -5614,7 +6291,8 @@ void Scheduler::SchedLiveTV(void)
         // Get the program that will be recording on this channel at
         // record start time and assume this LiveTV session continues
         // for at least another 30 minutes from now.
-        auto *dummy = new RecordingInfo(in.m_chanId, m_livetvTime, true, 4);
+        auto *dummy = new RecordingInfo(in.m_chanId,
+                                        m_placement.m_livetvTime, true, 4);
         dummy->SetRecordingStartTime(m_schedTime);
         if (m_schedTime.secsTo(dummy->GetRecordingEndTime()) < 1800)
             dummy->SetRecordingEndTime(m_schedTime.addSecs(1800));
@@ -5629,7 +6307,8 @@ void Scheduler::SchedLiveTV(void)
     if (m_livetvList.empty())
         return;
 
-    SchedNewRetryPass(m_livetvList.begin(), m_livetvList.end(), false, true);
+    SchedNewRetryPass(m_placement, m_livetvList.begin(), m_livetvList.end(),
+                      false, true);
 
     while (!m_livetvList.empty())
     {
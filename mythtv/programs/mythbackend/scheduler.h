@@ -3,15 +3,20 @@
 
 // C++ headers
 #include <deque>
+#include <utility>
 #include <vector>
 using namespace std;
 
 // Qt headers
 #include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QMutex>
 #include <QMap>
+#include <QPair>
 #include <QSet>
 
 // MythTV headers
@@ -21,6 +26,7 @@ using namespace std;
 #include "mythdeque.h"
 #include "mythscheduler.h"
 #include "mthread.h"
+#include "mthreadpool.h"
 #include "scheduledrecording.h"
 
 class EncoderLink;
@@ -43,8 +49,112 @@ class SchedInputInfo
     RecList      *m_conflictList {nullptr};
 };
 
+/** \class SchedMatchScope
+ *  \brief The slice of recordmatch that a RescheduleMatch request rebuilds.
+ *
+ *   A zero id or an invalid start time limit means "all", as in
+ *   Scheduler::UpdateMatches().
+ */
+class SchedMatchScope
+{
+  public:
+    SchedMatchScope(uint recordid, uint sourceid, uint mplexid,
+                    QDateTime maxstarttime)
+        : m_recordId(recordid), m_sourceId(sourceid), m_mplexId(mplexid),
+          m_maxStartTime(std::move(maxstarttime)) {}
+
+    bool SameRows(const SchedMatchScope &other) const
+    {
+        return m_recordId == other.m_recordId &&
+               m_sourceId == other.m_sourceId &&
+               m_mplexId  == other.m_mplexId;
+    }
+    bool Covers(const SchedMatchScope &other) const;
+
+    uint      m_recordId {0};
+    uint      m_sourceId {0};
+    uint      m_mplexId  {0};
+    QDateTime m_maxStartTime;
+};
+
+/** \class SchedPhaseTimer
+ *  \brief Wall time spent in each phase of a scheduler pass.
+ *
+ *   Starting a phase ends the previous one, so a pass is timed by
+ *   calling Start() before each step and Stop() after the last one.
+ */
+class SchedPhaseTimer
+{
+  public:
+    using Phase = QPair<QString, qint64>; // name, microseconds
+
+    void Clear(void) { m_phases.clear(); m_name.clear(); }
+    void Start(const QString &name);
+    void Stop(void);
+
+    const QList<Phase> &Phases(void) const { return m_phases; }
+    qint64 Total(void) const;
+    QString toString(void) const;
+
+  private:
+    QString       m_name;
+    QElapsedTimer m_timer;
+    QList<Phase>  m_phases;
+};
+
+// cache IsSameProgram()
+using IsSameKey = pair<const RecordingInfo*,const RecordingInfo*>;
+using IsSameCacheType = QMap<IsSameKey,bool>;
+
+/// A run of work list entries with the same recpriority and recpriority2.
+class SchedSublevel
+{
+  public:
+    size_t m_end      {0};     ///< end offset in SchedPlacement::m_newList
+    bool   m_levelEnd {false}; ///< last sublevel with this recpriority
+};
+
+/** \class SchedPlacement
+ *  \brief Working state for placing one part of the work list.
+ *
+ *   Normally the whole work list is placed using one SchedPlacement.
+ *   When the list splits into parts that share no conflict list, title
+ *   or recording rule, nothing done while placing one part can change
+ *   another, so each part gets its own SchedPlacement and the parts are
+ *   placed concurrently.
+ */
+class SchedPlacement
+{
+  public:
+    void clear(void);
+
+    RecList                m_workList;  ///< entries whose status may change
+    RecList                m_newList;   ///< entries to place, by priority
+    vector<SchedSublevel>  m_sublevels; ///< priority runs in m_newList
+    QMap<uint, RecList>    m_recordIdListMap;
+    QMap<QString, RecList> m_titleListMap;
+    IsSameCacheType        m_cacheIsSameProgram;
+    // Try to avoid LiveTV sessions until this time
+    QDateTime              m_livetvTime;
+};
+
+/** \class SchedPlacementResult
+ *  \brief The statuses that placing one part of the work list left,
+ *         kept so that the next reschedule can reuse them if the part
+ *         has not changed.  See Scheduler::PlaceIncremental().
+ */
+class SchedPlacementResult
+{
+  public:
+    vector<RecStatus::Type> m_status;     ///< by SchedPlacement::m_workList
+    QDateTime               m_livetvTime; ///< earliest recording placed
+};
+
 class Scheduler : public MThread, public MythScheduler
 {
+    friend class SchedulerBench;
+    friend class SchedPlacementRunnable;
+
   public:
     Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
               const QString& tmptable = "record", Scheduler *master_sched = nullptr);
@@ -138,8 +248,11 @@ class Scheduler : public MThread, public MythScheduler
     void DeleteTempTables(void);
     void UpdateDuplicates(void);
     bool FillRecordList(void);
+    bool PlaceWorkList(void);
     void UpdateMatches(uint recordid, uint sourceid, uint mplexid,
                        const QDateTime &maxstarttime);
+    static void AddMatchScope(QList<SchedMatchScope> &scopes,
+                              SchedMatchScope scope);
     void UpdateManuals(uint recordid);
     void BuildWorkList(void);
     bool ClearWorkList(void);
@@ -153,7 +266,8 @@ class Scheduler : public MThread, public MythScheduler
 
     bool IsBusyRecording(const RecordingInfo *rcinfo);
 
-    bool IsSameProgram(const RecordingInfo *a, const RecordingInfo *b) const;
+    static bool IsSameProgram(SchedPlacement &pl, const RecordingInfo *a,
+                              const RecordingInfo *b);
 
     bool FindNextConflict(const RecList &cardlist,
                           const RecordingInfo *p, RecConstIter &iter,
@@ -164,16 +278,28 @@ class Scheduler : public MThread, public MythScheduler
                                       uint *affinity = nullptr,
                                       bool checkAll = false)
         const;
-    void MarkOtherShowings(RecordingInfo *p);
-    void MarkShowingsList(RecList &showinglist, RecordingInfo *p);
-    void BackupRecStatus(void);
-    void RestoreRecStatus(void);
-    bool TryAnotherShowing(RecordingInfo *p,  bool samePriority,
-                           bool livetv = false);
+    static void MarkOtherShowings(SchedPlacement &pl, RecordingInfo *p);
+    static void MarkShowingsList(SchedPlacement &pl, RecList &showinglist,
+                                 RecordingInfo *p);
+    static void BackupRecStatus(SchedPlacement &pl);
+    static void RestoreRecStatus(SchedPlacement &pl);
+    bool TryAnotherShowing(SchedPlacement &pl, RecordingInfo *p,
+                           bool samePriority, bool livetv = false);
     void SchedNewRecords(void);
-    void SchedNewFirstPass(RecIter &start, const RecIter& end,
+    static void BuildSublevels(SchedPlacement &pl);
+    bool SplitPlacement(vector<SchedPlacement> &parts,
+                        size_t maxParts) const;
+    void PlaceIncremental(void);
+    QByteArray PlacementScope(void) const;
+    QByteArray PlacementKey(const SchedPlacement &pl) const;
+    void VerifyPlacement(const vector<RecStatus::Type> &before,
+                         const QDateTime &livetvTime);
+    void SchedNewLevels(SchedPlacement &pl);
+    void SchedNewFirstPass(SchedPlacement &pl, RecIter &start,
+                           const RecIter& end,
                            int recpriority, int recpriority2);
-    void SchedNewRetryPass(const RecIter& start, const RecIter& end,
+    void SchedNewRetryPass(SchedPlacement &pl, const RecIter& start,
+                           const RecIter& end,
                            bool samePriority, bool livetv = false);
     void SchedLiveTV(void);
     void PruneRedundants(void);
@@ -243,11 +369,22 @@ class Scheduler : public MThread, public MythScheduler
     RecList                m_livetvList;
     QMap<uint, SchedInputInfo> m_sinputInfoMap;
     vector<RecList *>      m_conflictLists;
-    QMap<uint, RecList>    m_recordIdListMap;
-    QMap<QString, RecList> m_titleListMap;
+    SchedPlacement         m_placement;
+    MThreadPool            m_placeThreadPool {"SchedPlacement"};
+    bool                   m_parallelPlacement {true};
+
+    // Results of the last incremental placement, by PlacementKey(), and
+    // the PlacementScope() they are valid for
+    QHash<QByteArray, SchedPlacementResult> m_placementCache;
+    QByteArray             m_placementScope;
+    bool                   m_verifyPlacement     {false};
+    uint                   m_placementParts      {0};
+    uint                   m_placementReused     {0};
+    uint                   m_placementMismatches {0};
 
     QDateTime m_schedTime;
     bool m_recListChanged              {false};
+    SchedPhaseTimer m_phaseTimer;
 
     bool m_specSched;
     bool m_schedulingEnabled           {true};
@@ -274,19 +411,12 @@ class Scheduler : public MThread, public MythScheduler
 
     std::array<QSet<QString>,4> m_sysEvents;
 
-    // Try to avoid LiveTV sessions until this time
-    QDateTime m_livetvTime;
-
     QDateTime m_lastPrepareTime;
     // Delay shutdown util this time (ms since epoch);
     int64_t m_delayShutdownTime        {0};
 
     OpenEndType m_openEnd;
 
-    // cache IsSameProgram()
-    using IsSameKey = pair<const RecordingInfo*,const RecordingInfo*>;
-    using IsSameCacheType = QMap<IsSameKey,bool>;
-    mutable IsSameCacheType m_cacheIsSameProgram;
     int m_tmLastLog                    {0};
 };
 
@@ -0,0 +1,566 @@
+// C++ headers
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QStringList>
+
+// MythTV headers
+#include "exitcodes.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "recordinginfo.h"
+#include "scheduler.h"
+#include "schedulerbench.h"
+
+#define LOC QString("SchedBench: ")
+
+/// One tuner, i.e. one input group holding a parent input and any
+/// multirec children.
+struct BenchTuner
+{
+    uint m_sourceId;
+    uint m_numInputs;
+    bool m_schedGroup;
+    uint m_inputGroup;
+    int  m_priority;
+};
+
+// Three multirec DVB tuners on the first source, and a capture card
+// on the second whose two inputs share one input group.
+static const std::array<BenchTuner,5> kTuners
+{{
+    { 1, 3, true,  1,  0 },
+    { 1, 3, true,  2,  0 },
+    { 1, 2, true,  3,  0 },
+    { 2, 1, false, 4, -1 },
+    { 2, 1, false, 4, -1 },
+}};
+
+static constexpr uint kNumSources        = 2;
+static constexpr uint kChannelsPerSource = 30;
+static constexpr uint kChannelsPerMplex  = 6;
+static constexpr uint kGuideDays         = 4;
+static constexpr uint kNumTitles         = 240;
+static constexpr uint kTitlesPerSource   = kNumTitles / kNumSources;
+static constexpr uint kEpisodesPerTitle  = 12;
+static constexpr uint kNumRules          = 80;
+
+/// The guide starts at midnight UTC on a Monday, so that the schedule,
+/// the find ids and the digest do not depend on when or where it is run.
+static const QDateTime kBenchEpoch(QDate(2020, 1, 6), QTime(0, 0), Qt::UTC);
+
+static const std::array<RecordingDupMethodType,5> kDupMethods
+{{
+    kDupCheckSubDesc, kDupCheckSub, kDupCheckDesc,
+    kDupCheckSubThenDesc, kDupCheckNone,
+}};
+
+/// Integer mixer so the corpus does not depend on the C library rand().
+static uint bench_hash(uint a, uint b)
+{
+    uint h = (a * 0x9E3779B1U) ^ (b + 0x7F4A7C15U + (a << 6) + (a >> 2));
+    h ^= h >> 15;
+    h *= 0x2C1B3C6DU;
+    h ^= h >> 12;
+    h *= 0x297A2D39U;
+    h ^= h >> 15;
+    return h;
+}
+
+static QString bench_title(uint title)
+{
+    return QString("Series %1").arg(title, 3, 10, QChar('0'));
+}
+
+/** \fn SchedulerBench::BuildInputs(void)
+ *  \brief Replaces the scheduler's input map, which was loaded from the
+ *         database, with the synthetic tuner topology in kTuners.
+ */
+void SchedulerBench::BuildInputs(void)
+{
+    Scheduler &s = *m_sched;
+
+    while (!s.m_conflictLists.empty())
+    {
+        delete s.m_conflictLists.back();
+        s.m_conflictLists.pop_back();
+    }
+    s.m_sinputInfoMap.clear();
+    m_sourceInputs.clear();
+    m_inputPriority.clear();
+
+    QMap<uint, vector<uint> > groupInputs;
+    uint inputid = 0;
+    for (const auto & tuner : kTuners)
+    {
+        uint parentid = inputid + 1;
+        for (uint i = 0; i < tuner.m_numInputs; ++i)
+        {
+            ++inputid;
+            SchedInputInfo &siinfo = s.m_sinputInfoMap[inputid];
+            siinfo.m_inputId = inputid;
+            siinfo.m_sgroupId = tuner.m_schedGroup ? parentid : inputid;
+            siinfo.m_schedGroup = tuner.m_schedGroup;
+            if (i == 0 && tuner.m_schedGroup)
+            {
+                for (uint j = 0; j < tuner.m_numInputs; ++j)
+                    siinfo.m_groupInputs.push_back(parentid + j);
+            }
+            groupInputs[tuner.m_inputGroup].push_back(inputid);
+            m_sourceInputs[tuner.m_sourceId].push_back(inputid);
+            m_inputPriority[inputid] = tuner.m_priority;
+        }
+    }
+
+    for (const auto & inputs : qAsConst(groupInputs))
+    {
+        auto *conflictlist = new RecList();
+        s.m_conflictLists.push_back(conflictlist);
+        for (uint id : inputs)
+        {
+            SchedInputInfo &siinfo = s.m_sinputInfoMap[id];
+            siinfo.m_conflictList = conflictlist;
+            for (uint other : inputs)
+            {
+                if (other != id)
+                    siinfo.m_conflictingInputs.push_back(other);
+            }
+        }
+    }
+}
+
+/** \fn SchedulerBench::BuildGuide(void)
+ *  \brief Fills every channel with back to back half hour and hour long
+ *         showings drawn from a fixed pool of series and episodes.
+ *
+ *   Each source carries its own series, so the two sources can be
+ *   placed independently.
+ */
+void SchedulerBench::BuildGuide(void)
+{
+    m_channels.clear();
+    m_showings.clear();
+
+    for (uint source = 1; source <= kNumSources; ++source)
+    {
+        for (uint n = 0; n < kChannelsPerSource; ++n)
+        {
+            Channel chan;
+            chan.m_chanId   = source * 1000 + n + 1;
+            chan.m_sourceId = source;
+            // The second source is analog, so it has no multiplexes.
+            chan.m_mplexId  = (source == 1) ?
+                source * 100 + n / kChannelsPerMplex + 1 : 0;
+            chan.m_chanNum  = QString::number(source * 100 + n + 1);
+            chan.m_callsign = QString("S%1C%2").arg(source).arg(n + 1);
+            m_channels.push_back(chan);
+        }
+    }
+
+    QDateTime guideEnd = m_baseTime.addDays(kGuideDays);
+    for (uint c = 0; c < m_channels.size(); ++c)
+    {
+        QDateTime start = m_baseTime;
+        while (start < guideEnd)
+        {
+            uint minute = m_baseTime.secsTo(start) / 60;
+            uint h = bench_hash(m_channels[c].m_chanId, minute);
+
+            Showing show;
+            show.m_channel = c;
+            show.m_title   = (h >> 8) % kTitlesPerSource +
+                (m_channels[c].m_sourceId - 1) * kTitlesPerSource;
+            show.m_episode = (h >> 20) % kEpisodesPerTitle + 1;
+            show.m_start   = start;
+            show.m_end     = start.addSecs((h % 4 == 0) ? 3600 : 1800);
+            m_showings.push_back(show);
+
+            start = show.m_end;
+        }
+    }
+}
+
+/** \fn SchedulerBench::BuildRules(void)
+ *  \brief Creates recording rules of every type and matches them against
+ *         the guide, as UpdateMatches() would in recordmatch.
+ *
+ *   Most rules are "All" rules; the rest cycle through the other types.
+ *   Override and "Don't Record" rules are attached to the second showing
+ *   of the "All" rule eight positions earlier, so that PruneOverlaps()
+ *   has real work to do.
+ */
+void SchedulerBench::BuildRules(void)
+{
+    m_rules.clear();
+
+    vector<vector<uint> > byTitle(kNumTitles);
+    for (uint i = 0; i < m_showings.size(); ++i)
+        byTitle[m_showings[i].m_title].push_back(i);
+
+    for (uint r = 0; r < kNumRules; ++r)
+    {
+        Rule rule;
+        rule.m_recordId  = r + 1;
+        rule.m_title     = (r * 3) % kNumTitles;
+        rule.m_dupMethod = kDupMethods[(r + r / 10) % kDupMethods.size()];
+        rule.m_priority  = static_cast<int>(bench_hash(r, 7) % 6) - 2;
+
+        switch (r % 10)
+        {
+            case 4:  rule.m_type = kDailyRecord;    break;
+            case 5:  rule.m_type = kWeeklyRecord;   break;
+            case 6:  rule.m_type = kOneRecord;      break;
+            case 7:  rule.m_type = kSingleRecord;   break;
+            case 8:  rule.m_type = kOverrideRecord; break;
+            case 9:  rule.m_type = kDontRecord;     break;
+            default: rule.m_type = kAllRecord;      break;
+        }
+
+        if (rule.m_type == kOverrideRecord || rule.m_type == kDontRecord)
+        {
+            rule.m_parentId = rule.m_recordId - 8;
+            rule.m_title    = m_rules[rule.m_parentId - 1].m_title;
+        }
+
+        const vector<uint> &showings = byTitle[rule.m_title];
+        if (showings.empty())
+        {
+            m_rules.push_back(rule);
+            continue;
+        }
+        const Showing &first = m_showings[showings[0]];
+
+        for (uint idx : showings)
+        {
+            const Showing &show = m_showings[idx];
+            bool match = false;
+            switch (rule.m_type)
+            {
+                case kDailyRecord:
+                    match = show.m_channel == first.m_channel &&
+                        show.m_start.time() == first.m_start.time();
+                    break;
+                case kWeeklyRecord:
+                    match = show.m_channel == first.m_channel &&
+                        show.m_start.time() == first.m_start.time() &&
+                        show.m_start.date().dayOfWeek() ==
+                        first.m_start.date().dayOfWeek();
+                    break;
+                case kSingleRecord:
+                    match = (idx == showings[0]);
+                    break;
+                case kOverrideRecord:
+                case kDontRecord:
+                    match = (idx == showings[min<size_t>(1, showings.size() - 1)]);
+                    break;
+                default:
+                    match = true;
+                    break;
+            }
+            if (match)
+                rule.m_showings.push_back(idx);
+        }
+
+        m_rules.push_back(rule);
+    }
+}
+
+/** \fn SchedulerBench::BuildWorkList(void)
+ *  \brief Fills the scheduler's work list with one entry per matched
+ *         showing and input, as AddNewRecords() does from the database.
+ */
+void SchedulerBench::BuildWorkList(void)
+{
+    Scheduler &s = *m_sched;
+
+    for (const auto & rule : m_rules)
+    {
+        for (uint idx : rule.m_showings)
+        {
+            const Showing &show = m_showings[idx];
+            const Channel &chan = m_channels[show.m_channel];
+
+            // The analog source has no program ids, so duplicate
+            // matching has to fall back to the subtitle and description.
+            QString programid;
+            if (chan.m_sourceId == 1)
+            {
+                programid = QString("EP%1%2")
+                    .arg(show.m_title, 6, 10, QChar('0'))
+                    .arg(show.m_episode, 4, 10, QChar('0'));
+            }
+            QString subtitle = (show.m_episode % 7 == 0) ? QString() :
+                QString("Episode %1").arg(show.m_episode);
+            QString description = QString("Synthetic episode %1 of %2")
+                .arg(show.m_episode).arg(bench_title(show.m_title));
+
+            // Count days and weeks from the start of the guide, which
+            // begins on a Monday, rather than from the calendar.
+            uint findid = 0;
+            uint day = m_baseTime.date().daysTo(show.m_start.date());
+            if (rule.m_type == kDailyRecord || rule.m_type == kOverrideRecord ||
+                rule.m_type == kDontRecord)
+                findid = day + 1;
+            else if (rule.m_type == kWeeklyRecord)
+                findid = day / 7 + 1;
+
+            RecStatus::Type recstatus = RecStatus::Unknown;
+            if (rule.m_type == kDontRecord)
+                recstatus = RecStatus::DontRecord;
+            else if (rule.m_type != kSingleRecord &&
+                     rule.m_type != kOverrideRecord &&
+                     rule.m_dupMethod != kDupCheckNone &&
+                     show.m_episode % 5 == 0)
+                recstatus = RecStatus::PreviousRecording;
+
+            for (uint inputid : m_sourceInputs[chan.m_sourceId])
+            {
+                auto *p = new RecordingInfo(
+                    bench_title(show.m_title), QString(),
+                    subtitle, QString(), description,
+                    0, show.m_episode, kEpisodesPerTitle, QString(),
+                    "Synthetic",
+
+                    chan.m_chanId, chan.m_chanNum,
+                    chan.m_callsign, chan.m_callsign,
+
+                    "Default", "Default",
+                    QString(), "Default",
+
+                    0, 0, 0,
+
+                    QString("SH%1").arg(show.m_title, 6, 10, QChar('0')),
+                    programid, QString(), kCategorySeries,
+
+                    rule.m_priority,
+
+                    show.m_start, show.m_end,
+                    show.m_start, show.m_end,
+
+                    0.0F, QDate(),
+
+                    false,
+
+                    RecStatus::Unknown, false,
+
+                    rule.m_recordId, rule.m_parentId, rule.m_type,
+                    kDupsInAll, rule.m_dupMethod,
+
+                    chan.m_sourceId, inputid,
+
+                    findid,
+
+                    false, 0, 0, 0,
+                    true, inputid, chan.m_mplexId,
+                    s.m_sinputInfoMap[inputid].m_sgroupId,
+                    QString("Input %1").arg(inputid));
+
+                p->SetRecordingStatus(recstatus);
+                p->SetRecordingPriority2(m_inputPriority[inputid]);
+                s.m_workList.push_back(p);
+            }
+        }
+    }
+}
+
+/** \fn SchedulerBench::ScheduleDigest(QMap<int, uint>&) const
+ *  \brief Returns a hash of the placed schedule and counts the entries
+ *         by recording status.
+ */
+QString SchedulerBench::ScheduleDigest(QMap<int, uint> &statusCounts) const
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    statusCounts.clear();
+    for (const auto *p : m_sched->m_recList)
+    {
+        ++statusCounts[p->GetRecordingStatus()];
+        hash.addData(QString("%1 %2 %3 %4 %5 %6\n")
+                     .arg(p->GetChanID())
+                     .arg(m_baseTime.secsTo(p->GetRecordingStartTime()))
+                     .arg(p->GetRecordingRuleID())
+                     .arg(p->GetInputID())
+                     .arg(p->GetRecordingStatus())
+                     .arg(p->GetRecordingPriority2()).toLatin1());
+    }
+
+    return QString(hash.result().toHex());
+}
+
+/** \fn SchedulerBench::PlaceOnce(void)
+ *  \brief Builds the work list and runs the placement phases on it.
+ *  \return The number of work list entries placed.
+ */
+uint SchedulerBench::PlaceOnce(void)
+{
+    // Schedule from two hours before the guide starts, so nothing is
+    // treated as in progress or already missed.
+    m_sched->m_schedTime = m_baseTime.addSecs(-2 * 3600);
+    m_sched->m_phaseTimer.Clear();
+    m_sched->m_phaseTimer.Start("AddNewRecords (synthetic)");
+    BuildWorkList();
+    uint worklist = m_sched->m_workList.size();
+    m_sched->PlaceWorkList();
+    m_sched->m_schedLock.unlock();
+    return worklist;
+}
+
+/** \fn SchedulerBench::Run(int)
+ *  \brief Places the synthetic work list \a iterations times and prints
+ *         the per phase wall time and the resulting schedule.
+ *
+ *   Returns GENERIC_EXIT_NOT_OK if a run does not produce the same
+ *   schedule as placing the whole list serially, or if incremental
+ *   placement differs from a full placement.
+ */
+int SchedulerBench::Run(int iterations)
+{
+    // Keep the result independent of this host's settings.  SchedOpenEnd
+    // is the only one the placement phases read; SchedLiveTV() also reads
+    // RecordPreRoll, but there are no encoders watching Live TV here.
+    gCoreContext->OverrideSettingForSession("SchedOpenEnd", "0");
+
+    m_baseTime = kBenchEpoch;
+
+    BuildInputs();
+    BuildGuide();
+    BuildRules();
+
+    uint matches = 0;
+    for (const auto & rule : m_rules)
+        matches += rule.m_showings.size();
+
+    cout << QString("Scheduler benchmark: %1 inputs in %2 conflict groups, "
+                    "%3 channels, %4 showings, %5 rules, %6 matches\n")
+        .arg(m_sched->m_sinputInfoMap.size())
+        .arg(m_sched->m_conflictLists.size())
+        .arg(m_channels.size()).arg(m_showings.size())
+        .arg(m_rules.size()).arg(matches).toLocal8Bit().constData();
+
+    QList<SchedPhaseTimer::Phase> best;
+    QList<qint64> totals;
+    QMap<int, uint> statusCounts;
+    bool consistent = true;
+
+    // Place the list once without splitting it, as the reference for
+    // the timed runs.
+    m_sched->m_parallelPlacement = false;
+    uint worklist = PlaceOnce();
+    QString digest = ScheduleDigest(statusCounts);
+    m_sched->m_parallelPlacement = true;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        PlaceOnce();
+
+        const QList<SchedPhaseTimer::Phase> &phases =
+            m_sched->m_phaseTimer.Phases();
+        if (best.empty())
+        {
+            best = phases;
+            for (const auto & phase : phases)
+                totals.push_back(phase.second);
+        }
+        else
+        {
+            for (int j = 0; j < best.size() && j < phases.size(); ++j)
+            {
+                best[j].second = min(best[j].second, phases[j].second);
+                totals[j] += phases[j].second;
+            }
+        }
+
+        QString runDigest = ScheduleDigest(statusCounts);
+        if (runDigest != digest)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Run %1 produced schedule %2, the serial "
+                        "placement produced %3")
+                .arg(i + 1).arg(runDigest).arg(digest));
+            consistent = false;
+        }
+    }
+
+    // Place the list incrementally.  The first run places every part,
+    // the second reuses every part and the third, after one rule has
+    // changed, places only the parts of that rule again.  Each is checked
+    // against a full placement, then a run reusing every part is timed.
+    gCoreContext->OverrideSettingForSession("SchedIncrementalPlacement", "1");
+    bool verify = m_sched->m_verifyPlacement;
+    m_sched->m_verifyPlacement = true;
+    m_sched->m_placementMismatches = 0;
+    PlaceOnce();
+    PlaceOnce();
+    m_rules[0].m_priority++;
+    PlaceOnce();
+    uint changedParts = m_sched->m_placementParts - m_sched->m_placementReused;
+    m_rules[0].m_priority--;
+    m_sched->m_verifyPlacement = false;
+    PlaceOnce();
+    PlaceOnce();
+    m_sched->m_verifyPlacement = verify;
+    gCoreContext->ClearOverrideSettingForSession("SchedIncrementalPlacement");
+
+    qint64 incrementalTime = 0;
+    for (const auto & phase : m_sched->m_phaseTimer.Phases())
+    {
+        if (phase.first == "SchedNewRecords")
+            incrementalTime = phase.second;
+    }
+
+    QString incrementalDigest = ScheduleDigest(statusCounts);
+    if (incrementalDigest != digest || m_sched->m_placementMismatches)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Incremental placement produced schedule %1 with %2 "
+                    "differences from a full placement, the serial "
+                    "placement produced %3")
+            .arg(incrementalDigest).arg(m_sched->m_placementMismatches)
+            .arg(digest));
+        consistent = false;
+    }
+
+    cout << QString("Work list: %1 entries, %2 runs\n")
+        .arg(worklist).arg(iterations).toLocal8Bit().constData();
+    cout << QString("%1 %2 %3\n").arg("Phase", -28)
+        .arg("min ms", 10).arg("avg ms", 10).toLocal8Bit().constData();
+    qint64 besttotal = 0;
+    qint64 avgtotal = 0;
+    for (int j = 0; j < best.size(); ++j)
+    {
+        besttotal += best[j].second;
+        avgtotal += totals[j] / iterations;
+        cout << QString("%1 %2 %3\n").arg(best[j].first, -28)
+            .arg(best[j].second / 1000.0, 10, 'f', 3)
+            .arg(totals[j] / iterations / 1000.0, 10, 'f', 3)
+            .toLocal8Bit().constData();
+    }
+    cout << QString("%1 %2 %3\n").arg("Total", -28)
+        .arg(besttotal / 1000.0, 10, 'f', 3)
+        .arg(avgtotal / 1000.0, 10, 'f', 3).toLocal8Bit().constData();
+
+    cout << QString("Incremental placement: %1 parts, %2 placed again "
+                    "after a rule change, SchedNewRecords %3 ms when "
+                    "nothing changed\n")
+        .arg(m_sched->m_placementParts).arg(changedParts)
+        .arg(incrementalTime / 1000.0, 0, 'f', 3)
+        .toLocal8Bit().constData();
+
+    cout << QString("Schedule: %1 entries\n")
+        .arg(m_sched->m_recList.size()).toLocal8Bit().constData();
+    for (auto it = statusCounts.cbegin(); it != statusCounts.cend(); ++it)
+    {
+        cout << QString("  %1 %2\n")
+            .arg(RecStatus::toString(RecStatus::Type(it.key())), -24)
+            .arg(it.value(), 6).toLocal8Bit().constData();
+    }
+    cout << QString("Schedule digest: %1\n").arg(digest)
+        .toLocal8Bit().constData();
+
+    gCoreContext->ClearOverrideSettingForSession("SchedOpenEnd");
+
+    return consistent ? GENERIC_EXIT_OK : GENERIC_EXIT_NOT_OK;
+}
@@ -0,0 +1,88 @@
+#ifndef SCHEDULERBENCH_H
+#define SCHEDULERBENCH_H
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QDateTime>
+#include <QString>
+#include <QMap>
+
+// MythTV headers
+#include "recordingtypes.h"
+
+class Scheduler;
+
+/** \class SchedulerBench
+ *  \brief Times the in-memory placement phases of the scheduler against
+ *         a synthetic guide, rule set and input topology.
+ *
+ *   The corpus is generated from fixed parameters on a guide anchored
+ *   to a fixed date, the scheduling time is pinned to that date and the
+ *   only setting placement reads is overridden, and nothing is read from
+ *   the database.  So the work list, the schedule and the digest printed
+ *   by Run() are the same on every run and every host, and the digest
+ *   can be compared between builds to catch changes in conflict
+ *   resolution, and the phase timings to catch changes in speed.  Each
+ *   run is also checked against a serial placement of the same list, and
+ *   incremental placement against a full placement.
+ */
+class SchedulerBench
+{
+  public:
+    explicit SchedulerBench(Scheduler *sched) : m_sched(sched) {}
+
+    int Run(int iterations = 5);
+
+  private:
+    class Channel
+    {
+      public:
+        uint    m_chanId   {0};
+        uint    m_sourceId {0};
+        uint    m_mplexId  {0};
+        QString m_chanNum;
+        QString m_callsign;
+    };
+
+    class Showing
+    {
+      public:
+        uint      m_channel {0}; // index into m_channels
+        uint      m_title   {0};
+        uint      m_episode {0};
+        QDateTime m_start;
+        QDateTime m_end;
+    };
+
+    class Rule
+    {
+      public:
+        uint                   m_recordId  {0};
+        uint                   m_parentId  {0};
+        uint                   m_title     {0};
+        RecordingType          m_type      {kNotRecording};
+        RecordingDupMethodType m_dupMethod {kDupCheckNone};
+        int                    m_priority  {0};
+        vector<uint>           m_showings; // indexes into m_showings
+    };
+
+    void BuildInputs(void);
+    void BuildGuide(void);
+    void BuildRules(void);
+    void BuildWorkList(void);
+    uint PlaceOnce(void);
+    QString ScheduleDigest(QMap<int, uint> &statusCounts) const;
+
+    Scheduler              *m_sched {nullptr};
+    QDateTime               m_baseTime;
+    QMap<uint, vector<uint> > m_sourceInputs;
+    QMap<uint, int>         m_inputPriority;
+    vector<Channel>         m_channels;
+    vector<Showing>         m_showings;
+    vector<Rule>            m_rules;
+};
+
+#endif // SCHEDULERBENCH_H
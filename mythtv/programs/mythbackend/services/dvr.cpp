@@ -52,9 +52,11 @@
 
 #include "scheduler.h"
 #include "tv_rec.h"
+#include "recordedcache.h"
 
 extern QMap<int, EncoderLink *> tvList;
 extern AutoExpire  *expirer;
+extern RecordedCache *recordedCache;
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -84,7 +86,11 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
     if (bDescending)
         desc = -1;
 
-    LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc, sSort );
+    // The cache only keeps the recordings in start time order
+    if (recordedCache && sSort.isEmpty())
+        recordedCache->GetRecordings( progList, false, inUseMap, isJobRunning, recMap, desc );
+    else
+        LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc, sSort );
 
     QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
 
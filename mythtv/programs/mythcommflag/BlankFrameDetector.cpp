@@ -652,4 +652,10 @@ BlankFrameDetector::reportTime(void) const
     return m_histogramAnalyzer->reportTime();
 }
 
+int
+BlankFrameDetector::lumaHeight(void) const
+{
+    return HistogramAnalyzer::kLumaHeight;
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -27,6 +27,7 @@ public:
             long long frameno, long long *pNextFrame) override; // FrameAnalyzer
     int finished(long long nframes, bool final) override; // FrameAnalyzer
     int reportTime(void) const override; // FrameAnalyzer
+    int lumaHeight(void) const override; // FrameAnalyzer
     FrameMap GetMap(unsigned int index) const override // FrameAnalyzer
         { return (index) ? m_blankMap : m_breakMap; }
 
@@ -12,10 +12,74 @@ extern "C" {
 #include "FrameAnalyzer.h"
 #include "TemplateFinder.h"
 #include "BorderDetector.h"
+#include "pixelkernels.h"
 
 using namespace frameAnalyzer;
 using namespace commDetector2;
 
+namespace {
+
+bool
+rowinrange(const uchar *row, int col1, int col2, int maxrange,
+        int maxoutliers, uchar *pminval, uchar *pmaxval, int *poutliers)
+{
+    /*
+     * Widen [*pminval, *pmaxval] to take in the pixels of row[col1..col2),
+     * skipping those that would make it wider than "maxrange" as outliers.
+     * Return false as soon as there are more than "maxoutliers" of those.
+     *
+     * A block of pixels that fits in the range along with everything before
+     * it contains no outliers, so the pixels only need to be looked at one
+     * by one in blocks that do not.
+     */
+    static constexpr int kBlock = 64;
+
+    const PixelKernels &kernels = pixel_kernels();
+    uchar minval = *pminval;
+    uchar maxval = *pmaxval;
+    bool inrange = true;
+
+    for (int cc = col1; cc < col2 && inrange; )
+    {
+        int end = min(col2, cc + kBlock);
+        if (end - cc == kBlock)
+        {
+            uchar lo = 0;
+            uchar hi = 0;
+            kernels.m_minMax(&row[cc], kBlock, &lo, &hi);
+            if (max(maxval, hi) - min(minval, lo) + 1 <= maxrange)
+            {
+                minval = min(minval, lo);
+                maxval = max(maxval, hi);
+                cc = end;
+                continue;
+            }
+        }
+        for ( ; cc < end; cc++)
+        {
+            uchar val = row[cc];
+            int range = max(maxval, val) - min(minval, val) + 1;
+            if (range > maxrange)
+            {
+                if ((*poutliers)++ < maxoutliers)
+                    continue;   /* Next column. */
+                inrange = false;
+                break;
+            }
+            if (val < minval)
+                minval = val;
+            if (val > maxval)
+                maxval = val;
+        }
+    }
+
+    *pminval = minval;
+    *pmaxval = maxval;
+    return inrange;
+}
+
+};  /* namespace */
+
 BorderDetector::BorderDetector(void)
 {
     m_debugLevel = gCoreContext->GetNumSetting("BorderDetectorDebugLevel", 0);
@@ -249,35 +313,30 @@ found_right:
         saved = minrow;
         for (int rr = minrow; rr < maxrow1; rr++)
         {
-            int outliers = 0;
-            bool inrange = true;
-            for (int cc = mincol; cc < maxcol1; cc++)
+            /* Exclude logo area from analysis. */
+            int logocol1 = maxcol1;
+            int logocol2 = maxcol1;
+            if (m_logo && rr >= m_logoRow && rr < m_logoRow + m_logoHeight)
             {
-                if (m_logo && rrccinrect(rr, cc, m_logoRow, m_logoCol,
-                            m_logoWidth, m_logoHeight))
-                    continue;   /* Exclude logo area from analysis. */
-
-                uchar val = pgm->data[0][rr * pgmwidth + cc];
-                int range = max(maxval, val) - min(minval, val) + 1;
-                if (range > kMaxRange)
-                {
-                    if (outliers++ < MAXOUTLIERS)
-                        continue;   /* Next column. */
-                    inrange = false;
-                    if (lines++ < kMaxLines)
-                        break;  /* Next row. */
-                    goto found_top;
-                }
-                if (val < minval)
-                    minval = val;
-                if (val > maxval)
-                    maxval = val;
+                logocol1 = max(mincol, min(maxcol1, m_logoCol));
+                logocol2 = max(logocol1,
+                        min(maxcol1, m_logoCol + m_logoWidth));
             }
-            if (inrange)
+
+            int outliers = 0;
+            bool inrange =
+                rowinrange(&pgm->data[0][rr * pgmwidth], mincol, logocol1,
+                        kMaxRange, MAXOUTLIERS, &minval, &maxval, &outliers) &&
+                rowinrange(&pgm->data[0][rr * pgmwidth], logocol2, maxcol1,
+                        kMaxRange, MAXOUTLIERS, &minval, &maxval, &outliers);
+            if (!inrange)
             {
-                saved = rr;
-                lines = 0;
+                if (lines++ < kMaxLines)
+                    continue;   /* Next row. */
+                goto found_top;
             }
+            saved = rr;
+            lines = 0;
         }
 found_top:
         if (newrow != saved + 1 + VERTSLOP)
@@ -298,35 +357,30 @@ found_top:
         saved = maxrow1 - 1;
         for (int rr = maxrow1 - 1; rr >= minrow; rr--)
         {
-            int outliers = 0;
-            bool inrange = true;
-            for (int cc = mincol; cc < maxcol1; cc++)
+            /* Exclude logo area from analysis. */
+            int logocol1 = maxcol1;
+            int logocol2 = maxcol1;
+            if (m_logo && rr >= m_logoRow && rr < m_logoRow + m_logoHeight)
             {
-                if (m_logo && rrccinrect(rr, cc, m_logoRow, m_logoCol,
-                            m_logoWidth, m_logoHeight))
-                    continue;   /* Exclude logo area from analysis. */
-
-                uchar val = pgm->data[0][rr * pgmwidth + cc];
-                int range = max(maxval, val) - min(minval, val) + 1;
-                if (range > kMaxRange)
-                {
-                    if (outliers++ < MAXOUTLIERS)
-                        continue;   /* Next column. */
-                    inrange = false;
-                    if (lines++ < kMaxLines)
-                        break;  /* Next row. */
-                    goto found_bottom;
-                }
-                if (val < minval)
-                    minval = val;
-                if (val > maxval)
-                    maxval = val;
+                logocol1 = max(mincol, min(maxcol1, m_logoCol));
+                logocol2 = max(logocol1,
+                        min(maxcol1, m_logoCol + m_logoWidth));
             }
-            if (inrange)
+
+            int outliers = 0;
+            bool inrange =
+                rowinrange(&pgm->data[0][rr * pgmwidth], mincol, logocol1,
+                        kMaxRange, MAXOUTLIERS, &minval, &maxval, &outliers) &&
+                rowinrange(&pgm->data[0][rr * pgmwidth], logocol2, maxcol1,
+                        kMaxRange, MAXOUTLIERS, &minval, &maxval, &outliers);
+            if (!inrange)
             {
-                saved = rr;
-                lines = 0;
+                if (lines++ < kMaxLines)
+                    continue;   /* Next row. */
+                goto found_bottom;
             }
+            saved = rr;
+            lines = 0;
         }
 found_bottom:
         if (newheight != saved - minrow - VERTSLOP)
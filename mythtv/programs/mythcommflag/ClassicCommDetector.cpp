@@ -21,9 +21,12 @@ using namespace std;
 #include "mythcontext.h"
 #include "programinfo.h"
 #include "mythplayer.h"
+#include "mythcommflagplayer.h"
+#include "mthread.h"
 
 // Commercial Flagging headers
 #include "ClassicCommDetector.h"
+#include "ClassicCommSegments.h"
 #include "ClassicLogoDetector.h"
 #include "ClassicSceneChangeDetector.h"
 
@@ -42,6 +45,68 @@ enum frameFormats {
     COMM_FORMAT_MAX       = 4,
 } FrameFormats;
 
+// Seconds decoded before each part of a segmented run, by the end of which
+// the decoder and the detectors have caught up with a serial run
+static const int kSegmentWarmup  = 10;
+// Seconds each part runs on into the next, to check that they agree
+static const int kSegmentOverlap = 2;
+// Shortest part worth a decoder of its own, in seconds
+static const int kSegmentMinimum = 600;
+
+/** \class ClassicCommDetectorSegment
+ *  \brief Flags one part of a recording, with a player and detector of its
+ *         own, for ClassicCommDetector::FlagSegments().
+ */
+class ClassicCommDetectorSegment : public MThread, public ClassicCommSegment
+{
+  public:
+    ClassicCommDetectorSegment(ClassicCommDetector *parent, int index,
+                               long long begin, long long end)
+      : MThread(QString("CommFlagSegment%1").arg(index)),
+        m_parent(parent), m_end(end) { m_begin = begin; }
+
+    void run(void) override; // MThread
+
+    ClassicCommDetector *m_parent           {nullptr};
+    long long            m_end              {-1}; ///< Frame after it, -1 for the end
+    bool                 m_ok               {false};
+    std::atomic<uint64_t> m_framesDecoded   {0};
+
+    // State at the end of the overlap with the next part
+    long long            m_curFrameNumber   {0};
+    int                  m_currentAspect    {0};
+};
+
+void ClassicCommDetectorSegment::run(void)
+{
+    RunProlog();
+
+    auto *player = dynamic_cast<MythCommFlagPlayer*>(m_parent->m_player);
+    PlayerContext *ctx = player ? player->CloneContext() : nullptr;
+    if (ctx)
+    {
+        // Created in this thread so that its scene change detector reports
+        // to it directly
+        auto *detector = new ClassicCommDetector(
+            m_parent->m_commDetectMethod, false, m_parent->m_fullSpeed,
+            ctx->m_player, m_parent->m_startedAt, m_parent->m_stopsAt,
+            m_parent->m_recordingStartedAt, m_parent->m_recordingStopsAt);
+        m_ok = detector->ProcessSegment(*this);
+
+        // The logo detector belongs to the parent
+        detector->m_logoDetector = nullptr;
+        detector->deleteLater();
+        delete ctx;
+    }
+    else
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Unable to open the recording again "
+                                 "for segmented flagging.");
+    }
+
+    RunEpilog();
+}
+
 static QString toStringFrameMaskValues(int mask, bool verbose)
 {
     QString msg;
@@ -165,6 +230,9 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
 
     m_commDetectBlankCanHaveLogo =
         !!gCoreContext->GetBoolSetting("CommDetectBlankCanHaveLogo", true);
+
+    m_commFlagSegments =
+        gCoreContext->GetNumSetting("CommFlagSegments", 1);
 }
 
 void ClassicCommDetector::Init()
@@ -403,6 +471,13 @@ bool ClassicCommDetector::go()
             cerr << "\r     0/        \r" << flush;
     }
 
+    int segments = SegmentCount(myTotalFrames);
+    if ((segments > 1) && FlagSegments(segments, myTotalFrames))
+        return true;
+
+    emit breathe();
+    if (m_bStop)
+        return false;
 
     float flagFPS = 0.0;
     long long  currentFrameNumber = 0LL;
@@ -584,6 +659,8 @@ bool ClassicCommDetector::go()
                 std::this_thread::sleep_for(std::chrono::microseconds(usecSleep));
         }
 
+        waitForCPUBudget();
+
         m_player->DiscardVideoFrame(currentFrame);
     }
 
@@ -612,18 +689,272 @@ bool ClassicCommDetector::go()
 void ClassicCommDetector::sceneChangeDetectorHasNewInformation(
     unsigned int framenum,bool isSceneChange,float debugValue)
 {
+    // The detector counts the frames it is given, which falls behind the
+    // frame numbers once the decoder skips one. A segmented run can only
+    // number its scene changes as a serial run would while it does not.
+    long long frame = framenum + m_sceneFrameOffset;
+    if (frame != m_curFrameNumber)
+        m_sceneFramesSkipped = true;
+
     if (isSceneChange)
     {
-        m_frameInfo[framenum].flagMask |= COMM_FRAME_SCENE_CHANGE;
-        m_sceneMap[framenum] = MARK_SCENE_CHANGE;
+        m_frameInfo[frame].flagMask |= COMM_FRAME_SCENE_CHANGE;
+        m_sceneMap[frame] = MARK_SCENE_CHANGE;
     }
     else
     {
-        m_frameInfo[framenum].flagMask &= ~COMM_FRAME_SCENE_CHANGE;
-        m_sceneMap.remove(framenum);
+        m_frameInfo[frame].flagMask &= ~COMM_FRAME_SCENE_CHANGE;
+        m_sceneMap.remove(frame);
     }
 
-    m_frameInfo[framenum].sceneChangePercent = (int) (debugValue*100);
+    m_frameInfo[frame].sceneChangePercent = (int) (debugValue*100);
+}
+
+/** \fn ClassicCommDetector::SegmentCount(long long) const
+ *  \brief Returns the number of parts to flag the recording in at once,
+ *         1 to flag it from front to back.
+ *
+ *   Parts need a seek table to start at, and are only used for finished
+ *   recordings long enough that each part takes at least kSegmentMinimum
+ *   seconds.
+ */
+int ClassicCommDetector::SegmentCount(long long totalFrames) const
+{
+    if ((m_commFlagSegments < 2) || m_stillRecording ||
+        m_sendCommBreakMapUpdates || (m_fps <= 0.0))
+        return 1;
+
+    DecoderBase *decoder = m_player->GetDecoder();
+    if (!dynamic_cast<MythCommFlagPlayer*>(m_player) ||
+        !decoder || !decoder->HasPositionMap())
+    {
+        LOG(VB_COMMFLAG, LOG_INFO,
+            "No seek table, flagging the recording in one part.");
+        return 1;
+    }
+
+    auto minimum = static_cast<long long>(kSegmentMinimum * m_fps);
+    return static_cast<int>(
+        max(1LL, min(static_cast<long long>(m_commFlagSegments),
+                     totalFrames / minimum)));
+}
+
+/** \fn ClassicCommDetector::FlagSegments(int, long long)
+ *  \brief Flags the recording in equal parts at once, each with a player
+ *         of its own, and joins the results.
+ *
+ *   Each part seeks to the keyframe before kSegmentWarmup seconds ahead of
+ *   its start, so that the decoder and detectors are in the same state as
+ *   in a serial run by the time it gets there, and runs on for
+ *   kSegmentOverlap seconds into the next part. MergeSegments() joins the
+ *   parts where they agree, so the result is the same as flagging from
+ *   front to back.
+ *
+ *  \return false if flagging was stopped, a part failed or the parts do not
+ *          agree, in which case go() flags the recording serially unless
+ *          it was stopped.
+ */
+bool ClassicCommDetector::FlagSegments(int segments, long long totalFrames)
+{
+    LOG(VB_COMMFLAG, LOG_INFO, QString("Flagging %1 frames in %2 parts")
+        .arg(totalFrames).arg(segments));
+
+    std::vector<ClassicCommDetectorSegment*> parts;
+    for (int i = 0; i < segments; i++)
+    {
+        long long begin = totalFrames * i / segments;
+        long long end = (i + 1 < segments) ?
+            totalFrames * (i + 1) / segments : -1;
+        parts.push_back(new ClassicCommDetectorSegment(this, i, begin, end));
+        parts.back()->start();
+    }
+
+    QElapsedTimer flagTime;
+    flagTime.start();
+    int prevpercent = -1;
+    bool running = true;
+    while (running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        emit breathe();
+        if (m_bStop)
+            m_segmentsStop = true;
+        m_segmentsPaused = m_bPaused;
+
+        running = false;
+        uint64_t frames = 0;
+        for (auto *part : parts)
+        {
+            running |= !part->isFinished();
+            frames += part->m_framesDecoded;
+        }
+
+        float elapsed = flagTime.elapsed() / 1000.0F;
+        float flagFPS = (elapsed != 0.0F) ? frames / elapsed : 0.0F;
+        int percentage = min(100, static_cast<int>(frames * 100 / totalFrames));
+
+        if (m_showProgress)
+        {
+            QString tmp = QString("\r%1%/%2fps  \r")
+                .arg(percentage, 3).arg((int)flagFPS, 4);
+            cerr << qPrintable(tmp) << flush;
+        }
+
+        emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+            "%1% Completed @ %2 fps.").arg(percentage).arg(flagFPS));
+
+        if (percentage % 10 == 0 && prevpercent != percentage)
+        {
+            prevpercent = percentage;
+            LOG(VB_GENERAL, LOG_INFO, QString("%1%% Completed @ %2 fps.")
+                .arg(percentage) .arg(flagFPS));
+        }
+    }
+
+    bool ok = !m_bStop;
+    for (auto *part : parts)
+    {
+        part->wait();
+        ok &= part->m_ok;
+    }
+
+    if (ok && !MergeSegments(parts))
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            "Flagged parts do not agree, flagging the recording in one part.");
+        ok = false;
+    }
+
+    for (auto *part : parts)
+        delete part;
+
+    if (m_showProgress)
+    {
+        cerr << "\b\b\b\b\b\b      \b\b\b\b\b\b";
+        cerr.flush();
+    }
+
+    return ok;
+}
+
+/** \fn ClassicCommDetector::ProcessSegment(ClassicCommDetectorSegment&)
+ *  \brief Flags one part of the recording for FlagSegments(), on a
+ *         detector of its own in the thread of the part.
+ */
+bool ClassicCommDetector::ProcessSegment(ClassicCommDetectorSegment &segment)
+{
+    ClassicCommDetector *parent = segment.m_parent;
+
+    if (m_player->OpenFile() < 0)
+        return false;
+
+    Init();
+    m_aggressiveDetection = parent->m_aggressiveDetection;
+    m_logoDetector        = parent->m_logoDetector;
+    m_logoInfoAvailable   = parent->m_logoInfoAvailable;
+
+    if (!m_player->InitVideo())
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "NVP: Unable to initialize video for FlagCommercials.");
+        return false;
+    }
+    m_player->EnableSubtitles(false);
+
+    long long first = max(0LL, segment.m_begin -
+                          static_cast<long long>(kSegmentWarmup * m_fps));
+    long long last = (segment.m_end < 0) ? -1 :
+        segment.m_end + static_cast<long long>(kSegmentOverlap * m_fps);
+
+    // The first part starts where a serial run does, the others seek
+    VideoFrame* currentFrame = m_player->GetRawVideoFrame(first ? first : -1);
+    if (!currentFrame)
+        return false;
+
+    float aspect = m_player->GetVideoAspect();
+    SetVideoParams(aspect);
+
+    // Number the frames as a serial run would have
+    m_sceneFrameOffset = first ? currentFrame->frameNumber : 0;
+    if (currentFrame->frameNumber > 0)
+        m_lastFrameNumber = currentFrame->frameNumber - 1;
+
+    while (true)
+    {
+        long long currentFrameNumber = currentFrame->frameNumber;
+
+        float newAspect = currentFrame->aspect;
+        if (newAspect != aspect)
+        {
+            SetVideoParams(aspect);
+            aspect = newAspect;
+        }
+
+        ProcessFrame(currentFrame, currentFrameNumber);
+        m_player->DiscardVideoFrame(currentFrame);
+        segment.m_framesDecoded++;
+
+        while (parent->m_segmentsPaused && !parent->m_segmentsStop)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (parent->m_segmentsStop)
+            return false;
+
+        if (((last >= 0) && (currentFrameNumber >= last)) ||
+            (m_player->GetEof() != kEofStateNone))
+            break;
+
+        // sleep a little so we don't use all cpu even if we're niced
+        if (!m_fullSpeed)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        currentFrame = m_player->GetRawVideoFrame();
+    }
+
+    segment.m_frameInfo.swap(m_frameInfo);
+    segment.m_blankFrameMap.swap(m_blankFrameMap);
+    segment.m_sceneMap.swap(m_sceneMap);
+    segment.m_skipped        = m_sceneFramesSkipped;
+    segment.m_curFrameNumber = m_curFrameNumber;
+    segment.m_currentAspect  = m_currentAspect;
+    return true;
+}
+
+/** \fn ClassicCommDetector::MergeSegments(const std::vector<ClassicCommDetectorSegment*>&)
+ *  \brief Joins the results of the parts flagged by FlagSegments(), see
+ *         MergeClassicCommSegments().
+ *  \return false, with the maps cleared, if the parts do not agree.
+ */
+bool ClassicCommDetector::MergeSegments(
+    const std::vector<ClassicCommDetectorSegment*> &segments)
+{
+    ClearAllMaps();
+
+    std::vector<const ClassicCommSegment*> results(segments.cbegin(),
+                                                   segments.cend());
+    if (!MergeClassicCommSegments(results, m_frameInfo, m_blankFrameMap,
+                                  m_sceneMap))
+    {
+        ClearAllMaps();
+        return false;
+    }
+
+    // Totals as ProcessFrame() would have kept them
+    m_framesProcessed = 0;
+    m_totalMinBrightness = 0;
+    m_decoderFoundAspectChanges = false;
+    for (const auto & info : qAsConst(m_frameInfo))
+    {
+        if (!(info.flagMask & COMM_FRAME_SKIPPED))
+            m_framesProcessed++;
+        if (info.minBrightness >= 0)
+            m_totalMinBrightness += info.minBrightness;
+        if (info.flagMask & COMM_FRAME_ASPECT_CHANGE)
+            m_decoderFoundAspectChanges = true;
+    }
+    m_blankFrameCount = m_blankFrameMap.size();
+    m_lastFrameNumber = m_curFrameNumber = segments.back()->m_curFrameNumber;
+    m_currentAspect = segments.back()->m_currentAspect;
+    return true;
 }
 
 void ClassicCommDetector::GetCommercialBreakList(frm_dir_map_t &marks)
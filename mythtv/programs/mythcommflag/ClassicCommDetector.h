@@ -2,7 +2,9 @@
 #define CLASSIC_COMMDETECTOR_H
 
 // C++ headers
+#include <atomic>
 #include <cstdint>
+#include <vector>
 
 // Qt headers
 #include <QObject>
@@ -19,6 +21,7 @@
 class MythPlayer;
 class LogoDetectorBase;
 class SceneChangeDetectorBase;
+class ClassicCommDetectorSegment;
 
 enum frameMaskValues {
     COMM_FRAME_SKIPPED       = 0x0001,
@@ -68,6 +71,7 @@ class ClassicCommDetector : public CommDetectorBase
         void logoDetectorBreathe();
 
         friend class ClassicLogoDetector;
+        friend class ClassicCommDetectorSegment;
 
     protected:
         ~ClassicCommDetector() override = default;
@@ -110,6 +114,11 @@ class ClassicCommDetector : public CommDetectorBase
             frm_dir_map_t &out, const show_map_t &in);
         void CleanupFrameInfo(void);
         void GetLogoCommBreakMap(show_map_t &map);
+        int  SegmentCount(long long totalFrames) const;
+        bool FlagSegments(int segments, long long totalFrames);
+        bool ProcessSegment(ClassicCommDetectorSegment &segment);
+        bool MergeSegments(
+            const std::vector<ClassicCommDetectorSegment*> &segments);
 
         SkipType m_commDetectMethod;
         frm_dir_map_t m_lastSentCommBreakMap;
@@ -161,6 +170,15 @@ class ClassicCommDetector : public CommDetectorBase
         bool m_decoderFoundAspectChanges   {false};
 
         SceneChangeDetectorBase* m_sceneChangeDetector {nullptr};
+        /// Frame number of the first frame given to m_sceneChangeDetector
+        long long m_sceneFrameOffset       {0};
+        /// A scene change was numbered other than the frame it was found on
+        bool m_sceneFramesSkipped          {false};
+
+        /// Parts of the recording flagged at once, see FlagSegments()
+        int m_commFlagSegments             {1};
+        std::atomic<bool> m_segmentsStop   {false};
+        std::atomic<bool> m_segmentsPaused {false};
 
 protected:
         MythPlayer *m_player               {nullptr};
@@ -0,0 +1,112 @@
+// C++ headers
+#include <limits> // for numeric_limits
+
+// MythTV headers
+#include "mythlogging.h"
+
+// Commercial Flagging headers
+#include "ClassicCommSegments.h"
+
+static bool same_frame_info(const FrameInfoEntry &a, const FrameInfoEntry &b)
+{
+    return (a.minBrightness == b.minBrightness) &&
+           (a.maxBrightness == b.maxBrightness) &&
+           (a.avgBrightness == b.avgBrightness) &&
+           (a.sceneChangePercent == b.sceneChangePercent) &&
+           (a.aspect == b.aspect) && (a.format == b.format) &&
+           (a.flagMask == b.flagMask);
+}
+
+/// Copies the entries for frames first up to end from one map to another.
+template <typename Map>
+static void copy_frames(Map &to, const Map &from, long long first, long long end)
+{
+    auto it = (first <= 0) ? from.cbegin() : from.lowerBound(first);
+    for (; (it != from.cend()) && (static_cast<long long>(it.key()) < end); ++it)
+        to.insert(it.key(), it.value());
+}
+
+/** \fn MergeClassicCommSegments(const std::vector<const ClassicCommSegment*>&, QMap<long long, FrameInfoEntry>&, frm_dir_map_t&, frm_dir_map_t&)
+ *  \brief Joins the parts of a segmented ClassicCommDetector run into the
+ *         maps a serial run would have built.
+ *
+ *   Each part is joined to the next at the first frame of their overlap
+ *   from which the two agree to its end. From there the next part is in
+ *   the state a serial run would have been in.
+ *
+ *   A serial run numbers scene changes by how many frames the scene change
+ *   detector has been given, which is not the frame number once a frame is
+ *   skipped. A part cannot know how many frames before it were skipped, so
+ *   no part may have skipped any.
+ *
+ *  \return false if a part skipped frames or never agrees with the next
+ *          one, in which case the maps are left incomplete and the
+ *          recording must be flagged serially instead.
+ */
+bool MergeClassicCommSegments(
+    const std::vector<const ClassicCommSegment*> &segments,
+    QMap<long long, FrameInfoEntry> &frameInfo,
+    frm_dir_map_t &blankFrameMap, frm_dir_map_t &sceneMap)
+{
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        if (segments[i]->m_skipped)
+        {
+            LOG(VB_GENERAL, LOG_WARNING,
+                QString("Flagged part %1 skipped frames.").arg(i));
+            return false;
+        }
+    }
+
+    long long from = std::numeric_limits<long long>::min();
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        const ClassicCommSegment *part = segments[i];
+        long long to = std::numeric_limits<long long>::max();
+
+        if (i + 1 < segments.size())
+        {
+            const ClassicCommSegment *next = segments[i + 1];
+            to = next->m_begin;
+
+            // Walk back from the end of the overlap while the parts agree
+            bool agree = false;
+            auto it = part->m_frameInfo.cend();
+            while (it != part->m_frameInfo.cbegin())
+            {
+                --it;
+                if (it.key() < next->m_begin)
+                    break;
+                auto other = next->m_frameInfo.constFind(it.key());
+                if ((other == next->m_frameInfo.cend()) ||
+                    !same_frame_info(*it, *other))
+                    break;
+                agree = true;
+                to = it.key();
+            }
+
+            if (!agree)
+            {
+                LOG(VB_GENERAL, LOG_WARNING,
+                    QString("Flagged parts %1 and %2 still disagree at frame "
+                            "%3.").arg(i).arg(i + 1)
+                        .arg(part->m_frameInfo.isEmpty() ?
+                             -1 : part->m_frameInfo.lastKey()));
+                return false;
+            }
+
+            LOG(VB_COMMFLAG, LOG_INFO,
+                QString("Joining flagged parts %1 and %2 at frame %3")
+                    .arg(i).arg(i + 1).arg(to));
+        }
+
+        copy_frames(frameInfo, part->m_frameInfo, from, to);
+        copy_frames(blankFrameMap, part->m_blankFrameMap, from, to);
+        copy_frames(sceneMap, part->m_sceneMap, from, to);
+        from = to;
+    }
+
+    return true;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,39 @@
+#ifndef CLASSIC_COMMSEGMENTS_H
+#define CLASSIC_COMMSEGMENTS_H
+
+// C++ headers
+#include <vector>
+
+// Qt headers
+#include <QMap>
+
+// MythTV headers
+#include "programtypes.h"
+
+// Commercial Flagging headers
+#include "ClassicCommDetector.h"
+
+/** \class ClassicCommSegment
+ *  \brief What one part of a segmented ClassicCommDetector run found, from
+ *         its warm-up to the end of its overlap with the next part.
+ */
+class ClassicCommSegment
+{
+  public:
+    long long                       m_begin {0}; ///< First frame of the part
+    /// Frames were skipped, so scene changes are not where a serial run
+    /// would have put them
+    bool                            m_skipped {false};
+    QMap<long long, FrameInfoEntry> m_frameInfo;
+    frm_dir_map_t                   m_blankFrameMap;
+    frm_dir_map_t                   m_sceneMap;
+};
+
+bool MergeClassicCommSegments(
+    const std::vector<const ClassicCommSegment*> &segments,
+    QMap<long long, FrameInfoEntry> &frameInfo,
+    frm_dir_map_t &blankFrameMap, frm_dir_map_t &sceneMap);
+
+#endif // CLASSIC_COMMSEGMENTS_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
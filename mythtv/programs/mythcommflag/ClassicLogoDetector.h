@@ -28,7 +28,6 @@ class ClassicLogoDetector : public LogoDetectorBase
     void DetectEdges(VideoFrame *frame, EdgeMaskEntry *edges, int edgeDiff);
 
     ClassicCommDetector *m_commDetector                    {nullptr};
-    unsigned int         m_frameNumber                     {0};
     unsigned int         m_commDetectBorder                {16};
 
     int                  m_commDetectLogoSamplesNeeded     {240};
@@ -369,9 +369,26 @@ CommDetector2::CommDetector2(
     if (histogramAnalyzer && m_logoFinder)
         histogramAnalyzer->setLogoState(m_logoFinder);
 
+    /*
+     * How far the greyscale image may be scaled down, if every analyzer
+     * allows it. See go().
+     */
+    int lines = 0;
+    for (const FrameAnalyzerItem *pass : { &pass0, &pass1 })
+    {
+        for (const FrameAnalyzer *analyzer : *pass)
+        {
+            int needed = analyzer->lumaHeight();
+            lines = (lines < 0 || !needed) ? -1 : max(lines, needed);
+        }
+    }
+    m_pgmConverter = pgmConverter;
+    m_scaledLumaHeight = max(lines, 0);
+
     /* Aggregate them all together. */
     m_frameAnalyzers.push_back(pass0);
     m_frameAnalyzers.push_back(pass1);
+    m_currentPass = m_frameAnalyzers.end();
 }
 
 void CommDetector2::reportState(int elapsedms, long long frameno,
@@ -484,6 +501,13 @@ bool CommDetector2::go(void)
 
     m_player->EnableSubtitles(false);
 
+    /*
+     * A job keeping to a CPU budget analyzes as small a picture as every
+     * analyzer allows.
+     */
+    if (m_cpuBudget > 0 && m_scaledLumaHeight > 0)
+        m_pgmConverter->setLumaHeight(m_scaledLumaHeight);
+
     QElapsedTimer totalFlagTime;
     totalFlagTime.start();
 
@@ -623,11 +647,15 @@ bool CommDetector2::go(void)
                         m_fullSpeed);
             }
 
+            waitForCPUBudget();
+
             // sleep a little so we don't use all cpu even if we're niced
             if (!m_fullSpeed && !m_isRecording)
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
-            if (m_sendBreakMapUpdates && (m_breakMapUpdateRequested ||
+            if (m_sendBreakMapUpdates &&
+                    !searchingForLogo(m_logoFinder, *m_currentPass) &&
+                    (m_breakMapUpdateRequested ||
                         !(m_currentFrameNumber % 500)))
             {
                 frm_dir_map_t breakMap;
@@ -770,7 +798,8 @@ void CommDetector2::recordingFinished(long long totalFileSize)
 
 void CommDetector2::requestCommBreakMapUpdate(void)
 {
-    if (searchingForLogo(m_logoFinder, *m_currentPass))
+    if (m_currentPass != m_frameAnalyzers.end() &&
+            searchingForLogo(m_logoFinder, *m_currentPass))
     {
         LOG(VB_COMMFLAG, LOG_INFO, "Ignoring request for commBreakMapUpdate; "
                                    "still doing logo detection");
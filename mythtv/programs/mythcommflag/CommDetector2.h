@@ -2,6 +2,7 @@
 #define COMMDETECTOR2_H
 
 // C++ headers
+#include <memory>
 #include <vector>
 using namespace std;
 
@@ -20,6 +21,7 @@ class TemplateFinder;
 class TemplateMatcher;
 class BlankFrameDetector;
 class SceneChangeDetector;
+class PGMConverter;
 
 namespace commDetector2 {
 
@@ -83,6 +85,8 @@ class CommDetector2 : public CommDetectorBase
     TemplateMatcher             *m_logoMatcher             {nullptr};
     BlankFrameDetector          *m_blankFrameDetector      {nullptr};
     SceneChangeDetector         *m_sceneChangeDetector     {nullptr};
+    shared_ptr<PGMConverter>     m_pgmConverter;
+    int                          m_scaledLumaHeight        {0};
 
     QString                      m_debugdir;
 };
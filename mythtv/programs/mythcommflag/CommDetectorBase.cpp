@@ -1,3 +1,8 @@
+// C++ headers
+#include <algorithm>
+#include <chrono> // for milliseconds
+#include <thread> // for sleep_for
+
 #include "CommDetectorBase.h"
 
 void CommDetectorBase::stop()
@@ -15,5 +20,41 @@ void CommDetectorBase::resume()
     m_bPaused = false;
 }
 
+void CommDetectorBase::setCPUBudget(int percent)
+{
+    m_cpuBudget = max(percent, 0);
+    m_cpuBudgetStart = clock();
+    m_cpuBudgetTimer.start();
+}
+
+/*
+ * Sleep for as long as it takes to bring the CPU time used by the whole
+ * process, decoder threads included, down to the budget. It is measured
+ * over the last few seconds, so time spent waiting for the recording is
+ * not saved up for a burst later.
+ */
+void CommDetectorBase::waitForCPUBudget(void)
+{
+    static constexpr qint64 kWindowMs = 10000;
+
+    if (m_cpuBudget <= 0)
+        return;
+
+    clock_t now = clock();
+    qint64 usedms = (now - m_cpuBudgetStart) * 1000 / CLOCKS_PER_SEC;
+    qint64 sleepms = usedms * 100 / m_cpuBudget - m_cpuBudgetTimer.elapsed();
+    if (sleepms > 0)
+    {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(min(sleepms, kWindowMs)));
+    }
+
+    if (m_cpuBudgetTimer.elapsed() >= kWindowMs)
+    {
+        m_cpuBudgetStart = clock();
+        m_cpuBudgetTimer.start();
+    }
+}
+
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -1,9 +1,11 @@
 #ifndef COMMDETECTOR_BASE_H
 #define COMMDETECTOR_BASE_H
 
+#include <ctime>
 #include <iostream>
 using namespace std;
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QMap>
 
@@ -35,6 +37,7 @@ public:
     void stop();
     void pause();
     void resume();
+    void setCPUBudget(int percent);
 
     virtual void GetCommercialBreakList(frm_dir_map_t &comms) = 0;
     virtual void recordingFinished(long long totalFileSize)
@@ -51,8 +54,15 @@ signals:
 
 protected:    
     ~CommDetectorBase() override = default;
+    void waitForCPUBudget(void);
+
     bool m_bPaused { false };
     bool m_bStop   { false };
+
+    /// Percent of one CPU core the process may use, 0 for no limit
+    int           m_cpuBudget      { 0 };
+    clock_t       m_cpuBudgetStart { 0 };
+    QElapsedTimer m_cpuBudgetTimer;
 };
 
 #endif // COMMDETECTOR_BASE_H
@@ -37,5 +37,22 @@ CommDetectorFactory::makeCommDetector(
             player, startedAt, stopsAt, recordingStartedAt, recordingStopsAt);
 }
 
+/*
+ * Whether every frame analyzer the detector for commDetectMethod uses can
+ * work on HD pictures decoded at half size. Only the histogram detectors of
+ * CommDetector2 declare a FrameAnalyzer::lumaHeight() that allows it; the
+ * logo template finder and matcher, and the ClassicCommDetector with its
+ * ClassicLogoDetector, keep the full picture.
+ */
+bool
+CommDetectorFactory::acceptsHalfSizeHD(SkipType commDetectMethod)
+{
+    if ((commDetectMethod & COMM_DETECT_PREPOSTROLL) ||
+        !(commDetectMethod & COMM_DETECT_2))
+        return false;
+
+    return !(commDetectMethod & COMM_DETECT_2_LOGO);
+}
+
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
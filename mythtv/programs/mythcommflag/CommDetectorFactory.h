@@ -24,6 +24,8 @@ class CommDetectorFactory
         const QDateTime& recordingStartedAt,
         const QDateTime& recordingStopsAt,
         bool useDB);
+
+    static bool acceptsHalfSizeHD(SkipType commDetectMethod);
 };
 
 #endif // COMMDETECTOR_FACTORY_H
@@ -1,5 +1,6 @@
 // ANSI C headers
 #include <cstdlib>
+#include <cstring>
 
 // C++ headers
 #include <algorithm>
@@ -19,11 +20,31 @@ extern "C" {
 // Commercial Flagging headers
 #include "FrameAnalyzer.h"
 #include "EdgeDetector.h"
+#include "pixelkernels.h"
 
 namespace edgeDetector {
 
 using namespace frameAnalyzer;
 
+static void
+rowsegments(int rr, int width, int excluderow, int excludecol,
+        int excludewidth, int excludeheight, int *pleft, int *pright)
+{
+    /*
+     * The columns of row "rr" outside of the excluded area are [0, *pleft)
+     * and [*pright, width). Either range may be empty.
+     */
+    if (rr < excluderow || rr >= excluderow + excludeheight ||
+            excludewidth <= 0)
+    {
+        *pleft = width;
+        *pright = width;
+        return;
+    }
+    *pleft = clamp(excludecol, 0, width);
+    *pright = clamp(excludecol + excludewidth, 0, width);
+}
+
 unsigned int *
 sgm_init_exclude(unsigned int *sgm, const AVFrame *src, int srcheight,
         int excluderow, int excludecol, int excludewidth, int excludeheight)
@@ -37,23 +58,23 @@ sgm_init_exclude(unsigned int *sgm, const AVFrame *src, int srcheight,
      */
     const int       srcwidth = src->linesize[0];
 
+    const PixelKernels &kernels = pixel_kernels();
+
     memset(sgm, 0, srcwidth * srcheight * sizeof(*sgm));
     int rr2 = srcheight - 1;
     int cc2 = srcwidth - 1;
     for (int rr = 0; rr < rr2; rr++)
     {
-        for (int cc = 0; cc < cc2; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                uchar *rr0 = &src->data[0][rr * srcwidth + cc];
-                uchar *rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                int dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                int dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
-        }
+        int left = 0;
+        int right = 0;
+        rowsegments(rr, cc2, excluderow, excludecol,
+                excludewidth, excludeheight, &left, &right);
+
+        const uchar *rr0 = &src->data[0][rr * srcwidth];
+        const uchar *rr1 = &src->data[0][(rr + 1) * srcwidth];
+        unsigned int *row = &sgm[rr * srcwidth];
+        kernels.m_sgmRow(row, rr0, rr1, left);
+        kernels.m_sgmRow(&row[right], &rr0[right], &rr1[right], cc2 - right);
     }
     return sgm;
 }
@@ -101,15 +122,18 @@ edge_mark(AVFrame *dst, int dstheight,
     int nn = 0;
     for (int rr = 0; rr < dstheight; rr++)
     {
-        for (int cc = 0; cc < dstwidth; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                sgmsorted[nn++] = sgm[(extratop + rr) * padded_width +
-                    extraleft + cc];
-            }
-        }
+        int left = 0;
+        int right = 0;
+        rowsegments(rr, dstwidth, excluderow, excludecol,
+                excludewidth, excludeheight, &left, &right);
+
+        const unsigned int *row = &sgm[(extratop + rr) * padded_width +
+            extraleft];
+        memcpy(&sgmsorted[nn], row, left * sizeof(*sgmsorted));
+        nn += left;
+        memcpy(&sgmsorted[nn], &row[right],
+                (dstwidth - right) * sizeof(*sgmsorted));
+        nn += dstwidth - right;
     }
 
     int dstnn = dstwidth * dstheight;
@@ -161,16 +185,20 @@ edge_mark(AVFrame *dst, int dstheight,
     }
 
     /* sgm is a padded matrix; dst is the unpadded matrix. */
+    const PixelKernels &kernels = pixel_kernels();
     for (int rr = 0; rr < dstheight; rr++)
     {
-        for (int cc = 0; cc < dstwidth; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight) &&
-                    sgm[(extratop + rr) * padded_width + extraleft + cc] >=
-                        thresholdval)
-                dst->data[0][rr * dstwidth + cc] = UCHAR_MAX;
-        }
+        int left = 0;
+        int right = 0;
+        rowsegments(rr, dstwidth, excluderow, excludecol,
+                excludewidth, excludeheight, &left, &right);
+
+        const unsigned int *row = &sgm[(extratop + rr) * padded_width +
+            extraleft];
+        uchar *dstrow = &dst->data[0][rr * dstwidth];
+        kernels.m_markRow(dstrow, row, left, thresholdval);
+        kernels.m_markRow(&dstrow[right], &row[right], dstwidth - right,
+                thresholdval);
     }
     return 0;
 }
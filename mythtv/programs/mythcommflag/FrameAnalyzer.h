@@ -67,6 +67,12 @@ public:
     }
     virtual int reportTime(void) const { return 0; }
 
+    /*
+     * Lines of luma the analyzer needs to see, if the greyscale image may be
+     * scaled down to that height. 0 if it needs the full picture.
+     */
+    virtual int lumaHeight(void) const { return 0; }
+
     virtual FrameMap GetMap(unsigned int) const = 0;
 };
 
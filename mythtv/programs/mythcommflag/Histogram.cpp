@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include "mythframe.h"
+#include "pixelkernels.h"
 
 void Histogram::generateFromImage(VideoFrame* frame, unsigned int frameWidth,
          unsigned int frameHeight, unsigned int minScanX, unsigned int maxScanX,
@@ -19,16 +20,16 @@ void Histogram::generateFromImage(VideoFrame* frame, unsigned int frameWidth,
     if (maxScanY > frameHeight-1)
         maxScanY = frameHeight-1;
 
+    if (minScanX >= maxScanX || minScanY >= maxScanY)
+        return;
+
     unsigned char* framePtr = frame->buf;
     int bytesPerLine = frame->pitches[0];
-    for(unsigned int y = minScanY; y < maxScanY; y += YSpacing)
-    {
-        for(unsigned int x = minScanX; x < maxScanX; x += XSpacing)
-        {
-            m_data[framePtr[y * bytesPerLine + x]]++;
-            m_numberOfSamples++;
-        }
-    }
+    int columns = (maxScanX - minScanX + XSpacing - 1) / XSpacing;
+    int rows = (maxScanY - minScanY + YSpacing - 1) / YSpacing;
+    pixel_histogram(m_data.data(), &framePtr[minScanY * bytesPerLine + minScanX],
+                    bytesPerLine, columns, rows, XSpacing, YSpacing);
+    m_numberOfSamples = columns * rows;
 }
 
 unsigned int Histogram::getAverageIntensity(void) const
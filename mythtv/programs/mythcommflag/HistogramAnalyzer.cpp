@@ -18,6 +18,7 @@
 #include "quickselect.h"
 #include "TemplateFinder.h"
 #include "HistogramAnalyzer.h"
+#include "pixelkernels.h"
 
 using namespace commDetector2;
 using namespace frameAnalyzer;
@@ -273,12 +274,16 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
      * Sampling coarseness of each frame. Higher values will allow analysis to
      * proceed faster (lower resolution), but might be less accurate. Lower
      * values will examine more pixels (higher resolution), but will run
-     * slower.
+     * slower. A greyscale image already scaled down is sampled as much
+     * more densely.
      */
     static constexpr int kRInc = 4;
     static constexpr int kCInc = 4;
 #define ROUNDUP(a,b)    (((a) + (b) - 1) / (b) * (b))
 
+    const int           rinc = max(1, kRInc / m_pgmConverter->getDivisor());
+    const int           cinc = max(1, kCInc / m_pgmConverter->getDivisor());
+    const PixelKernels  &kernels = pixel_kernels();
     int                 pgmwidth = 0;
     int                 pgmheight = 0;
     bool                ismonochromatic = false;
@@ -330,39 +335,50 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
         cropwidth = pgmwidth / 4;
     }
 
-    rr1 = ROUNDUP(croprow, kRInc);
-    cc1 = ROUNDUP(cropcol, kCInc);
-    rr2 = ROUNDUP(croprow + cropheight, kRInc);
-    cc2 = ROUNDUP(cropcol + cropwidth, kCInc);
-    rr3 = ROUNDUP(pgmheight, kRInc);
-    cc3 = ROUNDUP(pgmwidth, kCInc);
+    rr1 = ROUNDUP(croprow, rinc);
+    cc1 = ROUNDUP(cropcol, cinc);
+    rr2 = ROUNDUP(croprow + cropheight, rinc);
+    cc2 = ROUNDUP(cropcol + cropwidth, cinc);
+    rr3 = ROUNDUP(pgmheight, rinc);
+    cc3 = ROUNDUP(pgmwidth, cinc);
 
-    borderpixels = (rr1 / kRInc) * (cc3 / kCInc) +        /* top */
-        ((rr2 - rr1) / kRInc) * (cc1 / kCInc) +           /* left */
-        ((rr2 - rr1) / kRInc) * ((cc3 - cc2) / kCInc) +   /* right */
-        ((rr3 - rr2) / kRInc) * (cc3 / kCInc);            /* bottom */
+    borderpixels = (rr1 / rinc) * (cc3 / cinc) +        /* top */
+        ((rr2 - rr1) / rinc) * (cc1 / cinc) +           /* left */
+        ((rr2 - rr1) / rinc) * ((cc3 - cc2) / cinc) +   /* right */
+        ((rr3 - rr2) / rinc) * (cc3 / cinc);            /* bottom */
 
     pp = &m_buf[borderpixels];
     m_histVal.fill(0);
     m_histVal[kDefaultColor] += borderpixels;
-    for (int rr = rr1; rr < rr2; rr += kRInc)
+    for (int rr = rr1; rr < rr2; rr += rinc)
     {
-        int rroffset = rr * pgmwidth;
-
-        for (int cc = cc1; cc < cc2; cc += kCInc)
+        const unsigned char *row = &pgm->data[0][rr * pgmwidth];
+
+        /* Sample columns [from, to) of the row that are on the cinc grid. */
+        auto sample = [&](int from, int to) {
+            if (from >= to)
+                return;
+            int count = (to - from + cinc - 1) / cinc;
+            kernels.m_sampleRow(pp, &row[from], count, cinc,
+                    &sumval, &sumsquares);
+            pp += count;
+            livepixels += count;
+        };
+
+        if (m_logo && rr >= m_logoRr1 && rr <= m_logoRr2)
+        {
+            /* Exclude logo area from analysis. */
+            int after = max(cc1, m_logoCc2 + 1);
+            sample(cc1, min(cc2, m_logoCc1));
+            sample(cc1 + ROUNDUP(after - cc1, cinc), cc2);
+        }
+        else
         {
-            if (m_logo && rr >= m_logoRr1 && rr <= m_logoRr2 &&
-                    cc >= m_logoCc1 && cc <= m_logoCc2)
-                continue; /* Exclude logo area from analysis. */
-
-            unsigned char val = pgm->data[0][rroffset + cc];
-            *pp++ = val;
-            sumval += val;
-            sumsquares += val * val;
-            livepixels++;
-            m_histVal[val]++;
+            sample(cc1, cc2);
         }
     }
+    pixel_histogram(m_histVal.data(), &m_buf[borderpixels], livepixels,
+            livepixels, 1, 1, 1);
     npixels = borderpixels + livepixels;
 
     /* Scale scores down to [0..255]. */
@@ -26,6 +26,11 @@ public:
             MythPlayer *player, long long nframes);
     void setLogoState(TemplateFinder *finder);
     static const long long kUncached = -1;
+    /*
+     * Every fourth row of a 1080 line picture is sampled. A picture scaled
+     * down to no fewer lines is sampled more densely, for the same count.
+     */
+    static const int kLumaHeight = 270;
     enum FrameAnalyzer::analyzeFrameResult analyzeFrame(const VideoFrame *frame,
             long long frameno);
     int finished(long long nframes, bool final);
@@ -21,6 +21,41 @@ extern "C" {
 
 using namespace commDetector2;
 
+#ifdef PGM_CONVERT_GREYSCALE
+/*
+ * Average each divisor x divisor block of the luma plane into one pixel of
+ * dst, which is width x height.
+ */
+static int
+downscale_luma(AVFrame *dst, int width, int height, const VideoFrame *frame,
+        int divisor)
+{
+    if (ColorDepth(frame->codec) != 8 ||
+            frame->width < width * divisor || frame->height < height * divisor)
+        return -1;
+
+    const unsigned char *src = frame->buf + frame->offsets[0];
+    const int pitch = frame->pitches[0];
+    const unsigned int area = divisor * divisor;
+
+    for (int rr = 0; rr < height; rr++)
+    {
+        const unsigned char *in = src + static_cast<ptrdiff_t>(rr) * divisor * pitch;
+        unsigned char *out = dst->data[0] + rr * dst->linesize[0];
+
+        for (int cc = 0; cc < width; cc++)
+        {
+            unsigned int sum = 0;
+            for (int ii = 0; ii < divisor; ii++)
+                for (int jj = 0; jj < divisor; jj++)
+                    sum += in[ii * pitch + cc * divisor + jj];
+            out[cc] = (sum + area / 2) / area;
+        }
+    }
+    return 0;
+}
+#endif /* PGM_CONVERT_GREYSCALE */
+
 PGMConverter::~PGMConverter(void)
 {
     m_width = -1;
@@ -47,8 +82,16 @@ PGMConverter::MythPlayerInited(const MythPlayer *player)
     m_height = buf_dim.height();
 
 #ifdef PGM_CONVERT_GREYSCALE
+    m_divisor = 1;
+    while (m_lumaHeight > 0 && m_divisor < 4 &&
+            buf_dim.height() / (m_divisor * 2) >= m_lumaHeight)
+        m_divisor *= 2;
+    m_width  = buf_dim.width() / m_divisor;
+    m_height = buf_dim.height() / m_divisor;
+
+    /* Analyzers index a scaled down image by its width; don't pad the rows. */
     if (av_image_alloc(m_pgm.data, m_pgm.linesize,
-        m_width, m_height, AV_PIX_FMT_GRAY8, IMAGE_ALIGN))
+        m_width, m_height, AV_PIX_FMT_GRAY8, m_divisor > 1 ? 1 : IMAGE_ALIGN) < 0)
     {
         LOG(VB_COMMFLAG, LOG_ERR, QString("PGMConverter::MythPlayerInited "
                                           "av_image_alloc m_pgm (%1x%2) failed")
@@ -56,6 +99,14 @@ PGMConverter::MythPlayerInited(const MythPlayer *player)
         return -1;
     }
 
+    if (m_divisor > 1)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
+                                           "scaling luma down to %1x%2")
+                .arg(m_width).arg(m_height));
+        return 0;
+    }
+
     delete m_copy;
     m_copy = new MythAVCopy;
     LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
@@ -89,7 +140,18 @@ PGMConverter::getImage(const VideoFrame *frame, long long _frameno,
 
 #ifdef PGM_CONVERT_GREYSCALE
     (void)gettimeofday(&start, nullptr);
-    if (m_copy->Copy(&m_pgm, frame, m_pgm.data[0], AV_PIX_FMT_GRAY8) < 0)
+    if (m_divisor > 1)
+    {
+        if (downscale_luma(&m_pgm, m_width, m_height, frame, m_divisor) < 0)
+        {
+            LOG(VB_COMMFLAG, LOG_ERR,
+                QString("PGMConverter::getImage can't scale down frame %1 "
+                        "(%2x%3)").arg(_frameno).arg(frame->width)
+                    .arg(frame->height));
+            goto error;
+        }
+    }
+    else if (m_copy->Copy(&m_pgm, frame, m_pgm.data[0], AV_PIX_FMT_GRAY8) < 0)
         goto error;
     (void)gettimeofday(&end, nullptr);
     timersub(&end, &start, &elapsed);
@@ -33,15 +33,23 @@ public:
     PGMConverter(void) = default;
     ~PGMConverter(void);
 
+    /*
+     * Scale the image down by 2 or 4 while it keeps at least this many lines
+     * (0 for the full picture). Takes effect at MythPlayerInited.
+     */
+    void setLumaHeight(int lines) { m_lumaHeight = lines; }
     int MythPlayerInited(const MythPlayer *player);
     const AVFrame *getImage(const VideoFrame *frame, long long frameno,
             int *pwidth, int *pheight);
+    int getDivisor(void) const { return m_divisor; }
     int reportTime(void);
 
 private:
     long long       m_frameNo       {-1}; /* frame number */
-    int             m_width         {-1}; /* frame dimensions */
-    int             m_height        {-1}; /* frame dimensions */
+    int             m_width         {-1}; /* image dimensions */
+    int             m_height        {-1}; /* image dimensions */
+    int             m_lumaHeight    {0};  /* lines needed; 0 for all */
+    int             m_divisor       {1};  /* frame size / image size */
     AVFrame         m_pgm           {};   /* grayscale frame */
 #ifdef PGM_CONVERT_GREYSCALE
     struct timeval  m_convertTime   {0,0};
@@ -212,4 +212,10 @@ SceneChangeDetector::reportTime(void) const
     return m_histogramAnalyzer->reportTime();
 }
 
+int
+SceneChangeDetector::lumaHeight(void) const
+{
+    return HistogramAnalyzer::kLumaHeight;
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
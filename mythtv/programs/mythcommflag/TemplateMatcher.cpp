@@ -28,6 +28,7 @@ using namespace std;
 #include "BlankFrameDetector.h"
 #include "TemplateFinder.h"
 #include "TemplateMatcher.h"
+#include "pixelkernels.h"
 
 extern "C" {
 #include "libavutil/imgutils.h"
@@ -43,11 +44,7 @@ int pgm_set(const AVFrame *pict, int height)
     const int   width = pict->linesize[0];
     const int   size = height * width;
 
-    int score = 0;
-    for (int ii = 0; ii < size; ii++)
-        if (pict->data[0][ii])
-            score++;
-    return score;
+    return pixel_kernels().m_countSet(pict->data[0], size);
 }
 
 int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
@@ -64,6 +61,14 @@ int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
         return -1;
     }
 
+    if (radius == 0)
+    {
+        /* Only the same pixel of "test" can match. */
+        *pscore = pixel_kernels().m_countMatch(tmpl->data[0], test->data[0],
+                height * width);
+        return 0;
+    }
+
     int score = 0;
     for (int rr = 0; rr < height; rr++)
     {
@@ -43,6 +43,7 @@ using namespace std;
 #include "jobqueue.h"
 #include "remoteencoder.h"
 #include "io/mythmediabuffer.h"
+#include "io/mythstreamtap.h"
 #include "commandlineparser.h"
 #include "mythtranslation.h"
 #include "loggingserver.h"
@@ -81,6 +82,7 @@ CommDetectorBase* commDetector = nullptr;
 RemoteEncoder* recorder = nullptr;
 ProgramInfo *global_program_info = nullptr;
 int recorderNum = -1;
+int tapCPUBudget = 0;
 
 int jobID = -1;
 int lastCmd = -1;
@@ -480,6 +482,9 @@ static void commDetectorGotNewCommercialBreakList(void)
         QString("mythcommflag sending update: %1").arg(message));
 
     gCoreContext->SendMessage(message);
+
+    if (tapCPUBudget > 0)
+        global_program_info->SaveCommBreakList(newCommercialMap);
 }
 
 static void incomingCustomEvent(QEvent* e)
@@ -575,6 +580,17 @@ static int DoFlagCommercials(
     QObject::connect(commDetector, SIGNAL(gotNewCommercialBreakList()),
                      c,            SLOT(relay()));
 
+    if (watchingRecording && tapCPUBudget > 0)
+    {
+        // Keep the break list in the database up to date, so that it is
+        // complete as soon as the recording is.
+        LOG(VB_COMMFLAG, LOG_INFO,
+            QString("Following the recording in memory, CPU budget %1%")
+                .arg(tapCPUBudget));
+        commDetector->setCPUBudget(tapCPUBudget);
+        commDetector->requestCommBreakMapUpdate();
+    }
+
     if (useDB)
     {
         LOG(VB_COMMFLAG, LOG_INFO,
@@ -888,6 +904,17 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         }
     }
 
+    // The recorder shares a recording in progress in memory when flagging
+    // it is to keep within a CPU budget.
+    tapCPUBudget = 0;
+    if (useDB && !filename.startsWith("myth://"))
+    {
+        MythStreamTap *tap = MythStreamTap::Open(filename);
+        if (tap && !tap->IsFinished())
+            tapCPUBudget = tap->GetCPUBudget();
+        delete tap;
+    }
+
     auto flags = static_cast<PlayerFlags>(kAudioMuted | kVideoIsNull | kNoITV);
 
     int flagfast = gCoreContext->GetNumSetting("CommFlagFast", 0);
@@ -901,6 +928,19 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         flags = static_cast<PlayerFlags>(flags | kDecodeLowRes | kDecodeSingleThreaded | kDecodeNoLoopFilter);
     }
 
+    if (tapCPUBudget > 0)
+    {
+        // The loop filter only makes the picture nicer.
+        LOG(VB_GENERAL, LOG_INFO, "Decoding without the loop filter for flagging");
+        flags = static_cast<PlayerFlags>(flags | kDecodeNoLoopFilter);
+
+        if (CommDetectorFactory::acceptsHalfSizeHD(commDetectMethod))
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Decoding HD at half size for flagging");
+            flags = static_cast<PlayerFlags>(flags | kDecodeHalfSizeHD);
+        }
+    }
+
     // blank detector needs to be only sample center for this optimization.
     if (flagfast && ((COMM_DETECT_BLANKS  == commDetectMethod) ||
                      (COMM_DETECT_2_BLANK == commDetectMethod)))
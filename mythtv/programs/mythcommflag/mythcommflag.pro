@@ -15,7 +15,7 @@ QMAKE_CLEAN += $(TARGET)
 HEADERS += CommDetectorFactory.h CommDetectorBase.h
 HEADERS += ClassicLogoDetector.h
 HEADERS += ClassicSceneChangeDetector.h
-HEADERS += ClassicCommDetector.h
+HEADERS += ClassicCommDetector.h ClassicCommSegments.h
 HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
@@ -28,6 +28,7 @@ HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
 HEADERS += SceneChangeDetector.h
 HEADERS += PrePostRollFlagger.h
+HEADERS += pixelkernels.h
 
 HEADERS += LogoDetectorBase.h SceneChangeDetectorBase.h
 HEADERS += SlotRelayer.h CustomEventRelayer.h
@@ -36,7 +37,7 @@ HEADERS += commandlineparser.h
 SOURCES += CommDetectorFactory.cpp CommDetectorBase.cpp
 SOURCES += ClassicLogoDetector.cpp
 SOURCES += ClassicSceneChangeDetector.cpp
-SOURCES += ClassicCommDetector.cpp
+SOURCES += ClassicCommDetector.cpp ClassicCommSegments.cpp
 SOURCES += Histogram.cpp
 SOURCES += quickselect.cpp
 SOURCES += CommDetector2.cpp
@@ -49,8 +50,15 @@ SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
 SOURCES += SceneChangeDetector.cpp
 SOURCES += PrePostRollFlagger.cpp
+SOURCES += pixelkernels.cpp
 
 SOURCES += main.cpp commandlineparser.cpp
 
 QT += xml sql network
 
+test_clean.commands = -cd test/ && $(MAKE) -f Makefile clean
+clean.depends = test_clean
+QMAKE_EXTRA_TARGETS += test_clean clean
+test_distclean.commands = -cd test/ && $(MAKE) -f Makefile distclean
+distclean.depends = test_distclean
+QMAKE_EXTRA_TARGETS += test_distclean distclean
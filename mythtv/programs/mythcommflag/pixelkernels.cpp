@@ -0,0 +1,869 @@
+// ANSI C headers
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+// C++ headers
+#include <array>
+
+// MythTV headers
+#include "mythconfig.h"
+#include "mythlogging.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#if ARCH_X86 && (HAVE_SSE4 || HAVE_AVX2)
+#include <immintrin.h>
+#endif
+
+#if HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+#endif
+
+// Commercial Flagging headers
+#include "pixelkernels.h"
+
+/*
+ * C versions. The SIMD versions below hand any pixels left over at the end
+ * of a row to these.
+ */
+static void sample_row(uint8_t *dst, const uint8_t *src, int count, int step,
+                       unsigned long long *sum, unsigned long long *sumsquares)
+{
+    unsigned long long sumval = 0;
+    unsigned long long squares = 0;
+    for (int ii = 0; ii < count; ii++)
+    {
+        uint8_t val = src[ii * step];
+        dst[ii] = val;
+        sumval += val;
+        squares += val * val;
+    }
+    *sum += sumval;
+    *sumsquares += squares;
+}
+
+static void min_max(const uint8_t *src, int count,
+                    uint8_t *minval, uint8_t *maxval)
+{
+    uint8_t lo = UCHAR_MAX;
+    uint8_t hi = 0;
+    for (int ii = 0; ii < count; ii++)
+    {
+        if (src[ii] < lo)
+            lo = src[ii];
+        if (src[ii] > hi)
+            hi = src[ii];
+    }
+    *minval = lo;
+    *maxval = hi;
+}
+
+static void convolve_column(uint8_t *dst, const uint8_t *src, int stride,
+                            int count, const double *mask, int radius)
+{
+    for (int cc = 0; cc < count; cc++)
+    {
+        double sum = 0;
+        for (int ii = -radius; ii <= radius; ii++)
+            sum += mask[ii + radius] * src[ii * stride + cc];
+        dst[cc] = lround(sum);
+    }
+}
+
+static void convolve_row(uint8_t *dst, const uint8_t *src, int count,
+                         const double *mask, int radius)
+{
+    for (int cc = 0; cc < count; cc++)
+    {
+        double sum = 0;
+        for (int ii = -radius; ii <= radius; ii++)
+            sum += mask[ii + radius] * src[cc + ii];
+        dst[cc] = lround(sum);
+    }
+}
+
+static void sgm_row(unsigned int *dst, const uint8_t *row0,
+                    const uint8_t *row1, int count)
+{
+    for (int cc = 0; cc < count; cc++)
+    {
+        int dx = row1[cc + 1] - row0[cc];   /* southeast - northwest */
+        int dy = row1[cc] - row0[cc + 1];   /* southwest - northeast */
+        dst[cc] = dx * dx + dy * dy;
+    }
+}
+
+static void mark_row(uint8_t *dst, const unsigned int *sgm, int count,
+                     unsigned int threshold)
+{
+    for (int cc = 0; cc < count; cc++)
+        dst[cc] = sgm[cc] >= threshold ? UCHAR_MAX : 0;
+}
+
+static int count_set(const uint8_t *src, int count)
+{
+    int score = 0;
+    for (int ii = 0; ii < count; ii++)
+        if (src[ii])
+            score++;
+    return score;
+}
+
+static int count_match(const uint8_t *src1, const uint8_t *src2, int count)
+{
+    int score = 0;
+    for (int ii = 0; ii < count; ii++)
+        if (src1[ii] && src2[ii])
+            score++;
+    return score;
+}
+
+/*
+ * Vector loads of every 2nd or 4th pixel read up to step - 1 bytes past the
+ * last pixel they take, so they stop a pixel short of the end of the row.
+ */
+static inline int sample_limit(int count, int step)
+{
+    return step == 1 ? count : count - 1;
+}
+
+/*
+ * The convolutions add up the same products in the same order as the C
+ * versions, one lane per pixel, so the sums are identical. The results are
+ * never negative, so lround() is the integer part plus one where the
+ * fraction is at least a half.
+ *
+ * That only holds where C does its double arithmetic in SSE2 registers,
+ * so the x86 versions are limited to x86-64. There are no NEON versions, as
+ * the compiler may or may not fuse the multiply and add of either version.
+ */
+
+#if ARCH_X86 && HAVE_SSE4
+#define SSE4_TARGET __attribute__((target("sse4.1")))
+
+SSE4_TARGET static void SSE4_sample_row(uint8_t *dst, const uint8_t *src,
+                                        int count, int step,
+                                        unsigned long long *sum,
+                                        unsigned long long *sumsquares)
+{
+    int x = 0;
+    if (step == 1 || step == 2 || step == 4)
+    {
+        const __m128i zero   = _mm_setzero_si128();
+        const __m128i words  = _mm_set1_epi16(0x00FF);
+        const __m128i dwords = _mm_set1_epi32(0x000000FF);
+        const int     limit  = sample_limit(count, step);
+        __m128i sums      = zero;
+        __m128i squares64 = zero;
+        while (x + 16 <= limit)
+        {
+            // At most 260100 a lane per vector, so 4096 vectors fit 32 bits
+            __m128i squares = zero;
+            for (int n = 0; n < 4096 && x + 16 <= limit; n++, x += 16)
+            {
+                const auto *s = reinterpret_cast<const __m128i*>(&src[x * step]);
+                __m128i v;
+                if (step == 1)
+                {
+                    v = _mm_loadu_si128(s);
+                }
+                else if (step == 2)
+                {
+                    v = _mm_packus_epi16(_mm_and_si128(_mm_loadu_si128(s), words),
+                                         _mm_and_si128(_mm_loadu_si128(s + 1), words));
+                }
+                else
+                {
+                    __m128i a = _mm_packus_epi32(_mm_and_si128(_mm_loadu_si128(s), dwords),
+                                                 _mm_and_si128(_mm_loadu_si128(s + 1), dwords));
+                    __m128i b = _mm_packus_epi32(_mm_and_si128(_mm_loadu_si128(s + 2), dwords),
+                                                 _mm_and_si128(_mm_loadu_si128(s + 3), dwords));
+                    v = _mm_packus_epi16(a, b);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[x]), v);
+                sums = _mm_add_epi64(sums, _mm_sad_epu8(v, zero));
+                __m128i lo = _mm_unpacklo_epi8(v, zero);
+                __m128i hi = _mm_unpackhi_epi8(v, zero);
+                squares = _mm_add_epi32(squares, _mm_madd_epi16(lo, lo));
+                squares = _mm_add_epi32(squares, _mm_madd_epi16(hi, hi));
+            }
+            squares64 = _mm_add_epi64(squares64, _mm_unpacklo_epi32(squares, zero));
+            squares64 = _mm_add_epi64(squares64, _mm_unpackhi_epi32(squares, zero));
+        }
+        alignas(16) std::array<uint64_t,2> total {};
+        _mm_store_si128(reinterpret_cast<__m128i*>(total.data()), sums);
+        *sum += total[0] + total[1];
+        _mm_store_si128(reinterpret_cast<__m128i*>(total.data()), squares64);
+        *sumsquares += total[0] + total[1];
+    }
+    sample_row(&dst[x], &src[x * step], count - x, step, sum, sumsquares);
+}
+
+SSE4_TARGET static void SSE4_min_max(const uint8_t *src, int count,
+                                     uint8_t *minval, uint8_t *maxval)
+{
+    __m128i lo = _mm_set1_epi8(static_cast<char>(UCHAR_MAX));
+    __m128i hi = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[x]));
+        lo = _mm_min_epu8(lo, v);
+        hi = _mm_max_epu8(hi, v);
+    }
+    alignas(16) std::array<uint8_t,16> los {};
+    alignas(16) std::array<uint8_t,16> his {};
+    _mm_store_si128(reinterpret_cast<__m128i*>(los.data()), lo);
+    _mm_store_si128(reinterpret_cast<__m128i*>(his.data()), hi);
+    min_max(&src[x], count - x, minval, maxval);
+    for (int ii = 0; ii < 16; ii++)
+    {
+        if (los[ii] < *minval)
+            *minval = los[ii];
+        if (his[ii] > *maxval)
+            *maxval = his[ii];
+    }
+}
+
+#if ARCH_X86_64
+SSE4_TARGET static inline void SSE4_load4pd(const uint8_t *src,
+                                            __m128d &lo, __m128d &hi)
+{
+    int32_t bytes = 0;
+    memcpy(&bytes, src, sizeof(bytes));
+    __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+    lo = _mm_cvtepi32_pd(v);
+    hi = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+SSE4_TARGET static inline __m128i SSE4_lround_pd(__m128d sum)
+{
+    __m128d whole = _mm_round_pd(sum, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128d half  = _mm_cmpge_pd(_mm_sub_pd(sum, whole), _mm_set1_pd(0.5));
+    return _mm_cvttpd_epi32(_mm_add_pd(whole, _mm_and_pd(half, _mm_set1_pd(1.0))));
+}
+
+SSE4_TARGET static inline void SSE4_store4(uint8_t *dst, __m128d lo, __m128d hi)
+{
+    __m128i v = _mm_unpacklo_epi64(SSE4_lround_pd(lo), SSE4_lround_pd(hi));
+    v = _mm_packus_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    int32_t bytes = _mm_cvtsi128_si32(v);
+    memcpy(dst, &bytes, sizeof(bytes));
+}
+
+SSE4_TARGET static void SSE4_convolve_column(uint8_t *dst, const uint8_t *src,
+                                             int stride, int count,
+                                             const double *mask, int radius)
+{
+    int cc = 0;
+    for (; cc + 4 <= count; cc += 4)
+    {
+        __m128d lo = _mm_setzero_pd();
+        __m128d hi = _mm_setzero_pd();
+        for (int ii = -radius; ii <= radius; ii++)
+        {
+            __m128d m = _mm_set1_pd(mask[ii + radius]);
+            __m128d plo;
+            __m128d phi;
+            SSE4_load4pd(&src[ii * stride + cc], plo, phi);
+            lo = _mm_add_pd(lo, _mm_mul_pd(m, plo));
+            hi = _mm_add_pd(hi, _mm_mul_pd(m, phi));
+        }
+        SSE4_store4(&dst[cc], lo, hi);
+    }
+    convolve_column(&dst[cc], &src[cc], stride, count - cc, mask, radius);
+}
+
+SSE4_TARGET static void SSE4_convolve_row(uint8_t *dst, const uint8_t *src,
+                                          int count, const double *mask,
+                                          int radius)
+{
+    int cc = 0;
+    for (; cc + 4 <= count; cc += 4)
+    {
+        __m128d lo = _mm_setzero_pd();
+        __m128d hi = _mm_setzero_pd();
+        for (int ii = -radius; ii <= radius; ii++)
+        {
+            __m128d m = _mm_set1_pd(mask[ii + radius]);
+            __m128d plo;
+            __m128d phi;
+            SSE4_load4pd(&src[cc + ii], plo, phi);
+            lo = _mm_add_pd(lo, _mm_mul_pd(m, plo));
+            hi = _mm_add_pd(hi, _mm_mul_pd(m, phi));
+        }
+        SSE4_store4(&dst[cc], lo, hi);
+    }
+    convolve_row(&dst[cc], &src[cc], count - cc, mask, radius);
+}
+#endif // ARCH_X86_64
+
+SSE4_TARGET static void SSE4_sgm_row(unsigned int *dst, const uint8_t *row0,
+                                     const uint8_t *row1, int count)
+{
+    int cc = 0;
+    for (; cc + 8 <= count; cc += 8)
+    {
+        __m128i nw = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&row0[cc])));
+        __m128i ne = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&row0[cc + 1])));
+        __m128i sw = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&row1[cc])));
+        __m128i se = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&row1[cc + 1])));
+        __m128i dx = _mm_sub_epi16(se, nw);
+        __m128i dy = _mm_sub_epi16(sw, ne);
+        __m128i lo = _mm_unpacklo_epi16(dx, dy);
+        __m128i hi = _mm_unpackhi_epi16(dx, dy);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[cc]),     _mm_madd_epi16(lo, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[cc + 4]), _mm_madd_epi16(hi, hi));
+    }
+    sgm_row(&dst[cc], &row0[cc], &row1[cc], count - cc);
+}
+
+// All ones in each lane where sgm >= threshold
+SSE4_TARGET static inline __m128i SSE4_cmpge_epu32(const unsigned int *sgm,
+                                                   __m128i threshold)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sgm));
+    return _mm_cmpeq_epi32(_mm_max_epu32(v, threshold), v);
+}
+
+SSE4_TARGET static void SSE4_mark_row(uint8_t *dst, const unsigned int *sgm,
+                                      int count, unsigned int threshold)
+{
+    const __m128i thr = _mm_set1_epi32(static_cast<int>(threshold));
+    int cc = 0;
+    for (; cc + 16 <= count; cc += 16)
+    {
+        __m128i a = _mm_packs_epi32(SSE4_cmpge_epu32(&sgm[cc], thr),
+                                    SSE4_cmpge_epu32(&sgm[cc + 4], thr));
+        __m128i b = _mm_packs_epi32(SSE4_cmpge_epu32(&sgm[cc + 8], thr),
+                                    SSE4_cmpge_epu32(&sgm[cc + 12], thr));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[cc]), _mm_packs_epi16(a, b));
+    }
+    mark_row(&dst[cc], &sgm[cc], count - cc, threshold);
+}
+
+// min(pixel, 1) is 1 for each pixel that is set; psadbw adds those up.
+SSE4_TARGET static int SSE4_count_set(const uint8_t *src, int count)
+{
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i sums = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[x]));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_min_epu8(v, one), _mm_setzero_si128()));
+    }
+    return _mm_cvtsi128_si32(sums) + _mm_extract_epi32(sums, 2) +
+        count_set(&src[x], count - x);
+}
+
+SSE4_TARGET static int SSE4_count_match(const uint8_t *src1, const uint8_t *src2,
+                                        int count)
+{
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i sums = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src1[x]));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src2[x]));
+        __m128i both = _mm_min_epu8(_mm_min_epu8(a, b), one);
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(both, _mm_setzero_si128()));
+    }
+    return _mm_cvtsi128_si32(sums) + _mm_extract_epi32(sums, 2) +
+        count_match(&src1[x], &src2[x], count - x);
+}
+#endif // ARCH_X86 && HAVE_SSE4
+
+#if ARCH_X86 && HAVE_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// Puts the dwords of packs/packus of four in-lane results back in order
+#define AVX2_PACK_ORDER _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)
+
+AVX2_TARGET static void AVX2_sample_row(uint8_t *dst, const uint8_t *src,
+                                        int count, int step,
+                                        unsigned long long *sum,
+                                        unsigned long long *sumsquares)
+{
+    int x = 0;
+    if (step == 1 || step == 2 || step == 4)
+    {
+        const __m256i zero   = _mm256_setzero_si256();
+        const __m256i words  = _mm256_set1_epi16(0x00FF);
+        const __m256i dwords = _mm256_set1_epi32(0x000000FF);
+        const int     limit  = sample_limit(count, step);
+        __m256i sums      = zero;
+        __m256i squares64 = zero;
+        while (x + 32 <= limit)
+        {
+            // At most 260100 a lane per vector, so 4096 vectors fit 32 bits
+            __m256i squares = zero;
+            for (int n = 0; n < 4096 && x + 32 <= limit; n++, x += 32)
+            {
+                const auto *s = reinterpret_cast<const __m256i*>(&src[x * step]);
+                __m256i v;
+                if (step == 1)
+                {
+                    v = _mm256_loadu_si256(s);
+                }
+                else if (step == 2)
+                {
+                    v = _mm256_packus_epi16(_mm256_and_si256(_mm256_loadu_si256(s), words),
+                                            _mm256_and_si256(_mm256_loadu_si256(s + 1), words));
+                    v = _mm256_permute4x64_epi64(v, 0xD8);
+                }
+                else
+                {
+                    __m256i a = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(s), dwords),
+                                                    _mm256_and_si256(_mm256_loadu_si256(s + 1), dwords));
+                    __m256i b = _mm256_packus_epi32(_mm256_and_si256(_mm256_loadu_si256(s + 2), dwords),
+                                                    _mm256_and_si256(_mm256_loadu_si256(s + 3), dwords));
+                    v = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), AVX2_PACK_ORDER);
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[x]), v);
+                sums = _mm256_add_epi64(sums, _mm256_sad_epu8(v, zero));
+                __m256i lo = _mm256_unpacklo_epi8(v, zero);
+                __m256i hi = _mm256_unpackhi_epi8(v, zero);
+                squares = _mm256_add_epi32(squares, _mm256_madd_epi16(lo, lo));
+                squares = _mm256_add_epi32(squares, _mm256_madd_epi16(hi, hi));
+            }
+            squares64 = _mm256_add_epi64(squares64, _mm256_unpacklo_epi32(squares, zero));
+            squares64 = _mm256_add_epi64(squares64, _mm256_unpackhi_epi32(squares, zero));
+        }
+        alignas(32) std::array<uint64_t,4> total {};
+        _mm256_store_si256(reinterpret_cast<__m256i*>(total.data()), sums);
+        *sum += total[0] + total[1] + total[2] + total[3];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(total.data()), squares64);
+        *sumsquares += total[0] + total[1] + total[2] + total[3];
+    }
+    sample_row(&dst[x], &src[x * step], count - x, step, sum, sumsquares);
+}
+
+AVX2_TARGET static void AVX2_min_max(const uint8_t *src, int count,
+                                     uint8_t *minval, uint8_t *maxval)
+{
+    __m256i lo = _mm256_set1_epi8(static_cast<char>(UCHAR_MAX));
+    __m256i hi = _mm256_setzero_si256();
+    int x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[x]));
+        lo = _mm256_min_epu8(lo, v);
+        hi = _mm256_max_epu8(hi, v);
+    }
+    alignas(32) std::array<uint8_t,32> los {};
+    alignas(32) std::array<uint8_t,32> his {};
+    _mm256_store_si256(reinterpret_cast<__m256i*>(los.data()), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(his.data()), hi);
+    min_max(&src[x], count - x, minval, maxval);
+    for (int ii = 0; ii < 32; ii++)
+    {
+        if (los[ii] < *minval)
+            *minval = los[ii];
+        if (his[ii] > *maxval)
+            *maxval = his[ii];
+    }
+}
+
+#if ARCH_X86_64
+AVX2_TARGET static inline void AVX2_load8pd(const uint8_t *src,
+                                            __m256d &lo, __m256d &hi)
+{
+    __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+    lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(v));
+    hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1));
+}
+
+AVX2_TARGET static inline __m128i AVX2_lround_pd(__m256d sum)
+{
+    __m256d whole = _mm256_round_pd(sum, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256d half  = _mm256_cmp_pd(_mm256_sub_pd(sum, whole), _mm256_set1_pd(0.5), _CMP_GE_OQ);
+    return _mm256_cvttpd_epi32(_mm256_add_pd(whole, _mm256_and_pd(half, _mm256_set1_pd(1.0))));
+}
+
+AVX2_TARGET static inline void AVX2_store8(uint8_t *dst, __m256d lo, __m256d hi)
+{
+    __m128i v = _mm_packus_epi32(AVX2_lround_pd(lo), AVX2_lround_pd(hi));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(v, v));
+}
+
+AVX2_TARGET static void AVX2_convolve_column(uint8_t *dst, const uint8_t *src,
+                                             int stride, int count,
+                                             const double *mask, int radius)
+{
+    int cc = 0;
+    for (; cc + 8 <= count; cc += 8)
+    {
+        __m256d lo = _mm256_setzero_pd();
+        __m256d hi = _mm256_setzero_pd();
+        for (int ii = -radius; ii <= radius; ii++)
+        {
+            __m256d m = _mm256_set1_pd(mask[ii + radius]);
+            __m256d plo;
+            __m256d phi;
+            AVX2_load8pd(&src[ii * stride + cc], plo, phi);
+            lo = _mm256_add_pd(lo, _mm256_mul_pd(m, plo));
+            hi = _mm256_add_pd(hi, _mm256_mul_pd(m, phi));
+        }
+        AVX2_store8(&dst[cc], lo, hi);
+    }
+    convolve_column(&dst[cc], &src[cc], stride, count - cc, mask, radius);
+}
+
+AVX2_TARGET static void AVX2_convolve_row(uint8_t *dst, const uint8_t *src,
+                                          int count, const double *mask,
+                                          int radius)
+{
+    int cc = 0;
+    for (; cc + 8 <= count; cc += 8)
+    {
+        __m256d lo = _mm256_setzero_pd();
+        __m256d hi = _mm256_setzero_pd();
+        for (int ii = -radius; ii <= radius; ii++)
+        {
+            __m256d m = _mm256_set1_pd(mask[ii + radius]);
+            __m256d plo;
+            __m256d phi;
+            AVX2_load8pd(&src[cc + ii], plo, phi);
+            lo = _mm256_add_pd(lo, _mm256_mul_pd(m, plo));
+            hi = _mm256_add_pd(hi, _mm256_mul_pd(m, phi));
+        }
+        AVX2_store8(&dst[cc], lo, hi);
+    }
+    convolve_row(&dst[cc], &src[cc], count - cc, mask, radius);
+}
+#endif // ARCH_X86_64
+
+AVX2_TARGET static void AVX2_sgm_row(unsigned int *dst, const uint8_t *row0,
+                                     const uint8_t *row1, int count)
+{
+    int cc = 0;
+    for (; cc + 16 <= count; cc += 16)
+    {
+        __m256i nw = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row0[cc])));
+        __m256i ne = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row0[cc + 1])));
+        __m256i sw = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row1[cc])));
+        __m256i se = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row1[cc + 1])));
+        __m256i dx = _mm256_sub_epi16(se, nw);
+        __m256i dy = _mm256_sub_epi16(sw, ne);
+        // Pixels 0-3 and 8-11, then 4-7 and 12-15
+        __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(dx, dy), _mm256_unpacklo_epi16(dx, dy));
+        __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(dx, dy), _mm256_unpackhi_epi16(dx, dy));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[cc]),     _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[cc + 8]), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    sgm_row(&dst[cc], &row0[cc], &row1[cc], count - cc);
+}
+
+AVX2_TARGET static inline __m256i AVX2_cmpge_epu32(const unsigned int *sgm,
+                                                   __m256i threshold)
+{
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sgm));
+    return _mm256_cmpeq_epi32(_mm256_max_epu32(v, threshold), v);
+}
+
+AVX2_TARGET static void AVX2_mark_row(uint8_t *dst, const unsigned int *sgm,
+                                      int count, unsigned int threshold)
+{
+    const __m256i thr = _mm256_set1_epi32(static_cast<int>(threshold));
+    int cc = 0;
+    for (; cc + 32 <= count; cc += 32)
+    {
+        __m256i a = _mm256_packs_epi32(AVX2_cmpge_epu32(&sgm[cc], thr),
+                                       AVX2_cmpge_epu32(&sgm[cc + 8], thr));
+        __m256i b = _mm256_packs_epi32(AVX2_cmpge_epu32(&sgm[cc + 16], thr),
+                                       AVX2_cmpge_epu32(&sgm[cc + 24], thr));
+        __m256i v = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(a, b), AVX2_PACK_ORDER);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst[cc]), v);
+    }
+    mark_row(&dst[cc], &sgm[cc], count - cc, threshold);
+}
+
+AVX2_TARGET static inline int AVX2_sum_epi64(__m256i sums)
+{
+    __m128i v = _mm_add_epi64(_mm256_castsi256_si128(sums),
+                              _mm256_extracti128_si256(sums, 1));
+    return _mm_cvtsi128_si32(v) + _mm_extract_epi32(v, 2);
+}
+
+AVX2_TARGET static int AVX2_count_set(const uint8_t *src, int count)
+{
+    const __m256i one = _mm256_set1_epi8(1);
+    __m256i sums = _mm256_setzero_si256();
+    int x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src[x]));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_min_epu8(v, one), _mm256_setzero_si256()));
+    }
+    return AVX2_sum_epi64(sums) + count_set(&src[x], count - x);
+}
+
+AVX2_TARGET static int AVX2_count_match(const uint8_t *src1, const uint8_t *src2,
+                                        int count)
+{
+    const __m256i one = _mm256_set1_epi8(1);
+    __m256i sums = _mm256_setzero_si256();
+    int x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src1[x]));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&src2[x]));
+        __m256i both = _mm256_min_epu8(_mm256_min_epu8(a, b), one);
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(both, _mm256_setzero_si256()));
+    }
+    return AVX2_sum_epi64(sums) + count_match(&src1[x], &src2[x], count - x);
+}
+#endif // ARCH_X86 && HAVE_AVX2
+
+#if HAVE_INTRINSICS_NEON
+static void NEON_sample_row(uint8_t *dst, const uint8_t *src, int count,
+                            int step, unsigned long long *sum,
+                            unsigned long long *sumsquares)
+{
+    int x = 0;
+    if (step == 1 || step == 2 || step == 4)
+    {
+        const int limit = sample_limit(count, step);
+        uint64x2_t sums      = vdupq_n_u64(0);
+        uint64x2_t squares64 = vdupq_n_u64(0);
+        while (x + 16 <= limit)
+        {
+            // At most 260100 a lane per vector, so 4096 vectors fit 32 bits
+            uint32x4_t sums32  = vdupq_n_u32(0);
+            uint32x4_t squares = vdupq_n_u32(0);
+            for (int n = 0; n < 4096 && x + 16 <= limit; n++, x += 16)
+            {
+                const uint8_t *s = &src[x * step];
+                uint8x16_t v;
+                if (step == 1)
+                    v = vld1q_u8(s);
+                else if (step == 2)
+                    v = vld2q_u8(s).val[0];
+                else
+                    v = vld4q_u8(s).val[0];
+                vst1q_u8(&dst[x], v);
+                sums32  = vpadalq_u16(sums32, vpaddlq_u8(v));
+                squares = vpadalq_u16(squares, vmull_u8(vget_low_u8(v), vget_low_u8(v)));
+                squares = vpadalq_u16(squares, vmull_u8(vget_high_u8(v), vget_high_u8(v)));
+            }
+            sums      = vpadalq_u32(sums, sums32);
+            squares64 = vpadalq_u32(squares64, squares);
+        }
+        *sum += vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1);
+        *sumsquares += vgetq_lane_u64(squares64, 0) + vgetq_lane_u64(squares64, 1);
+    }
+    sample_row(&dst[x], &src[x * step], count - x, step, sum, sumsquares);
+}
+
+static void NEON_min_max(const uint8_t *src, int count,
+                         uint8_t *minval, uint8_t *maxval)
+{
+    uint8x16_t lo = vdupq_n_u8(UCHAR_MAX);
+    uint8x16_t hi = vdupq_n_u8(0);
+    int x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        uint8x16_t v = vld1q_u8(&src[x]);
+        lo = vminq_u8(lo, v);
+        hi = vmaxq_u8(hi, v);
+    }
+    std::array<uint8_t,16> los {};
+    std::array<uint8_t,16> his {};
+    vst1q_u8(los.data(), lo);
+    vst1q_u8(his.data(), hi);
+    min_max(&src[x], count - x, minval, maxval);
+    for (int ii = 0; ii < 16; ii++)
+    {
+        if (los[ii] < *minval)
+            *minval = los[ii];
+        if (his[ii] > *maxval)
+            *maxval = his[ii];
+    }
+}
+
+static void NEON_sgm_row(unsigned int *dst, const uint8_t *row0,
+                         const uint8_t *row1, int count)
+{
+    int cc = 0;
+    for (; cc + 8 <= count; cc += 8)
+    {
+        uint8x8_t nw = vld1_u8(&row0[cc]);
+        uint8x8_t ne = vld1_u8(&row0[cc + 1]);
+        uint8x8_t sw = vld1_u8(&row1[cc]);
+        uint8x8_t se = vld1_u8(&row1[cc + 1]);
+        // The 16 bit differences wrap to the right signed values
+        int16x8_t dx = vreinterpretq_s16_u16(vsubl_u8(se, nw));
+        int16x8_t dy = vreinterpretq_s16_u16(vsubl_u8(sw, ne));
+        int32x4_t lo = vmlal_s16(vmull_s16(vget_low_s16(dx), vget_low_s16(dx)),
+                                 vget_low_s16(dy), vget_low_s16(dy));
+        int32x4_t hi = vmlal_s16(vmull_s16(vget_high_s16(dx), vget_high_s16(dx)),
+                                 vget_high_s16(dy), vget_high_s16(dy));
+        vst1q_u32(&dst[cc],     vreinterpretq_u32_s32(lo));
+        vst1q_u32(&dst[cc + 4], vreinterpretq_u32_s32(hi));
+    }
+    sgm_row(&dst[cc], &row0[cc], &row1[cc], count - cc);
+}
+
+static void NEON_mark_row(uint8_t *dst, const unsigned int *sgm, int count,
+                          unsigned int threshold)
+{
+    const uint32x4_t thr = vdupq_n_u32(threshold);
+    int cc = 0;
+    for (; cc + 16 <= count; cc += 16)
+    {
+        uint16x8_t a = vcombine_u16(vmovn_u32(vcgeq_u32(vld1q_u32(&sgm[cc]), thr)),
+                                    vmovn_u32(vcgeq_u32(vld1q_u32(&sgm[cc + 4]), thr)));
+        uint16x8_t b = vcombine_u16(vmovn_u32(vcgeq_u32(vld1q_u32(&sgm[cc + 8]), thr)),
+                                    vmovn_u32(vcgeq_u32(vld1q_u32(&sgm[cc + 12]), thr)));
+        vst1q_u8(&dst[cc], vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    }
+    mark_row(&dst[cc], &sgm[cc], count - cc, threshold);
+}
+
+// min(pixel, 1) is 1 for each pixel that is set. 255 vectors fit 8 bits.
+static int NEON_count_set(const uint8_t *src, int count)
+{
+    const uint8x16_t one = vdupq_n_u8(1);
+    uint64x2_t sums = vdupq_n_u64(0);
+    int x = 0;
+    while (x + 16 <= count)
+    {
+        uint8x16_t sums8 = vdupq_n_u8(0);
+        for (int n = 0; n < 255 && x + 16 <= count; n++, x += 16)
+            sums8 = vaddq_u8(sums8, vminq_u8(vld1q_u8(&src[x]), one));
+        sums = vpadalq_u32(sums, vpaddlq_u16(vpaddlq_u8(sums8)));
+    }
+    return static_cast<int>(vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1)) +
+        count_set(&src[x], count - x);
+}
+
+static int NEON_count_match(const uint8_t *src1, const uint8_t *src2, int count)
+{
+    const uint8x16_t one = vdupq_n_u8(1);
+    uint64x2_t sums = vdupq_n_u64(0);
+    int x = 0;
+    while (x + 16 <= count)
+    {
+        uint8x16_t sums8 = vdupq_n_u8(0);
+        for (int n = 0; n < 255 && x + 16 <= count; n++, x += 16)
+        {
+            uint8x16_t both = vminq_u8(vld1q_u8(&src1[x]), vld1q_u8(&src2[x]));
+            sums8 = vaddq_u8(sums8, vminq_u8(both, one));
+        }
+        sums = vpadalq_u32(sums, vpaddlq_u16(vpaddlq_u8(sums8)));
+    }
+    return static_cast<int>(vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1)) +
+        count_match(&src1[x], &src2[x], count - x);
+}
+#endif // HAVE_INTRINSICS_NEON
+
+static PixelKernels c_kernels(void)
+{
+    PixelKernels kernels;
+    kernels.m_sampleRow      = sample_row;
+    kernels.m_minMax         = min_max;
+    kernels.m_convolveColumn = convolve_column;
+    kernels.m_convolveRow    = convolve_row;
+    kernels.m_sgmRow         = sgm_row;
+    kernels.m_markRow        = mark_row;
+    kernels.m_countSet       = count_set;
+    kernels.m_countMatch     = count_match;
+    return kernels;
+}
+
+static PixelKernels select_kernels(void)
+{
+    PixelKernels kernels = c_kernels();
+#if ARCH_X86
+    int flags = av_get_cpu_flags();
+#if HAVE_SSE4
+    if (flags & AV_CPU_FLAG_SSE4)
+    {
+        kernels.m_name       = "SSE4";
+        kernels.m_sampleRow  = SSE4_sample_row;
+        kernels.m_minMax     = SSE4_min_max;
+#if ARCH_X86_64
+        kernels.m_convolveColumn = SSE4_convolve_column;
+        kernels.m_convolveRow    = SSE4_convolve_row;
+#endif
+        kernels.m_sgmRow     = SSE4_sgm_row;
+        kernels.m_markRow    = SSE4_mark_row;
+        kernels.m_countSet   = SSE4_count_set;
+        kernels.m_countMatch = SSE4_count_match;
+    }
+#endif
+#if HAVE_AVX2
+    // libavutil also checks that the OS saves the upper halves of registers
+    if (flags & AV_CPU_FLAG_AVX2)
+    {
+        kernels.m_name       = "AVX2";
+        kernels.m_sampleRow  = AVX2_sample_row;
+        kernels.m_minMax     = AVX2_min_max;
+#if ARCH_X86_64
+        kernels.m_convolveColumn = AVX2_convolve_column;
+        kernels.m_convolveRow    = AVX2_convolve_row;
+#endif
+        kernels.m_sgmRow     = AVX2_sgm_row;
+        kernels.m_markRow    = AVX2_mark_row;
+        kernels.m_countSet   = AVX2_count_set;
+        kernels.m_countMatch = AVX2_count_match;
+    }
+#endif
+#elif HAVE_INTRINSICS_NEON
+    if (have_neon(av_get_cpu_flags()))
+    {
+        kernels.m_name       = "NEON";
+        kernels.m_sampleRow  = NEON_sample_row;
+        kernels.m_minMax     = NEON_min_max;
+        kernels.m_sgmRow     = NEON_sgm_row;
+        kernels.m_markRow    = NEON_mark_row;
+        kernels.m_countSet   = NEON_count_set;
+        kernels.m_countMatch = NEON_count_match;
+    }
+#endif
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Using %1 frame analysis kernels").arg(kernels.m_name));
+    return kernels;
+}
+
+const PixelKernels &pixel_kernels(bool useSIMD)
+{
+    static const PixelKernels s_c = c_kernels();
+    static const PixelKernels s_simd = select_kernels();
+    return useSIMD ? s_simd : s_c;
+}
+
+void pixel_histogram(int *hist, const uint8_t *src, int pitch,
+                     int width, int height, int xstep, int ystep)
+{
+    std::array<std::array<int,UCHAR_MAX + 1>,4> tables {};
+    for (int rr = 0; rr < height; rr++)
+    {
+        const uint8_t *row = &src[static_cast<ptrdiff_t>(rr) * ystep * pitch];
+        int cc = 0;
+        for (; cc + 4 <= width; cc += 4)
+        {
+            tables[0][row[(cc + 0) * xstep]]++;
+            tables[1][row[(cc + 1) * xstep]]++;
+            tables[2][row[(cc + 2) * xstep]]++;
+            tables[3][row[(cc + 3) * xstep]]++;
+        }
+        for (; cc < width; cc++)
+            tables[0][row[cc * xstep]]++;
+    }
+    for (int ii = 0; ii <= UCHAR_MAX; ii++)
+        hist[ii] += tables[0][ii] + tables[1][ii] + tables[2][ii] + tables[3][ii];
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
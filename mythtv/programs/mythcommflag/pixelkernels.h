@@ -0,0 +1,70 @@
+/*
+ * pixelkernels.h
+ *
+ * Inner loops of the frame analyzers over rows of greyscale pixels, with
+ * SSE4.1, AVX2 and NEON versions picked once for the CPU at runtime. Every
+ * version gives exactly the same result as the C one.
+ */
+
+#ifndef PIXELKERNELS_H
+#define PIXELKERNELS_H
+
+#include <cstdint>
+
+struct PixelKernels
+{
+    const char *m_name { "C" };
+
+    /*
+     * Copy every "step"th of the "count" pixels starting at "src" to "dst",
+     * and add their sum and sum of squares to "*sum" and "*sumsquares".
+     */
+    void (*m_sampleRow)(uint8_t *dst, const uint8_t *src, int count, int step,
+                        unsigned long long *sum,
+                        unsigned long long *sumsquares) { nullptr };
+
+    /* Smallest and largest of "count" pixels. */
+    void (*m_minMax)(const uint8_t *src, int count,
+                     uint8_t *minval, uint8_t *maxval) { nullptr };
+
+    /*
+     * Convolve with a mask of 2 * radius + 1 doubles, down a column
+     * ("stride" bytes between rows, "src" at the centre row) or along a
+     * row, and round each result to the nearest integer (lround).
+     */
+    void (*m_convolveColumn)(uint8_t *dst, const uint8_t *src, int stride,
+                             int count, const double *mask, int radius) { nullptr };
+    void (*m_convolveRow)(uint8_t *dst, const uint8_t *src, int count,
+                          const double *mask, int radius) { nullptr };
+
+    /*
+     * Squared gradient magnitude on 45 degree rotated axes, between a row
+     * and the row below it. Reads count + 1 pixels of each row.
+     */
+    void (*m_sgmRow)(unsigned int *dst, const uint8_t *row0,
+                     const uint8_t *row1, int count) { nullptr };
+
+    /* UCHAR_MAX where sgm >= threshold, otherwise 0. */
+    void (*m_markRow)(uint8_t *dst, const unsigned int *sgm, int count,
+                      unsigned int threshold) { nullptr };
+
+    /* Number of non-zero pixels, and of positions non-zero in both. */
+    int (*m_countSet)(const uint8_t *src, int count) { nullptr };
+    int (*m_countMatch)(const uint8_t *src1, const uint8_t *src2, int count) { nullptr };
+};
+
+/* The kernels for this CPU, or the C ones. */
+const PixelKernels &pixel_kernels(bool useSIMD = true);
+
+/*
+ * Add a histogram of "width" x "height" pixels, every "xstep"th pixel of
+ * every "ystep"th row, to "hist". There is no SIMD version of this; it
+ * spreads consecutive pixels over four tables instead, so that runs of the
+ * same value do not wait on each other's increments.
+ */
+void pixel_histogram(int *hist, const uint8_t *src, int pitch,
+                     int width, int height, int xstep, int ystep);
+
+#endif  /* !PIXELKERNELS_H */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,371 @@
+/*
+ *  Class TestCommSegments
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "mythframe.h"
+
+#include "ClassicCommSegments.h"
+#include "ClassicSceneChangeDetector.h"
+
+/*
+ * Flags frames of a synthetic recording into a ClassicCommSegment the way
+ * ClassicCommDetector::ProcessFrame() does, with a scene change detector
+ * and a frame of its own, so that parts can be flagged on threads of
+ * their own.
+ */
+class SegmentFlagger : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static const int kWidth      = 64;
+    static const int kHeight     = 48;
+    static const int kSceneSize  = 60;
+
+    SegmentFlagger(int width, int height, bool drop)
+      : m_width(width), m_height(height), m_drop(drop)
+    {
+        m_buf.resize(GetBufferSize(FMT_YV12, m_width, m_height));
+        init(&m_frame, FMT_YV12, m_buf.data(), m_width, m_height,
+             static_cast<int>(m_buf.size()));
+        std::fill(m_buf.begin(), m_buf.end(), 128);
+    }
+
+    /// Frames the decoder does not return, when it drops any
+    bool dropped(long long frame) const
+    {
+        return m_drop && (frame % 97 == 13);
+    }
+
+    /// Flags frames first to last into segment, with a detector of its own
+    void flag(long long first, long long last, ClassicCommSegment &segment)
+    {
+        auto *detector = new ClassicSceneChangeDetector(m_width, m_height,
+                                                        2, 4, 4);
+        connect(detector, &SceneChangeDetectorBase::haveNewInformation,
+                this, &SegmentFlagger::sceneChange);
+        m_current = &segment;
+        m_offset = -1;
+
+        long long lastFrame = first - 1;
+        for (long long frame = first; frame <= last; frame++)
+        {
+            if (dropped(frame))
+                continue;
+
+            // As ClassicCommDetector::ProcessSegment()
+            if (m_offset < 0)
+                m_offset = first ? frame : 0;
+
+            FrameInfoEntry info {-1, -1, -1, -1, 0, 0, 0};
+
+            // Fill in dummy info records for skipped frames.
+            info.flagMask = COMM_FRAME_SKIPPED;
+            while (++lastFrame < frame)
+                segment.m_frameInfo[lastFrame] = info;
+            info.flagMask = 0;
+
+            fillFrame(frame);
+            int level = brightness(frame);
+            info.minBrightness = level;
+            info.maxBrightness = level + 7;
+            info.avgBrightness = level + 3;
+            if (level < 20)
+            {
+                info.flagMask |= COMM_FRAME_BLANK;
+                segment.m_blankFrameMap[frame] = MARK_BLANK_FRAME;
+            }
+            segment.m_frameInfo[frame] = info;
+
+            m_curFrame = frame;
+            detector->processFrame(&m_frame);
+        }
+
+        detector->deleteLater();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+
+  private:
+    static uint hash(uint a)
+    {
+        a ^= a >> 16;
+        a *= 0x7FEB352DU;
+        a ^= a >> 15;
+        a *= 0x846CA68BU;
+        a ^= a >> 16;
+        return a;
+    }
+
+    /// Scenes of varying brightness, every fifth ending on blank frames
+    static int brightness(long long frame)
+    {
+        long long scene = frame / kSceneSize;
+        if ((scene % 5 == 4) && (frame % kSceneSize >= kSceneSize - 3))
+            return 16;
+        return 40 + static_cast<int>(hash(static_cast<uint>(scene)) % 180);
+    }
+
+    void fillFrame(long long frame)
+    {
+        int level = brightness(frame);
+        for (int y = 0; y < m_height; y++)
+        {
+            for (int x = 0; x < m_width; x++)
+            {
+                m_frame.buf[m_frame.offsets[0] + y * m_frame.pitches[0] + x] =
+                    level + ((x + y + frame) & 7);
+            }
+        }
+        m_frame.frameNumber = frame;
+    }
+
+    /// As ClassicCommDetector::sceneChangeDetectorHasNewInformation()
+    void sceneChange(unsigned int framenum, bool isSceneChange,
+                     float debugValue)
+    {
+        long long frame = framenum + m_offset;
+        if (frame != m_curFrame)
+            m_current->m_skipped = true;
+
+        FrameInfoEntry &info = m_current->m_frameInfo[frame];
+        if (isSceneChange)
+        {
+            info.flagMask |= COMM_FRAME_SCENE_CHANGE;
+            m_current->m_sceneMap[frame] = MARK_SCENE_CHANGE;
+        }
+        else
+        {
+            info.flagMask &= ~COMM_FRAME_SCENE_CHANGE;
+            m_current->m_sceneMap.remove(frame);
+        }
+        info.sceneChangePercent = (int) (debugValue*100);
+    }
+
+    int                        m_width;
+    int                        m_height;
+    bool                       m_drop;
+    std::vector<unsigned char> m_buf;
+    VideoFrame                 m_frame    {};
+    ClassicCommSegment        *m_current  {nullptr};
+    long long                  m_curFrame {0};
+    long long                  m_offset   {0};
+};
+
+/*
+ * Flags a synthetic recording front to back and in parts, the way
+ * ClassicCommDetector::go() and ClassicCommDetector::FlagSegments() do,
+ * and checks that the parts joined by MergeClassicCommSegments() give
+ * the maps of the serial run.  The scene change detector is the real
+ * one, so the parts only agree once its state has caught up.  When the
+ * decoder drops frames, the serial run numbers scene changes by how many
+ * frames the detector has seen, which the parts cannot reproduce, so
+ * they must be rejected.
+ */
+class TestCommSegments : public QObject
+{
+    Q_OBJECT
+
+    static const int kFrames     = 3000;
+    static const int kWarmup     = 50;
+    static const int kOverlap    = 20;
+
+    static ClassicCommSegment flagSerial(bool drop = false,
+                                         long long frames = kFrames,
+                                         int width = SegmentFlagger::kWidth,
+                                         int height = SegmentFlagger::kHeight)
+    {
+        ClassicCommSegment serial;
+        SegmentFlagger(width, height, drop).flag(0, frames - 1, serial);
+        return serial;
+    }
+
+    /// Splits the recording as ClassicCommDetector::FlagSegments() does,
+    /// and flags each part on a thread of its own
+    static std::vector<ClassicCommSegment> flagParts(
+        int parts, long long warmup, bool drop = false,
+        long long frames = kFrames, int width = SegmentFlagger::kWidth,
+        int height = SegmentFlagger::kHeight)
+    {
+        std::vector<ClassicCommSegment> segments(parts);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < parts; i++)
+        {
+            long long begin = frames * i / parts;
+            long long last = (i + 1 < parts) ?
+                frames * (i + 1) / parts + kOverlap : frames - 1;
+            segments[i].m_begin = begin;
+            threads.emplace_back([=, &segments]()
+            {
+                SegmentFlagger(width, height, drop)
+                    .flag(std::max(0LL, begin - warmup), last, segments[i]);
+            });
+        }
+        for (auto & thread : threads)
+            thread.join();
+        return segments;
+    }
+
+    static bool merge(const std::vector<ClassicCommSegment> &segments,
+                      ClassicCommSegment &merged)
+    {
+        std::vector<const ClassicCommSegment*> parts;
+        for (const auto & segment : segments)
+            parts.push_back(&segment);
+        return MergeClassicCommSegments(parts, merged.m_frameInfo,
+                                        merged.m_blankFrameMap,
+                                        merged.m_sceneMap);
+    }
+
+    static void compare(const ClassicCommSegment &actual,
+                        const ClassicCommSegment &expected)
+    {
+        QCOMPARE(actual.m_frameInfo.keys(), expected.m_frameInfo.keys());
+        for (auto it = expected.m_frameInfo.cbegin();
+             it != expected.m_frameInfo.cend(); ++it)
+        {
+            const FrameInfoEntry &a = actual.m_frameInfo[it.key()];
+            const FrameInfoEntry &e = *it;
+            QVERIFY2((a.minBrightness == e.minBrightness) &&
+                     (a.maxBrightness == e.maxBrightness) &&
+                     (a.avgBrightness == e.avgBrightness) &&
+                     (a.sceneChangePercent == e.sceneChangePercent) &&
+                     (a.aspect == e.aspect) && (a.format == e.format) &&
+                     (a.flagMask == e.flagMask),
+                     qPrintable(QString("frame %1").arg(it.key())));
+        }
+        QCOMPARE(actual.m_blankFrameMap, expected.m_blankFrameMap);
+        QCOMPARE(actual.m_sceneMap, expected.m_sceneMap);
+    }
+
+  private slots:
+    static void serialRun(void)
+    {
+        ClassicCommSegment serial = flagSerial();
+
+        // Something for the parts to agree on
+        QVERIFY(serial.m_sceneMap.size() >
+                kFrames / SegmentFlagger::kSceneSize / 2);
+        QVERIFY(!serial.m_blankFrameMap.isEmpty());
+        QVERIFY(!serial.m_skipped);
+    }
+
+    static void serialRun_droppedFrames(void)
+    {
+        ClassicCommSegment serial = flagSerial(true);
+
+        QVERIFY(serial.m_skipped);
+        SegmentFlagger flagger(SegmentFlagger::kWidth, SegmentFlagger::kHeight,
+                               true);
+        for (long long frame = 0; frame < kFrames; frame++)
+        {
+            if (flagger.dropped(frame))
+            {
+                QVERIFY(serial.m_frameInfo[frame].flagMask &
+                        COMM_FRAME_SKIPPED);
+            }
+        }
+    }
+
+    static void segmented_data(void)
+    {
+        QTest::addColumn<int>("parts");
+        QTest::addColumn<int>("warmup");
+
+        QTest::newRow("2 parts")           << 2 << kWarmup;
+        QTest::newRow("3 parts")           << 3 << kWarmup;
+        QTest::newRow("7 parts")           << 7 << kWarmup;
+        QTest::newRow("4 parts, no warmup") << 4 << 0;
+    }
+
+    static void segmented(void)
+    {
+        QFETCH(int, parts);
+        QFETCH(int, warmup);
+
+        ClassicCommSegment serial = flagSerial();
+        ClassicCommSegment merged;
+        QVERIFY(merge(flagParts(parts, warmup), merged));
+        compare(merged, serial);
+    }
+
+    /// The parts cannot number scene changes as the serial run does
+    static void droppedFrames(void)
+    {
+        std::vector<ClassicCommSegment> segments = flagParts(3, kWarmup, true);
+        QVERIFY(segments[1].m_skipped);
+
+        ClassicCommSegment merged;
+        QVERIFY(!merge(segments, merged));
+    }
+
+    static void disagree(void)
+    {
+        std::vector<ClassicCommSegment> segments = flagParts(2, kWarmup);
+
+        // The last frame of the overlap differs, so there is nowhere the
+        // two parts agree to the end of it
+        segments[0].m_frameInfo.last().flagMask ^= COMM_FRAME_BLANK;
+
+        ClassicCommSegment merged;
+        QVERIFY(!merge(segments, merged));
+    }
+
+    /// Times flagging a 720x576 recording of 5 minutes at 25 fps serially
+    /// and in as many parts as there are cores, and reports the speedup.
+    /// Only the frame analysis is timed; in mythcommflag each part also
+    /// decodes its share of the recording.
+    static void benchmarkSpeedup(void)
+    {
+        using clock = std::chrono::steady_clock;
+        const long long kBenchFrames = 5 * 60 * 25;
+        const int kBenchWidth = 720;
+        const int kBenchHeight = 576;
+        int parts = std::max(2U, std::thread::hardware_concurrency());
+
+        ClassicCommSegment serial;
+        ClassicCommSegment merged;
+        double serialTime = 0;
+        double partsTime = 0;
+        QBENCHMARK_ONCE
+        {
+            auto start = clock::now();
+            serial = flagSerial(false, kBenchFrames, kBenchWidth, kBenchHeight);
+            auto middle = clock::now();
+            std::vector<ClassicCommSegment> segments =
+                flagParts(parts, 5 * 25, false, kBenchFrames, kBenchWidth,
+                          kBenchHeight);
+            QVERIFY(merge(segments, merged));
+            auto end = clock::now();
+            serialTime = std::chrono::duration<double>(middle - start).count();
+            partsTime = std::chrono::duration<double>(end - middle).count();
+        }
+        compare(merged, serial);
+
+        std::cout << QString("Serial: %1 s, %2 parts: %3 s, speedup %4x")
+            .arg(serialTime, 0, 'f', 2).arg(parts).arg(partsTime, 0, 'f', 2)
+            .arg(serialTime / partsTime, 0, 'f', 2)
+            .toLocal8Bit().constData() << std::endl;
+    }
+};
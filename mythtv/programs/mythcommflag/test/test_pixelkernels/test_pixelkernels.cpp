@@ -0,0 +1,3 @@
+#include "test_pixelkernels.h"
+
+QTEST_APPLESS_MAIN(TestPixelKernels)
@@ -0,0 +1,342 @@
+/*
+ *  Class TestPixelKernels
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <array>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "pixelkernels.h"
+
+#define ITER    100
+#define WIDTH   1920
+#define HEIGHT  1080
+
+class TestPixelKernels: public QObject
+{
+    Q_OBJECT
+
+    enum Kernel { kSampleRow, kMinMax, kConvolve, kSgm, kMark, kCount };
+
+    /// Flat areas, ramps and noise, with a letterbox bar at the top
+    static std::vector<uint8_t> picture(int width, int height)
+    {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height);
+        uint32_t noise = 12345;
+        for (int rr = 0; rr < height; rr++)
+        {
+            for (int cc = 0; cc < width; cc++)
+            {
+                noise = noise * 1103515245 + 12345;
+                int val = 0;
+                if (rr < height / 8)
+                    val = 16 + (noise >> 29);
+                else if (cc < width / 3)
+                    val = (rr + cc) & 0xFF;
+                else if (cc < 2 * width / 3)
+                    val = 128;
+                else
+                    val = noise >> 24;
+                pixels[static_cast<size_t>(rr) * width + cc] = val;
+            }
+        }
+        return pixels;
+    }
+
+    /// The Gaussian mask that CannyEdgeDetector uses
+    static std::array<double,5> cannyMask(void)
+    {
+        std::array<double,5> mask {};
+        double sum = 0;
+        for (int rr = -2; rr <= 2; rr++)
+        {
+            mask[rr + 2] = exp(-(rr * rr) / (2 * 0.5 * 0.5));
+            sum += mask[rr + 2];
+        }
+        for (double &weight : mask)
+            weight /= sum;
+        return mask;
+    }
+
+  private slots:
+    static void initTestCase(void)
+    {
+        std::cout << "Kernels: " << pixel_kernels().m_name << std::endl;
+    }
+
+    // Every kernel must give the same result as the C version, for rows of
+    // any length and alignment
+
+    static void sampleRow(void)
+    {
+        const PixelKernels &simd = pixel_kernels(true);
+        const PixelKernels &purec = pixel_kernels(false);
+        std::vector<uint8_t> src = picture(WIDTH, 4);
+        for (int step = 1; step <= 5; step++)
+        {
+            for (int count = 0; count < 300; count++)
+            {
+                for (int offset = 0; offset < 4; offset++)
+                {
+                    std::vector<uint8_t> dst1(count);
+                    std::vector<uint8_t> dst2(count);
+                    unsigned long long sum1 = 1;
+                    unsigned long long sum2 = 1;
+                    unsigned long long squares1 = 2;
+                    unsigned long long squares2 = 2;
+                    const uint8_t *row = &src[WIDTH * 2 + WIDTH * 2 / 3 + offset];
+                    simd.m_sampleRow(dst1.data(), row, count, step, &sum1, &squares1);
+                    purec.m_sampleRow(dst2.data(), row, count, step, &sum2, &squares2);
+                    QVERIFY(dst1 == dst2);
+                    QCOMPARE(sum1, sum2);
+                    QCOMPARE(squares1, squares2);
+                }
+            }
+        }
+
+        // Long enough for the 32 bit partial sums to be flushed
+        std::vector<uint8_t> white(WIDTH * HEIGHT, UCHAR_MAX);
+        std::vector<uint8_t> dst(WIDTH * HEIGHT);
+        unsigned long long sum = 0;
+        unsigned long long squares = 0;
+        simd.m_sampleRow(dst.data(), white.data(), WIDTH * HEIGHT, 1, &sum, &squares);
+        QCOMPARE(sum, 255ULL * WIDTH * HEIGHT);
+        QCOMPARE(squares, 255ULL * 255 * WIDTH * HEIGHT);
+    }
+
+    static void minMax(void)
+    {
+        const PixelKernels &simd = pixel_kernels(true);
+        const PixelKernels &purec = pixel_kernels(false);
+        std::vector<uint8_t> src = picture(WIDTH, HEIGHT);
+        for (int count = 0; count < 300; count++)
+        {
+            for (int rr : { 0, HEIGHT / 2 })
+            {
+                const uint8_t *row = &src[rr * WIDTH + WIDTH * 2 / 3 - count / 2];
+                uint8_t min1 = 0;
+                uint8_t max1 = 0;
+                uint8_t min2 = 0;
+                uint8_t max2 = 0;
+                simd.m_minMax(row, count, &min1, &max1);
+                purec.m_minMax(row, count, &min2, &max2);
+                QCOMPARE(min1, min2);
+                QCOMPARE(max1, max2);
+            }
+        }
+    }
+
+    static void convolve(void)
+    {
+        const PixelKernels &simd = pixel_kernels(true);
+        const PixelKernels &purec = pixel_kernels(false);
+        std::vector<uint8_t> src = picture(WIDTH, 8);
+        std::array<double,5> canny = cannyMask();
+        // Every pair of neighbours averages to an exact half or a whole
+        std::array<double,3> halves { 0.5, 0, 0.5 };
+        for (int count = 0; count < 300; count++)
+        {
+            for (int rr = 2; rr < 6; rr++)
+            {
+                const uint8_t *row = &src[rr * WIDTH + 2 + rr];
+                std::vector<uint8_t> dst1(count);
+                std::vector<uint8_t> dst2(count);
+                simd.m_convolveColumn(dst1.data(), row, WIDTH, count, canny.data(), 2);
+                purec.m_convolveColumn(dst2.data(), row, WIDTH, count, canny.data(), 2);
+                QVERIFY(dst1 == dst2);
+                simd.m_convolveRow(dst1.data(), row, count, canny.data(), 2);
+                purec.m_convolveRow(dst2.data(), row, count, canny.data(), 2);
+                QVERIFY(dst1 == dst2);
+                simd.m_convolveRow(dst1.data(), row, count, halves.data(), 1);
+                purec.m_convolveRow(dst2.data(), row, count, halves.data(), 1);
+                QVERIFY(dst1 == dst2);
+            }
+        }
+    }
+
+    static void sgm(void)
+    {
+        const PixelKernels &simd = pixel_kernels(true);
+        const PixelKernels &purec = pixel_kernels(false);
+        std::vector<uint8_t> src = picture(WIDTH, HEIGHT);
+        for (int count = 0; count < 300; count++)
+        {
+            for (int rr : { 0, HEIGHT / 8 - 1, HEIGHT / 2 })
+            {
+                const uint8_t *row0 = &src[rr * WIDTH + WIDTH * 2 / 3 - count / 2];
+                const uint8_t *row1 = row0 + WIDTH;
+                std::vector<unsigned int> dst1(count);
+                std::vector<unsigned int> dst2(count);
+                simd.m_sgmRow(dst1.data(), row0, row1, count);
+                purec.m_sgmRow(dst2.data(), row0, row1, count);
+                QVERIFY(dst1 == dst2);
+            }
+        }
+    }
+
+    static void mark(void)
+    {
+        const PixelKernels &simd = pixel_kernels(true);
+        const PixelKernels &purec = pixel_kernels(false);
+        std::vector<unsigned int> sgm(300);
+        uint32_t noise = 1;
+        for (unsigned int &value : sgm)
+        {
+            noise = noise * 1103515245 + 12345;
+            value = noise;
+        }
+        for (unsigned int threshold : { 0U, 1U, 5000U, 0x80000000U, UINT_MAX })
+        {
+            for (int count = 0; count < 300; count++)
+            {
+                std::vector<uint8_t> dst1(count);
+                std::vector<uint8_t> dst2(count);
+                simd.m_markRow(dst1.data(), sgm.data(), count, threshold);
+                purec.m_markRow(dst2.data(), sgm.data(), count, threshold);
+                QVERIFY(dst1 == dst2);
+            }
+        }
+    }
+
+    static void count(void)
+    {
+        const PixelKernels &simd = pixel_kernels(true);
+        const PixelKernels &purec = pixel_kernels(false);
+        std::vector<uint8_t> edges1(WIDTH * HEIGHT);
+        std::vector<uint8_t> edges2(WIDTH * HEIGHT);
+        uint32_t noise = 1;
+        for (size_t ii = 0; ii < edges1.size(); ii++)
+        {
+            noise = noise * 1103515245 + 12345;
+            edges1[ii] = (noise >> 28) < 3 ? UCHAR_MAX : 0;
+            edges2[ii] = (noise >> 24) & 1 ? UCHAR_MAX : 0;
+        }
+        for (int count = 0; count < 300; count++)
+        {
+            QCOMPARE(simd.m_countSet(&edges1[count], count),
+                     purec.m_countSet(&edges1[count], count));
+            QCOMPARE(simd.m_countMatch(&edges1[count], &edges2[count], count),
+                     purec.m_countMatch(&edges1[count], &edges2[count], count));
+        }
+        QCOMPARE(simd.m_countSet(edges1.data(), WIDTH * HEIGHT),
+                 purec.m_countSet(edges1.data(), WIDTH * HEIGHT));
+        QCOMPARE(simd.m_countMatch(edges1.data(), edges2.data(), WIDTH * HEIGHT),
+                 purec.m_countMatch(edges1.data(), edges2.data(), WIDTH * HEIGHT));
+    }
+
+    static void histogram(void)
+    {
+        std::vector<uint8_t> src = picture(WIDTH, HEIGHT);
+        for (int step : { 1, 2, 4, 10 })
+        {
+            std::array<int,UCHAR_MAX + 1> hist {};
+            std::array<int,UCHAR_MAX + 1> expected {};
+            hist[7] = expected[7] = 3;
+            int columns = (WIDTH - 1) / step;
+            int rows = (HEIGHT - 1) / step;
+            pixel_histogram(hist.data(), &src[WIDTH + 1], WIDTH, columns, rows,
+                            step, step);
+            for (int rr = 0; rr < rows; rr++)
+                for (int cc = 0; cc < columns; cc++)
+                    expected[src[(1 + rr * step) * WIDTH + 1 + cc * step]]++;
+            QVERIFY(hist == expected);
+        }
+    }
+
+    static void throughput_data(void)
+    {
+        QTest::addColumn<int>("kernel");
+        QTest::addColumn<bool>("SIMD");
+        QTest::newRow("sample row")               << (int)kSampleRow << true;
+        QTest::newRow("sample row Pure C")        << (int)kSampleRow << false;
+        QTest::newRow("min max")                  << (int)kMinMax    << true;
+        QTest::newRow("min max Pure C")           << (int)kMinMax    << false;
+        QTest::newRow("convolve")                 << (int)kConvolve  << true;
+        QTest::newRow("convolve Pure C")          << (int)kConvolve  << false;
+        QTest::newRow("gradient")                 << (int)kSgm       << true;
+        QTest::newRow("gradient Pure C")          << (int)kSgm       << false;
+        QTest::newRow("mark edges")               << (int)kMark      << true;
+        QTest::newRow("mark edges Pure C")        << (int)kMark      << false;
+        QTest::newRow("match template")           << (int)kCount     << true;
+        QTest::newRow("match template Pure C")    << (int)kCount     << false;
+    }
+
+    // Frames per second and pixels per second of each kernel over a whole
+    // 1080p picture
+    static void throughput(void)
+    {
+        QFETCH(int, kernel);
+        QFETCH(bool, SIMD);
+        const PixelKernels &kernels = pixel_kernels(SIMD);
+        std::vector<uint8_t> src = picture(WIDTH, HEIGHT + 4);
+        std::vector<uint8_t> dst(WIDTH * (HEIGHT + 4));
+        std::vector<unsigned int> sgm(WIDTH * HEIGHT);
+        std::array<double,5> mask = cannyMask();
+        unsigned long long total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        QBENCHMARK_ONCE
+        {
+            for (int i = 0; i < ITER; i++)
+            {
+                for (int rr = 2; rr < HEIGHT + 2; rr++)
+                {
+                    const uint8_t *row = &src[rr * WIDTH];
+                    uint8_t *out = &dst[rr * WIDTH];
+                    uint8_t lo = 0;
+                    uint8_t hi = 0;
+                    switch (kernel)
+                    {
+                        case kSampleRow:
+                            kernels.m_sampleRow(out, row, WIDTH, 1, &total, &total);
+                            break;
+                        case kMinMax:
+                            kernels.m_minMax(row, WIDTH, &lo, &hi);
+                            total += hi - lo;
+                            break;
+                        case kConvolve:
+                            kernels.m_convolveColumn(out + 2, row + 2, WIDTH, WIDTH - 4, mask.data(), 2);
+                            kernels.m_convolveRow(out + 2, row + 2, WIDTH - 4, mask.data(), 2);
+                            break;
+                        case kSgm:
+                            kernels.m_sgmRow(&sgm[(rr - 2) * WIDTH], row, row + WIDTH, WIDTH - 1);
+                            break;
+                        case kMark:
+                            kernels.m_markRow(out, &sgm[(rr - 2) * WIDTH], WIDTH, 5000);
+                            break;
+                        case kCount:
+                            total += kernels.m_countMatch(row, out, WIDTH);
+                            break;
+                    }
+                }
+            }
+        }
+        std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+        std::cout << QString("%1: %2 fps, %3 Mpixels/s (%4)")
+            .arg(QTest::currentDataTag())
+            .arg(ITER / secs.count(), 0, 'f', 0)
+            .arg(ITER * double(WIDTH) * HEIGHT / secs.count() / 1e6, 0, 'f', 0)
+            .arg(total & 1)
+            .toLocal8Bit().constData() << std::endl;
+    }
+};
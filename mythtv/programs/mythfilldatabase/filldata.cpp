@@ -32,6 +32,7 @@ using namespace std;
 
 // filldata headers
 #include "filldata.h"
+#include "xmltvimport.h"
 
 #define LOC QString("FillData: ")
 #define LOC_WARN QString("FillData, Warning: ")
@@ -89,22 +90,20 @@ void FillData::SetRefresh(int day, bool set)
 // XMLTV stuff
 bool FillData::GrabDataFromFile(int id, QString &filename)
 {
-    ChannelInfoList chanlist;
-    QMap<QString, QList<ProgInfo> > proglist;
+    XMLTVImport import(id, m_chanData);
 
-    if (!m_xmltvParser.parseFile(filename, &chanlist, &proglist))
+    if (!m_xmltvParser.parseFile(filename, &import))
+    {
+        import.Abort();
         return false;
+    }
 
-    m_chanData.handleChannels(id, &chanlist);
-    if (proglist.count() == 0)
+    import.Finish();
+    if (import.GetProgramCount() == 0)
     {
         LOG(VB_GENERAL, LOG_INFO, "No programs found in data.");
         m_endOfData = true;
     }
-    else
-    {
-        ProgramData::HandlePrograms(id, proglist);
-    }
     return true;
 }
 
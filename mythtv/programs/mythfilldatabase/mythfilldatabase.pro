@@ -18,8 +18,9 @@ DEPENDPATH  += ../../libs/libmythtv/mpeg
 
 # Input
 HEADERS += filldata.h   channeldata.h
-HEADERS += xmltvparser.h
+HEADERS += xmltvparser.h  xmltvimport.h
 HEADERS += fillutil.h   commandlineparser.h
 SOURCES += filldata.cpp channeldata.cpp
 SOURCES += xmltvparser.cpp fillutil.cpp
+SOURCES += xmltvimport.cpp
 SOURCES += main.cpp     commandlineparser.cpp
@@ -0,0 +1,326 @@
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QStringList>
+
+// MythTV headers
+#include "mythdbcon.h"
+#include "mythlogging.h"
+
+// filldata headers
+#include "channeldata.h"
+#include "xmltvimport.h"
+
+#define LOC QString("XMLTVImport: ")
+
+const int  XMLTVImport::kChunkSize     = 1000;
+const int  XMLTVImport::kMinChunkSize  = 50;
+const uint XMLTVImport::kMaxPending    = 20000;
+const uint XMLTVImport::kMaxInFlight   = 32;
+const int  XMLTVImport::kStatsInterval = 10000;
+
+/// Fixes up one chunk on the import's thread pool.
+class XMLTVFixupRunnable : public QRunnable
+{
+  public:
+    XMLTVFixupRunnable(XMLTVImport &import, XMLTVChunk *chunk) :
+        m_import(import), m_chunk(chunk) {}
+
+    void run(void) override // QRunnable
+    {
+        m_import.FixChunk(m_chunk);
+    }
+
+  private:
+    XMLTVImport &m_import;
+    XMLTVChunk  *m_chunk;
+};
+
+void XMLTVWriteThread::run(void)
+{
+    RunProlog();
+    m_parent->RunWriter();
+    RunEpilog();
+}
+
+XMLTVImport::XMLTVImport(uint sourceid, const ChannelData &chanData) :
+    m_sourceId(sourceid), m_chanData(chanData)
+{
+    m_timer.start();
+    m_statsTimer.start();
+    m_writeThread = new XMLTVWriteThread(this);
+    m_writeThread->start();
+}
+
+XMLTVImport::~XMLTVImport()
+{
+    Stop();
+    delete m_writeThread;
+    m_writeThread = nullptr;
+}
+
+void XMLTVImport::AddChannels(ChannelInfoList &chanlist)
+{
+    m_chanData.handleChannels(m_sourceId, &chanlist);
+}
+
+void XMLTVImport::AddProgram(const ProgInfo &pginfo)
+{
+    const QString &xmltvid = pginfo.m_channel;
+
+    // Most grabbers write the programmes channel by channel, in which
+    // case a channel is complete once the next one starts.
+    if (xmltvid != m_lastChannel)
+    {
+        auto it = m_pending.constFind(m_lastChannel);
+        if (it != m_pending.constEnd() && it->size() >= kMinChunkSize)
+            FlushChannel(m_lastChannel, false);
+        m_lastChannel = xmltvid;
+    }
+
+    QList<ProgInfo> &list = m_pending[xmltvid];
+    list.push_back(pginfo);
+    m_pendingCount++;
+    m_parsed++;
+
+    if (list.size() >= kChunkSize)
+        FlushChannel(xmltvid, false);
+    else if (m_pendingCount >= kMaxPending + m_pending.size())
+        FlushAll(false);
+}
+
+/** \fn XMLTVImport::Finish(void)
+ *  \brief Writes the programmes still held and waits for all the
+ *         stages to complete.
+ */
+void XMLTVImport::Finish(void)
+{
+    FlushAll(true);
+    Stop();
+}
+
+/** \fn XMLTVImport::Abort(void)
+ *  \brief Discards the programmes not yet written and waits for all the
+ *         stages to complete.
+ */
+void XMLTVImport::Abort(void)
+{
+    m_pending.clear();
+    m_pendingCount = 0;
+
+    QMutexLocker locker(&m_lock);
+    m_aborted = true;
+    locker.unlock();
+
+    Stop();
+}
+
+void XMLTVImport::Stop(void)
+{
+    QMutexLocker locker(&m_lock);
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_chunkFixed.wakeAll();
+    locker.unlock();
+
+    m_fixPool.waitForDone();
+    m_writeThread->wait();
+
+    LogStats(m_aborted ? "Aborted" : "Finished");
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Updated programs: %1 Unchanged programs: %2")
+                .arg(m_updated) .arg(m_unchanged));
+}
+
+/** \fn XMLTVImport::FlushChannel(const QString&, bool)
+ *  \brief Cuts the programmes held for a channel into a chunk and hands
+ *         it to the fixup stage.
+ *
+ *   Unless this is the final chunk of the channel, the latest programme
+ *   is held back to start the next chunk, so that a missing stop time
+ *   can still be taken from the programme that follows it.
+ */
+void XMLTVImport::FlushChannel(const QString &xmltvid, bool final)
+{
+    auto it = m_pending.find(xmltvid);
+    if (it == m_pending.end() || it->size() < (final ? 1 : 2))
+        return;
+
+    auto *chunk = new XMLTVChunk;
+    chunk->m_seq = m_nextSeq++;
+    chunk->m_xmltvId = xmltvid;
+    chunk->m_programs.swap(*it);
+    m_pending.erase(it);
+
+    if (!final)
+    {
+        auto latest = std::max_element(
+            chunk->m_programs.begin(), chunk->m_programs.end(),
+            [](const ProgInfo &a, const ProgInfo &b)
+            { return a.m_starttime < b.m_starttime; });
+        chunk->m_nextStart = latest->m_starttime;
+        chunk->m_nextStartTs = latest->m_startts;
+        m_pending[xmltvid].push_back(*latest);
+        chunk->m_programs.erase(latest);
+    }
+
+    m_pendingCount -= chunk->m_programs.size();
+    QueueChunk(chunk);
+}
+
+void XMLTVImport::FlushAll(bool final)
+{
+    QStringList channels = m_pending.keys();
+    for (const auto & xmltvid : qAsConst(channels))
+        FlushChannel(xmltvid, final);
+}
+
+void XMLTVImport::QueueChunk(XMLTVChunk *chunk)
+{
+    QMutexLocker locker(&m_lock);
+    while (m_inFlight >= kMaxInFlight)
+        m_chunkWritten.wait(&m_lock);
+    m_inFlight++;
+    m_queued += chunk->m_programs.size();
+    locker.unlock();
+
+    m_fixPool.start(new XMLTVFixupRunnable(*this, chunk), "XMLTVFixup");
+}
+
+void XMLTVImport::FixChunk(XMLTVChunk *chunk)
+{
+    MythTimer timer;
+    timer.start();
+
+    // NOLINTNEXTLINE(modernize-loop-convert)
+    for (auto it = chunk->m_programs.begin(); it != chunk->m_programs.end(); ++it)
+        chunk->m_sortlist.push_back(&(*it));
+
+    ProgramData::FixProgramList(chunk->m_sortlist);
+
+    if (!chunk->m_sortlist.isEmpty() && chunk->m_nextStart.isValid())
+    {
+        ProgInfo *last = chunk->m_sortlist.back();
+        if (last->m_endts.isEmpty() || last->m_startts > last->m_endts)
+        {
+            last->m_endts   = chunk->m_nextStartTs;
+            last->m_endtime = chunk->m_nextStart;
+        }
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_fixed.insert(chunk->m_seq, chunk);
+    m_fixedCount += chunk->m_sortlist.size();
+    m_fixTime += timer.elapsed();
+    m_chunkFixed.wakeAll();
+}
+
+/** \fn XMLTVImport::RunWriter(void)
+ *  \brief Writes the fixed up chunks in the order they were cut.
+ */
+void XMLTVImport::RunWriter(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    uint seq = 0;
+
+    QMutexLocker locker(&m_lock);
+    while (true)
+    {
+        auto it = m_fixed.find(seq);
+        if (it == m_fixed.end())
+        {
+            if (m_finished && m_inFlight == 0)
+                break;
+            m_chunkFixed.wait(&m_lock, kStatsInterval);
+            continue;
+        }
+
+        XMLTVChunk *chunk = *it;
+        m_fixed.erase(it);
+        bool write = !m_aborted;
+        locker.unlock();
+
+        MythTimer timer;
+        timer.start();
+        if (write)
+            WriteChunk(query, chunk);
+        int elapsed = timer.elapsed();
+        uint count = chunk->m_sortlist.size();
+        delete chunk;
+
+        locker.relock();
+        seq++;
+        m_inFlight--;
+        m_writeTime += elapsed;
+        if (write)
+            m_writtenCount += count;
+        m_chunkWritten.wakeAll();
+
+        if (m_statsTimer.elapsed() >= kStatsInterval)
+        {
+            m_statsTimer.restart();
+            LogStats("Progress");
+        }
+    }
+}
+
+void XMLTVImport::WriteChunk(MSqlQuery &query, const XMLTVChunk *chunk)
+{
+    // The last programme written for this channel is carried over in front
+    // of the chunk, so that FixProgramList() also sees the two programmes
+    // either side of the cut. The carried one was written with the chunk
+    // before; if it loses to a programme of this chunk, DeleteOverlaps()
+    // removes it when that one is written.
+    QList<ProgInfo*> sortlist = chunk->m_sortlist;
+    auto carried = m_carried.find(chunk->m_xmltvId);
+    if (carried != m_carried.end() && !sortlist.isEmpty())
+    {
+        sortlist.push_front(&(*carried));
+        ProgramData::FixProgramList(sortlist);
+        sortlist.removeOne(&(*carried));
+    }
+    if (!sortlist.isEmpty())
+        m_carried[chunk->m_xmltvId] = *sortlist.back();
+
+    vector<uint> chanids;
+    if (!ProgramData::GetChanIds(query, m_sourceId, chunk->m_xmltvId, chanids))
+        return;
+
+    if (chanids.empty())
+    {
+        LOG(VB_GENERAL, LOG_NOTICE,
+            QString("Unknown xmltv channel identifier: %1"
+                    " - Skipping channel.").arg(chunk->m_xmltvId));
+        return;
+    }
+
+    uint updated = 0;
+    uint unchanged = 0;
+    for (uint chanid : chanids)
+    {
+        ProgramData::HandlePrograms(query, chanid, sortlist,
+                                    unchanged, updated);
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_updated += updated;
+    m_unchanged += unchanged;
+}
+
+// Must be called with m_lock held, or once the stages have stopped.
+void XMLTVImport::LogStats(const QString &what)
+{
+    double secs = m_timer.elapsed() * 0.001;
+    double rate = (secs > 0.0) ? m_writtenCount / secs : 0.0;
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1: parsed %2, fixed %3 in %4 ms, written %5 in %6 ms "
+                "(%7 programs/s), %8 chunks in flight")
+            .arg(what).arg(m_queued).arg(m_fixedCount).arg(m_fixTime)
+            .arg(m_writtenCount).arg(m_writeTime).arg(rate, 0, 'f', 1)
+            .arg(m_inFlight));
+}
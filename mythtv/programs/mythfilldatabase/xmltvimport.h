@@ -0,0 +1,139 @@
+#ifndef XMLTVIMPORT_H
+#define XMLTVIMPORT_H
+
+// Qt headers
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// MythTV headers
+#include "mthread.h"
+#include "mthreadpool.h"
+#include "mythtimer.h"
+#include "programdata.h"
+
+// filldata headers
+#include "xmltvparser.h"
+
+class ChannelData;
+class MSqlQuery;
+class XMLTVImport;
+
+/// A run of programmes of one channel, passed from stage to stage.
+class XMLTVChunk
+{
+  public:
+    uint             m_seq {0};
+    QString          m_xmltvId;
+    QList<ProgInfo>  m_programs;
+    QList<ProgInfo*> m_sortlist;
+    /// Start of the programme held back for the next chunk of this
+    /// channel, used for a missing stop time at the end of this one.
+    QDateTime        m_nextStart;
+    QString          m_nextStartTs;
+};
+
+class XMLTVWriteThread : public MThread
+{
+  public:
+    explicit XMLTVWriteThread(XMLTVImport *parent) :
+        MThread("XMLTVWrite"), m_parent(parent) {}
+    ~XMLTVWriteThread() override { wait(); m_parent = nullptr; }
+    void run(void) override; // MThread
+  private:
+    XMLTVImport *m_parent;
+};
+
+/** \class XMLTVImport
+ *  \brief Streams the programmes read by XMLTVParser into the program
+ *         table.
+ *
+ *   The parser thread cuts the programmes of each channel into chunks.
+ *   Each chunk is sorted and cleaned up with ProgramData::FixProgramList()
+ *   on a thread pool, and written by a single writer thread in the order
+ *   the chunks were cut, with the last programme written for the channel
+ *   carried over so that overlaps across a cut are removed as well.
+ *   The parser blocks while too many chunks are
+ *   waiting, so the number of programmes held in memory is bounded no
+ *   matter how large the file is.
+ */
+class XMLTVImport : public XMLTVSink
+{
+    friend class XMLTVWriteThread;
+    friend class XMLTVFixupRunnable;
+
+  public:
+    XMLTVImport(uint sourceid, const ChannelData &chanData);
+    ~XMLTVImport() override;
+
+    void AddChannels(ChannelInfoList &chanlist) override; // XMLTVSink
+    void AddProgram(const ProgInfo &pginfo) override; // XMLTVSink
+
+    void Finish(void);
+    void Abort(void);
+
+    uint GetProgramCount(void) const { return m_parsed; }
+
+  private:
+    void FlushChannel(const QString &xmltvid, bool final);
+    void FlushAll(bool final);
+    void QueueChunk(XMLTVChunk *chunk);
+    void FixChunk(XMLTVChunk *chunk);
+    void RunWriter(void);
+    void WriteChunk(MSqlQuery &query, const XMLTVChunk *chunk);
+    void Stop(void);
+    void LogStats(const QString &what);
+
+    uint                            m_sourceId {0};
+    const ChannelData              &m_chanData;
+
+    // Used by the parser thread only
+    QMap<QString, QList<ProgInfo> > m_pending;
+    QString                         m_lastChannel;
+    uint                            m_pendingCount {0};
+    uint                            m_nextSeq      {0};
+    uint                            m_parsed       {0};
+
+    // Used by the writer thread only
+    /// The last programme written for each channel
+    QMap<QString, ProgInfo>         m_carried;
+
+    MThreadPool                     m_fixPool      {"XMLTVFixup"};
+    XMLTVWriteThread               *m_writeThread  {nullptr};
+
+    QMutex                          m_lock;
+    QWaitCondition                  m_chunkFixed;
+    QWaitCondition                  m_chunkWritten;
+    QMap<uint, XMLTVChunk*>         m_fixed;
+    uint                            m_inFlight     {0};
+    bool                            m_finished     {false};
+    bool                            m_aborted      {false};
+
+    // Statistics, protected by m_lock
+    MythTimer                       m_timer;
+    MythTimer                       m_statsTimer;
+    uint                            m_queued       {0};
+    uint                            m_fixedCount   {0};
+    uint                            m_writtenCount {0};
+    uint                            m_updated      {0};
+    uint                            m_unchanged    {0};
+    qint64                          m_fixTime      {0};
+    qint64                          m_writeTime    {0};
+
+    /// Programmes of one channel cut into a chunk at most
+    static const int  kChunkSize;
+    /// Programmes of a channel cut into a chunk when the file moves on
+    /// to another channel
+    static const int  kMinChunkSize;
+    /// Programmes held by the parser before every channel is cut
+    static const uint kMaxPending;
+    /// Chunks fixed up or waiting to be written before the parser blocks
+    static const uint kMaxInFlight;
+    /// Milliseconds between progress reports
+    static const int  kStatsInterval;
+};
+
+#endif // XMLTVIMPORT_H
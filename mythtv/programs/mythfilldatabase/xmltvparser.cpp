@@ -189,9 +189,45 @@ static int readNextWithErrorCheck(QXmlStreamReader &xml)
     return true;
 }
 
+/// Collects a whole XMLTV file in memory.
+class XMLTVListSink : public XMLTVSink
+{
+  public:
+    XMLTVListSink(ChannelInfoList *chanlist,
+                  QMap<QString, QList<ProgInfo> > *proglist) :
+        m_chanlist(chanlist), m_proglist(proglist) {}
+
+    void AddChannels(ChannelInfoList &chanlist) override // XMLTVSink
+    {
+        m_chanlist->insert(m_chanlist->end(), chanlist.begin(), chanlist.end());
+    }
+
+    void AddProgram(const ProgInfo &pginfo) override // XMLTVSink
+    {
+        (*m_proglist)[pginfo.m_channel].push_back(pginfo);
+    }
+
+  private:
+    ChannelInfoList                  *m_chanlist {nullptr};
+    QMap<QString, QList<ProgInfo> >  *m_proglist {nullptr};
+};
+
 bool XMLTVParser::parseFile(
     const QString& filename, ChannelInfoList *chanlist,
     QMap<QString, QList<ProgInfo> > *proglist)
+{
+    XMLTVListSink sink(chanlist, proglist);
+    return parseFile(filename, &sink);
+}
+
+/** \fn XMLTVParser::parseFile(const QString&, XMLTVSink*)
+ *  \brief Reads an XMLTV file element by element, handing each channel
+ *         and programme to the sink as soon as it is complete.
+ *
+ *   Nothing but the element being read is held by the parser, so the
+ *   memory used depends on the sink rather than on the size of the file.
+ */
+bool XMLTVParser::parseFile(const QString& filename, XMLTVSink *sink)
 {
     m_movieGrabberPath = MetadataDownload::GetMovieGrabber();
     m_tvGrabberPath = MetadataDownload::GetTelevisionGrabber();
@@ -208,6 +244,7 @@ bool XMLTVParser::parseFile(
     QUrl sourceUrl;
     QString aggregatedTitle;
     QString aggregatedDesc;
+    ChannelInfoList chanlist;
     bool haveReadTV = false;
     while (!xml.atEnd() && !xml.hasError() && (! (xml.isEndElement() && xml.name() == "tv")))
     {
@@ -287,7 +324,7 @@ bool XMLTVParser::parseFile(
                 chaninfo->m_freqId = chaninfo->m_chanNum;
                 //TODO optimize this, no use to do al this parsing if xmltvid is empty; but make sure you will read until the next channel!!
                 if (!chaninfo->m_xmltvId.isEmpty())
-                    chanlist->push_back(*chaninfo);
+                    chanlist.push_back(*chaninfo);
                 delete chaninfo;
             }//channel
             else if (xml.name() == "programme")
@@ -298,6 +335,14 @@ bool XMLTVParser::parseFile(
                     return false;
                 }
 
+                // The channels precede the programmes, make them known
+                // before the first programme is handed over.
+                if (!chanlist.empty())
+                {
+                    sink->AddChannels(chanlist);
+                    chanlist.clear();
+                }
+
                 QString programid;
                 QString season;
                 QString episode;
@@ -735,7 +780,7 @@ bool XMLTVParser::parseFile(
                 {
                     // so we have a (relatively) clean program element now, which is good enough to process or to store
                     if (pginfo->m_clumpidx.isEmpty())
-                        (*proglist)[pginfo->m_channel].push_back(*pginfo);
+                        sink->AddProgram(*pginfo);
                     else
                     {
                         /* append all titles/descriptions from one clump */
@@ -760,7 +805,7 @@ bool XMLTVParser::parseFile(
                         {
                             pginfo->m_title = aggregatedTitle;
                             pginfo->m_description = aggregatedDesc;
-                            (*proglist)[pginfo->m_channel].push_back(*pginfo);
+                            sink->AddProgram(*pginfo);
                         }
                     }
                 }
@@ -773,7 +818,8 @@ bool XMLTVParser::parseFile(
         LOG(VB_GENERAL, LOG_ERR, QString("Malformed XML file, missing </tv> element, at line %1, %2").arg(xml.lineNumber()).arg(xml.errorString()));
         return false;
     }
-    //TODO add code for adding data on the run
+    if (!chanlist.empty())
+        sink->AddChannels(chanlist);
     f.close();
 
     return true;
@@ -13,12 +13,29 @@ class ProgInfo;
 class QUrl;
 class QDomElement;
 
+/** \class XMLTVSink
+ *  \brief Receives the channels and programmes of an XMLTV file as the
+ *         parser reads them.
+ */
+class XMLTVSink
+{
+  public:
+    virtual ~XMLTVSink() = default;
+
+    /// Called with the channels read so far, before the programme that
+    /// follows them and at the end of the file.
+    virtual void AddChannels(ChannelInfoList &chanlist) = 0;
+    /// Called for every valid programme, with clumps already merged.
+    virtual void AddProgram(const ProgInfo &pginfo) = 0;
+};
+
 class XMLTVParser
 {
   public:
     XMLTVParser();
     bool parseFile(const QString& filename, ChannelInfoList *chanlist,
                    QMap<QString, QList<ProgInfo> > *proglist);
+    bool parseFile(const QString& filename, XMLTVSink *sink);
 
   private:
     unsigned int m_currentYear {0};
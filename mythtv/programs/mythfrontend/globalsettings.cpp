@@ -312,6 +312,22 @@ static GlobalCheckBoxSetting *CommFlagFast()
     return gc;
 }
 
+static GlobalSpinBoxSetting *CommFlagSegments()
+{
+    auto *gs = new GlobalSpinBoxSetting("CommFlagSegments", 1, 16, 1);
+
+    gs->setLabel(GeneralSettings::tr("Commercial detection parts"));
+
+    gs->setValue(1);
+
+    gs->setHelpText(GeneralSettings::tr("Finished recordings with a seek "
+                                        "table are flagged in up to this many "
+                                        "parts at once, each using a CPU "
+                                        "core. Only the classic detection "
+                                        "methods use more than one part."));
+    return gs;
+}
+
 static HostComboBoxSetting *AutoCommercialSkip()
 {
     auto *gc = new HostComboBoxSetting("AutoCommercialSkip");
@@ -2932,6 +2948,27 @@ static GlobalComboBoxSetting *GRSchedOpenEnd()
     return bc;
 }
 
+static GlobalCheckBoxSetting *GRSchedIncrementalPlacement()
+{
+    auto *gc = new GlobalCheckBoxSetting("SchedIncrementalPlacement");
+
+    gc->setLabel(GeneralRecPrioritiesSettings::tr("Reschedule only changed "
+                                                  "conflicts"));
+
+    gc->setValue(false);
+
+    gc->setHelpText(GeneralRecPrioritiesSettings::tr("If enabled, the "
+                                                     "scheduler keeps the "
+                                                     "result for showings "
+                                                     "whose rules, times and "
+                                                     "tuners have not changed "
+                                                     "since the last "
+                                                     "reschedule, instead of "
+                                                     "resolving every "
+                                                     "conflict again."));
+    return gc;
+}
+
 static GlobalSpinBoxSetting *GRPrefInputRecPriority()
 {
     auto *bs = new GlobalSpinBoxSetting("PrefInputPriority", 1, 99, 1);
@@ -4458,6 +4495,7 @@ GeneralSettings::GeneralSettings()
 
     jobs->addChild(CommercialSkipMethod());
     jobs->addChild(CommFlagFast());
+    jobs->addChild(CommFlagSegments());
     jobs->addChild(AggressiveCommDetect());
     jobs->addChild(DeferAutoTranscodeDays());
 
@@ -4498,6 +4536,7 @@ GeneralRecPrioritiesSettings::GeneralRecPrioritiesSettings()
     sched->setLabel(tr("Scheduler Options"));
 
     sched->addChild(GRSchedOpenEnd());
+    sched->addChild(GRSchedIncrementalPlacement());
     sched->addChild(GRPrefInputRecPriority());
     sched->addChild(GRHDTVRecPriority());
     sched->addChild(GRWSRecPriority());
@@ -52,6 +52,8 @@ ProgramInfoCache::~ProgramInfoCache()
 
     Clear();
     free_vec(m_nextCache);
+    for (auto & it : m_nextChanged)
+        delete it;
 }
 
 void ProgramInfoCache::ScheduleLoad(const bool updateUI)
@@ -66,21 +68,54 @@ void ProgramInfoCache::ScheduleLoad(const bool updateUI)
     }
 }
 
+/** \brief Loads the recordings changed since the cache was loaded, or
+ *         the whole list if the backend can not tell which changed.
+ *
+ *  The result is applied to the cache by the next call to Refresh().
+ */
 void ProgramInfoCache::Load(const bool updateUI)
 {
     QMutexLocker locker(&m_lock);
     m_loadIsQueued = false;
+    QString cursor = m_cursor;
 
     locker.unlock();
     /**/
+    bool reload = true;
+    vector<ProgramInfo*> changed;
+    vector<uint> deleted;
+    if (!RemoteGetRecordedListChanges(cursor, reload, changed, deleted))
+    {
+        cursor.clear();
+        reload = true;
+    }
+
     // Get an unsorted list (sort = 0) from RemoteGetRecordedList
     // we sort the list later anyway.
-    vector<ProgramInfo*> *tmp = RemoteGetRecordedList(0);
+    vector<ProgramInfo*> *tmp = nullptr;
+    if (reload)
+        tmp = RemoteGetRecordedList(0);
     /**/
     locker.relock();
 
-    free_vec(m_nextCache);
-    m_nextCache = tmp;
+    if (reload)
+    {
+        free_vec(m_nextCache);
+        m_nextCache = tmp;
+        for (auto & it : m_nextChanged)
+            delete it;
+        m_nextChanged.clear();
+        m_nextDeleted.clear();
+        m_cursor = tmp ? cursor : QString();
+    }
+    else
+    {
+        m_nextChanged.insert(m_nextChanged.end(),
+                             changed.begin(), changed.end());
+        m_nextDeleted.insert(m_nextDeleted.end(),
+                             deleted.begin(), deleted.end());
+        m_cursor = cursor;
+    }
 
     if (updateUI)
         QCoreApplication::postEvent(
@@ -106,7 +141,8 @@ void ProgramInfoCache::WaitForLoadToComplete(void) const
 /** \brief Refreshed the cache.
  *
  *  If a new list has been loaded this fills the cache with that list
- *  if not, this simply removes list items marked for deletion from the
+ *  and then applies any changes loaded since, if not, this applies the
+ *  loaded changes and removes list items marked for deletion from the
  *  the list.
  *
  *  \note This must only be called from the UI thread.
@@ -128,8 +164,10 @@ void ProgramInfoCache::Refresh(void)
         }
         delete m_nextCache;
         m_nextCache = nullptr;
+        ApplyChanges();
         return;
     }
+    ApplyChanges();
     locker.unlock();
 
     Cache::iterator it = m_cache.begin();
@@ -147,6 +185,41 @@ void ProgramInfoCache::Refresh(void)
     }
 }
 
+/// Applies the loaded changes to the cache, m_lock must be held when
+/// this is called.
+void ProgramInfoCache::ApplyChanges(void)
+{
+    for (auto *pginfo : m_nextChanged)
+    {
+        Cache::iterator it = m_cache.find(pginfo->GetRecordingID());
+        if (!pginfo->GetChanID())
+        {
+            delete pginfo;
+        }
+        else if (it != m_cache.end())
+        {
+            (*it)->clone(*pginfo, true);
+            delete pginfo;
+        }
+        else
+        {
+            m_cache[pginfo->GetRecordingID()] = pginfo;
+        }
+    }
+    m_nextChanged.clear();
+
+    for (uint recordingID : m_nextDeleted)
+    {
+        Cache::iterator it = m_cache.find(recordingID);
+        if (it != m_cache.end())
+        {
+            delete (*it);
+            m_cache.erase(it);
+        }
+    }
+    m_nextDeleted.clear();
+}
+
 /** \brief Updates a ProgramInfo in the cache.
  *  \note This must only be called from the UI thread.
  *  \return True iff the ProgramInfo was in the cache and was updated.
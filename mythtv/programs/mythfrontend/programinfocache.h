@@ -12,6 +12,7 @@ using namespace std;
 #include <QWaitCondition>
 #include <QDateTime>
 #include <QMutex>
+#include <QString>
 #include <QHash>
 
 class ProgramInfoLoader;
@@ -45,6 +46,7 @@ class ProgramInfoCache
   private:
     void Load(bool updateUI = true);
     void Clear(void);
+    void ApplyChanges(void);
 
   private:
     // NOTE: Hash would be faster for lookups and updates, but we need a sorted
@@ -57,6 +59,11 @@ class ProgramInfoCache
     mutable QMutex          m_lock;
     Cache                   m_cache;
     vector<ProgramInfo*>   *m_nextCache         {nullptr};
+    /// Changes loaded since m_nextCache, or since the cache if none
+    vector<ProgramInfo*>    m_nextChanged;
+    vector<uint>            m_nextDeleted;
+    /// Backend cursor of the list once the loaded changes are applied
+    QString                 m_cursor;
     QObject                *m_listener          {nullptr};
     bool                    m_loadIsQueued      {false};
     uint                    m_loadsInProgress   {0};
@@ -0,0 +1,206 @@
+
+#include "encodebuffer.h"
+
+#include "audioreencodebuffer.h"
+#include "io/mythavformatwriter.h"
+#include "HLS/httplivestream.h"
+#include "mythframepool.h"
+
+#include <chrono> // for milliseconds
+#include <thread> // for sleep_for
+
+EncodeBuffer::EncodeBuffer(AudioReencodeBuffer *arb, MythAVFormatWriter *avfw,
+                           MythAVFormatWriter *avfw2, HTTPLiveStream *hls,
+                           int hlsSegmentSize, int size)
+  : m_arb(arb),   m_avfw(avfw),                     m_avfw2(avfw2),
+    m_hls(hls),   m_hlsSegmentSize(hlsSegmentSize), m_maxFrames(size),
+    m_hlsSegment(hls ? hls->GetCurrentSegment() : 0)
+{
+    setAutoDelete(false);
+    MythFramePool::Get()->AddClient();
+}
+
+EncodeBuffer::~EncodeBuffer()
+{
+    stop();
+
+    for (auto *frame : qAsConst(m_allFrames))
+    {
+        MythFramePool::Get()->Release(frame->buf);
+        delete frame;
+    }
+    MythFramePool::Get()->RemoveClient();
+}
+
+/// Stops the encoder thread, dropping the frames it has not written yet
+void EncodeBuffer::stop(void)
+{
+    m_queueLock.lock();
+    m_runThread = false;
+    m_queueLock.unlock();
+    m_frameWaitCond.wakeAll();
+
+    while (m_isRunning)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+/// Waits for the encoder thread to write every frame added so far
+void EncodeBuffer::finish(void)
+{
+    m_queueLock.lock();
+    m_finish = true;
+    m_queueLock.unlock();
+    m_frameWaitCond.wakeAll();
+
+    while (m_isRunning)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+void EncodeBuffer::run()
+{
+    QMutexLocker locker(&m_queueLock);
+    while (m_runThread)
+    {
+        if (m_frameList.isEmpty())
+        {
+            if (m_finish)
+                break;
+
+            m_frameWaitCond.wait(locker.mutex());
+            continue;
+        }
+
+        EncodeFrameInfo efInfo = m_frameList.takeFirst();
+        locker.unlock();
+
+        WriteAudio(efInfo.timecodeOffset);
+        if (efInfo.frame)
+            WriteVideo(efInfo);
+
+        locker.relock();
+        if (efInfo.frame)
+            m_freeFrames.append(efInfo.frame);
+        m_frameWaitCond.wakeAll();
+    }
+    locker.unlock();
+    m_isRunning = false;
+}
+
+/**
+ * Returns a frame of the given size for the next picture to encode, waiting
+ * while all of them are queued for the encoder.
+ *
+ * \return nullptr once the encoder thread has been stopped
+ */
+VideoFrame *EncodeBuffer::GetFreeFrame(int width, int height)
+{
+    QMutexLocker locker(&m_queueLock);
+
+    while (m_freeFrames.isEmpty() && m_allFrames.size() >= m_maxFrames)
+    {
+        if (!m_runThread)
+            return nullptr;
+        m_frameWaitCond.wait(locker.mutex());
+    }
+
+    VideoFrame *frame = nullptr;
+    if (!m_freeFrames.isEmpty())
+    {
+        frame = m_freeFrames.takeFirst();
+        if (frame->width == width && frame->height == height)
+            return frame;
+        MythFramePool::Get()->Release(frame->buf);
+    }
+    else
+    {
+        frame = new VideoFrame {};
+        m_allFrames.append(frame);
+    }
+
+    size_t size = GetBufferSize(FMT_YV12, width, height);
+    unsigned char *buf = MythFramePool::Get()->Acquire(size);
+    init(frame, FMT_YV12, buf, width, height, static_cast<int>(size));
+    return frame;
+}
+
+/**
+ * Queues a frame from GetFreeFrame() for the encoder. Its timecode is on the
+ * output time base, timecodeOffset takes it back to the input time base.
+ * A null frame only has the audio written that is due so far.
+ */
+void EncodeBuffer::AddFrame(VideoFrame *frame, long long timecodeOffset)
+{
+    QMutexLocker locker(&m_queueLock);
+
+    m_frameList.append({ frame, timecodeOffset });
+    m_frameWaitCond.wakeAll();
+}
+
+/**
+ * Returns the number of HLS segments the encoder thread has started since
+ * the last call. The caller adds them to the HTTPLiveStream.
+ */
+int EncodeBuffer::TakeNewSegments(void)
+{
+    QMutexLocker locker(&m_queueLock);
+
+    int segments = m_newSegments;
+    m_newSegments = 0;
+    return segments;
+}
+
+/// Writes the audio that plays before the last video frame written
+void EncodeBuffer::WriteAudio(long long timecodeOffset)
+{
+    AudioBuffer *ab = nullptr;
+    while ((ab = m_arb->GetData(m_lastWrittenTime)) != nullptr)
+    {
+        auto *buf = (unsigned char *)ab->data();
+        long long tc = ab->m_time - timecodeOffset;
+        m_avfw->WriteAudioFrame(buf, m_audioFrame, tc);
+
+        if (m_avfw2)
+        {
+            if ((m_avfw2->GetTimecodeOffset() == -1) &&
+                (m_avfw->GetTimecodeOffset() != -1))
+            {
+                m_avfw2->SetTimecodeOffset(m_avfw->GetTimecodeOffset());
+            }
+
+            tc = ab->m_time - timecodeOffset;
+            m_avfw2->WriteAudioFrame(buf, m_audioFrame, tc);
+        }
+
+        ++m_audioFrame;
+        delete ab;
+    }
+}
+
+void EncodeBuffer::WriteVideo(const EncodeFrameInfo &efInfo)
+{
+    if ((m_hls) &&
+        (m_avfw->GetFramesWritten()) &&
+        (m_hlsSegmentFrames > m_hlsSegmentSize) &&
+        (m_avfw->NextFrameIsKeyFrame()))
+    {
+        ++m_hlsSegment;
+        m_avfw->ReOpen(m_hls->GetFilename(m_hlsSegment));
+
+        if (m_avfw2)
+            m_avfw2->ReOpen(m_hls->GetFilename(m_hlsSegment, false, true));
+
+        m_hlsSegmentFrames = 0;
+
+        QMutexLocker locker(&m_queueLock);
+        ++m_newSegments;
+    }
+
+    if (m_avfw->WriteVideoFrame(efInfo.frame) > 0)
+    {
+        m_lastWrittenTime = efInfo.frame->timecode + efInfo.timecodeOffset;
+        if (m_hls)
+            ++m_hlsSegmentFrames;
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,82 @@
+#ifndef ENCODEBUFFER_H
+#define ENCODEBUFFER_H
+
+#include <QList>
+#include <QWaitCondition>
+#include <QMutex>
+#include <QRunnable>
+
+#include "mythframe.h"
+
+class AudioReencodeBuffer;
+class MythAVFormatWriter;
+class HTTPLiveStream;
+
+/**
+ * Encodes and muxes the output of a libavformat transcode on its own thread,
+ * so that the transcode loop can scale the next frames while the encoders
+ * work on the last ones.
+ *
+ * Frames are taken from a small set that is reused, which bounds the frames
+ * waiting for the encoder. They are written in the order they were added,
+ * each after the audio that goes before it, exactly as the transcode loop
+ * would have written them itself.
+ *
+ * HTTPLiveStream is not thread safe, so for HLS the encoder thread only
+ * reopens the writers on the next segment's file, which GetFilename() gives
+ * without changing the stream. The transcode loop adds the segments to the
+ * stream, as told by TakeNewSegments().
+ *
+ * The buffer must be started on a thread as soon as it is made.
+ */
+class EncodeBuffer : public QRunnable
+{
+  public:
+    EncodeBuffer(AudioReencodeBuffer *arb, MythAVFormatWriter *avfw,
+                 MythAVFormatWriter *avfw2, HTTPLiveStream *hls,
+                 int hlsSegmentSize, int size = 4);
+    ~EncodeBuffer() override;
+
+    void          stop(void);
+    void          finish(void);
+    void run() override; // QRunnable
+    VideoFrame   *GetFreeFrame(int width, int height);
+    void          AddFrame(VideoFrame *frame, long long timecodeOffset);
+    int           TakeNewSegments(void);
+
+  private:
+    struct EncodeFrameInfo
+    {
+        VideoFrame *frame;
+        long long   timecodeOffset;
+    };
+
+    void          WriteAudio(long long timecodeOffset);
+    void          WriteVideo(const EncodeFrameInfo &info);
+
+    AudioReencodeBuffer * const m_arb            {nullptr};
+    MythAVFormatWriter * const  m_avfw           {nullptr};
+    MythAVFormatWriter * const  m_avfw2          {nullptr};
+    HTTPLiveStream * const      m_hls            {nullptr};
+    int const                   m_hlsSegmentSize;
+    int const                   m_maxFrames;
+    bool volatile               m_runThread      {true};
+    bool volatile               m_isRunning      {true}; // Started when made
+
+    // Only used by the encoder thread
+    int                         m_audioFrame     {0};
+    int                         m_hlsSegmentFrames {0};
+    uint16_t                    m_hlsSegment       {0};
+    long long                   m_lastWrittenTime  {0};
+
+    QMutex mutable              m_queueLock; // Guards the following...
+    bool                        m_finish         {false};
+    int                         m_newSegments    {0};
+    QList<EncodeFrameInfo>      m_frameList;
+    QList<VideoFrame*>          m_freeFrames;
+    QList<VideoFrame*>          m_allFrames;
+    QWaitCondition              m_frameWaitCond;
+};
+
+#endif
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
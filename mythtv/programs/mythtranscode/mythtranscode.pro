@@ -17,14 +17,14 @@ macx: QMAKE_CFLAGS -= -O3 -O2 -O1 -Os
 
 # Input
 SOURCES += main.cpp transcode.cpp mpeg2fix.cpp
-SOURCES += audioreencodebuffer.cpp cutter.cpp videodecodebuffer.cpp
+SOURCES += audioreencodebuffer.cpp cutter.cpp videodecodebuffer.cpp encodebuffer.cpp
 SOURCES += commandlineparser.cpp
 SOURCES += external/replex/element.cpp external/replex/mpg_common.cpp
 SOURCES += external/replex/multiplex.cpp external/replex/pes.cpp
 SOURCES += external/replex/ringbuffer.cpp external/replex/ts.cpp
 
 HEADERS += mpeg2fix.h transcodedefs.h commandlineparser.h
-HEADERS += audioreencodebuffer.h cutter.h videodecodebuffer.h
+HEADERS += audioreencodebuffer.h cutter.h videodecodebuffer.h encodebuffer.h
 HEADERS += external/replex/element.h external/replex/mpg_common.h
 HEADERS += external/replex/multiplex.h external/replex/pes.h
 HEADERS += external/replex/ringbuffer.h external/replex/ts.h
@@ -43,3 +43,10 @@ DEPENDPATH += ../../libs/libmythtv/recorders
 }
 
 INCLUDEPATH += $$DEPENDPATH
+
+test_clean.commands = -cd test/ && $(MAKE) -f Makefile clean
+clean.depends = test_clean
+QMAKE_EXTRA_TARGETS += test_clean clean
+test_distclean.commands = -cd test/ && $(MAKE) -f Makefile distclean
+distclean.depends = test_distclean
+QMAKE_EXTRA_TARGETS += test_distclean distclean
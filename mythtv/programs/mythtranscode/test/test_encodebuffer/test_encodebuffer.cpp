@@ -0,0 +1,3 @@
+#include "test_encodebuffer.h"
+
+QTEST_APPLESS_MAIN(TestEncodeBuffer)
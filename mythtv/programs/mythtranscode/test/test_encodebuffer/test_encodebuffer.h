@@ -0,0 +1,401 @@
+/*
+ *  Class TestEncodeBuffer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+#include "mythcorecontext.h"
+#include "mythframe.h"
+#include "mythavutil.h"
+#include "io/mythavformatwriter.h"
+
+#include "audioreencodebuffer.h"
+#include "encodebuffer.h"
+
+extern "C" {
+#include "libswscale/swscale.h"
+}
+
+/*
+ * The same frames and audio written through EncodeBuffer and through the
+ * loop transcode.cpp ran before it must give the same file, byte for byte.
+ */
+class TestEncodeBuffer : public QObject
+{
+    Q_OBJECT
+
+    static const int kWidth          = 64;
+    static const int kHeight         = 48;
+    static const int kFrames         = 300;
+    static const int kFrameTime      = 40;    // msec, 25 fps
+    static const int kAudioRate      = 48000;
+    static const int kAudioChannels  = 2;
+    static const int kAudioPerFrame  = kAudioRate * kFrameTime / 1000;
+
+    QTemporaryDir m_dir;
+
+    std::unique_ptr<MythAVFormatWriter> makeWriter(const QString &name,
+                                                   int width, int height,
+                                                   int threads = 1,
+                                                   bool frameThreading = false)
+    {
+        auto writer = std::make_unique<MythAVFormatWriter>();
+        writer->SetContainer("mpegts");
+        writer->SetVideoCodec("mpeg2video");
+        writer->SetAudioCodec("mp2");
+        writer->SetFilename(m_dir.filePath(name));
+        writer->SetWidth(width);
+        writer->SetHeight(height);
+        writer->SetAspect(16.0F / 9.0F);
+        writer->SetFramerate(1000.0 / kFrameTime);
+        writer->SetKeyFrameDist(15);
+        writer->SetVideoBitrate(4000000);
+        writer->SetAudioBitrate(128000);
+        writer->SetAudioChannels(kAudioChannels);
+        writer->SetAudioFrameRate(kAudioRate);
+        writer->SetAudioFormat(FORMAT_S16);
+        writer->SetThreadCount(threads);
+        writer->SetFrameThreading(frameThreading);
+        if (!writer->Init() || !writer->OpenFile())
+            return nullptr;
+        return writer;
+    }
+
+    /// Set up as transcode.cpp does for libavformat output
+    static std::unique_ptr<AudioReencodeBuffer> makeAudio(
+        MythAVFormatWriter *writer)
+    {
+        auto arb = std::make_unique<AudioReencodeBuffer>(
+            FORMAT_S16, kAudioChannels, false);
+        arb->Reconfigure(AudioSettings(FORMAT_S16, kAudioChannels,
+                                       AV_CODEC_ID_NONE, kAudioRate, false));
+        arb->m_audioFrameSize =
+            writer->GetAudioFrameSize() * kAudioChannels * 2;
+        return arb;
+    }
+
+    /// Adds the audio that plays with frame number i, as the decoder does
+    static void addAudio(AudioReencodeBuffer *arb, int i)
+    {
+        std::vector<int16_t> samples(kAudioPerFrame * kAudioChannels);
+        for (size_t s = 0; s < samples.size(); s++)
+            samples[s] = static_cast<int16_t>(((i * 131) + (s * 7)) & 0x3FFF);
+        arb->AddFrames(samples.data(), kAudioPerFrame,
+                       static_cast<int64_t>(i) * kFrameTime);
+    }
+
+    static void fillFrame(VideoFrame *frame, int i)
+    {
+        for (int y = 0; y < frame->height; y++)
+        {
+            unsigned char *row = frame->buf + frame->offsets[0] +
+                                 (y * frame->pitches[0]);
+            for (int x = 0; x < frame->width; x++)
+                row[x] = static_cast<unsigned char>(x + y + (i * 3));
+        }
+        for (uint plane = 1; plane < 3; plane++)
+        {
+            memset(frame->buf + frame->offsets[plane], 128,
+                   static_cast<size_t>(frame->pitches[plane]) *
+                   ((frame->height + 1) / 2));
+        }
+        frame->timecode = static_cast<long long>(i) * kFrameTime;
+    }
+
+    /// Every third frame is dropped, as when halving the frame rate
+    static bool skipped(int i) { return (i % 3) == 2; }
+
+    /// The write loop transcode.cpp ran before EncodeBuffer
+    static void writeAudioSerial(MythAVFormatWriter *writer,
+                                 AudioReencodeBuffer *arb,
+                                 long long lastWrittenTime, int &audioFrame)
+    {
+        AudioBuffer *ab = nullptr;
+        while ((ab = arb->GetData(lastWrittenTime)) != nullptr)
+        {
+            long long tc = ab->m_time;
+            writer->WriteAudioFrame((unsigned char *)ab->data(),
+                                    audioFrame++, tc);
+            delete ab;
+        }
+    }
+
+    static QByteArray readFile(const QString &name)
+    {
+        QFile file(name);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        gCoreContext = new MythCoreContext("bin_version", nullptr);
+        QVERIFY(m_dir.isValid());
+    }
+
+    void cleanupTestCase(void)
+    {
+        delete gCoreContext;
+        gCoreContext = nullptr;
+    }
+
+    void finish_writesSameOutputAsSerial(void)
+    {
+        auto serial = makeWriter("serial.ts", kWidth, kHeight);
+        QVERIFY(serial);
+        auto serialAudio = makeAudio(serial.get());
+
+        VideoFrame frame {};
+        size_t size = GetBufferSize(FMT_YV12, kWidth, kHeight);
+        init(&frame, FMT_YV12, GetAlignedBuffer(size), kWidth, kHeight,
+             static_cast<int>(size));
+        long long lastWrittenTime = 0;
+        int audioFrame = 0;
+        for (int i = 0; i < kFrames; i++)
+        {
+            addAudio(serialAudio.get(), i);
+            writeAudioSerial(serial.get(), serialAudio.get(),
+                             lastWrittenTime, audioFrame);
+            if (skipped(i))
+                continue;
+            fillFrame(&frame, i);
+            if (serial->WriteVideoFrame(&frame) > 0)
+                lastWrittenTime = frame.timecode;
+        }
+        av_freep(&frame.buf);
+        serial->CloseFile();
+
+        auto threaded = makeWriter("threaded.ts", kWidth, kHeight);
+        QVERIFY(threaded);
+        auto threadedAudio = makeAudio(threaded.get());
+
+        EncodeBuffer buffer(threadedAudio.get(), threaded.get(),
+                            nullptr, nullptr, 0);
+        std::thread encoder([&buffer]() { buffer.run(); });
+        std::set<VideoFrame*> frames;
+        bool gotFrames = true;
+        for (int i = 0; i < kFrames; i++)
+        {
+            addAudio(threadedAudio.get(), i);
+            VideoFrame *next = nullptr;
+            if (!skipped(i))
+            {
+                next = buffer.GetFreeFrame(kWidth, kHeight);
+                gotFrames &= (next != nullptr);
+                if (!next)
+                    break;
+                frames.insert(next);
+                fillFrame(next, i);
+            }
+            buffer.AddFrame(next, 0);
+        }
+        buffer.finish();
+        encoder.join();
+        threaded->CloseFile();
+
+        QVERIFY(gotFrames);
+        QVERIFY(frames.size() <= 4);
+        QVERIFY(serial->GetFramesWritten() > 0);
+        QCOMPARE(threaded->GetFramesWritten(), serial->GetFramesWritten());
+        QCOMPARE(threaded->GetTimecodeOffset(), serial->GetTimecodeOffset());
+
+        QByteArray expected = readFile(m_dir.filePath("serial.ts"));
+        QVERIFY(!expected.isEmpty());
+        QVERIFY(readFile(m_dir.filePath("threaded.ts")) == expected);
+
+        // The frames written are reused, at a new size if need be
+        VideoFrame *resized = buffer.GetFreeFrame(kWidth / 2, kHeight / 2);
+        QVERIFY(resized != nullptr);
+        QCOMPARE(resized->width, kWidth / 2);
+        QCOMPARE(resized->height, kHeight / 2);
+    }
+
+    /// MPEG-2 with B frames holds frames back, as x264 does with frame
+    /// threading. Closing the file must still write all of them.
+    void closeFile_drainsEncoder(void)
+    {
+        auto writer = makeWriter("drain.ts", kWidth, kHeight, 2, true);
+        QVERIFY(writer);
+
+        VideoFrame frame {};
+        size_t size = GetBufferSize(FMT_YV12, kWidth, kHeight);
+        init(&frame, FMT_YV12, GetAlignedBuffer(size), kWidth, kHeight,
+             static_cast<int>(size));
+        const int kCount = 20;
+        for (int i = 0; i < kCount; i++)
+        {
+            fillFrame(&frame, i);
+            QVERIFY(writer->WriteVideoFrame(&frame) >= 0);
+        }
+        av_freep(&frame.buf);
+        QVERIFY(writer->GetFramesWritten() < kCount);
+
+        writer->CloseFile();
+        QCOMPARE(writer->GetFramesWritten(), static_cast<long long>(kCount));
+    }
+
+    void stop_doesNotBlock(void)
+    {
+        for (int round = 0; round < 20; round++)
+        {
+            auto writer = makeWriter(QString("stop%1.ts").arg(round),
+                                     kWidth, kHeight);
+            QVERIFY(writer);
+            auto arb = makeAudio(writer.get());
+
+            EncodeBuffer buffer(arb.get(), writer.get(), nullptr, nullptr, 0);
+            std::thread encoder([&buffer]() { buffer.run(); });
+            int stopAt = 10 + (round * 7);
+            for (int i = 0; i < stopAt; i++)
+            {
+                addAudio(arb.get(), i);
+                VideoFrame *next = buffer.GetFreeFrame(kWidth, kHeight);
+                if (!next)
+                    break;
+                fillFrame(next, i);
+                buffer.AddFrame(next, 0);
+            }
+            buffer.stop();
+            encoder.join();
+            writer->CloseFile();
+
+            // Once the free frames are used up, it returns at once
+            VideoFrame *next = nullptr;
+            for (int i = 0; i < 5; i++)
+            {
+                next = buffer.GetFreeFrame(kWidth, kHeight);
+                if (!next)
+                    break;
+            }
+            QVERIFY(next == nullptr);
+        }
+    }
+
+    /// Scales 1080 lines down to 720 and encodes them, first the way
+    /// transcode.cpp did and then with the encoder on its own thread.
+    /// Reports frames per second for both.
+    void benchmarkScaleAndEncode(void)
+    {
+        using clock = std::chrono::steady_clock;
+        const int kSrcWidth  = 1920;
+        const int kSrcHeight = 1080;
+        const int kDstWidth  = 1280;
+        const int kDstHeight = 720;
+        const int kCount     = 200;
+        int threads = std::max(1, QThread::idealThreadCount());
+
+        VideoFrame source {};
+        size_t srcSize = GetBufferSize(FMT_YV12, kSrcWidth, kSrcHeight);
+        init(&source, FMT_YV12, GetAlignedBuffer(srcSize),
+             kSrcWidth, kSrcHeight, static_cast<int>(srcSize));
+        fillFrame(&source, 0);
+
+        SwsContext *scontext = sws_getContext(
+            kSrcWidth, kSrcHeight, AV_PIX_FMT_YUV420P,
+            kDstWidth, kDstHeight, AV_PIX_FMT_YUV420P,
+            SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+        QVERIFY(scontext);
+        AVFrame imageIn;
+        AVFrame imageOut;
+        AVPictureFill(&imageIn, &source);
+
+        auto scale = [&](VideoFrame *frame, int i)
+        {
+            AVPictureFill(&imageOut, frame);
+            sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
+                      kSrcHeight, imageOut.data, imageOut.linesize);
+            frame->timecode = static_cast<long long>(i) * kFrameTime;
+        };
+
+        double serialFPS = 0.0;
+        {
+            auto writer = makeWriter("bench_serial.ts",
+                                     kDstWidth, kDstHeight, threads);
+            QVERIFY(writer);
+            auto arb = makeAudio(writer.get());
+            VideoFrame frame {};
+            size_t size = GetBufferSize(FMT_YV12, kDstWidth, kDstHeight);
+            init(&frame, FMT_YV12, GetAlignedBuffer(size),
+                 kDstWidth, kDstHeight, static_cast<int>(size));
+            long long lastWrittenTime = 0;
+            int audioFrame = 0;
+
+            auto start = clock::now();
+            for (int i = 0; i < kCount; i++)
+            {
+                addAudio(arb.get(), i);
+                scale(&frame, i);
+                writeAudioSerial(writer.get(), arb.get(),
+                                 lastWrittenTime, audioFrame);
+                if (writer->WriteVideoFrame(&frame) > 0)
+                    lastWrittenTime = frame.timecode;
+            }
+            std::chrono::duration<double> secs = clock::now() - start;
+            serialFPS = kCount / secs.count();
+
+            av_freep(&frame.buf);
+            writer->CloseFile();
+        }
+
+        double threadedFPS = 0.0;
+        {
+            auto writer = makeWriter("bench_threaded.ts",
+                                     kDstWidth, kDstHeight, threads, true);
+            QVERIFY(writer);
+            auto arb = makeAudio(writer.get());
+            EncodeBuffer buffer(arb.get(), writer.get(), nullptr, nullptr, 0);
+            std::thread encoder([&buffer]() { buffer.run(); });
+
+            auto start = clock::now();
+            for (int i = 0; i < kCount; i++)
+            {
+                addAudio(arb.get(), i);
+                VideoFrame *frame = buffer.GetFreeFrame(kDstWidth, kDstHeight);
+                if (!frame)
+                    break;
+                scale(frame, i);
+                buffer.AddFrame(frame, 0);
+            }
+            buffer.finish();
+            std::chrono::duration<double> secs = clock::now() - start;
+            threadedFPS = kCount / secs.count();
+
+            encoder.join();
+            writer->CloseFile();
+        }
+
+        sws_freeContext(scontext);
+        av_freep(&source.buf);
+
+        std::cout << QString("1080 to 720 MPEG-2, %1 threads: serial %2 fps, "
+                             "EncodeBuffer %3 fps")
+            .arg(threads).arg(serialFPS, 0, 'f', 1)
+            .arg(threadedFPS, 0, 'f', 1)
+            .toLocal8Bit().constData() << std::endl;
+        QVERIFY(serialFPS > 0.0 && threadedFPS > 0.0);
+    }
+};
@@ -34,6 +34,7 @@
 #include "HLS/httplivestream.h"
 
 #include "videodecodebuffer.h"
+#include "encodebuffer.h"
 #include "cutter.h"
 #include "audioreencodebuffer.h"
 
@@ -204,13 +205,11 @@ int Transcode::TranscodeFile(const QString &inputname,
 {
     QDateTime curtime = MythDate::current();
     QDateTime statustime = curtime;
-    int audioFrame = 0;
     std::unique_ptr<Cutter> cutter = nullptr;
     std::unique_ptr<MythAVFormatWriter> avfw = nullptr;
     std::unique_ptr<MythAVFormatWriter> avfw2 = nullptr;
     std::unique_ptr<HTTPLiveStream> hls = nullptr;
     int hlsSegmentSize = 0;
-    int hlsSegmentFrames = 0;
 
 #if !CONFIG_LIBMP3LAME
     (void)profileName;
@@ -550,6 +549,9 @@ int Transcode::TranscodeFile(const QString &inputname,
                 .arg(threads).arg(preset).arg(tune));
 
         avfw->SetThreadCount(threads);
+        // The HLS encoder runs on its own thread, so latency does not matter
+        if (m_hlsMode)
+            avfw->SetFrameThreading(true);
         avfw->SetEncodingPreset(preset);
         avfw->SetEncodingTune(tune);
 
@@ -863,7 +865,8 @@ int Transcode::TranscodeFile(const QString &inputname,
         (video_width != newWidth) || (video_height != newHeight)
         || nonAligned;
 
-    if (rescale)
+    // libavformat transcodes scale straight into the EncodeBuffer's frames
+    if (rescale && (!m_avfMode || !fifodir.isEmpty()))
     {
         size_t newSize = 0;
         if (nonAligned)
@@ -1012,6 +1015,9 @@ int Transcode::TranscodeFile(const QString &inputname,
     bool writekeyframe = true;
     long lastKeyFrame = 0;
     int num_keyframes = 0;
+    int audioFrame = 0;
+    // timecode of the last write video frame in input or output time
+    long long lastWrittenTime = 0;
 #endif
 
     frm_dir_map_t::iterator dm_iter;
@@ -1024,8 +1030,6 @@ int Transcode::TranscodeFile(const QString &inputname,
     int dropvideo = 0;
     // timecode of the last read video frame in input time
     long long lasttimecode = 0;
-    // timecode of the last write video frame in input or output time
-    long long lastWrittenTime = 0;
     // delta between the same video frame in input and output due to applying the cut list
     long long timecodeOffset = 0;
 
@@ -1054,6 +1058,15 @@ int Transcode::TranscodeFile(const QString &inputname,
         new VideoDecodeBuffer(player, videoOutput, honorCutList);
     MThreadPool::globalInstance()->start(videoBuffer, "VideoDecodeBuffer");
 
+    // Encoding and muxing for libavformat happen on a thread of their own
+    EncodeBuffer *encodeBuffer = nullptr;
+    if (m_avfMode)
+    {
+        encodeBuffer = new EncodeBuffer(arb, avfw.get(), avfw2.get(), hls.get(),
+                                        hlsSegmentSize);
+        MThreadPool::globalInstance()->startReserved(encodeBuffer, "EncodeBuffer");
+    }
+
     QElapsedTimer flagTime;
     flagTime.start();
 
@@ -1355,53 +1368,77 @@ int Transcode::TranscodeFile(const QString &inputname,
                         .arg(newWidth).arg(newHeight));
             }
 
-            if (rescale)
+            if (encodeBuffer)
             {
-                AVPictureFill(&imageIn, lastDecode);
-                AVPictureFill(&imageOut, &frame);
-
-                int bottomBand = (lastDecode->height == 1088) ? 8 : 0;
-                scontext = sws_getCachedContext(scontext,
-                               lastDecode->width, lastDecode->height, FrameTypeToPixelFormat(lastDecode->codec),
-                               frame.width, frame.height, FrameTypeToPixelFormat(frame.codec),
-                               SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-
-                sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
-                          lastDecode->height - bottomBand,
-                          imageOut.data, imageOut.linesize);
-            }
+                lasttimecode = frame.timecode;
+                frame.timecode -= timecodeOffset;
 
-            // audio is fully decoded, so we need to reencode it
-            AudioBuffer *ab = nullptr;
-            while ((ab = arb->GetData(lastWrittenTime)) != nullptr)
-            {
-                auto *buf = (unsigned char *)ab->data();
-                if (m_avfMode)
+                VideoFrame *encodeFrame = nullptr;
+                if (halfFramerate && !skippedLastFrame)
                 {
-                    if (did_ff != 1)
-                    {
-                        long long tc = ab->m_time - timecodeOffset;
-                        avfw->WriteAudioFrame(buf, audioFrame, tc);
-
-                        if (avfw2)
-                        {
-                            if ((avfw2->GetTimecodeOffset() == -1) &&
-                                (avfw->GetTimecodeOffset() != -1))
-                            {
-                                avfw2->SetTimecodeOffset(
-                                    avfw->GetTimecodeOffset());
-                            }
-
-                            tc = ab->m_time - timecodeOffset;
-                            avfw2->WriteAudioFrame(buf, audioFrame, tc);
-                        }
+                    skippedLastFrame = true;
+                }
+                else
+                {
+                    skippedLastFrame = false;
+                    encodeFrame = encodeBuffer->GetFreeFrame(newWidth, newHeight);
+                }
 
-                        ++audioFrame;
+                if (encodeFrame)
+                {
+                    if (rescale || lastDecode->width != newWidth ||
+                        lastDecode->height != newHeight)
+                    {
+                        AVPictureFill(&imageIn, lastDecode);
+                        AVPictureFill(&imageOut, encodeFrame);
+
+                        int bottomBand = (lastDecode->height == 1088) ? 8 : 0;
+                        scontext = sws_getCachedContext(scontext,
+                                       lastDecode->width, lastDecode->height, FrameTypeToPixelFormat(lastDecode->codec),
+                                       encodeFrame->width, encodeFrame->height, FrameTypeToPixelFormat(encodeFrame->codec),
+                                       SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
+                        sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
+                                  lastDecode->height - bottomBand,
+                                  imageOut.data, imageOut.linesize);
                     }
+                    else
+                    {
+                        copy(encodeFrame, lastDecode);
+                    }
+                    encodeFrame->timecode = frame.timecode;
                 }
+
+                // The audio goes in even when the frame is skipped
+                encodeBuffer->AddFrame(encodeFrame, timecodeOffset);
+
+                for (int n = encodeBuffer->TakeNewSegments(); hls && n > 0; --n)
+                    hls->AddSegment();
+            }
 #if CONFIG_LIBMP3LAME
-                else
+            else
+            {
+                if (rescale)
                 {
+                    AVPictureFill(&imageIn, lastDecode);
+                    AVPictureFill(&imageOut, &frame);
+
+                    int bottomBand = (lastDecode->height == 1088) ? 8 : 0;
+                    scontext = sws_getCachedContext(scontext,
+                                   lastDecode->width, lastDecode->height, FrameTypeToPixelFormat(lastDecode->codec),
+                                   frame.width, frame.height, FrameTypeToPixelFormat(frame.codec),
+                                   SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
+                    sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
+                              lastDecode->height - bottomBand,
+                              imageOut.data, imageOut.linesize);
+                }
+
+                // audio is fully decoded, so we need to reencode it
+                AudioBuffer *ab = nullptr;
+                while ((ab = arb->GetData(lastWrittenTime)) != nullptr)
+                {
+                    auto *buf = (unsigned char *)ab->data();
                     m_nvr->SetOption("audioframesize", ab->size());
                     m_nvr->WriteAudio(buf, audioFrame++,
                                     ab->m_time - timecodeOffset);
@@ -1421,61 +1458,15 @@ int Transcode::TranscodeFile(const QString &inputname,
                         delete ab;
                         return REENCODE_ERROR;
                     }
+                    delete ab;
                 }
-#endif
-                delete ab;
-            }
 
-            if (!m_avfMode)
-            {
-#if CONFIG_LIBMP3LAME
                 player->GetCC608Reader()->
                     TranscodeWriteText(&TranscodeWriteText, (void *)(m_nvr));
-#else
-                LOG(VB_GENERAL, LOG_ERR,
-                    "Not compiled with libmp3lame support");
-                return REENCODE_ERROR;
-#endif
-            }
-            lasttimecode = frame.timecode;
-            frame.timecode -= timecodeOffset;
 
-            if (m_avfMode)
-            {
-                if (halfFramerate && !skippedLastFrame)
-                {
-                    skippedLastFrame = true;
-                }
-                else
-                {
-                    skippedLastFrame = false;
-
-                    if ((hls) &&
-                        (avfw->GetFramesWritten()) &&
-                        (hlsSegmentFrames > hlsSegmentSize) &&
-                        (avfw->NextFrameIsKeyFrame()))
-                    {
-                        hls->AddSegment();
-                        avfw->ReOpen(hls->GetCurrentFilename());
-
-                        if (avfw2)
-                            avfw2->ReOpen(hls->GetCurrentFilename(true));
-
-                        hlsSegmentFrames = 0;
-                    }
-
-                    if (avfw->WriteVideoFrame(rescale ? &frame : lastDecode) > 0)
-                    {
-                        lastWrittenTime = frame.timecode + timecodeOffset;
-                        if (hls)
-                            ++hlsSegmentFrames;
-                    }
+                lasttimecode = frame.timecode;
+                frame.timecode -= timecodeOffset;
 
-                }
-            }
-#if CONFIG_LIBMP3LAME
-            else
-            {
                 if (forceKeyFrames)
                     m_nvr->WriteVideo(rescale ? &frame : lastDecode, true, true);
                 else
@@ -1528,6 +1519,14 @@ int Transcode::TranscodeFile(const QString &inputname,
                     LOG(VB_GENERAL, LOG_NOTICE,
                         "Transcoding STOPped by JobQueue");
 
+                    if (encodeBuffer)
+                    {
+                        encodeBuffer->stop();
+                        for (int n = encodeBuffer->TakeNewSegments();
+                             hls && n > 0; --n)
+                            hls->AddSegment();
+                        delete encodeBuffer;
+                    }
                     unlink(outputname.toLocal8Bit().constData());
                     if (rescale)
                     {
@@ -1578,6 +1577,14 @@ int Transcode::TranscodeFile(const QString &inputname,
         player->DiscardVideoFrame(lastDecode);
     }
 
+    if (encodeBuffer)
+    {
+        encodeBuffer->finish();
+        for (int n = encodeBuffer->TakeNewSegments(); hls && n > 0; --n)
+            hls->AddSegment();
+        delete encodeBuffer;
+    }
+
     sws_freeContext(scontext);
 
     if (!m_fifow)
@@ -657,6 +657,23 @@ static GlobalCheckBoxSetting *AutoCommflagWhileRecording()
     return gc;
 };
 
+static HostSpinBoxSetting *CommFlagTapCPUBudget()
+{
+    auto *gc = new HostSpinBoxSetting("CommFlagTapCPUBudget", 0, 400, 10);
+    gc->setLabel(QObject::tr("CPU budget for commercial detection while "
+                             "recording (%)"));
+    gc->setHelpText(QObject::tr("If not zero, and commercial detection jobs "
+                                "start when the recording starts, each "
+                                "recorder on this backend shares what it "
+                                "writes with a detection job on this backend "
+                                "through memory. That job then reads nothing "
+                                "back from disk, keeps the commercial break "
+                                "list up to date, and uses no more than this "
+                                "percentage of one CPU core."));
+    gc->setValue(0);
+    return gc;
+};
+
 static GlobalTextEditSetting *UserJob(uint job_num)
 {
     auto *gc = new GlobalTextEditSetting(QString("UserJob%1").arg(job_num));
@@ -989,6 +1006,7 @@ BackendSettings::BackendSettings()
     group5->addChild(JobQueueWindowStart());
     group5->addChild(JobQueueWindowEnd());
     group5->addChild(JobQueueCPU());
+    group5->addChild(CommFlagTapCPUBudget());
     group5->addChild(JobAllowMetadata());
     group5->addChild(JobAllowCommFlag());
     group5->addChild(JobAllowTranscode());
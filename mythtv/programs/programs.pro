@@ -22,3 +22,15 @@ using_backend {
 }
 
 using_mythtranscode: SUBDIRS += mythtranscode
+
+# unit tests mythcommflag
+mythcommflag-test.depends = sub-mythcommflag
+mythcommflag-test.target = buildtestmythcommflag
+mythcommflag-test.commands = cd mythcommflag/test && $(QMAKE) && $(MAKE)
+unix:QMAKE_EXTRA_TARGETS += mythcommflag-test
+
+# unit tests mythtranscode
+mythtranscode-test.depends = sub-mythtranscode
+mythtranscode-test.target = buildtestmythtranscode
+mythtranscode-test.commands = cd mythtranscode/test && $(QMAKE) && $(MAKE)
+unix:QMAKE_EXTRA_TARGETS += mythtranscode-test